@@ -0,0 +1,198 @@
+/*--------------------------------------------------------------------*/
+/* benchchurn.c                                                       */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The size of the buffer of a key */
+
+enum {MAX_KEY_LENGTH = 32};
+
+/* The number of times the lookups and maps of a phase are repeated */
+
+enum {ROUNDS = 5};
+
+/* The number of rounds of removals and puts that churn the table */
+
+enum {CHURN_ROUNDS = 4};
+
+/* The size of the blocks the program allocates between puts */
+
+enum {JUNK_SIZE = 48};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of seconds elapsed on the monotonic clock. */
+
+static double now(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the count that pvExtra points to. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvValue;
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up each of the iKeyCount keys of oSymTable, which ppcKeys
+   lists, in an order unrelated to the order they were put in, and map
+   over oSymTable, ROUNDS times each, and write the rates, labelled pcName, and the memory
+   oSymTable uses to stdout. */
+
+static void measure(const char *pcName, SymTable_T oSymTable,
+   char **ppcKeys, int iKeyCount)
+{
+   size_t uFound = 0;
+   size_t uMapped = 0;
+   double dStart;
+   double dGet;
+   double dMap;
+   int iRound;
+   int i;
+
+   dStart = now();
+   for (iRound = 0; iRound < ROUNDS; iRound++)
+      for (i = 0; i < iKeyCount; i++)
+         uFound += SymTable_get(oSymTable, ppcKeys[(int)(((unsigned long)i
+            * 1000003u) % (unsigned long)iKeyCount)]) != NULL;
+   dGet = now() - dStart;
+   dStart = now();
+   for (iRound = 0; iRound < ROUNDS; iRound++)
+      SymTable_map(oSymTable, countBinding, &uMapped);
+   dMap = now() - dStart;
+
+   printf("%-10s get %.0f ops/s, map %.0f bindings/s, %lu bytes\n",
+      pcName, (double)iKeyCount * ROUNDS / dGet,
+      (double)iKeyCount * ROUNDS / dMap,
+      (unsigned long)SymTable_memoryUsage(oSymTable, NULL));
+   if (uFound != (size_t)iKeyCount * ROUNDS ||
+      uMapped != (size_t)iKeyCount * ROUNDS)
+      printf("Found %lu and mapped %lu bindings instead of %lu\n",
+         (unsigned long)uFound, (unsigned long)uMapped,
+         (unsigned long)iKeyCount * ROUNDS);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Measure lookups and maps of the SymTable ADT with argv[1] bindings
+   when they are new, after rounds of removing a third of them and
+   putting them again while the program allocates other blocks in
+   between, which scatters the nodes and keys of the table over the
+   heap, and after SymTable_compact. Exit with EXIT_FAILURE if argv[1]
+   is missing or invalid or insufficient memory is available.
+   Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   SymTable_T oSymTable;
+   char **ppcKeys;
+   void **ppvJunk;
+   size_t uJunk = 0;
+   size_t u;
+   double dStart;
+   int iKeyCount;
+   int iRound;
+   int i;
+   int j;
+
+   if (argc != 2 || sscanf(argv[1], "%d", &iKeyCount) != 1 ||
+      iKeyCount <= 0)
+   {
+      fprintf(stderr, "Usage: %s keycount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   ppcKeys = (char**)malloc((size_t)iKeyCount * sizeof(char*));
+   ppvJunk = (void**)malloc((size_t)iKeyCount * CHURN_ROUNDS *
+      sizeof(void*));
+   oSymTable = SymTable_new();
+   if (ppcKeys == NULL || ppvJunk == NULL || oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   /* Multiplying by a prime scatters the keys. */
+   for (i = 0; i < iKeyCount; i++)
+   {
+      j = (int)(((unsigned long)i * 2654435761u) %
+         (unsigned long)iKeyCount);
+      ppcKeys[i] = (char*)malloc(MAX_KEY_LENGTH);
+      if (ppcKeys[i] == NULL)
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+      sprintf(ppcKeys[i], "symbol_%d", j);
+   }
+
+   for (i = 0; i < iKeyCount; i++)
+   {
+      if (! SymTable_put(oSymTable, ppcKeys[i], oSymTable))
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+   measure("new", oSymTable, ppcKeys, iKeyCount);
+
+   for (iRound = 0; iRound < CHURN_ROUNDS; iRound++)
+   {
+      for (i = iRound % 3; i < iKeyCount; i += 3)
+         (void)SymTable_remove(oSymTable, ppcKeys[i]);
+      for (i = iRound % 3; i < iKeyCount; i += 3)
+      {
+         ppvJunk[uJunk] = malloc(JUNK_SIZE);
+         if (ppvJunk[uJunk] == NULL ||
+            ! SymTable_put(oSymTable, ppcKeys[i], oSymTable))
+         {
+            fprintf(stderr, "Insufficient memory\n");
+            exit(EXIT_FAILURE);
+         }
+         uJunk++;
+      }
+   }
+   /* Half of the other blocks are freed, leaving holes between the
+      nodes of the table. */
+   for (u = 0; u < uJunk; u += 2)
+      free(ppvJunk[u]);
+   measure("churned", oSymTable, ppcKeys, iKeyCount);
+
+   dStart = now();
+   if (! SymTable_compact(oSymTable))
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   printf("compact    %d bindings: %f seconds\n", iKeyCount,
+      now() - dStart);
+   measure("compacted", oSymTable, ppcKeys, iKeyCount);
+
+   SymTable_free(oSymTable);
+   for (u = 1; u < uJunk; u += 2)
+      free(ppvJunk[u]);
+   for (i = 0; i < iKeyCount; i++)
+      free(ppcKeys[i]);
+   free(ppcKeys);
+   free(ppvJunk);
+   return 0;
+}
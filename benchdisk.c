@@ -0,0 +1,177 @@
+/*--------------------------------------------------------------------*/
+/* benchdisk.c                                                        */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtabledisk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The size of the buffer of a key */
+
+enum {MAX_KEY_LENGTH = 24};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of seconds elapsed on the monotonic clock. */
+
+static double now(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the rate of the iCount operations named pcName made since
+   dStart, and the pages oSymTable has read and written since the
+   counts *puReads and *puWrites, to stdout. Update the counts. */
+
+static void report(const char *pcName, SymTable_T oSymTable, int iCount,
+   double dStart, size_t *puReads, size_t *puWrites)
+{
+   double dSeconds = now() - dStart;
+   size_t uReads;
+   size_t uWrites;
+
+   SymTable_getPageStats(oSymTable, &uReads, &uWrites, NULL);
+   printf("%-8s %d: %f seconds, %.0f ops/s, %lu pages read, "
+      "%lu written\n", pcName, iCount, dSeconds,
+      (double)iCount / dSeconds, (unsigned long)(uReads - *puReads),
+      (unsigned long)(uWrites - *puWrites));
+   fflush(stdout);
+   *puReads = uReads;
+   *puWrites = uWrites;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the count that pvExtra points to. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvValue;
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Measure the disk-backed implementation of the SymTable ADT with
+   argv[1] bindings and a cache of argv[2] pages, by default one
+   thousandth of the number of bindings, which is about a tenth of the
+   pages they fill: put the bindings, get each of them and as many
+   missing keys in a scattered order, replace each value, map over
+   them and remove them. argv[3] is the directory of the file (default
+   $TMPDIR or /tmp). The kernel may keep the file in its own page
+   cache, in which case the reads cost a copy rather than a seek. Exit
+   with EXIT_FAILURE if the arguments are invalid. Otherwise return
+   0. */
+
+int main(int argc, char *argv[])
+{
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   size_t uReads = 0;
+   size_t uWrites = 0;
+   size_t uPages;
+   size_t uCount;
+   double dStart;
+   int iKeyCount;
+   int iCachePages;
+   int i;
+   int j;
+
+   if (argc < 2 || argc > 4)
+   {
+      fprintf(stderr, "Usage: %s keycount [cachepages [directory]]\n",
+         argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iKeyCount) != 1 || iKeyCount <= 0)
+   {
+      fprintf(stderr, "Invalid arguments\n");
+      exit(EXIT_FAILURE);
+   }
+   iCachePages = iKeyCount / 1000 > 0 ? iKeyCount / 1000 : 1;
+   if (argc >= 3 && (sscanf(argv[2], "%d", &iCachePages) != 1 ||
+      iCachePages <= 0))
+   {
+      fprintf(stderr, "Invalid arguments\n");
+      exit(EXIT_FAILURE);
+   }
+
+   oSymTable = SymTable_newDisk(argc == 4 ? argv[3] : NULL,
+      (size_t)iCachePages, NULL);
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   dStart = now();
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      if (! SymTable_put(oSymTable, acKey, oSymTable))
+      {
+         fprintf(stderr, "Cannot put %s\n", acKey);
+         exit(EXIT_FAILURE);
+      }
+   }
+   report("put", oSymTable, iKeyCount, dStart, &uReads, &uWrites);
+   SymTable_getPageStats(oSymTable, NULL, NULL, &uPages);
+   printf("pages    %lu in the file, %d in the cache, %.1f times the "
+      "cache\n", (unsigned long)uPages, iCachePages,
+      (double)uPages / iCachePages);
+
+   /* Multiplying by a prime scatters the keys over the buckets. */
+   dStart = now();
+   for (i = 0; i < iKeyCount; i++)
+   {
+      j = (int)(((unsigned long)i * 2654435761u) % (unsigned long)iKeyCount);
+      sprintf(acKey, "key%d", j);
+      if (SymTable_get(oSymTable, acKey) != oSymTable)
+         printf("Lost %s\n", acKey);
+   }
+   report("get", oSymTable, iKeyCount, dStart, &uReads, &uWrites);
+   dStart = now();
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "key%d", iKeyCount + i);
+      (void)SymTable_get(oSymTable, acKey);
+   }
+   report("miss", oSymTable, iKeyCount, dStart, &uReads, &uWrites);
+   dStart = now();
+   for (i = 0; i < iKeyCount; i++)
+   {
+      j = (int)(((unsigned long)i * 2654435761u) % (unsigned long)iKeyCount);
+      sprintf(acKey, "key%d", j);
+      (void)SymTable_replace(oSymTable, acKey, oSymTable);
+   }
+   report("replace", oSymTable, iKeyCount, dStart, &uReads, &uWrites);
+   dStart = now();
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   report("map", oSymTable, iKeyCount, dStart, &uReads, &uWrites);
+   if (uCount != (size_t)iKeyCount)
+      printf("Mapped %lu bindings\n", (unsigned long)uCount);
+   dStart = now();
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      (void)SymTable_remove(oSymTable, acKey);
+   }
+   report("remove", oSymTable, iKeyCount, dStart, &uReads, &uWrites);
+
+   SymTable_free(oSymTable);
+   return 0;
+}
@@ -0,0 +1,225 @@
+/*--------------------------------------------------------------------*/
+/* benchflood.c                                                       */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include "symtablegeneric.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The multiplier of the unkeyed polynomial hash that the hash table
+   used before its hash function took a random key */
+
+enum {POLY_MULTIPLIER = 65599};
+
+/* The characters a key suffix is made of */
+
+enum {FIRST_CHAR = 33, LAST_CHAR = 126};
+enum {CHAR_COUNT = LAST_CHAR - FIRST_CHAR + 1};
+
+/* The size of the buffer of a key */
+
+enum {MAX_KEY_LENGTH = 16};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the unkeyed polynomial hash code of the uLen characters at
+   pcKey. Anyone who knows it can choose keys that collide. */
+
+static size_t hashPoly(const char *pcKey, size_t uLen)
+{
+   size_t uHash = 0;
+   size_t u;
+   for (u = 0; u < uLen; u++)
+      uHash = uHash * POLY_MULTIPLIER + (size_t)pcKey[u];
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of buckets a hash table has after iKeyCount
+   keys have been put into it. */
+
+static size_t finalBucketCount(int iKeyCount)
+{
+   size_t uCount = SymTable_nextBucketCount(0);
+   size_t uNext;
+   int i;
+   for (i = 0; i < iKeyCount; i++)
+   {
+      uNext = SymTable_nextBucketCount(uCount);
+      if ((size_t)i >= SYMTABLE_MAX_LOAD * uCount && uNext != 0)
+         uCount = uNext;
+   }
+   return uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Fill ppcKeys with iKeyCount keys, each a number followed by three
+   characters. If iFlood, the characters are chosen so that every key
+   has a polynomial hash code divisible by the final bucket count,
+   putting all of them in one bucket of an unkeyed table. Otherwise
+   they are fixed. */
+
+static void makeKeys(char **ppcKeys, int iKeyCount, int iFlood)
+{
+   size_t uBuckets = finalBucketCount(iKeyCount);
+   size_t uPower = (size_t)POLY_MULTIPLIER * POLY_MULTIPLIER *
+      POLY_MULTIPLIER;
+   size_t uResidue;
+   size_t uSuffix;
+   long *plSuffixes;
+   long lNumber;
+   int i;
+
+   /* plSuffixes[r] is a suffix whose hash code is r modulo uBuckets,
+      as a number in base CHAR_COUNT, or -1 if there is none */
+   plSuffixes = (long*)malloc(uBuckets * sizeof(long));
+   if (plSuffixes == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   memset(plSuffixes, -1, uBuckets * sizeof(long));
+   for (uSuffix = 0; uSuffix < (size_t)CHAR_COUNT * CHAR_COUNT * CHAR_COUNT;
+      uSuffix++)
+   {
+      uResidue = ((uSuffix / CHAR_COUNT / CHAR_COUNT + FIRST_CHAR) *
+         POLY_MULTIPLIER * POLY_MULTIPLIER +
+         (uSuffix / CHAR_COUNT % CHAR_COUNT + FIRST_CHAR) *
+         POLY_MULTIPLIER + uSuffix % CHAR_COUNT + FIRST_CHAR) % uBuckets;
+      if (plSuffixes[uResidue] < 0)
+         plSuffixes[uResidue] = (long)uSuffix;
+   }
+
+   i = 0;
+   for (lNumber = 0; i < iKeyCount; lNumber++)
+   {
+      sprintf(ppcKeys[i], "%08ld", lNumber);
+      if (iFlood)
+      {
+         uResidue = (uBuckets - hashPoly(ppcKeys[i], 8) * uPower % uBuckets)
+            % uBuckets;
+         if (plSuffixes[uResidue] < 0)
+            continue;
+         uSuffix = (size_t)plSuffixes[uResidue];
+      }
+      else
+         uSuffix = 0;
+      ppcKeys[i][8] = (char)(uSuffix / CHAR_COUNT / CHAR_COUNT + FIRST_CHAR);
+      ppcKeys[i][9] = (char)(uSuffix / CHAR_COUNT % CHAR_COUNT + FIRST_CHAR);
+      ppcKeys[i][10] = (char)(uSuffix % CHAR_COUNT + FIRST_CHAR);
+      ppcKeys[i][11] = '\0';
+      /* the sum wraps around for a few prefixes; those are skipped */
+      if (iFlood && hashPoly(ppcKeys[i], 11) % uBuckets != 0)
+         continue;
+      i++;
+   }
+   free(plSuffixes);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put the iKeyCount keys ppcKeys into oSymTable and look each of them
+   up, and write the CPU time of both to stdout under the name
+   pcName. Free oSymTable. */
+
+static void bench(const char *pcName, SymTable_T oSymTable,
+   char **ppcKeys, int iKeyCount)
+{
+   clock_t iStart;
+   double dPut;
+   double dGet;
+   size_t uFound = 0;
+   int i;
+
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   iStart = clock();
+   for (i = 0; i < iKeyCount; i++)
+      (void)SymTable_put(oSymTable, ppcKeys[i], ppcKeys[i]);
+   dPut = ((double)(clock() - iStart)) / CLOCKS_PER_SEC;
+
+   iStart = clock();
+   for (i = 0; i < iKeyCount; i++)
+      uFound += SymTable_get(oSymTable, ppcKeys[i]) == ppcKeys[i];
+   dGet = ((double)(clock() - iStart)) / CLOCKS_PER_SEC;
+
+   printf("%-28s %d keys: put %f, get %f seconds\n", pcName,
+      iKeyCount, dPut, dGet);
+   if (uFound != (size_t)iKeyCount)
+      printf("Lookups found %lu keys instead of %d\n",
+         (unsigned long)uFound, iKeyCount);
+   fflush(stdout);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Measure the hash table implementation of the SymTable ADT on keys
+   chosen to collide under an unkeyed polynomial hash, as an attacker
+   who knows that hash would choose them, and on ordinary keys.
+   argv[1] is the number of keys. Exit with EXIT_FAILURE if argv[1] is
+   missing or invalid. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   struct SymTableOps sPolyOps = {NULL, hashPoly, NULL};
+   char **ppcFlood;
+   char **ppcPlain;
+   int iKeyCount;
+   int i;
+
+   if (argc != 2 || sscanf(argv[1], "%d", &iKeyCount) != 1 ||
+      iKeyCount <= 0)
+   {
+      fprintf(stderr, "Usage: %s keycount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   ppcFlood = (char**)malloc((size_t)iKeyCount * sizeof(char*));
+   ppcPlain = (char**)malloc((size_t)iKeyCount * sizeof(char*));
+   if (ppcFlood == NULL || ppcPlain == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iKeyCount; i++)
+   {
+      ppcFlood[i] = (char*)malloc(MAX_KEY_LENGTH);
+      ppcPlain[i] = (char*)malloc(MAX_KEY_LENGTH);
+      if (ppcFlood[i] == NULL || ppcPlain[i] == NULL)
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+   makeKeys(ppcFlood, iKeyCount, 1);
+   makeKeys(ppcPlain, iKeyCount, 0);
+
+   bench("ordinary keys", SymTable_new(), ppcPlain, iKeyCount);
+   bench("colliding keys", SymTable_new(), ppcFlood, iKeyCount);
+   bench("ordinary keys, unkeyed hash", SymTable_newWithOps(&sPolyOps),
+      ppcPlain, iKeyCount);
+   bench("colliding keys, unkeyed hash", SymTable_newWithOps(&sPolyOps),
+      ppcFlood, iKeyCount);
+
+   for (i = 0; i < iKeyCount; i++)
+   {
+      free(ppcFlood[i]);
+      free(ppcPlain[i]);
+   }
+   free(ppcFlood);
+   free(ppcPlain);
+   return 0;
+}
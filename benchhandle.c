@@ -0,0 +1,147 @@
+/*--------------------------------------------------------------------*/
+/* benchhandle.c                                                      */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtablehash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The size of the buffer of a key */
+
+enum {MAX_KEY_LENGTH = 32};
+
+/* The number of requests handled for each key */
+
+enum {ROUNDS = 5};
+
+/* One request in this many removes its key and puts it back */
+
+enum {REMOVE_EVERY = 8};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of seconds elapsed on the monotonic clock. */
+
+static double now(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Exit with EXIT_FAILURE after reporting that insufficient memory is
+   available. */
+
+static void failMemory(void)
+{
+   fprintf(stderr, "Insufficient memory\n");
+   exit(EXIT_FAILURE);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Handle ROUNDS requests for each of the iKeyCount keys of oSymTable,
+   which ppcKeys lists, each of which reads the value of its key,
+   replaces it and, once in REMOVE_EVERY requests, removes the key and
+   puts it back, looking the key up for each call unless iUseHandles.
+   Return the number of seconds taken. */
+
+static double handleRequests(SymTable_T oSymTable, char **ppcKeys,
+   int iKeyCount, int iUseHandles)
+{
+   struct SymTableHandle sHandle;
+   const char *pcKey;
+   void *pvValue;
+   double dStart;
+   long lRequest = 0;
+   int iRound;
+   int i;
+
+   dStart = now();
+   for (iRound = 0; iRound < ROUNDS; iRound++)
+      for (i = 0; i < iKeyCount; i++, lRequest++)
+      {
+         pcKey = ppcKeys[(int)(((unsigned long)i * 1000003u) %
+            (unsigned long)iKeyCount)];
+         if (iUseHandles)
+         {
+            if (! SymTable_find(oSymTable, pcKey, &sHandle))
+               continue;
+            pvValue = SymTable_handleValue(oSymTable, &sHandle);
+            (void)SymTable_handleSet(oSymTable, &sHandle, pvValue);
+            if (lRequest % REMOVE_EVERY == 0)
+               (void)SymTable_handleRemove(oSymTable, &sHandle);
+         }
+         else
+         {
+            pvValue = SymTable_get(oSymTable, pcKey);
+            (void)SymTable_replace(oSymTable, pcKey, pvValue);
+            if (lRequest % REMOVE_EVERY == 0)
+               (void)SymTable_remove(oSymTable, pcKey);
+         }
+         if (lRequest % REMOVE_EVERY == 0 &&
+            ! SymTable_put(oSymTable, pcKey, pvValue))
+            failMemory();
+      }
+   return now() - dStart;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare requests on a SymTable of argv[1] keys that look their key
+   up for each call with requests that look it up once and use a
+   handle, and write the rates to stdout. Exit with EXIT_FAILURE if
+   argv[1] is missing or invalid or insufficient memory is available.
+   Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   SymTable_T oSymTable;
+   char **ppcKeys;
+   double dKeys;
+   double dHandles;
+   int iKeyCount;
+   int i;
+
+   if (argc != 2 || sscanf(argv[1], "%d", &iKeyCount) != 1 ||
+      iKeyCount <= 0)
+   {
+      fprintf(stderr, "Usage: %s keycount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   ppcKeys = (char**)malloc((size_t)iKeyCount * sizeof(char*));
+   oSymTable = SymTable_new();
+   if (ppcKeys == NULL || oSymTable == NULL)
+      failMemory();
+   for (i = 0; i < iKeyCount; i++)
+   {
+      ppcKeys[i] = (char*)malloc(MAX_KEY_LENGTH);
+      if (ppcKeys[i] == NULL)
+         failMemory();
+      sprintf(ppcKeys[i], "request_key_%d", i);
+      if (! SymTable_put(oSymTable, ppcKeys[i], ppcKeys[i]))
+         failMemory();
+   }
+
+   dKeys = handleRequests(oSymTable, ppcKeys, iKeyCount, 0);
+   dHandles = handleRequests(oSymTable, ppcKeys, iKeyCount, 1);
+   printf("keys     %d keys: %.0f requests/s\n", iKeyCount,
+      (double)iKeyCount * ROUNDS / dKeys);
+   printf("handles  %d keys: %.0f requests/s\n", iKeyCount,
+      (double)iKeyCount * ROUNDS / dHandles);
+
+   SymTable_free(oSymTable);
+   for (i = 0; i < iKeyCount; i++)
+      free(ppcKeys[i]);
+   free(ppcKeys);
+   return 0;
+}
@@ -0,0 +1,189 @@
+/*--------------------------------------------------------------------*/
+/* benchhuge.c                                                        */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+
+#include "symtablehash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Return a file descriptor that counts the data TLB misses of loads
+   made by this process in user mode, or -1 if the system does not
+   let it count them. */
+
+static int openTlbCounter(void)
+{
+#if defined(__linux__) && defined(SYS_perf_event_open)
+   struct perf_event_attr sAttr;
+   memset(&sAttr, 0, sizeof(sAttr));
+   sAttr.size = sizeof(sAttr);
+   sAttr.type = PERF_TYPE_HW_CACHE;
+   sAttr.config = PERF_COUNT_HW_CACHE_DTLB |
+      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+   sAttr.disabled = 1;
+   sAttr.exclude_kernel = 1;
+   sAttr.exclude_hv = 1;
+   return (int)syscall(SYS_perf_event_open, &sAttr, 0, -1, -1, 0);
+#else
+   return -1;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of kilobytes of this process backed by
+   transparent huge pages, or -1 if the system does not say. */
+
+static long hugePageKilobytes(void)
+{
+   char acLine[128];
+   long lKilobytes = -1;
+   FILE *psFile = fopen("/proc/self/smaps_rollup", "r");
+   if (psFile == NULL)
+      return -1;
+   while (fgets(acLine, (int)sizeof(acLine), psFile) != NULL)
+      if (sscanf(acLine, "AnonHugePages: %ld", &lKilobytes) == 1)
+         break;
+   fclose(psFile);
+   return lKilobytes;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of seconds elapsed on the monotonic clock. */
+
+static double now(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put the iKeyCount keys ppcKeys into a table with the allocation
+   policy iFlags, look iLookupCount of them up in random order, and
+   write the time and TLB misses of the lookups to stdout under the
+   name pcName. */
+
+static void bench(const char *pcName, int iFlags, char **ppcKeys,
+   int iKeyCount, int iLookupCount)
+{
+   SymTable_T oSymTable;
+   long long llMisses = 0;
+   unsigned int uRandom = 12345;
+   size_t uFound = 0;
+   double dStart;
+   double dSeconds;
+   int iCounter;
+   int i;
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL ||
+      ! SymTable_setAllocPolicy(oSymTable, iFlags, 0))
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iKeyCount; i++)
+      (void)SymTable_put(oSymTable, ppcKeys[i], ppcKeys[i]);
+
+   iCounter = openTlbCounter();
+#ifdef __linux__
+   if (iCounter >= 0)
+      ioctl(iCounter, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+   dStart = now();
+   for (i = 0; i < iLookupCount; i++)
+   {
+      uRandom = uRandom * 1103515245u + 12345u;
+      uFound += SymTable_get(oSymTable,
+         ppcKeys[(uRandom >> 8) % (unsigned int)iKeyCount]) != NULL;
+   }
+   dSeconds = now() - dStart;
+   if (iCounter >= 0)
+   {
+      if (read(iCounter, &llMisses, sizeof(llMisses)) !=
+         (ssize_t)sizeof(llMisses))
+         llMisses = -1;
+      close(iCounter);
+   }
+
+   printf("%-12s %d lookups: %f seconds, ", pcName, iLookupCount,
+      dSeconds);
+   if (iCounter >= 0)
+      printf("%lld dTLB misses", llMisses);
+   else
+      printf("dTLB counter unavailable");
+   printf(", %ld kB in huge pages\n", hugePageKilobytes());
+   if (uFound != (size_t)iLookupCount)
+      printf("Lookups found %lu keys instead of %d\n",
+         (unsigned long)uFound, iLookupCount);
+   fflush(stdout);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Measure random lookups in a hash table of argv[1] keys whose bucket
+   array is allocated in ordinary pages and in huge pages. Exit with
+   EXIT_FAILURE if argv[1] is missing or invalid. Otherwise return
+   0. */
+
+int main(int argc, char *argv[])
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {LOOKUPS_PER_KEY = 4};
+
+   char **ppcKeys;
+   int iKeyCount;
+   int i;
+
+   if (argc != 2 || sscanf(argv[1], "%d", &iKeyCount) != 1 ||
+      iKeyCount <= 0)
+   {
+      fprintf(stderr, "Usage: %s keycount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   ppcKeys = (char**)malloc((size_t)iKeyCount * sizeof(char*));
+   if (ppcKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iKeyCount; i++)
+   {
+      ppcKeys[i] = (char*)malloc(MAX_KEY_LENGTH);
+      if (ppcKeys[i] == NULL)
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+      sprintf(ppcKeys[i], "%d", i);
+   }
+
+   bench("4 kB pages", 0, ppcKeys, iKeyCount,
+      iKeyCount * LOOKUPS_PER_KEY);
+   bench("huge pages", SYMTABLE_ALLOC_HUGE_PAGES, ppcKeys, iKeyCount,
+      iKeyCount * LOOKUPS_PER_KEY);
+
+   for (i = 0; i < iKeyCount; i++)
+      free(ppcKeys[i]);
+   free(ppcKeys);
+   return 0;
+}
@@ -0,0 +1,121 @@
+/*--------------------------------------------------------------------*/
+/* benchkeys.c                                                        */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* Write the CPU time consumed since iStart by the operation named
+   pcName on iCount keys to stdout. */
+
+static void report(const char *pcName, int iCount, clock_t iStart)
+{
+   double dSeconds = ((double)(clock() - iStart)) / CLOCKS_PER_SEC;
+   printf("%-8s %d keys: %f seconds\n", pcName, iCount, dSeconds);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Measure the SymTable ADT on keys that look like file paths and
+   share a long common prefix, as real path and URL keys do, and the
+   memory the table uses for them. argv[1] is the number of keys. Exit
+   with EXIT_FAILURE if argv[1] is missing or invalid. Otherwise
+   return 0. */
+
+int main(int argc, char *argv[])
+{
+   enum {MAX_KEY_LENGTH = 160};
+   enum {ROUNDS = 10};
+
+   SymTable_T oSymTable;
+   char **ppcKeys;
+   char **ppcMisses;
+   clock_t iStart;
+   int iKeyCount;
+   int iRound;
+   int i;
+   size_t uFound = 0;
+
+   if (argc != 2 || sscanf(argv[1], "%d", &iKeyCount) != 1 ||
+      iKeyCount <= 0)
+   {
+      fprintf(stderr, "Usage: %s keycount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   ppcKeys = (char**)malloc((size_t)iKeyCount * sizeof(char*));
+   ppcMisses = (char**)malloc((size_t)iKeyCount * sizeof(char*));
+   if (ppcKeys == NULL || ppcMisses == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iKeyCount; i++)
+   {
+      ppcKeys[i] = (char*)malloc(MAX_KEY_LENGTH);
+      ppcMisses[i] = (char*)malloc(MAX_KEY_LENGTH);
+      if (ppcKeys[i] == NULL || ppcMisses[i] == NULL)
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+      sprintf(ppcKeys[i],
+         "/home/cos217/armlab/assignments/symtable/src/module%d/"
+         "implementation/source/file_number_%d.c", i % 97, i);
+      sprintf(ppcMisses[i],
+         "/home/cos217/armlab/assignments/symtable/src/module%d/"
+         "implementation/source/file_number_%d.h", i % 97, i);
+   }
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   iStart = clock();
+   for (i = 0; i < iKeyCount; i++)
+      (void)SymTable_put(oSymTable, ppcKeys[i], ppcKeys[i]);
+   report("put", iKeyCount, iStart);
+   printf("memory   %d keys: %lu bytes\n", iKeyCount,
+      (unsigned long)SymTable_memoryUsage(oSymTable, NULL));
+
+   iStart = clock();
+   for (iRound = 0; iRound < ROUNDS; iRound++)
+      for (i = 0; i < iKeyCount; i++)
+         uFound += SymTable_get(oSymTable, ppcKeys[i]) != NULL;
+   report("get hit", iKeyCount * ROUNDS, iStart);
+
+   iStart = clock();
+   for (iRound = 0; iRound < ROUNDS; iRound++)
+      for (i = 0; i < iKeyCount; i++)
+         uFound += SymTable_contains(oSymTable, ppcMisses[i]);
+   report("get miss", iKeyCount * ROUNDS, iStart);
+
+   iStart = clock();
+   for (i = 0; i < iKeyCount; i++)
+      (void)SymTable_remove(oSymTable, ppcKeys[i]);
+   report("remove", iKeyCount, iStart);
+
+   if (uFound != (size_t)iKeyCount * ROUNDS)
+      printf("Lookups found %lu keys instead of %lu\n",
+         (unsigned long)uFound, (unsigned long)iKeyCount * ROUNDS);
+
+   SymTable_free(oSymTable);
+   for (i = 0; i < iKeyCount; i++)
+   {
+      free(ppcKeys[i]);
+      free(ppcMisses[i]);
+   }
+   free(ppcKeys);
+   free(ppcMisses);
+   return 0;
+}
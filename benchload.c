@@ -0,0 +1,188 @@
+/*--------------------------------------------------------------------*/
+/* benchload.c                                                        */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtablehash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The longest line the line-by-line loader reads */
+
+enum {MAX_LINE_LENGTH = 256};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of seconds elapsed on the monotonic clock. */
+
+static double now(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the ingest rate of the loader named pcName, which read
+   uBytes bytes into uBindings bindings since dStart, to stdout. */
+
+static void report(const char *pcName, size_t uBytes, size_t uBindings,
+   double dStart)
+{
+   double dSeconds = now() - dStart;
+   printf("%-21s %lu bindings: %f seconds, %.1f MB/s\n", pcName,
+      (unsigned long)uBindings, dSeconds,
+      (double)uBytes / dSeconds / 1e6);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free pvValue. pcKey and pvExtra are unused. */
+
+static void freeValue(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvExtra;
+   free(pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Load the file at pcPath into oSymTable line by line, with fgets and
+   SymTable_put, copying each value. Return the number of bindings
+   added. */
+
+static size_t loadByLines(SymTable_T oSymTable, const char *pcPath)
+{
+   char acLine[MAX_LINE_LENGTH];
+   char *pcTab;
+   char *pcValue;
+   size_t uLength;
+   size_t uBindings = 0;
+   FILE *psFile;
+
+   psFile = fopen(pcPath, "r");
+   if (psFile == NULL)
+   {
+      fprintf(stderr, "Cannot read %s\n", pcPath);
+      exit(EXIT_FAILURE);
+   }
+   while (fgets(acLine, MAX_LINE_LENGTH, psFile) != NULL)
+   {
+      uLength = strlen(acLine);
+      if (uLength > 0 && acLine[uLength - 1] == '\n')
+         acLine[--uLength] = '\0';
+      pcTab = strchr(acLine, '\t');
+      if (pcTab == NULL)
+         continue;
+      *pcTab = '\0';
+      pcValue = (char*)malloc(uLength - (size_t)(pcTab - acLine));
+      if (pcValue == NULL)
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+      strcpy(pcValue, pcTab + 1);
+      if (SymTable_put(oSymTable, acLine, pcValue))
+         uBindings++;
+      else
+         free(pcValue);
+   }
+   fclose(psFile);
+   return uBindings;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Measure how fast a tab-separated file of argv[1] lines is loaded
+   into the hash table implementation of the SymTable ADT line by line
+   and by SymTable_loadFile with 1 to argv[2] threads (default 4). The
+   file is written to benchload.tmp and removed afterwards. Exit with
+   EXIT_FAILURE if the arguments are invalid. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   enum {MAX_NAME_LENGTH = 32};
+
+   const char *pcPath = "benchload.tmp";
+   char acName[MAX_NAME_LENGTH];
+   SymTable_T oSymTable;
+   FILE *psFile;
+   long lFileSize;
+   size_t uBindings;
+   double dStart;
+   int iLineCount;
+   int iMaxThreads = 4;
+   int iThreads;
+   int i;
+
+   if (argc != 2 && argc != 3)
+   {
+      fprintf(stderr, "Usage: %s linecount [maxthreads]\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iLineCount) != 1 || iLineCount <= 0 ||
+      (argc == 3 && (sscanf(argv[2], "%d", &iMaxThreads) != 1 ||
+      iMaxThreads <= 0)))
+   {
+      fprintf(stderr, "Invalid arguments\n");
+      exit(EXIT_FAILURE);
+   }
+
+   /* Keys look like the paths of benchkeys and values like sizes
+      and dates, as in a dump of file metadata. */
+   psFile = fopen(pcPath, "w");
+   if (psFile == NULL)
+   {
+      fprintf(stderr, "Cannot write %s\n", pcPath);
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iLineCount; i++)
+      fprintf(psFile, "/home/cos217/armlab/assignments/symtable/src/"
+         "module%d/source/file_number_%d.c\t%d bytes, 2024-%02d-%02d\n",
+         i % 97, i, i * 37 % 100000, i % 12 + 1, i % 28 + 1);
+   lFileSize = ftell(psFile);
+   fclose(psFile);
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   dStart = now();
+   uBindings = loadByLines(oSymTable, pcPath);
+   report("fgets and put", (size_t)lFileSize, uBindings, dStart);
+   SymTable_map(oSymTable, freeValue, NULL);
+   SymTable_free(oSymTable);
+
+   for (iThreads = 1; iThreads <= iMaxThreads; iThreads *= 2)
+   {
+      oSymTable = SymTable_new();
+      if (oSymTable == NULL)
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+      dStart = now();
+      if (! SymTable_loadFile(oSymTable, pcPath, iThreads, &uBindings))
+      {
+         fprintf(stderr, "Cannot load %s\n", pcPath);
+         exit(EXIT_FAILURE);
+      }
+      sprintf(acName, "loadFile, %d threads", iThreads);
+      report(acName, (size_t)lFileSize, uBindings, dStart);
+      SymTable_free(oSymTable);
+   }
+
+   remove(pcPath);
+   return 0;
+}
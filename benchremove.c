@@ -0,0 +1,160 @@
+/*--------------------------------------------------------------------*/
+/* benchremove.c                                                      */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The size of the buffer of a key */
+
+enum {MAX_KEY_LENGTH = 32};
+
+/*--------------------------------------------------------------------*/
+
+/* The keys that collectOdd has gathered */
+
+struct Collected
+{
+   /* The copies of the keys */
+   char **ppcKeys;
+
+   /* The number of keys gathered */
+   size_t uCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of seconds elapsed on the monotonic clock. */
+
+static double now(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if the number that the key pcKey ends with is odd, and 0
+   otherwise. pvValue and pvExtra are unused. */
+
+static int isOdd(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   (void)pvValue;
+   (void)pvExtra;
+   return (pcKey[strlen(pcKey) - 1] - '0') % 2 == 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a copy of pcKey to the Collected pvExtra if isOdd selects it.
+   Exit with EXIT_FAILURE if insufficient memory is available. */
+
+static void collectOdd(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   struct Collected *psCollected = (struct Collected*)pvExtra;
+   char *pcCopy;
+
+   if (! isOdd(pcKey, pvValue, NULL))
+      return;
+   pcCopy = (char*)malloc(strlen(pcKey) + 1);
+   if (pcCopy == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   strcpy(pcCopy, pcKey);
+   psCollected->ppcKeys[psCollected->uCount++] = pcCopy;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable that binds iKeyCount keys. Exit with
+   EXIT_FAILURE if insufficient memory is available. */
+
+static SymTable_T build(int iKeyCount)
+{
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "symbol_%d", i);
+      if (! SymTable_put(oSymTable, acKey, oSymTable))
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+   }
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the half of argv[1] bindings whose keys end with an odd
+   digit, first by gathering their keys with SymTable_map and removing
+   each, then with SymTable_removeIf, and write the time each takes to
+   stdout. Exit with EXIT_FAILURE if argv[1] is missing or invalid or
+   insufficient memory is available. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   SymTable_T oSymTable;
+   struct Collected sCollected;
+   size_t uRemoved;
+   size_t u;
+   double dStart;
+   int iKeyCount;
+
+   if (argc != 2 || sscanf(argv[1], "%d", &iKeyCount) != 1 ||
+      iKeyCount <= 0)
+   {
+      fprintf(stderr, "Usage: %s keycount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   sCollected.ppcKeys = (char**)malloc((size_t)iKeyCount *
+      sizeof(char*));
+   if (sCollected.ppcKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   oSymTable = build(iKeyCount);
+   sCollected.uCount = 0;
+   dStart = now();
+   SymTable_map(oSymTable, collectOdd, &sCollected);
+   for (u = 0; u < sCollected.uCount; u++)
+   {
+      (void)SymTable_remove(oSymTable, sCollected.ppcKeys[u]);
+      free(sCollected.ppcKeys[u]);
+   }
+   printf("map and remove  %d keys: %lu removed in %f seconds\n",
+      iKeyCount, (unsigned long)sCollected.uCount, now() - dStart);
+   SymTable_free(oSymTable);
+
+   oSymTable = build(iKeyCount);
+   dStart = now();
+   uRemoved = SymTable_removeIf(oSymTable, isOdd, NULL);
+   printf("removeIf        %d keys: %lu removed in %f seconds\n",
+      iKeyCount, (unsigned long)uRemoved, now() - dStart);
+   SymTable_free(oSymTable);
+
+   free(sCollected.ppcKeys);
+   return 0;
+}
@@ -0,0 +1,162 @@
+/*--------------------------------------------------------------------*/
+/* benchshard.c                                                       */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtableshard.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/*--------------------------------------------------------------------*/
+
+/* struct Worker describes the keys that one thread inserts. */
+
+struct Worker
+{
+   /* the table every thread inserts into */
+   ShardedSymTable_T oTable;
+   /* the keys of this thread */
+   char **ppcKeys;
+   /* number of keys of this thread */
+   int iKeyCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Put every key of the worker pvWorker into its table. Return NULL. */
+
+static void *putKeys(void *pvWorker)
+{
+   struct Worker *psWorker = (struct Worker*)pvWorker;
+   int i;
+
+   for (i = 0; i < psWorker->iKeyCount; i++)
+      (void)ShardedSymTable_put(psWorker->oTable, psWorker->ppcKeys[i],
+         NULL);
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of seconds elapsed on the monotonic clock. */
+
+static double now(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Insert the iKeyCount keys ppcKeys into a table with uShardCount
+   shards using iThreadCount threads, and write the insert throughput
+   to stdout. */
+
+static void benchInsert(char **ppcKeys, int iKeyCount,
+   int iThreadCount, size_t uShardCount)
+{
+   enum {MAX_THREAD_COUNT = 64};
+
+   ShardedSymTable_T oTable;
+   pthread_t aThreads[MAX_THREAD_COUNT];
+   struct Worker asWorkers[MAX_THREAD_COUNT];
+   int iShare = iKeyCount / iThreadCount;
+   double dStart;
+   double dSeconds;
+   int i;
+
+   oTable = ShardedSymTable_new(uShardCount);
+   if (oTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   dStart = now();
+   for (i = 0; i < iThreadCount; i++)
+   {
+      asWorkers[i].oTable = oTable;
+      asWorkers[i].ppcKeys = ppcKeys + i * iShare;
+      asWorkers[i].iKeyCount =
+         (i == iThreadCount - 1) ? iKeyCount - i * iShare : iShare;
+      pthread_create(&aThreads[i], NULL, putKeys, &asWorkers[i]);
+   }
+   for (i = 0; i < iThreadCount; i++)
+      pthread_join(aThreads[i], NULL);
+   dSeconds = now() - dStart;
+
+   printf("%2d threads, %3lu shards: %f seconds, %.2f million puts/s\n",
+      iThreadCount, (unsigned long)uShardCount, dSeconds,
+      (double)iKeyCount / dSeconds / 1e6);
+   fflush(stdout);
+
+   ShardedSymTable_free(oTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Measure the insert throughput of the ShardedSymTable ADT with 1 to
+   argv[2] threads (default 8). argv[1] is the total number of keys
+   to insert. Exit with EXIT_FAILURE if the arguments are invalid.
+   Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {MAX_THREAD_COUNT = 64};
+   enum {SHARD_COUNT = 64};
+
+   char **ppcKeys;
+   int iKeyCount;
+   int iMaxThreads = 8;
+   int iThreads;
+   int i;
+
+   if (argc != 2 && argc != 3)
+   {
+      fprintf(stderr, "Usage: %s bindingcount [maxthreads]\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iKeyCount) != 1 || iKeyCount <= 0 ||
+      (argc == 3 && (sscanf(argv[2], "%d", &iMaxThreads) != 1 ||
+      iMaxThreads <= 0 || iMaxThreads > MAX_THREAD_COUNT)))
+   {
+      fprintf(stderr, "Invalid arguments\n");
+      exit(EXIT_FAILURE);
+   }
+
+   /* The keys are built up front so that only the puts are timed. */
+   ppcKeys = (char**)malloc((size_t)iKeyCount * sizeof(char*));
+   if (ppcKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iKeyCount; i++)
+   {
+      ppcKeys[i] = (char*)malloc(MAX_KEY_LENGTH);
+      if (ppcKeys[i] == NULL)
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+      sprintf(ppcKeys[i], "%d", i);
+   }
+
+   for (iThreads = 1; iThreads <= iMaxThreads; iThreads *= 2)
+   {
+      benchInsert(ppcKeys, iKeyCount, iThreads, 1);
+      benchInsert(ppcKeys, iKeyCount, iThreads, SHARD_COUNT);
+   }
+
+   for (i = 0; i < iKeyCount; i++)
+      free(ppcKeys[i]);
+   free(ppcKeys);
+   return 0;
+}
@@ -0,0 +1,235 @@
+/*--------------------------------------------------------------------*/
+/* benchshm.c                                                         */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtable.h"
+#include "symtableshm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The size of the buffer of a key or of the name of a segment */
+
+enum {MAX_KEY_LENGTH = 32};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of seconds elapsed on the monotonic clock. */
+
+static double now(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable that binds each of the iKeyCount keys to
+   its index in the array piValues, or NULL if insufficient memory is
+   available. */
+
+static SymTable_T buildPrivate(int iKeyCount, int *piValues)
+{
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+      return NULL;
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      if (! SymTable_put(oSymTable, acKey, &piValues[i]))
+      {
+         SymTable_free(oSymTable);
+         return NULL;
+      }
+   }
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Build a private SymTable of the iKeyCount keys and look each of
+   them up. Exit with 0 if every key is found, and 1 otherwise. */
+
+static void runPrivateWorker(int iKeyCount, int *piValues)
+{
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int iStatus = 0;
+   int i;
+
+   oSymTable = buildPrivate(iKeyCount, piValues);
+   if (oSymTable == NULL)
+      _exit(1);
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      if (SymTable_get(oSymTable, acKey) != &piValues[i])
+         iStatus = 1;
+   }
+   SymTable_free(oSymTable);
+   _exit(iStatus);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Attach to the segment named pcName and look each of the iKeyCount
+   keys up. Exit with 0 if every key is found, and 1 otherwise. */
+
+static void runSharedWorker(const char *pcName, int iKeyCount)
+{
+   SharedSymTable_T oTable;
+   char acKey[MAX_KEY_LENGTH];
+   size_t uLength;
+   int iStatus = 0;
+   int iValue;
+   int i;
+
+   oTable = SharedSymTable_attach(pcName);
+   if (oTable == NULL)
+      _exit(1);
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      uLength = sizeof(int);
+      if (! SharedSymTable_get(oTable, acKey, &iValue, &uLength) ||
+         iValue != i)
+         iStatus = 1;
+   }
+   SharedSymTable_detach(oTable);
+   _exit(iStatus);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Wait for the iWorkerCount child processes of this process. Return
+   the number that did not exit with 0. */
+
+static int waitForWorkers(int iWorkerCount)
+{
+   int iFailures = 0;
+   int iStatus;
+   int i;
+
+   for (i = 0; i < iWorkerCount; i++)
+      if (wait(&iStatus) < 0 || ! WIFEXITED(iStatus) ||
+         WEXITSTATUS(iStatus) != 0)
+         iFailures++;
+   return iFailures;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare argv[2] worker processes that each build their own
+   SymTable of argv[1] keys and look every key up with as many
+   workers that look the keys up in one SharedSymTable built by this
+   process, and write the time each approach takes from the start to
+   the last lookup, and the memory its tables take, to stdout. Exit
+   with EXIT_FAILURE if the arguments are invalid or a table cannot be
+   built. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   SymTable_T oSymTable;
+   SharedSymTable_T oTable;
+   char acName[MAX_KEY_LENGTH];
+   char acKey[MAX_KEY_LENGTH];
+   int *piValues;
+   size_t uPrivateBytes;
+   size_t uUsed;
+   double dStart;
+   double dBuilt;
+   int iKeyCount;
+   int iWorkerCount;
+   int i;
+
+   if (argc != 3)
+   {
+      fprintf(stderr, "Usage: %s keycount workercount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iKeyCount) != 1 || iKeyCount <= 0 ||
+      sscanf(argv[2], "%d", &iWorkerCount) != 1 || iWorkerCount <= 0)
+   {
+      fprintf(stderr, "Invalid arguments\n");
+      exit(EXIT_FAILURE);
+   }
+   piValues = (int*)malloc((size_t)iKeyCount * sizeof(int));
+   if (piValues == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iKeyCount; i++)
+      piValues[i] = i;
+
+   oSymTable = buildPrivate(iKeyCount, piValues);
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   uPrivateBytes = SymTable_memoryUsage(oSymTable, NULL);
+   SymTable_free(oSymTable);
+
+   fflush(stdout);
+   dStart = now();
+   for (i = 0; i < iWorkerCount; i++)
+      if (fork() == 0)
+         runPrivateWorker(iKeyCount, piValues);
+   if (waitForWorkers(iWorkerCount) != 0)
+      printf("A private worker failed\n");
+   printf("private  %d workers, %d keys: %f seconds, %lu bytes of "
+      "tables\n", iWorkerCount, iKeyCount, now() - dStart,
+      (unsigned long)uPrivateBytes * (unsigned long)iWorkerCount);
+
+   sprintf(acName, "/benchshm.%ld", (long)getpid());
+   dStart = now();
+   oTable = SharedSymTable_create(acName,
+      (size_t)iKeyCount * 128 + (1 << 20));
+   if (oTable == NULL)
+   {
+      fprintf(stderr, "Cannot create %s\n", acName);
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      if (! SharedSymTable_put(oTable, acKey, &i, sizeof(int)))
+      {
+         fprintf(stderr, "Segment full after %d keys\n", i);
+         SharedSymTable_detach(oTable);
+         SharedSymTable_unlink(acName);
+         exit(EXIT_FAILURE);
+      }
+   }
+   dBuilt = now();
+   fflush(stdout);
+   for (i = 0; i < iWorkerCount; i++)
+      if (fork() == 0)
+         runSharedWorker(acName, iKeyCount);
+   if (waitForWorkers(iWorkerCount) != 0)
+      printf("A shared worker failed\n");
+   SharedSymTable_getUsage(oTable, &uUsed, NULL);
+   printf("shared   %d workers, %d keys: %f seconds, %f of them "
+      "building, %lu bytes of segment\n", iWorkerCount, iKeyCount,
+      now() - dStart, dBuilt - dStart, (unsigned long)uUsed);
+
+   SharedSymTable_detach(oTable);
+   SharedSymTable_unlink(acName);
+   free(piValues);
+   return 0;
+}
@@ -0,0 +1,103 @@
+/*--------------------------------------------------------------------*/
+/* benchu64.c                                                         */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include "symtableu64.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* Write the CPU time consumed since iStart by the operation named
+   pcName on iCount keys to stdout. */
+
+static void report(const char *pcName, int iCount, clock_t iStart)
+{
+   double dSeconds = ((double)(clock() - iStart)) / CLOCKS_PER_SEC;
+   printf("%-16s %d keys: %f seconds\n", pcName, iCount, dSeconds);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Measure integer identifiers as keys, once rendered as decimal
+   strings in a SymTable the way testLargeTable does, and once as
+   integers in a SymTableU64. argv[1] is the number of identifiers.
+   Exit with EXIT_FAILURE if argv[1] is missing or invalid. Otherwise
+   return 0. */
+
+int main(int argc, char *argv[])
+{
+   enum {MAX_KEY_LENGTH = 24};
+   enum {ROUNDS = 10};
+
+   SymTable_T oSymTable;
+   SymTableU64_T oSymTableU64;
+   uint64_t *puIds;
+   char acKey[MAX_KEY_LENGTH];
+   clock_t iStart;
+   int iKeyCount;
+   int iRound;
+   int i;
+   size_t uFound = 0;
+
+   if (argc != 2 || sscanf(argv[1], "%d", &iKeyCount) != 1 ||
+      iKeyCount <= 0)
+   {
+      fprintf(stderr, "Usage: %s keycount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   /* sparse identifiers, as database keys and handles are */
+   puIds = (uint64_t*)malloc((size_t)iKeyCount * sizeof(uint64_t));
+   oSymTable = SymTable_new();
+   oSymTableU64 = SymTable_newU64();
+   if (puIds == NULL || oSymTable == NULL || oSymTableU64 == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iKeyCount; i++)
+      puIds[i] = (uint64_t)i * 7919 + 100000;
+
+   iStart = clock();
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(acKey, "%lu", (unsigned long)puIds[i]);
+      (void)SymTable_put(oSymTable, acKey, acKey);
+   }
+   report("string put", iKeyCount, iStart);
+
+   iStart = clock();
+   for (iRound = 0; iRound < ROUNDS; iRound++)
+      for (i = 0; i < iKeyCount; i++)
+      {
+         sprintf(acKey, "%lu", (unsigned long)puIds[i]);
+         uFound += SymTable_contains(oSymTable, acKey);
+      }
+   report("string get", iKeyCount * ROUNDS, iStart);
+
+   iStart = clock();
+   for (i = 0; i < iKeyCount; i++)
+      (void)SymTable_putU64(oSymTableU64, puIds[i], puIds);
+   report("u64 put", iKeyCount, iStart);
+
+   iStart = clock();
+   for (iRound = 0; iRound < ROUNDS; iRound++)
+      for (i = 0; i < iKeyCount; i++)
+         uFound += SymTable_containsU64(oSymTableU64, puIds[i]);
+   report("u64 get", iKeyCount * ROUNDS, iStart);
+
+   if (uFound != (size_t)iKeyCount * ROUNDS * 2)
+      printf("Lookups found %lu keys instead of %lu\n",
+         (unsigned long)uFound, (unsigned long)iKeyCount * ROUNDS * 2);
+
+   SymTable_free(oSymTable);
+   SymTable_freeU64(oSymTableU64);
+   free(puIds);
+   return 0;
+}
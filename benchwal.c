@@ -0,0 +1,159 @@
+/*--------------------------------------------------------------------*/
+/* benchwal.c                                                         */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtablehash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The size of the buffer of a key or value */
+
+enum {MAX_KEY_LENGTH = 24};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of seconds elapsed on the monotonic clock. */
+
+static double now(void)
+{
+   struct timespec sTime;
+   clock_gettime(CLOCK_MONOTONIC, &sTime);
+   return (double)sTime.tv_sec + (double)sTime.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the rate of the iCount operations named pcName made since
+   dStart, and the log statistics of oSymTable, to stdout. */
+
+static void report(const char *pcName, SymTable_T oSymTable, int iCount,
+   double dStart)
+{
+   double dSeconds = now() - dStart;
+   size_t uLogged;
+   size_t uWritten;
+   size_t uSyncs;
+   size_t uCompactions;
+
+   SymTable_getLogStats(oSymTable, &uLogged, &uWritten, &uSyncs,
+      &uCompactions);
+   printf("%-8s %d: %f seconds, %.0f ops/s, %lu syncs, "
+      "%lu compactions, write amplification %.2f\n", pcName, iCount,
+      dSeconds, (double)iCount / dSeconds, (unsigned long)uSyncs,
+      (unsigned long)uCompactions,
+      uLogged == 0 ? 0.0 : (double)uWritten / (double)uLogged);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new table whose log is the file at pcPath, syncing every
+   iGroupSize records and compacting at twice the live size. Exit with
+   EXIT_FAILURE if it cannot be opened. */
+
+static SymTable_T openTable(const char *pcPath, int iGroupSize)
+{
+   SymTable_T oSymTable = SymTable_new();
+   if (oSymTable == NULL ||
+      ! SymTable_openLog(oSymTable, pcPath, (size_t)iGroupSize, 2))
+   {
+      fprintf(stderr, "Cannot open the log %s\n", pcPath);
+      exit(EXIT_FAILURE);
+   }
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Measure the durable hash table implementation of the SymTable ADT:
+   put argv[1] bindings, replace each value, remove half of them, and
+   then recover the table from its log. argv[2] is the number of
+   records per sync (default 1000). The log is written to benchwal.tmp
+   and removed afterwards. Exit with EXIT_FAILURE if the arguments are
+   invalid. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   const char *pcPath = "benchwal.tmp";
+   SymTable_T oSymTable;
+   char (*pacKeys)[MAX_KEY_LENGTH];
+   char (*pacValues)[MAX_KEY_LENGTH];
+   size_t uLength;
+   double dStart;
+   int iKeyCount;
+   int iGroupSize = 1000;
+   int i;
+
+   if (argc != 2 && argc != 3)
+   {
+      fprintf(stderr, "Usage: %s keycount [groupsize]\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iKeyCount) != 1 || iKeyCount <= 0 ||
+      (argc == 3 && (sscanf(argv[2], "%d", &iGroupSize) != 1 ||
+      iGroupSize <= 0)))
+   {
+      fprintf(stderr, "Invalid arguments\n");
+      exit(EXIT_FAILURE);
+   }
+
+   pacKeys = (char(*)[MAX_KEY_LENGTH])malloc((size_t)iKeyCount *
+      MAX_KEY_LENGTH);
+   pacValues = (char(*)[MAX_KEY_LENGTH])malloc((size_t)iKeyCount *
+      MAX_KEY_LENGTH);
+   if (pacKeys == NULL || pacValues == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (i = 0; i < iKeyCount; i++)
+   {
+      sprintf(pacKeys[i], "key%d", i);
+      sprintf(pacValues[i], "value%d", i * 7);
+   }
+
+   remove(pcPath);
+   oSymTable = openTable(pcPath, iGroupSize);
+   dStart = now();
+   for (i = 0; i < iKeyCount; i++)
+      (void)SymTable_put(oSymTable, pacKeys[i], pacKeys[i]);
+   report("put", oSymTable, iKeyCount, dStart);
+   dStart = now();
+   for (i = 0; i < iKeyCount; i++)
+      (void)SymTable_replace(oSymTable, pacKeys[i], pacValues[i]);
+   report("replace", oSymTable, iKeyCount, dStart);
+   dStart = now();
+   for (i = 0; i < iKeyCount; i += 2)
+      (void)SymTable_remove(oSymTable, pacKeys[i]);
+   if (! SymTable_sync(oSymTable))
+   {
+      fprintf(stderr, "Cannot write the log %s\n", pcPath);
+      exit(EXIT_FAILURE);
+   }
+   report("remove", oSymTable, (iKeyCount + 1) / 2, dStart);
+   uLength = SymTable_getLength(oSymTable);
+   SymTable_free(oSymTable);
+
+   dStart = now();
+   oSymTable = openTable(pcPath, iGroupSize);
+   printf("recovery %lu bindings: %f seconds\n",
+      (unsigned long)SymTable_getLength(oSymTable), now() - dStart);
+   if (SymTable_getLength(oSymTable) != uLength)
+      printf("Recovered %lu bindings instead of %lu\n",
+         (unsigned long)SymTable_getLength(oSymTable),
+         (unsigned long)uLength);
+   SymTable_free(oSymTable);
+
+   remove(pcPath);
+   remove("benchwal.tmp.compact");
+   free(pacKeys);
+   free(pacValues);
+   return 0;
+}
@@ -45,4 +45,111 @@ binding in oSymTable, passing pvExtra as an extra parameter. */
 void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), 
 const void *pvExtra);
 
+/* The functions below are provided by symtablelist.c, symtablehash.c, symtableeytz.c and
+symtabledisk.c. */
+
+/* SymTable_putN, SymTable_getN, SymTable_containsN and SymTable_removeN behave like
+SymTable_put, SymTable_get, SymTable_contains and SymTable_remove, but the key is the uLen
+characters at pcKey, which need not be followed by a '\0'. This lets a caller use a slice of
+a larger buffer, such as a token, as a key without copying it into a string first. */
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey, size_t uLen, const void *pvValue);
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey, size_t uLen);
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey, size_t uLen);
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey, size_t uLen);
+
+/* struct SymTableOps holds the functions a SymTable uses to release its values and to hash
+and compare its keys. Any of them may be NULL. */
+struct SymTableOps {
+    /* the function called with each value that the SymTable stops binding */
+    void (*pfFreeValue)(void *pvValue);
+    /* the function that returns the hash code of the uLen characters at pcKey, used instead
+       of the built-in hash function by symtablehash.c, symtableeytz.c and symtabledisk.c and
+       ignored by symtablelist.c */
+    size_t (*pfHash)(const char *pcKey, size_t uLen);
+    /* the function that returns 1 if the uLen characters at pcKey1 and at pcKey2 are the
+       same key and 0 otherwise, used instead of an exact comparison. Keys of different
+       lengths are never the same key, and keys that are the same must hash alike. */
+    int (*pfEquals)(const char *pcKey1, const char *pcKey2, size_t uLen);
+};
+
+/* Returns a new SymTable object with no bindings that uses the functions of *psOps, or NULL
+if insufficient memory is available. If psOps->pfFreeValue is not NULL the SymTable owns its
+values: SymTable_free and SymTable_clear release every value in the same pass that frees the
+keys, and SymTable_remove and SymTable_replace release the value they take out of the table.
+The pointer those two return then only tells whether pcKey was found and must not be
+dereferenced. */
+SymTable_T SymTable_newWithOps(const struct SymTableOps *psOps);
+
+/* Removes every binding of oSymTable, releasing the values as SymTable_free does. Memory
+that oSymTable can use again for new bindings, such as the bucket array of symtablehash.c, is
+kept rather than freed. */
+void SymTable_clear(SymTable_T oSymTable);
+
+/* struct SymTableMemory splits the memory a SymTable has allocated into its parts, in bytes
+requested from the allocator, not counting the allocator's own headers. */
+struct SymTableMemory {
+    /* the bucket array of symtablehash.c, the arrays of hash codes of symtableeytz.c, or 0
+       for symtablelist.c */
+    size_t buckets;
+    /* the nodes that link bindings: list nodes, or overflow Buckets and tree nodes */
+    size_t nodes;
+    /* the copies of the keys, with the data stored alongside each key */
+    size_t keys;
+    /* everything else: the SymTable object itself and its bookkeeping arrays */
+    size_t overhead;
+};
+
+/* Returns the number of bytes oSymTable has allocated and, unless psUsage is NULL, stores how
+they divide into parts in *psUsage. Takes time proportional to the number of bindings. */
+size_t SymTable_memoryUsage(SymTable_T oSymTable, struct SymTableMemory *psUsage);
+
+/* Moves into oSymTable each binding of oSource whose key oSymTable does not bind, leaving
+oSource with the bindings whose keys both bind. The nodes of the bindings moved are reused
+rather than copied, except by symtableeytz.c, which merges them into its sorted array in one
+pass, and by symtablelist.c for nodes SymTable_compact has moved into a block. With
+symtablehash.c and symtableeytz.c a key is not hashed again if both SymTables hash keys alike,
+as tables made by SymTable_newWithSeed with the same seed or by SymTable_newWithOps with the
+same hash function do. The values move with their bindings, to be released as oSymTable
+releases its own. oSource must be another SymTable; with symtablehash.c, neither may have an
+open scope and oSource may have neither a capacity nor expiry times. Returns 1 if successful or
+0 if insufficient memory is available, in which case the bindings not moved stay in oSource. */
+int SymTable_merge(SymTable_T oSymTable, SymTable_T oSource);
+
+/* Removes from oSymTable each binding whose key oOther does not bind, calling
+(*pfRemoved)(pcKey, pvValue, pvExtra) with it, unless pfRemoved is NULL, before its value is
+released as SymTable_remove releases it. pcKey is only valid during the call, which must not
+change oSymTable or oOther. Keys are looked up in oOther as SymTable_merge looks them up in
+oSymTable. oOther must be another SymTable, and with symtablehash.c oSymTable must have no
+open scope. Returns the number of bindings removed. */
+size_t SymTable_intersect(SymTable_T oSymTable, SymTable_T oOther,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra);
+
+/* Removes from oSymTable each binding whose key oOther binds, as SymTable_intersect removes
+those whose key it does not bind. Returns the number of bindings removed. */
+size_t SymTable_diff(SymTable_T oSymTable, SymTable_T oOther,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra);
+
+/* Removes from oSymTable each binding for which (*pfPredicate)(pcKey, pvValue, pvExtra)
+returns nonzero, releasing its value as SymTable_remove releases it, in one pass that unlinks
+the bindings where it finds them instead of looking each key up again. pcKey is only valid
+during the call, which must not use oSymTable. With symtablehash.c oSymTable must have no
+open scope, and in multimap mode pfPredicate is called once for each key, with its first
+value, and removes the key with all of its values. Returns the number of bindings removed. */
+size_t SymTable_removeIf(SymTable_T oSymTable,
+int (*pfPredicate)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra);
+
+/* Moves the nodes and keys of oSymTable, which churn leaves scattered over the heap, into a
+few large blocks in the order SymTable_map visits them, frees the memory they leave and
+returns what it can of it to the system, so that lookups and maps touch fewer cache lines and
+pages. symtablehash.c moves the keys, leaving its Buckets where they are, and symtabledisk.c
+rewrites its file with each chain on consecutive pages. Pointers into oSymTable obtained
+before, such as the values of loaded keys or the arrays of SymTable_getAll, become invalid.
+With symtablehash.c oSymTable must have no open scope. Takes time proportional to the number
+of bindings. Returns 1 if successful or 0 if insufficient memory is available, in which case
+the bindings of oSymTable are unchanged. */
+int SymTable_compact(SymTable_T oSymTable);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,1288 @@
+/******************************************************************/
+/* symtabledisk.c                                                 */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "symtabledisk.h"
+
+/* number of bytes in a page of the file and in a frame of the page cache */
+enum {PAGE_SIZE = 4096};
+/* offsets in a page of the number of the next page of its bucket, of the number of bytes of
+records it holds and of its kind; its records follow the header */
+enum {PAGE_NEXT = 0, PAGE_USED = 8, PAGE_KIND = 12, PAGE_HEADER = 16};
+/* number of bytes of records a page has room for */
+enum {PAGE_ROOM = PAGE_SIZE - PAGE_HEADER};
+/* the kinds of page: one on the free list, and one of the chain of a bucket */
+enum {KIND_FREE = 0, KIND_BUCKET = 1};
+/* offsets in a record of the hash code of the key, the value, the length of the key and the
+'\0' terminated characters of the key */
+enum {RECORD_VALUE = sizeof(uint64_t), RECORD_LENGTH = RECORD_VALUE + sizeof(void*),
+    RECORD_KEY = RECORD_LENGTH + sizeof(uint32_t)};
+/* the largest percentage of the room in the first pages of the buckets that records may use
+before the next bucket is split */
+enum {LOAD_PERCENT = 75};
+/* number of pages of the cache of a SymTable made by SymTable_new */
+enum {DEFAULT_CACHE_PAGES = 256};
+/* number of pages SymTable_map reads at once, the next chunk being read by a thread of its
+own while the bindings of the last one are applied */
+enum {READAHEAD_PAGES = 64};
+
+/* the number of the page of no page, which ends a chain */
+#define NO_PAGE ((size_t)-1)
+/* the number of the frame of no frame, which ends the LRU list */
+#define NO_FRAME ((size_t)-1)
+
+/* struct Frame is one page of memory of the page cache. The frames that hold pages form a
+list from the one used last to the one used longest ago, which is evicted first. */
+struct Frame {
+    /* the PAGE_SIZE bytes of the page, or NULL until the frame is first used */
+    unsigned char *data;
+    /* the number of the page in data, or NO_PAGE if the frame holds none */
+    size_t page;
+    /* the frame used after this one, or NO_FRAME if it is the newest */
+    size_t newer;
+    /* the frame used before this one, or NO_FRAME if it is the oldest */
+    size_t older;
+    /* 1 if data has changed since the page was read or written, 0 otherwise */
+    int dirty;
+};
+
+/* struct SymTable keeps its bindings as records in fixed-size pages of a file, grouped in
+buckets by linear hashing: the first 2 to the power level buckets, and as many more as have
+been split from them, each own a chain of pages. When the records outgrow LOAD_PERCENT of
+the room in the buckets, the next bucket in turn is split in two, so the table grows one
+bucket at a time instead of rehashing every binding at once. The pages in use are kept in a
+bounded cache of frames, in memory, that writes the one used longest ago back to the file
+when it needs room. */
+struct SymTable {
+    /* for each bucket, the number of the first page of its chain */
+    size_t *primaries;
+    /* number of entries primaries has room for */
+    size_t primaryMax;
+    /* number of times the buckets have doubled */
+    size_t level;
+    /* the next bucket to split; buckets below it have been split at this level */
+    size_t split;
+    /* number of bindings in SymTable */
+    size_t length;
+    /* number of bytes of records in the pages */
+    size_t recordBytes;
+    /* the frames of the page cache */
+    struct Frame *frames;
+    /* number of frames that have been used */
+    size_t frameCount;
+    /* number of frames in frames, the bound of the cache */
+    size_t frameMax;
+    /* the frame used last, or NO_FRAME if none has been used */
+    size_t newest;
+    /* the frame used longest ago, or NO_FRAME if none has been used */
+    size_t oldest;
+    /* for each page, the frame that holds it, or NO_FRAME if it is only in the file */
+    size_t *frameOf;
+    /* number of pages, free ones included */
+    size_t pageCount;
+    /* number of entries frameOf has room for */
+    size_t pageMax;
+    /* the numbers of the pages that no bucket uses */
+    size_t *freePages;
+    /* number of entries in freePages */
+    size_t freeCount;
+    /* number of entries freePages has room for */
+    size_t freeMax;
+    /* the descriptor of the file, or -1 until the first page is written */
+    int file;
+    /* the directory the file is made in, or NULL for the default one */
+    char *dir;
+    /* number of pages read from the file */
+    size_t reads;
+    /* number of pages written to the file */
+    size_t writes;
+    /* the functions that release values and hash and compare keys */
+    struct SymTableOps ops;
+};
+
+/* struct Place is where the record of a binding lies. */
+struct Place {
+    /* the number of the page that holds the record */
+    size_t page;
+    /* the number of the page before it in the chain of its bucket, or NO_PAGE if it is the
+       first */
+    size_t previous;
+    /* the offset of the record in the page */
+    size_t offset;
+    /* the page in the cache, valid until another page is fetched */
+    unsigned char *data;
+};
+
+/* struct Readahead is a chunk of pages that SymTable_map reads from the file. */
+struct Readahead {
+    /* the descriptor of the file */
+    int file;
+    /* the buffer of READAHEAD_PAGES pages the chunk is read into */
+    unsigned char *data;
+    /* the number of the first page of the chunk */
+    size_t first;
+    /* number of pages in the chunk */
+    size_t count;
+    /* 1 if the chunk was read, 0 if the file could not be read */
+    int ok;
+    /* 1 if the chunk is read by a thread of its own, 0 if it was read by the caller */
+    int threaded;
+    /* the thread reading the chunk if threaded */
+    pthread_t thread;
+};
+
+/* struct Repack is the new file SymTable_compact writes the chains of the buckets into, one
+page after another. */
+struct Repack {
+    /* the descriptor of the new file */
+    int file;
+    /* a buffer of READAHEAD_PAGES pages, the last of them in use the page being filled */
+    unsigned char *data;
+    /* number of pages started */
+    size_t count;
+    /* number of pages in data that have not been written */
+    size_t buffered;
+};
+
+/* struct SetOp is the state of a merge, intersection or difference of two SymTables while
+the bindings of the first are swept. */
+struct SetOp {
+    /* the SymTable the keys of the swept one are looked up in, or merged into */
+    SymTable_T oOther;
+    /* 1 if the bindings whose keys oOther has leave, 0 if those whose keys it lacks */
+    int iLeaveFound;
+    /* the function called with each binding removed, or NULL */
+    void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra);
+    /* the extra argument of pfRemoved */
+    void *pvExtra;
+    /* number of bindings that left the swept SymTable */
+    size_t count;
+    /* 1 if a binding could not be merged for lack of memory, 0 otherwise */
+    int failed;
+};
+
+/* struct RemoveIf is a call of SymTable_removeIf while the records of a SymTable are swept. */
+struct RemoveIf {
+    /* the function that selects the bindings to remove */
+    int (*pfPredicate)(const char *pcKey, void *pvValue, void *pvExtra);
+    /* the extra argument of pfPredicate */
+    void *pvExtra;
+    /* number of bindings removed */
+    size_t count;
+};
+
+/* Return a hash code of the uLength characters at pcKey, which are read eight at a time and
+each word mixed in with a multiply, then spread by the finalizer of MurmurHash3 so that its
+low bits, which pick the bucket, depend on every character. */
+static size_t SymTable_hash(const char *pcKey, size_t uLength) {
+    const uint64_t GOLDEN_RATIO = 0x9E3779B97F4A7C15u;
+    uint64_t x = 0xcbf29ce484222325u ^ uLength;
+    uint64_t m;
+    size_t u;
+    size_t i;
+    assert(pcKey != NULL);
+    for(u = 0; u + 8 <= uLength; u += 8) {
+        memcpy(&m, pcKey + u, 8);
+        x = (x ^ m) * GOLDEN_RATIO;
+        x ^= x >> 29;
+    }
+    m = 0;
+    for(i = 0; u + i < uLength; i++) m |= (uint64_t)(unsigned char)pcKey[u + i] << (8 * i);
+    x = (x ^ m) * GOLDEN_RATIO;
+    x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdu;
+    x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53u;
+    return (size_t)(x ^ (x >> 33));
+}
+
+/* Return the hash code of the uLength characters at pcKey under the hash function of
+oSymTable. A hash code from pfHash is mixed like the built-in one, since its low bits pick the
+bucket. */
+static size_t SymTable_hashKey(SymTable_T oSymTable, const char *pcKey, size_t uLength) {
+    uint64_t x;
+    if(oSymTable->ops.pfHash == NULL) return SymTable_hash(pcKey, uLength);
+    x = (uint64_t)oSymTable->ops.pfHash(pcKey, uLength);
+    x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdu;
+    x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53u;
+    return (size_t)(x ^ (x >> 33));
+}
+
+/* Return 1 if oSymTable1 and oSymTable2 give every key the same hash code, so that the hash
+codes stored in the records of one are valid in the other, and 0 otherwise. */
+static int SymTable_sameHash(SymTable_T oSymTable1, SymTable_T oSymTable2) {
+    return oSymTable1->ops.pfHash == oSymTable2->ops.pfHash;
+}
+
+/* Return the number of the bucket of oSymTable that the keys with hash code hash fall into:
+the low level bits of hash, or one bit more if that bucket has already been split. */
+static size_t SymTable_bucketOf(SymTable_T oSymTable, size_t hash) {
+    size_t uMask = ((size_t)1 << oSymTable->level) - 1;
+    size_t uBucket = hash & uMask;
+    if(uBucket < oSymTable->split) uBucket = hash & (2 * uMask + 1);
+    return uBucket;
+}
+
+/* Return the number of buckets of oSymTable. */
+static size_t SymTable_bucketCount(SymTable_T oSymTable) {
+    return ((size_t)1 << oSymTable->level) + oSymTable->split;
+}
+
+/* Return the 64 bit number at pc. */
+static uint64_t SymTable_load64(const unsigned char *pc) {
+    uint64_t x;
+    memcpy(&x, pc, sizeof(x));
+    return x;
+}
+
+/* Return the 32 bit number at pc. */
+static uint32_t SymTable_load32(const unsigned char *pc) {
+    uint32_t x;
+    memcpy(&x, pc, sizeof(x));
+    return x;
+}
+
+/* Store x at pc. */
+static void SymTable_store64(unsigned char *pc, uint64_t x) {
+    memcpy(pc, &x, sizeof(x));
+}
+
+/* Store x at pc. */
+static void SymTable_store32(unsigned char *pc, uint32_t x) {
+    memcpy(pc, &x, sizeof(x));
+}
+
+/* Return the number of the page after the page at data in its chain, or NO_PAGE. */
+static size_t SymTable_getNext(const unsigned char *data) {
+    uint64_t uNext = SymTable_load64(data + PAGE_NEXT);
+    return uNext == UINT64_MAX ? NO_PAGE : (size_t)uNext;
+}
+
+/* Make uNext the page after the page at data in its chain. */
+static void SymTable_setNext(unsigned char *data, size_t uNext) {
+    SymTable_store64(data + PAGE_NEXT, uNext == NO_PAGE ? UINT64_MAX : (uint64_t)uNext);
+}
+
+/* Return the number of bytes of records in the page at data. */
+static size_t SymTable_getUsed(const unsigned char *data) {
+    return SymTable_load32(data + PAGE_USED);
+}
+
+/* Return the number of bytes of the record at pcRecord. */
+static size_t SymTable_recordSize(const unsigned char *pcRecord) {
+    return RECORD_KEY + SymTable_load32(pcRecord + RECORD_LENGTH) + 1;
+}
+
+/* Return the value of the record at pcRecord. */
+static void *SymTable_recordValue(const unsigned char *pcRecord) {
+    void *pvValue;
+    memcpy(&pvValue, pcRecord + RECORD_VALUE, sizeof(void*));
+    return pvValue;
+}
+
+/* Return 1 if the record at pcRecord of oSymTable holds the uLength characters at pcKey,
+whose hash code is hash, and 0 otherwise. */
+static int SymTable_matches(SymTable_T oSymTable, const unsigned char *pcRecord,
+const char *pcKey, size_t uLength, size_t hash) {
+    if((size_t)SymTable_load64(pcRecord) != hash) return 0;
+    if(SymTable_load32(pcRecord + RECORD_LENGTH) != uLength) return 0;
+    if(oSymTable->ops.pfEquals != NULL)
+        return oSymTable->ops.pfEquals((const char*)pcRecord + RECORD_KEY, pcKey, uLength);
+    return memcmp(pcRecord + RECORD_KEY, pcKey, uLength) == 0;
+}
+
+/* Read the uSize bytes at uOffset of iFile into data, filling what lies past the end of the
+file with zeros. Return 1 if successful or 0 if the file cannot be read. */
+static int SymTable_readAt(int iFile, unsigned char *data, size_t uSize, size_t uOffset) {
+    ssize_t iRead;
+    while(uSize > 0) {
+        iRead = pread(iFile, data, uSize, (off_t)uOffset);
+        if(iRead < 0) return 0;
+        if(iRead == 0) {
+            memset(data, 0, uSize);
+            return 1;
+        }
+        data += iRead;
+        uSize -= (size_t)iRead;
+        uOffset += (size_t)iRead;
+    }
+    return 1;
+}
+
+/* Write the uSize bytes at data to uOffset of iFile. Return 1 if successful or 0 if the
+file cannot be written. */
+static int SymTable_writeAt(int iFile, const unsigned char *data, size_t uSize,
+size_t uOffset) {
+    ssize_t iWritten;
+    while(uSize > 0) {
+        iWritten = pwrite(iFile, data, uSize, (off_t)uOffset);
+        if(iWritten <= 0) return 0;
+        data += iWritten;
+        uSize -= (size_t)iWritten;
+        uOffset += (size_t)iWritten;
+    }
+    return 1;
+}
+
+/* Create a file for the pages of oSymTable in its directory and unlink it, so that it is
+removed when it is closed. Return its descriptor, or -1 if the file cannot be created. */
+static int SymTable_openFile(SymTable_T oSymTable) {
+    const char *pcDir = oSymTable->dir;
+    char *pcPath;
+    int iFile;
+    if(pcDir == NULL) pcDir = getenv("TMPDIR");
+    if(pcDir == NULL || *pcDir == '\0') pcDir = "/tmp";
+    pcPath = (char*)malloc(strlen(pcDir) + sizeof("/symtableXXXXXX"));
+    if(pcPath == NULL) return -1;
+    strcpy(pcPath, pcDir);
+    strcat(pcPath, "/symtableXXXXXX");
+    iFile = mkstemp(pcPath);
+    if(iFile >= 0) (void)unlink(pcPath);
+    free(pcPath);
+    return iFile;
+}
+
+/* Take frame uFrame of oSymTable out of the LRU list. */
+static void SymTable_unlinkFrame(SymTable_T oSymTable, size_t uFrame) {
+    struct Frame *psFrame = &oSymTable->frames[uFrame];
+    if(psFrame->newer != NO_FRAME) oSymTable->frames[psFrame->newer].older = psFrame->older;
+    else oSymTable->newest = psFrame->older;
+    if(psFrame->older != NO_FRAME) oSymTable->frames[psFrame->older].newer = psFrame->newer;
+    else oSymTable->oldest = psFrame->newer;
+}
+
+/* Put frame uFrame of oSymTable, which is not in the LRU list, at its newest end. */
+static void SymTable_pushFrame(SymTable_T oSymTable, size_t uFrame) {
+    struct Frame *psFrame = &oSymTable->frames[uFrame];
+    psFrame->newer = NO_FRAME;
+    psFrame->older = oSymTable->newest;
+    if(oSymTable->newest != NO_FRAME) oSymTable->frames[oSymTable->newest].newer = uFrame;
+    else oSymTable->oldest = uFrame;
+    oSymTable->newest = uFrame;
+}
+
+/* Return the number of a frame of oSymTable that holds no page, at the newest end of the LRU
+list: one not used yet while the cache is below its bound, otherwise the oldest, whose page
+is first written to the file if it changed. Return NO_FRAME if insufficient memory is
+available or the file cannot be written. */
+static size_t SymTable_takeFrame(SymTable_T oSymTable) {
+    struct Frame *psFrame;
+    size_t uFrame = NO_FRAME;
+    if(oSymTable->frameCount < oSymTable->frameMax) {
+        uFrame = oSymTable->frameCount;
+        oSymTable->frames[uFrame].data = (unsigned char*)malloc(PAGE_SIZE);
+        if(oSymTable->frames[uFrame].data != NULL) {
+            oSymTable->frames[uFrame].page = NO_PAGE;
+            oSymTable->frames[uFrame].dirty = 0;
+            oSymTable->frameCount++;
+            SymTable_pushFrame(oSymTable, uFrame);
+            return uFrame;
+        }
+    }
+    uFrame = oSymTable->oldest;
+    if(uFrame == NO_FRAME) return NO_FRAME;
+    psFrame = &oSymTable->frames[uFrame];
+    if(psFrame->page != NO_PAGE) {
+        if(psFrame->dirty) {
+            if(oSymTable->file < 0) oSymTable->file = SymTable_openFile(oSymTable);
+            if(oSymTable->file < 0) return NO_FRAME;
+            if(!SymTable_writeAt(oSymTable->file, psFrame->data, PAGE_SIZE,
+                psFrame->page * PAGE_SIZE)) return NO_FRAME;
+            oSymTable->writes++;
+        }
+        oSymTable->frameOf[psFrame->page] = NO_FRAME;
+        psFrame->page = NO_PAGE;
+        psFrame->dirty = 0;
+    }
+    SymTable_unlinkFrame(oSymTable, uFrame);
+    SymTable_pushFrame(oSymTable, uFrame);
+    return uFrame;
+}
+
+/* Return page uPage of oSymTable in the cache, reading it from the file if it is not there,
+and mark it as changed if iChange. The pointer is only valid until another page is fetched.
+Return NULL if insufficient memory is available or the file cannot be read or written. */
+static unsigned char *SymTable_fetch(SymTable_T oSymTable, size_t uPage, int iChange) {
+    struct Frame *psFrame;
+    size_t uFrame = oSymTable->frameOf[uPage];
+    if(uFrame != NO_FRAME) {
+        if(uFrame != oSymTable->newest) {
+            SymTable_unlinkFrame(oSymTable, uFrame);
+            SymTable_pushFrame(oSymTable, uFrame);
+        }
+    }
+    else {
+        uFrame = SymTable_takeFrame(oSymTable);
+        if(uFrame == NO_FRAME) return NULL;
+        /* every page that is not in the cache has been written */
+        assert(oSymTable->file >= 0);
+        if(!SymTable_readAt(oSymTable->file, oSymTable->frames[uFrame].data, PAGE_SIZE,
+            uPage * PAGE_SIZE)) return NULL;
+        oSymTable->reads++;
+        oSymTable->frames[uFrame].page = uPage;
+        oSymTable->frameOf[uPage] = uFrame;
+    }
+    psFrame = &oSymTable->frames[uFrame];
+    if(iChange) psFrame->dirty = 1;
+    return psFrame->data;
+}
+
+/* Return the number of an empty page of oSymTable, in the cache and ending its chain, taken
+from the free list or added to the end of the file. Return NO_PAGE if insufficient memory
+is available or the file cannot be written. */
+static size_t SymTable_newPage(SymTable_T oSymTable) {
+    size_t *newFrameOf;
+    size_t newMax;
+    size_t uPage;
+    size_t uFrame;
+    unsigned char *data;
+    size_t u;
+
+    if(oSymTable->freeCount > 0) {
+        uPage = oSymTable->freePages[oSymTable->freeCount - 1];
+        data = SymTable_fetch(oSymTable, uPage, 1);
+        if(data == NULL) return NO_PAGE;
+        oSymTable->freeCount--;
+    }
+    else {
+        if(oSymTable->pageCount == oSymTable->pageMax) {
+            newMax = oSymTable->pageMax == 0 ? 64 : 2 * oSymTable->pageMax;
+            newFrameOf = (size_t*)realloc(oSymTable->frameOf, newMax * sizeof(size_t));
+            if(newFrameOf == NULL) return NO_PAGE;
+            for(u = oSymTable->pageMax; u < newMax; u++) newFrameOf[u] = NO_FRAME;
+            oSymTable->frameOf = newFrameOf;
+            oSymTable->pageMax = newMax;
+        }
+        uFrame = SymTable_takeFrame(oSymTable);
+        if(uFrame == NO_FRAME) return NO_PAGE;
+        uPage = oSymTable->pageCount++;
+        oSymTable->frames[uFrame].page = uPage;
+        oSymTable->frames[uFrame].dirty = 1;
+        oSymTable->frameOf[uPage] = uFrame;
+        data = oSymTable->frames[uFrame].data;
+    }
+    memset(data, 0, PAGE_HEADER);
+    SymTable_setNext(data, NO_PAGE);
+    SymTable_store32(data + PAGE_KIND, KIND_BUCKET);
+    return uPage;
+}
+
+/* Put page uPage of oSymTable, which no chain links to any more, on the free list. A page
+that cannot be fetched or listed is lost to oSymTable, which only wastes its room. */
+static void SymTable_freePage(SymTable_T oSymTable, size_t uPage) {
+    size_t *newPages;
+    size_t newMax;
+    unsigned char *data;
+    if(oSymTable->freeCount == oSymTable->freeMax) {
+        newMax = oSymTable->freeMax == 0 ? 16 : 2 * oSymTable->freeMax;
+        newPages = (size_t*)realloc(oSymTable->freePages, newMax * sizeof(size_t));
+        if(newPages == NULL) return;
+        oSymTable->freePages = newPages;
+        oSymTable->freeMax = newMax;
+    }
+    data = SymTable_fetch(oSymTable, uPage, 1);
+    if(data == NULL) return;
+    SymTable_store32(data + PAGE_KIND, KIND_FREE);
+    SymTable_store32(data + PAGE_USED, 0);
+    oSymTable->freePages[oSymTable->freeCount++] = uPage;
+}
+
+/* Return 1 if oSymTable binds the uLength characters at pcKey, whose hash code is hash, and
+store where its record lies in *psPlace, or return 0 otherwise. A page that cannot be read
+ends the search as if the key were not bound. */
+static int SymTable_locate(SymTable_T oSymTable, const char *pcKey, size_t uLength,
+size_t hash, struct Place *psPlace) {
+    size_t uEnd;
+    size_t uOffset;
+    psPlace->previous = NO_PAGE;
+    psPlace->page = oSymTable->primaries[SymTable_bucketOf(oSymTable, hash)];
+    while(psPlace->page != NO_PAGE) {
+        psPlace->data = SymTable_fetch(oSymTable, psPlace->page, 0);
+        if(psPlace->data == NULL) return 0;
+        uEnd = PAGE_HEADER + SymTable_getUsed(psPlace->data);
+        for(uOffset = PAGE_HEADER; uOffset < uEnd;
+            uOffset += SymTable_recordSize(psPlace->data + uOffset)) {
+            if(SymTable_matches(oSymTable, psPlace->data + uOffset, pcKey, uLength, hash)) {
+                psPlace->offset = uOffset;
+                return 1;
+            }
+        }
+        psPlace->previous = psPlace->page;
+        psPlace->page = SymTable_getNext(psPlace->data);
+    }
+    return 0;
+}
+
+/* Append a record binding the uLength characters at pcKey, whose hash code is hash, to
+pvValue to the first page of the chain of bucket uBucket of oSymTable with room for it,
+adding a page to the chain if none has. Return 1 if successful or 0 if insufficient memory
+is available or the file cannot be read or written. */
+static int SymTable_addRecord(SymTable_T oSymTable, size_t uBucket, const char *pcKey,
+size_t uLength, size_t hash, const void *pvValue) {
+    size_t uSize = RECORD_KEY + uLength + 1;
+    size_t uPage = oSymTable->primaries[uBucket];
+    size_t uLast = NO_PAGE;
+    size_t uUsed = 0;
+    unsigned char *data;
+    unsigned char *pcRecord;
+
+    while(uPage != NO_PAGE) {
+        data = SymTable_fetch(oSymTable, uPage, 0);
+        if(data == NULL) return 0;
+        uUsed = SymTable_getUsed(data);
+        if(uUsed + uSize <= PAGE_ROOM) break;
+        uLast = uPage;
+        uPage = SymTable_getNext(data);
+    }
+    if(uPage == NO_PAGE) {
+        uPage = SymTable_newPage(oSymTable);
+        if(uPage == NO_PAGE) return 0;
+        data = SymTable_fetch(oSymTable, uLast, 1);
+        if(data == NULL) {
+            SymTable_freePage(oSymTable, uPage);
+            return 0;
+        }
+        SymTable_setNext(data, uPage);
+        uUsed = 0;
+    }
+    data = SymTable_fetch(oSymTable, uPage, 1);
+    if(data == NULL) return 0;
+    pcRecord = data + PAGE_HEADER + uUsed;
+    SymTable_store64(pcRecord, (uint64_t)hash);
+    memcpy(pcRecord + RECORD_VALUE, &pvValue, sizeof(void*));
+    SymTable_store32(pcRecord + RECORD_LENGTH, (uint32_t)uLength);
+    memcpy(pcRecord + RECORD_KEY, pcKey, uLength);
+    pcRecord[RECORD_KEY + uLength] = '\0';
+    SymTable_store32(data + PAGE_USED, (uint32_t)(uUsed + uSize));
+    return 1;
+}
+
+/* Remove the record at *psPlace from oSymTable, shifting the records after it down, and
+free its page if that leaves an overflow page empty. The value is not released. Return 1 if
+the page was freed and 0 otherwise. */
+static int SymTable_cut(SymTable_T oSymTable, const struct Place *psPlace) {
+    unsigned char *data;
+    size_t uUsed;
+    size_t uSize;
+    size_t uNext;
+
+    data = SymTable_fetch(oSymTable, psPlace->page, 1);
+    assert(data != NULL);
+    uUsed = SymTable_getUsed(data);
+    uSize = SymTable_recordSize(data + psPlace->offset);
+    memmove(data + psPlace->offset, data + psPlace->offset + uSize,
+        PAGE_HEADER + uUsed - psPlace->offset - uSize);
+    SymTable_store32(data + PAGE_USED, (uint32_t)(uUsed - uSize));
+    oSymTable->length--;
+    oSymTable->recordBytes -= uSize;
+    if(uUsed > uSize || psPlace->previous == NO_PAGE) return 0;
+
+    uNext = SymTable_getNext(data);
+    data = SymTable_fetch(oSymTable, psPlace->previous, 1);
+    if(data == NULL) return 0;
+    SymTable_setNext(data, uNext);
+    SymTable_freePage(oSymTable, psPlace->page);
+    return 1;
+}
+
+/* Put the pages of the chain starting at page uPage of oSymTable on the free list. A page
+that cannot be read ends the chain, losing the pages after it as SymTable_freePage loses a
+page. */
+static void SymTable_freeChain(SymTable_T oSymTable, size_t uPage) {
+    unsigned char *data;
+    size_t uNext;
+    while(uPage != NO_PAGE) {
+        data = SymTable_fetch(oSymTable, uPage, 0);
+        if(data == NULL) break;
+        uNext = SymTable_getNext(data);
+        SymTable_freePage(oSymTable, uPage);
+        uPage = uNext;
+    }
+}
+
+/* Split bucket split of oSymTable in two: copy out the records of its chain, give both
+buckets new first pages, add each record again to the one of the two buckets it now falls
+into, and only then free the old chain. Leave oSymTable as it was if insufficient memory is
+available or a page cannot be read or written. */
+static void SymTable_split(SymTable_T oSymTable) {
+    size_t uFrom = oSymTable->split;
+    size_t uTo = uFrom + ((size_t)1 << oSymTable->level);
+    size_t uOldFrom = oSymTable->primaries[uFrom];
+    size_t uOldLevel = oSymTable->level;
+    unsigned char *pcRecords = NULL;
+    unsigned char *newRecords;
+    unsigned char *data;
+    size_t *newPrimaries;
+    size_t uBytes = 0;
+    size_t uMax = 0;
+    size_t newMax;
+    size_t uPage;
+    size_t uUsed;
+    size_t uOffset;
+    size_t uSize;
+    size_t hash;
+
+    if(uTo >= oSymTable->primaryMax) {
+        newMax = 2 * oSymTable->primaryMax;
+        newPrimaries = (size_t*)realloc(oSymTable->primaries, newMax * sizeof(size_t));
+        if(newPrimaries == NULL) return;
+        oSymTable->primaries = newPrimaries;
+        oSymTable->primaryMax = newMax;
+    }
+    for(uPage = uOldFrom; uPage != NO_PAGE; uPage = SymTable_getNext(data)) {
+        data = SymTable_fetch(oSymTable, uPage, 0);
+        if(data == NULL) {
+            free(pcRecords);
+            return;
+        }
+        uUsed = SymTable_getUsed(data);
+        if(uUsed == 0) continue;
+        if(uBytes + uUsed > uMax) {
+            uMax = uMax == 0 ? PAGE_ROOM : 2 * uMax;
+            newRecords = (unsigned char*)realloc(pcRecords, uMax);
+            if(newRecords == NULL) {
+                free(pcRecords);
+                return;
+            }
+            pcRecords = newRecords;
+        }
+        memcpy(pcRecords + uBytes, data + PAGE_HEADER, uUsed);
+        uBytes += uUsed;
+    }
+    oSymTable->primaries[uFrom] = SymTable_newPage(oSymTable);
+    oSymTable->primaries[uTo] = oSymTable->primaries[uFrom] == NO_PAGE ? NO_PAGE :
+        SymTable_newPage(oSymTable);
+    if(++oSymTable->split == (size_t)1 << oSymTable->level) {
+        oSymTable->level++;
+        oSymTable->split = 0;
+    }
+
+    /* The old chain still holds every record, so a failure only undoes the new chains. */
+    for(uOffset = 0; oSymTable->primaries[uTo] != NO_PAGE && uOffset < uBytes;
+        uOffset += uSize) {
+        uSize = SymTable_recordSize(pcRecords + uOffset);
+        hash = (size_t)SymTable_load64(pcRecords + uOffset);
+        if(!SymTable_addRecord(oSymTable, SymTable_bucketOf(oSymTable, hash),
+            (const char*)pcRecords + uOffset + RECORD_KEY, uSize - RECORD_KEY - 1, hash,
+            SymTable_recordValue(pcRecords + uOffset))) break;
+    }
+    free(pcRecords);
+    if(uOffset < uBytes || oSymTable->primaries[uTo] == NO_PAGE) {
+        SymTable_freeChain(oSymTable, oSymTable->primaries[uFrom]);
+        SymTable_freeChain(oSymTable, oSymTable->primaries[uTo]);
+        oSymTable->primaries[uFrom] = uOldFrom;
+        oSymTable->level = uOldLevel;
+        oSymTable->split = uFrom;
+        return;
+    }
+    SymTable_freeChain(oSymTable, uOldFrom);
+}
+
+/* Bind the uLength characters at pcKey, whose hash code is hash and which oSymTable does not
+bind, to pvValue, and split the next bucket if the records have outgrown the buckets. Return
+1 if successful or 0 if insufficient memory is available or the file cannot be read or
+written. */
+static int SymTable_add(SymTable_T oSymTable, const char *pcKey, size_t uLength, size_t hash,
+const void *pvValue) {
+    if(uLength > SymTable_getMaxKeyLength()) return 0;
+    if(!SymTable_addRecord(oSymTable, SymTable_bucketOf(oSymTable, hash), pcKey, uLength, hash,
+        pvValue)) return 0;
+    oSymTable->length++;
+    oSymTable->recordBytes += RECORD_KEY + uLength + 1;
+    if(oSymTable->recordBytes * 100 >
+        (size_t)LOAD_PERCENT * PAGE_ROOM * SymTable_bucketCount(oSymTable))
+        SymTable_split(oSymTable);
+    return 1;
+}
+
+/* Release pvValue, which oSymTable no longer binds, with the value-free function of
+oSymTable if it has one. */
+static void SymTable_release(SymTable_T oSymTable, void *pvValue) {
+    if(oSymTable->ops.pfFreeValue != NULL) oSymTable->ops.pfFreeValue(pvValue);
+}
+
+/* Call pfApply with the key and value of each record of the page at data, passing pvExtra
+as an extra parameter, unless the page is free. */
+static void SymTable_mapPage(const unsigned char *data,
+void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), void *pvExtra) {
+    size_t uEnd;
+    size_t uOffset;
+    if(SymTable_load32(data + PAGE_KIND) != KIND_BUCKET) return;
+    uEnd = PAGE_HEADER + SymTable_getUsed(data);
+    for(uOffset = PAGE_HEADER; uOffset < uEnd; uOffset += SymTable_recordSize(data + uOffset))
+        pfApply((const char*)data + uOffset + RECORD_KEY, SymTable_recordValue(data + uOffset),
+            pvExtra);
+}
+
+/* Read the chunk of pages of the Readahead pvChunk from its file. Return NULL. */
+static void *SymTable_readChunk(void *pvChunk) {
+    struct Readahead *psChunk = (struct Readahead*)pvChunk;
+    psChunk->ok = SymTable_readAt(psChunk->file, psChunk->data, psChunk->count * PAGE_SIZE,
+        psChunk->first * PAGE_SIZE);
+    return NULL;
+}
+
+/* Start reading the psChunk->count pages from psChunk->first on by a thread of its own, or
+read them at once if no thread can be started. */
+static void SymTable_startChunk(struct Readahead *psChunk) {
+    psChunk->threaded = pthread_create(&psChunk->thread, NULL, SymTable_readChunk,
+        psChunk) == 0;
+    if(!psChunk->threaded) (void)SymTable_readChunk(psChunk);
+}
+
+/* Release the value of the binding pcKey to pvValue with the value-free function of the
+SymTable pvExtra. */
+static void SymTable_releaseBinding(const char *pcKey, void *pvValue, void *pvExtra) {
+    (void)pcKey;
+    SymTable_release((SymTable_T)pvExtra, pvValue);
+}
+
+/* Return 1 if oOther binds the key of the record at pcRecord of oSymTable, and 0 otherwise.
+The hash code in the record is used unless the two SymTables hash differently. */
+static int SymTable_findIn(SymTable_T oOther, SymTable_T oSymTable,
+const unsigned char *pcRecord) {
+    struct Place sPlace;
+    const char *pcKey = (const char*)pcRecord + RECORD_KEY;
+    size_t uLength = SymTable_load32(pcRecord + RECORD_LENGTH);
+    size_t hash = SymTable_sameHash(oSymTable, oOther) ? (size_t)SymTable_load64(pcRecord) :
+        SymTable_hashKey(oOther, pcKey, uLength);
+    return SymTable_locate(oOther, pcKey, uLength, hash, &sPlace);
+}
+
+/* Return 0, keeping the record at pcRecord in oSymTable, unless the SetOp pvOp has it leave.
+Otherwise pass the binding to the pfRemoved of the SetOp, release its value and return 1. */
+static int SymTable_dropBinding(SymTable_T oSymTable, const unsigned char *pcRecord,
+void *pvOp) {
+    struct SetOp *psOp = (struct SetOp*)pvOp;
+    void *pvValue = SymTable_recordValue(pcRecord);
+    if(SymTable_findIn(psOp->oOther, oSymTable, pcRecord) != psOp->iLeaveFound) return 0;
+    if(psOp->pfRemoved != NULL)
+        psOp->pfRemoved((const char*)pcRecord + RECORD_KEY, pvValue, psOp->pvExtra);
+    SymTable_release(oSymTable, pvValue);
+    psOp->count++;
+    return 1;
+}
+
+/* Return 0, keeping the record at pcRecord in oSymTable, if the oOther of the SetOp pvOp
+binds its key or the binding cannot be added to it. Otherwise add the binding to oOther and
+return 1. */
+static int SymTable_moveBinding(SymTable_T oSymTable, const unsigned char *pcRecord,
+void *pvOp) {
+    struct SetOp *psOp = (struct SetOp*)pvOp;
+    const char *pcKey = (const char*)pcRecord + RECORD_KEY;
+    size_t uLength = SymTable_load32(pcRecord + RECORD_LENGTH);
+    size_t hash;
+    if(SymTable_findIn(psOp->oOther, oSymTable, pcRecord)) return 0;
+    hash = SymTable_sameHash(oSymTable, psOp->oOther) ? (size_t)SymTable_load64(pcRecord) :
+        SymTable_hashKey(psOp->oOther, pcKey, uLength);
+    if(!SymTable_add(psOp->oOther, pcKey, uLength, hash, SymTable_recordValue(pcRecord))) {
+        psOp->failed = 1;
+        return 0;
+    }
+    psOp->count++;
+    return 1;
+}
+
+/* Return 0, keeping the record at pcRecord in oSymTable, unless the predicate of the
+RemoveIf pvCall selects it. Otherwise release its value, count it and return 1. */
+static int SymTable_dropSelected(SymTable_T oSymTable, const unsigned char *pcRecord,
+void *pvCall) {
+    struct RemoveIf *psCall = (struct RemoveIf*)pvCall;
+    void *pvValue = SymTable_recordValue(pcRecord);
+    if(!psCall->pfPredicate((const char*)pcRecord + RECORD_KEY, pvValue, psCall->pvExtra))
+        return 0;
+    SymTable_release(oSymTable, pvValue);
+    psCall->count++;
+    return 1;
+}
+
+/* Call pfLeaves with each record of oSymTable and pvExtra, and remove the records for which
+it returns 1. pfLeaves may only look at other SymTables, so the page of the record stays in
+the cache during the call. */
+static void SymTable_sweep(SymTable_T oSymTable, int (*pfLeaves)(SymTable_T oSymTable,
+const unsigned char *pcRecord, void *pvExtra), void *pvExtra) {
+    struct Place sPlace;
+    size_t uBucketCount = SymTable_bucketCount(oSymTable);
+    size_t uNext;
+    size_t u;
+    int iFreed;
+
+    for(u = 0; u < uBucketCount; u++) {
+        sPlace.previous = NO_PAGE;
+        sPlace.page = oSymTable->primaries[u];
+        while(sPlace.page != NO_PAGE) {
+            sPlace.data = SymTable_fetch(oSymTable, sPlace.page, 0);
+            if(sPlace.data == NULL) break;
+            uNext = SymTable_getNext(sPlace.data);
+            iFreed = 0;
+            sPlace.offset = PAGE_HEADER;
+            while(!iFreed && sPlace.offset < PAGE_HEADER + SymTable_getUsed(sPlace.data)) {
+                if(!pfLeaves(oSymTable, sPlace.data + sPlace.offset, pvExtra)) {
+                    sPlace.offset += SymTable_recordSize(sPlace.data + sPlace.offset);
+                    continue;
+                }
+                iFreed = SymTable_cut(oSymTable, &sPlace);
+                if(!iFreed) sPlace.data = SymTable_fetch(oSymTable, sPlace.page, 0);
+            }
+            if(!iFreed) sPlace.previous = sPlace.page;
+            sPlace.page = uNext;
+        }
+    }
+}
+
+SymTable_T SymTable_newDisk(const char *pcDir, size_t uCachePages,
+const struct SymTableOps *psOps) {
+    SymTable_T newDiskTable;
+    assert(uCachePages > 0);
+
+    newDiskTable = (SymTable_T)calloc(1, sizeof(struct SymTable));
+    if(newDiskTable == NULL) return NULL;
+    newDiskTable->file = -1;
+    newDiskTable->newest = NO_FRAME;
+    newDiskTable->oldest = NO_FRAME;
+    newDiskTable->frameMax = uCachePages;
+    if(psOps != NULL) newDiskTable->ops = *psOps;
+    newDiskTable->frames = (struct Frame*)calloc(uCachePages, sizeof(struct Frame));
+    newDiskTable->primaryMax = 1;
+    newDiskTable->primaries = (size_t*)malloc(sizeof(size_t));
+    if(pcDir != NULL) {
+        newDiskTable->dir = (char*)malloc(strlen(pcDir) + 1);
+        if(newDiskTable->dir != NULL) strcpy(newDiskTable->dir, pcDir);
+    }
+    if(newDiskTable->frames == NULL || newDiskTable->primaries == NULL ||
+        (pcDir != NULL && newDiskTable->dir == NULL)) {
+        SymTable_free(newDiskTable);
+        return NULL;
+    }
+    newDiskTable->primaries[0] = SymTable_newPage(newDiskTable);
+    if(newDiskTable->primaries[0] == NO_PAGE) {
+        SymTable_free(newDiskTable);
+        return NULL;
+    }
+    return newDiskTable;
+}
+
+SymTable_T SymTable_new(void) {
+    return SymTable_newDisk(NULL, DEFAULT_CACHE_PAGES, NULL);
+}
+
+SymTable_T SymTable_newWithOps(const struct SymTableOps *psOps) {
+    assert(psOps != NULL);
+    return SymTable_newDisk(NULL, DEFAULT_CACHE_PAGES, psOps);
+}
+
+size_t SymTable_getMaxKeyLength(void) {
+    return PAGE_ROOM - RECORD_KEY - 1;
+}
+
+void SymTable_free(SymTable_T oSymTable) {
+    size_t u;
+    assert(oSymTable != NULL);
+
+    if(oSymTable->ops.pfFreeValue != NULL && oSymTable->length > 0)
+        SymTable_map(oSymTable, SymTable_releaseBinding, oSymTable);
+    if(oSymTable->file >= 0) (void)close(oSymTable->file);
+    if(oSymTable->frames != NULL)
+        for(u = 0; u < oSymTable->frameCount; u++) free(oSymTable->frames[u].data);
+    free(oSymTable->frames);
+    free(oSymTable->primaries);
+    free(oSymTable->frameOf);
+    free(oSymTable->freePages);
+    free(oSymTable->dir);
+    free(oSymTable);
+}
+
+void SymTable_clear(SymTable_T oSymTable) {
+    size_t u;
+    assert(oSymTable != NULL);
+
+    if(oSymTable->ops.pfFreeValue != NULL && oSymTable->length > 0)
+        SymTable_map(oSymTable, SymTable_releaseBinding, oSymTable);
+    /* the pages are dropped unwritten and the file is emptied; the frames are kept */
+    for(u = 0; u < oSymTable->frameCount; u++) {
+        oSymTable->frames[u].page = NO_PAGE;
+        oSymTable->frames[u].dirty = 0;
+    }
+    for(u = 0; u < oSymTable->pageCount; u++) oSymTable->frameOf[u] = NO_FRAME;
+    if(oSymTable->file >= 0) (void)ftruncate(oSymTable->file, 0);
+    oSymTable->pageCount = 0;
+    oSymTable->freeCount = 0;
+    oSymTable->level = 0;
+    oSymTable->split = 0;
+    oSymTable->length = 0;
+    oSymTable->recordBytes = 0;
+    /* a frame is free, so the first page needs no memory and no write */
+    oSymTable->primaries[0] = SymTable_newPage(oSymTable);
+    assert(oSymTable->primaries[0] != NO_PAGE);
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return oSymTable->length;
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    assert(pcKey != NULL);
+    return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey, size_t uLen, const void *pvValue) {
+    struct Place sPlace;
+    size_t hash;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    hash = SymTable_hashKey(oSymTable, pcKey, uLen);
+    if(SymTable_locate(oSymTable, pcKey, uLen, hash, &sPlace)) return 0;
+    return SymTable_add(oSymTable, pcKey, uLen, hash, pvValue);
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    struct Place sPlace;
+    void *output;
+    size_t uLength;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uLength = strlen(pcKey);
+    if(!SymTable_locate(oSymTable, pcKey, uLength, SymTable_hashKey(oSymTable, pcKey, uLength),
+        &sPlace)) return NULL;
+    output = SymTable_recordValue(sPlace.data + sPlace.offset);
+    sPlace.data = SymTable_fetch(oSymTable, sPlace.page, 1);
+    memcpy(sPlace.data + sPlace.offset + RECORD_VALUE, &pvValue, sizeof(void*));
+    SymTable_release(oSymTable, output);
+    return output;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
+    struct Place sPlace;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_locate(oSymTable, pcKey, uLen, SymTable_hashKey(oSymTable, pcKey, uLen),
+        &sPlace);
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
+    struct Place sPlace;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    if(!SymTable_locate(oSymTable, pcKey, uLen, SymTable_hashKey(oSymTable, pcKey, uLen),
+        &sPlace)) return NULL;
+    return SymTable_recordValue(sPlace.data + sPlace.offset);
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
+    struct Place sPlace;
+    void *output;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    if(!SymTable_locate(oSymTable, pcKey, uLen, SymTable_hashKey(oSymTable, pcKey, uLen),
+        &sPlace)) return NULL;
+    output = SymTable_recordValue(sPlace.data + sPlace.offset);
+    (void)SymTable_cut(oSymTable, &sPlace);
+    SymTable_release(oSymTable, output);
+    return output;
+}
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+const void *pvExtra) {
+    struct Readahead asChunks[2];
+    struct Readahead *psChunk;
+    const unsigned char *data;
+    size_t uPage;
+    size_t u;
+    int i;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    /* Pages are visited in the order of the file rather than of the buckets, so that it is
+       read front to back. A page in the cache may be newer than its copy in the file. */
+    if(oSymTable->file < 0) {
+        for(uPage = 0; uPage < oSymTable->pageCount; uPage++)
+            SymTable_mapPage(oSymTable->frames[oSymTable->frameOf[uPage]].data, pfApply,
+                (void*)pvExtra);
+        return;
+    }
+    for(i = 0; i < 2; i++) {
+        asChunks[i].file = oSymTable->file;
+        asChunks[i].data = (unsigned char*)malloc(READAHEAD_PAGES * PAGE_SIZE);
+    }
+    if(asChunks[0].data == NULL || asChunks[1].data == NULL) {
+        free(asChunks[0].data);
+        free(asChunks[1].data);
+        /* without buffers the pages are fetched through the cache, one at a time */
+        for(uPage = 0; uPage < oSymTable->pageCount; uPage++) {
+            data = SymTable_fetch(oSymTable, uPage, 0);
+            if(data != NULL) SymTable_mapPage(data, pfApply, (void*)pvExtra);
+        }
+        return;
+    }
+
+    asChunks[0].first = 0;
+    asChunks[0].count = oSymTable->pageCount < READAHEAD_PAGES ? oSymTable->pageCount :
+        READAHEAD_PAGES;
+    SymTable_startChunk(&asChunks[0]);
+    for(i = 0; ; i = 1 - i) {
+        psChunk = &asChunks[i];
+        if(psChunk->threaded) (void)pthread_join(psChunk->thread, NULL);
+        uPage = psChunk->first + psChunk->count;
+        if(uPage < oSymTable->pageCount) {
+            asChunks[1 - i].first = uPage;
+            asChunks[1 - i].count = oSymTable->pageCount - uPage < READAHEAD_PAGES ?
+                oSymTable->pageCount - uPage : READAHEAD_PAGES;
+            SymTable_startChunk(&asChunks[1 - i]);
+        }
+        for(u = 0; u < psChunk->count; u++) {
+            if(oSymTable->frameOf[psChunk->first + u] != NO_FRAME)
+                data = oSymTable->frames[oSymTable->frameOf[psChunk->first + u]].data;
+            else if(psChunk->ok) data = psChunk->data + u * PAGE_SIZE;
+            else continue;
+            SymTable_mapPage(data, pfApply, (void*)pvExtra);
+        }
+        if(psChunk->ok) oSymTable->reads += psChunk->count;
+        if(uPage >= oSymTable->pageCount) break;
+    }
+    free(asChunks[0].data);
+    free(asChunks[1].data);
+}
+
+size_t SymTable_memoryUsage(SymTable_T oSymTable, struct SymTableMemory *psUsage) {
+    struct SymTableMemory sUsage;
+    const struct Frame *psFrame;
+    size_t u;
+    assert(oSymTable != NULL);
+
+    sUsage.buckets = oSymTable->primaryMax * sizeof(size_t);
+    sUsage.nodes = 0;
+    sUsage.keys = 0;
+    sUsage.overhead = sizeof(struct SymTable) + oSymTable->frameMax * sizeof(struct Frame)
+        + oSymTable->pageMax * sizeof(size_t) + oSymTable->freeMax * sizeof(size_t);
+    if(oSymTable->dir != NULL) sUsage.overhead += strlen(oSymTable->dir) + 1;
+    /* the cached pages that hold records count as keys, the rest of the cache as overhead */
+    for(u = 0; u < oSymTable->frameCount; u++) {
+        psFrame = &oSymTable->frames[u];
+        if(psFrame->page != NO_PAGE && SymTable_getUsed(psFrame->data) > 0)
+            sUsage.keys += PAGE_SIZE;
+        else sUsage.overhead += PAGE_SIZE;
+    }
+
+    if(psUsage != NULL) *psUsage = sUsage;
+    return sUsage.buckets + sUsage.nodes + sUsage.keys + sUsage.overhead;
+}
+
+int SymTable_merge(SymTable_T oSymTable, SymTable_T oSource) {
+    struct SetOp sOp;
+    assert(oSymTable != NULL);
+    assert(oSource != NULL);
+    assert(oSymTable != oSource);
+
+    sOp.oOther = oSymTable;
+    sOp.iLeaveFound = 0;
+    sOp.pfRemoved = NULL;
+    sOp.pvExtra = NULL;
+    sOp.count = 0;
+    sOp.failed = 0;
+    SymTable_sweep(oSource, SymTable_moveBinding, &sOp);
+    return !sOp.failed;
+}
+
+size_t SymTable_intersect(SymTable_T oSymTable, SymTable_T oOther,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    struct SetOp sOp;
+    assert(oSymTable != NULL);
+    assert(oOther != NULL);
+    assert(oSymTable != oOther);
+
+    sOp.oOther = oOther;
+    sOp.iLeaveFound = 0;
+    sOp.pfRemoved = pfRemoved;
+    sOp.pvExtra = (void*)pvExtra;
+    sOp.count = 0;
+    sOp.failed = 0;
+    SymTable_sweep(oSymTable, SymTable_dropBinding, &sOp);
+    return sOp.count;
+}
+
+size_t SymTable_diff(SymTable_T oSymTable, SymTable_T oOther,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    struct SetOp sOp;
+    assert(oSymTable != NULL);
+    assert(oOther != NULL);
+    assert(oSymTable != oOther);
+
+    sOp.oOther = oOther;
+    sOp.iLeaveFound = 1;
+    sOp.pfRemoved = pfRemoved;
+    sOp.pvExtra = (void*)pvExtra;
+    sOp.count = 0;
+    sOp.failed = 0;
+    SymTable_sweep(oSymTable, SymTable_dropBinding, &sOp);
+    return sOp.count;
+}
+
+size_t SymTable_removeIf(SymTable_T oSymTable,
+int (*pfPredicate)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    struct RemoveIf sCall;
+    assert(oSymTable != NULL);
+    assert(pfPredicate != NULL);
+
+    sCall.pfPredicate = pfPredicate;
+    sCall.pvExtra = (void*)pvExtra;
+    sCall.count = 0;
+    SymTable_sweep(oSymTable, SymTable_dropSelected, &sCall);
+    return sCall.count;
+}
+
+void SymTable_getPageStats(SymTable_T oSymTable, size_t *puReads, size_t *puWrites,
+size_t *puPages) {
+    assert(oSymTable != NULL);
+    if(puReads != NULL) *puReads = oSymTable->reads;
+    if(puWrites != NULL) *puWrites = oSymTable->writes;
+    if(puPages != NULL) *puPages = oSymTable->pageCount;
+}
+
+/* Write the buffered pages of psRepack to its file. Return 1 if successful or 0 if the file
+cannot be written. */
+static int SymTable_flushRepack(struct Repack *psRepack) {
+    if(!SymTable_writeAt(psRepack->file, psRepack->data, psRepack->buffered * PAGE_SIZE,
+        (psRepack->count - psRepack->buffered) * PAGE_SIZE)) return 0;
+    psRepack->buffered = 0;
+    return 1;
+}
+
+/* Start the next page of psRepack, empty and ending its chain, and make it the page after the
+one being filled if iLink is 1. Return the page, which is valid until the next one is started,
+or NULL if the buffered pages cannot be written to make room for it. */
+static unsigned char *SymTable_startPage(struct Repack *psRepack, int iLink) {
+    unsigned char *data;
+    if(iLink)
+        SymTable_setNext(psRepack->data + (psRepack->buffered - 1) * PAGE_SIZE, psRepack->count);
+    if(psRepack->buffered == READAHEAD_PAGES && !SymTable_flushRepack(psRepack)) return NULL;
+    data = psRepack->data + psRepack->buffered * PAGE_SIZE;
+    memset(data, 0, PAGE_SIZE);
+    SymTable_setNext(data, NO_PAGE);
+    SymTable_store32(data + PAGE_KIND, KIND_BUCKET);
+    psRepack->buffered++;
+    psRepack->count++;
+    return data;
+}
+
+int SymTable_compact(SymTable_T oSymTable) {
+    struct Repack sRepack;
+    struct Frame *psFrame;
+    size_t *newPrimaries;
+    size_t *newFrameOf;
+    unsigned char *data;
+    unsigned char *pcPage = NULL;
+    size_t uBuckets;
+    size_t uBucket;
+    size_t uPage;
+    size_t uEnd;
+    size_t uOffset;
+    size_t uSize;
+    size_t uUsed;
+    size_t u;
+    int iSuccessful = 1;
+    assert(oSymTable != NULL);
+
+    /* a SymTable that has not written a page yet has all of them in the cache */
+    if(oSymTable->file < 0) return 1;
+    newPrimaries = (size_t*)malloc(oSymTable->primaryMax * sizeof(size_t));
+    sRepack.data = (unsigned char*)malloc(READAHEAD_PAGES * PAGE_SIZE);
+    sRepack.file = newPrimaries != NULL && sRepack.data != NULL ?
+        SymTable_openFile(oSymTable) : -1;
+    if(sRepack.file < 0) {
+        free(newPrimaries);
+        free(sRepack.data);
+        return 0;
+    }
+    sRepack.count = 0;
+    sRepack.buffered = 0;
+
+    /* The records of each chain are packed onto consecutive pages of the new file, in the
+       order of the buckets, so that neither a lookup nor SymTable_map seeks within a chain. */
+    uBuckets = SymTable_bucketCount(oSymTable);
+    for(uBucket = 0; iSuccessful && uBucket < uBuckets; uBucket++) {
+        newPrimaries[uBucket] = sRepack.count;
+        pcPage = SymTable_startPage(&sRepack, 0);
+        iSuccessful = pcPage != NULL;
+        uPage = oSymTable->primaries[uBucket];
+        while(iSuccessful && uPage != NO_PAGE) {
+            data = SymTable_fetch(oSymTable, uPage, 0);
+            if(data == NULL) {
+                iSuccessful = 0;
+                break;
+            }
+            uEnd = PAGE_HEADER + SymTable_getUsed(data);
+            for(uOffset = PAGE_HEADER; iSuccessful && uOffset < uEnd; uOffset += uSize) {
+                uSize = SymTable_recordSize(data + uOffset);
+                uUsed = SymTable_getUsed(pcPage);
+                if(uUsed + uSize > PAGE_ROOM) {
+                    pcPage = SymTable_startPage(&sRepack, 1);
+                    if(pcPage == NULL) {
+                        iSuccessful = 0;
+                        continue;
+                    }
+                    uUsed = 0;
+                }
+                memcpy(pcPage + PAGE_HEADER + uUsed, data + uOffset, uSize);
+                SymTable_store32(pcPage + PAGE_USED, (uint32_t)(uUsed + uSize));
+            }
+            uPage = SymTable_getNext(data);
+        }
+    }
+    if(iSuccessful) iSuccessful = SymTable_flushRepack(&sRepack);
+    if(iSuccessful && sRepack.count > oSymTable->pageMax) {
+        newFrameOf = (size_t*)realloc(oSymTable->frameOf, sRepack.count * sizeof(size_t));
+        if(newFrameOf == NULL) iSuccessful = 0;
+        else {
+            oSymTable->frameOf = newFrameOf;
+            oSymTable->pageMax = sRepack.count;
+        }
+    }
+    free(sRepack.data);
+    if(!iSuccessful) {
+        (void)close(sRepack.file);
+        free(newPrimaries);
+        return 0;
+    }
+
+    /* the cache holds pages of the old file, whose numbers mean nothing in the new one */
+    for(u = 0; u < oSymTable->pageMax; u++) oSymTable->frameOf[u] = NO_FRAME;
+    for(u = 0; u < oSymTable->frameCount; u++) {
+        psFrame = &oSymTable->frames[u];
+        psFrame->page = NO_PAGE;
+        psFrame->dirty = 0;
+    }
+    (void)close(oSymTable->file);
+    oSymTable->file = sRepack.file;
+    free(oSymTable->primaries);
+    oSymTable->primaries = newPrimaries;
+    oSymTable->pageCount = sRepack.count;
+    oSymTable->freeCount = 0;
+    oSymTable->writes += sRepack.count;
+    return 1;
+}
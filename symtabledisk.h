@@ -0,0 +1,33 @@
+/******************************************************************/
+/* symtabledisk.h                                                 */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#ifndef SYMTABLEDISK_INCLUDED
+#define SYMTABLEDISK_INCLUDED
+#include <stddef.h>
+#include "symtable.h"
+
+/* The functions below are provided only by symtabledisk.c. */
+
+/* Returns a new SymTable object with no bindings that keeps them in pages of a file and at
+most uCachePages of those pages in memory, or NULL if insufficient memory is available. The
+file is created, and at once unlinked, in the directory pcDir, or in $TMPDIR or /tmp if pcDir
+is NULL, the first time a page must leave the cache, so a SymTable that fits in its cache
+never touches the disk. Values are stored as the pointers themselves, so the file is scratch
+space for one process rather than a durable copy of the bindings. The functions of *psOps
+are used unless psOps is NULL. uCachePages must be at least 1. */
+SymTable_T SymTable_newDisk(const char *pcDir, size_t uCachePages,
+const struct SymTableOps *psOps);
+
+/* Returns the length of the longest key a SymTable of symtabledisk.c can bind. A record
+never spans two pages, so SymTable_put fails for longer keys. */
+size_t SymTable_getMaxKeyLength(void);
+
+/* Stores, unless the pointer is NULL, the number of pages oSymTable has read from its file in
+*puReads, the number it has written in *puWrites, and the number of pages of the file, free
+ones included, in *puPages. */
+void SymTable_getPageStats(SymTable_T oSymTable, size_t *puReads, size_t *puWrites,
+size_t *puPages);
+
+#endif
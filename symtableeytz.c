@@ -0,0 +1,851 @@
+/******************************************************************/
+/* symtableeytz.c                                                 */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <limits.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "symtable.h"
+
+/* number of bindings the delta buffer of a small SymTable holds before it is merged */
+enum {DELTA_MIN = 32};
+/* square of the number of times the square root of its length that a delta buffer holds */
+enum {DELTA_SCALE = 16};
+/* number of bits of the delta filter per binding the delta buffer has room for */
+enum {FILTER_BITS = 8};
+/* number of bits in a word of the delta filter */
+enum {WORD_BITS = 64};
+/* number of bytes the key pool starts with */
+enum {POOL_MIN = 256};
+/* number of levels of the search array that a prefetch runs ahead: the 16 descendants four
+levels below index k sit together at index 16k, two cache lines of hash codes */
+enum {PREFETCH_LEVELS = 4};
+/* number of hash codes in a cache line of 64 bytes */
+enum {CODES_PER_LINE = 64 / sizeof(size_t)};
+
+/* the length of an Entry whose binding was removed, which no key length equals */
+#define REMOVED ((size_t)-1)
+
+/* struct Entry is one binding of the SymTable. Its hash code is kept apart from it, in the
+array that lookups search, so that a search reads eight hash codes per cache line. */
+struct Entry {
+    /* the offset of the key in the key pool of the SymTable */
+    size_t offset;
+    /* the number of characters in the key, or REMOVED if the binding was removed */
+    size_t length;
+    /* the value the Entry stores for the key */
+    void *value;
+};
+
+/* struct Item is a binding on its way into the sorted array, with its hash code beside it so
+that a batch of bindings can be sorted. */
+struct Item {
+    /* the hash code of the key under the SymTable the binding goes to */
+    size_t hash;
+    /* the binding, whose key is in the pool of the SymTable it comes from */
+    struct Entry entry;
+    /* where the binding is in the SymTable it comes from, as SymTable_merge counts */
+    size_t origin;
+};
+
+/* struct SymTable keeps its bindings in one array sorted by hash code and length and laid
+out in Eytzinger order: the children of index k are at 2k and 2k + 1, so a lookup walks down
+an implicit binary tree whose top levels share a few cache lines. New bindings go to a small
+unsorted delta buffer that is sorted and merged into the array when it fills, and removed
+bindings stay in the array, marked REMOVED, until the array is rebuilt. */
+struct SymTable {
+    /* the hash codes of the sorted bindings in Eytzinger order from index 1, or NULL */
+    size_t *hashes;
+    /* the sorted bindings, each at the index of its hash code */
+    struct Entry *entries;
+    /* number of bindings in hashes and entries, counting the removed ones */
+    size_t sorted;
+    /* number of bindings in hashes and entries that were removed */
+    size_t removed;
+    /* the hash codes of the bindings of the delta buffer, or NULL */
+    size_t *deltaHashes;
+    /* the bindings added since the last merge, in the order they were added */
+    struct Entry *delta;
+    /* number of bindings in the delta buffer */
+    size_t deltaCount;
+    /* number of bindings the delta buffer holds before it is merged */
+    size_t deltaMax;
+    /* number of bindings deltaHashes and delta have room for, a power of two */
+    size_t deltaSize;
+    /* a Bloom filter that has two bits set for each hash code of the delta buffer, so that
+       most lookups of keys it lacks skip the scan, or NULL */
+    uint64_t *deltaFilter;
+    /* the characters of the keys, each followed by a '\0', or NULL */
+    char *pool;
+    /* number of bytes of pool in use, including the keys of removed bindings */
+    size_t poolUsed;
+    /* number of bytes allocated for pool */
+    size_t poolSize;
+    /* number of bytes of pool that the keys of the bindings use */
+    size_t keyBytes;
+    /* number of bindings in SymTable */
+    size_t length;
+    /* the functions that release values and hash and compare keys */
+    struct SymTableOps ops;
+};
+
+/* Return a hash code of the uLength characters at pcKey, which are read eight at a time and
+each word mixed in with a multiply; the finalizer of MurmurHash3 then spreads every bit over
+the high bits that the sorted order compares first. The hash function has no seed, so
+symtablehash.c is the one to use for keys that an attacker chooses. Words are read in the
+byte order of the machine, which only changes which codes keys get. */
+static size_t SymTable_hash(const char *pcKey, size_t uLength) {
+    const uint64_t GOLDEN_RATIO = 0x9E3779B97F4A7C15u;
+    uint64_t x = 0xcbf29ce484222325u ^ uLength;
+    uint64_t m;
+    size_t u;
+    size_t i;
+    assert(pcKey != NULL);
+    for(u = 0; u + 8 <= uLength; u += 8) {
+        memcpy(&m, pcKey + u, 8);
+        x = (x ^ m) * GOLDEN_RATIO;
+        x ^= x >> 29;
+    }
+    m = 0;
+    for(i = 0; u + i < uLength; i++) m |= (uint64_t)(unsigned char)pcKey[u + i] << (8 * i);
+    x = (x ^ m) * GOLDEN_RATIO;
+    x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdu;
+    x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53u;
+    return (size_t)(x ^ (x >> 33));
+}
+
+/* Return the hash code of the uLength characters at pcKey under the hash function of
+oSymTable. */
+static size_t SymTable_hashKey(SymTable_T oSymTable, const char *pcKey, size_t uLength) {
+    if(oSymTable->ops.pfHash != NULL) return oSymTable->ops.pfHash(pcKey, uLength);
+    return SymTable_hash(pcKey, uLength);
+}
+
+/* Return 1 if the uLength characters at pcKey1 and at pcKey2 are the same key to oSymTable
+and 0 otherwise, comparing them with the pfEquals of oSymTable or, if it is NULL, with
+memcmp. */
+static int SymTable_equals(SymTable_T oSymTable, const char *pcKey1, const char *pcKey2,
+size_t uLength) {
+    if(oSymTable->ops.pfEquals != NULL) return oSymTable->ops.pfEquals(pcKey1, pcKey2, uLength);
+    return memcmp(pcKey1, pcKey2, uLength) == 0;
+}
+
+/* Return 1 if psEntry of oSymTable holds the uLength characters at pcKey and 0 otherwise.
+Removed Entries have a length no key has and are rejected with the keys of other lengths. */
+static int SymTable_matches(SymTable_T oSymTable, const struct Entry *psEntry,
+const char *pcKey, size_t uLength) {
+    if(psEntry->length != uLength) return 0;
+    return SymTable_equals(oSymTable, oSymTable->pool + psEntry->offset, pcKey, uLength);
+}
+
+/* Release value, which oSymTable no longer binds, with the value-free function of
+oSymTable if it has one. */
+static void SymTable_release(SymTable_T oSymTable, void *value) {
+    if(oSymTable->ops.pfFreeValue != NULL) oSymTable->ops.pfFreeValue(value);
+}
+
+/* Return the Eytzinger index of the first binding in sorted order of an array of uCount
+bindings, or 0 if uCount is 0. */
+static size_t SymTable_first(size_t uCount) {
+    size_t k;
+    if(uCount == 0) return 0;
+    for(k = 1; 2 * k <= uCount; k *= 2);
+    return k;
+}
+
+/* Return the Eytzinger index of the binding that follows index k in sorted order in an array
+of uCount bindings, or 0 if k is the last one. */
+static size_t SymTable_next(size_t k, size_t uCount) {
+    if(2 * k + 1 <= uCount) {
+        for(k = 2 * k + 1; 2 * k <= uCount; k *= 2);
+        return k;
+    }
+    /* climb past the right turns, then past the left turn that had k below it */
+    while(k & 1) k >>= 1;
+    return k >> 1;
+}
+
+/* Return the Eytzinger index of the sorted binding of oSymTable that holds the uLength
+characters at pcKey, whose hash code is hash, or 0 if there is none. The descent has no
+branch that depends on the hash codes it compares, so it costs no mispredictions, and each
+step prefetches the two cache lines of hash codes four levels further down, which lets the
+memory fetch several levels at once. */
+static size_t SymTable_search(SymTable_T oSymTable, const char *pcKey, size_t uLength,
+size_t hash) {
+    const size_t *hashes = oSymTable->hashes;
+    size_t uCount = oSymTable->sorted;
+    size_t k = 1;
+    while(k <= uCount) {
+#ifdef __GNUC__
+        __builtin_prefetch(hashes + (k << PREFETCH_LEVELS));
+        __builtin_prefetch(hashes + (k << PREFETCH_LEVELS) + CODES_PER_LINE);
+#endif
+        k = 2 * k + (hashes[k] < hash);
+    }
+    /* k went right after its last left turn at the first hash code not below hash; undo
+       the right turns and that left turn to reach it, or 0 if every code is below hash */
+#ifdef __GNUC__
+    k >>= __builtin_ctzll(~(unsigned long long)k) + 1;
+#else
+    while(k & 1) k >>= 1;
+    k >>= 1;
+#endif
+    /* bindings whose hash codes are equal follow each other in sorted order */
+    for(; k != 0 && hashes[k] == hash; k = SymTable_next(k, uCount))
+        if(SymTable_matches(oSymTable, &oSymTable->entries[k], pcKey, uLength)) return k;
+    return 0;
+}
+
+/* Return the bit of the delta filter of oSymTable that hash selects from its low half if
+iHigh is 0, or from its high half if iHigh is 1. */
+static size_t SymTable_filterBit(SymTable_T oSymTable, size_t hash, int iHigh) {
+    if(iHigh) hash >>= sizeof(size_t) * CHAR_BIT / 2;
+    return hash & (oSymTable->deltaSize * FILTER_BITS - 1);
+}
+
+/* Set the two bits of hash in the delta filter of oSymTable. */
+static void SymTable_markDelta(SymTable_T oSymTable, size_t hash) {
+    size_t uBit1 = SymTable_filterBit(oSymTable, hash, 0);
+    size_t uBit2 = SymTable_filterBit(oSymTable, hash, 1);
+    oSymTable->deltaFilter[uBit1 / WORD_BITS] |= (uint64_t)1 << (uBit1 % WORD_BITS);
+    oSymTable->deltaFilter[uBit2 / WORD_BITS] |= (uint64_t)1 << (uBit2 % WORD_BITS);
+}
+
+/* Return 1 if both bits of hash are set in the delta filter of oSymTable, so that the delta
+buffer may hold a key with that hash code, and 0 if it holds none. Bits are cleared only when
+the delta buffer is emptied, so they may also be left by bindings removed from it. */
+static int SymTable_mayHold(SymTable_T oSymTable, size_t hash) {
+    size_t uBit1 = SymTable_filterBit(oSymTable, hash, 0);
+    size_t uBit2 = SymTable_filterBit(oSymTable, hash, 1);
+    return (oSymTable->deltaFilter[uBit1 / WORD_BITS] >> (uBit1 % WORD_BITS) &
+        oSymTable->deltaFilter[uBit2 / WORD_BITS] >> (uBit2 % WORD_BITS) & 1) != 0;
+}
+
+/* Return 1 more than the index in the delta buffer of oSymTable of the binding that holds the
+uLength characters at pcKey, whose hash code is hash, or 0 if there is none. */
+static size_t SymTable_scan(SymTable_T oSymTable, const char *pcKey, size_t uLength,
+size_t hash) {
+    size_t u;
+    if(oSymTable->deltaCount == 0 || ! SymTable_mayHold(oSymTable, hash)) return 0;
+    for(u = 0; u < oSymTable->deltaCount; u++)
+        if(oSymTable->deltaHashes[u] == hash &&
+            SymTable_matches(oSymTable, &oSymTable->delta[u], pcKey, uLength)) return u + 1;
+    return 0;
+}
+
+/* Return the Entry of oSymTable that holds the uLength characters at pcKey, or NULL if
+there is none. */
+static struct Entry *SymTable_find(SymTable_T oSymTable, const char *pcKey, size_t uLength) {
+    size_t hash = SymTable_hashKey(oSymTable, pcKey, uLength);
+    size_t k = SymTable_search(oSymTable, pcKey, uLength, hash);
+    if(k != 0) return &oSymTable->entries[k];
+    k = SymTable_scan(oSymTable, pcKey, uLength, hash);
+    if(k != 0) return &oSymTable->delta[k - 1];
+    return NULL;
+}
+
+/* Return a negative number, 0 or a positive number as the Item pv1 points to sorts before,
+with or after the one pv2 points to: by hash code, then by length. */
+static int SymTable_compareItems(const void *pv1, const void *pv2) {
+    const struct Item *psItem1 = (const struct Item*)pv1;
+    const struct Item *psItem2 = (const struct Item*)pv2;
+    if(psItem1->hash != psItem2->hash) return psItem1->hash < psItem2->hash ? -1 : 1;
+    if(psItem1->entry.length != psItem2->entry.length)
+        return psItem1->entry.length < psItem2->entry.length ? -1 : 1;
+    return 0;
+}
+
+/* Free the arrays of oSymTable and leave it with no bindings. */
+static void SymTable_freeArrays(SymTable_T oSymTable) {
+    free(oSymTable->hashes);
+    free(oSymTable->entries);
+    free(oSymTable->deltaHashes);
+    free(oSymTable->delta);
+    free(oSymTable->deltaFilter);
+    free(oSymTable->pool);
+    oSymTable->hashes = NULL;
+    oSymTable->entries = NULL;
+    oSymTable->deltaHashes = NULL;
+    oSymTable->delta = NULL;
+    oSymTable->deltaFilter = NULL;
+    oSymTable->pool = NULL;
+    oSymTable->sorted = 0;
+    oSymTable->removed = 0;
+    oSymTable->deltaCount = 0;
+    oSymTable->deltaMax = DELTA_MIN;
+    oSymTable->deltaSize = 0;
+    oSymTable->poolUsed = 0;
+    oSymTable->poolSize = 0;
+    oSymTable->keyBytes = 0;
+    oSymTable->length = 0;
+}
+
+/* Free the delta buffer of oSymTable, which must hold no bindings, and its filter. */
+static void SymTable_freeDelta(SymTable_T oSymTable) {
+    assert(oSymTable->deltaCount == 0);
+    free(oSymTable->deltaHashes);
+    free(oSymTable->delta);
+    free(oSymTable->deltaFilter);
+    oSymTable->deltaHashes = NULL;
+    oSymTable->delta = NULL;
+    oSymTable->deltaFilter = NULL;
+    oSymTable->deltaSize = 0;
+}
+
+/* Make room in the delta buffer of oSymTable for at least uSize bindings, and size its filter
+to match. Return 1 if successful, or 0 if insufficient memory is available. */
+static int SymTable_growDelta(SymTable_T oSymTable, size_t uSize) {
+    size_t *newHashes;
+    struct Entry *newDelta;
+    uint64_t *newFilter;
+    size_t uRoom;
+    size_t u;
+    if(uSize <= oSymTable->deltaSize) return 1;
+    for(uRoom = DELTA_MIN; uRoom < uSize; uRoom *= 2);
+    newFilter = (uint64_t*)calloc(uRoom * FILTER_BITS / WORD_BITS, sizeof(uint64_t));
+    if(newFilter == NULL) return 0;
+    newHashes = (size_t*)realloc(oSymTable->deltaHashes, uRoom * sizeof(size_t));
+    if(newHashes == NULL) {
+        free(newFilter);
+        return 0;
+    }
+    oSymTable->deltaHashes = newHashes;
+    newDelta = (struct Entry*)realloc(oSymTable->delta, uRoom * sizeof(struct Entry));
+    if(newDelta == NULL) {
+        free(newFilter);
+        return 0;
+    }
+    oSymTable->delta = newDelta;
+    free(oSymTable->deltaFilter);
+    oSymTable->deltaFilter = newFilter;
+    oSymTable->deltaSize = uRoom;
+    for(u = 0; u < oSymTable->deltaCount; u++)
+        SymTable_markDelta(oSymTable, oSymTable->deltaHashes[u]);
+    return 1;
+}
+
+/* Make room in the pool of oSymTable for uBytes more bytes, at least doubling its size. Return
+1 if successful, or 0 if insufficient memory is available. */
+static int SymTable_growPool(SymTable_T oSymTable, size_t uBytes) {
+    char *newPool;
+    size_t uSize;
+    if(oSymTable->poolSize - oSymTable->poolUsed >= uBytes) return 1;
+    uSize = oSymTable->poolSize < POOL_MIN ? POOL_MIN : oSymTable->poolSize * 2;
+    while(uSize - oSymTable->poolUsed < uBytes) uSize *= 2;
+    newPool = (char*)realloc(oSymTable->pool, uSize);
+    if(newPool == NULL) return 0;
+    oSymTable->pool = newPool;
+    oSymTable->poolSize = uSize;
+    return 1;
+}
+
+/* Add to the delta buffer of oSymTable, which must have room for it and its key, a binding of
+the uLength characters at pcKey, whose hash code is hash, to pvValue. */
+static void SymTable_append(SymTable_T oSymTable, size_t hash, const char *pcKey,
+size_t uLength, const void *pvValue) {
+    struct Entry *psEntry = &oSymTable->delta[oSymTable->deltaCount];
+    assert(oSymTable->deltaCount < oSymTable->deltaSize);
+    assert(oSymTable->poolSize - oSymTable->poolUsed > uLength);
+    psEntry->offset = oSymTable->poolUsed;
+    psEntry->length = uLength;
+    psEntry->value = (void*)pvValue;
+    memcpy(oSymTable->pool + oSymTable->poolUsed, pcKey, uLength);
+    oSymTable->pool[oSymTable->poolUsed + uLength] = '\0';
+    oSymTable->poolUsed += uLength + 1;
+    oSymTable->keyBytes += uLength + 1;
+    oSymTable->deltaHashes[oSymTable->deltaCount++] = hash;
+    SymTable_markDelta(oSymTable, hash);
+    oSymTable->length++;
+}
+
+/* Rebuild the sorted array of oSymTable from the bindings it has not removed and the bindings
+of its delta buffer. The old array and the sorted delta buffer are merged in one pass down
+both in sorted order, so a rebuild takes time proportional to the number of bindings. The keys
+stay where they are in the pool unless iForce is 1 or the keys of removed bindings fill most
+of it, in which case they are copied, in the order of the new array, into a new pool that has
+room for no others. Return 1 if successful, or 0 if insufficient memory is available, in which
+case oSymTable is unchanged. */
+static int SymTable_rebuild(SymTable_T oSymTable, int iForce) {
+    struct Item *psItems;
+    size_t *newHashes;
+    struct Entry *newEntries;
+    char *newPool = NULL;
+    struct Entry *psEntry;
+    size_t uItems = oSymTable->deltaCount;
+    size_t uCount = oSymTable->length;
+    int iCompact = iForce || oSymTable->poolUsed - oSymTable->keyBytes > oSymTable->keyBytes;
+    size_t uPoolUsed = 0;
+    size_t i = 0;
+    size_t j;
+    size_t k;
+    size_t u;
+
+    if(uCount == 0) {
+        SymTable_freeArrays(oSymTable);
+        return 1;
+    }
+    psItems = (struct Item*)malloc((uItems == 0 ? 1 : uItems) * sizeof(struct Item));
+    newHashes = (size_t*)malloc((uCount + 1) * sizeof(size_t));
+    newEntries = (struct Entry*)malloc((uCount + 1) * sizeof(struct Entry));
+    if(iCompact) newPool = (char*)malloc(oSymTable->keyBytes);
+    if(psItems == NULL || newHashes == NULL || newEntries == NULL ||
+        (iCompact && newPool == NULL)) {
+        free(psItems);
+        free(newHashes);
+        free(newEntries);
+        free(newPool);
+        return 0;
+    }
+    for(u = 0; u < uItems; u++) {
+        psItems[u].hash = oSymTable->deltaHashes[u];
+        psItems[u].entry = oSymTable->delta[u];
+        psItems[u].origin = 0;
+    }
+    qsort(psItems, uItems, sizeof(struct Item), SymTable_compareItems);
+
+    /* k walks the old array and j the new one, both in sorted order */
+    k = SymTable_first(oSymTable->sorted);
+    for(j = SymTable_first(uCount); j != 0; j = SymTable_next(j, uCount)) {
+        while(k != 0 && oSymTable->entries[k].length == REMOVED)
+            k = SymTable_next(k, oSymTable->sorted);
+        if(k != 0 && (i == uItems || oSymTable->hashes[k] < psItems[i].hash ||
+            (oSymTable->hashes[k] == psItems[i].hash &&
+            oSymTable->entries[k].length <= psItems[i].entry.length))) {
+            newHashes[j] = oSymTable->hashes[k];
+            newEntries[j] = oSymTable->entries[k];
+            k = SymTable_next(k, oSymTable->sorted);
+        }
+        else {
+            assert(i < uItems);
+            newHashes[j] = psItems[i].hash;
+            newEntries[j] = psItems[i].entry;
+            i++;
+        }
+    }
+    free(psItems);
+    /* the keys are laid out in the order lookups descend the array and SymTable_map visits it */
+    for(j = 1; iCompact && j <= uCount; j++) {
+        psEntry = &newEntries[j];
+        memcpy(newPool + uPoolUsed, oSymTable->pool + psEntry->offset, psEntry->length + 1);
+        psEntry->offset = uPoolUsed;
+        uPoolUsed += psEntry->length + 1;
+    }
+
+    free(oSymTable->hashes);
+    free(oSymTable->entries);
+    oSymTable->hashes = newHashes;
+    oSymTable->entries = newEntries;
+    oSymTable->sorted = uCount;
+    oSymTable->removed = 0;
+    oSymTable->deltaCount = 0;
+    if(iCompact) {
+        assert(uPoolUsed == oSymTable->keyBytes);
+        free(oSymTable->pool);
+        oSymTable->pool = newPool;
+        oSymTable->poolUsed = uPoolUsed;
+        oSymTable->poolSize = uPoolUsed;
+    }
+
+    /* A delta buffer of a few times the square root of the length balances the scans of the
+       delta buffer that the filter lets through against the merges that rebuild the whole
+       array. */
+    for(oSymTable->deltaMax = DELTA_MIN;
+        oSymTable->deltaMax * oSymTable->deltaMax < DELTA_SCALE * uCount;
+        oSymTable->deltaMax *= 2);
+    if(oSymTable->deltaSize != oSymTable->deltaMax) SymTable_freeDelta(oSymTable);
+    else memset(oSymTable->deltaFilter, 0, oSymTable->deltaSize * FILTER_BITS / CHAR_BIT);
+    return 1;
+}
+
+/* Rebuild the sorted array of oSymTable if it has no bindings left or if removed bindings fill
+half of it, so that the memory of removed bindings is given back. A SymTable that cannot be
+rebuilt for lack of memory keeps its removed bindings until a later rebuild. */
+static void SymTable_shrink(SymTable_T oSymTable) {
+    if(oSymTable->length == 0 || oSymTable->removed * 2 > oSymTable->sorted)
+        (void)SymTable_rebuild(oSymTable, 0);
+}
+
+/* Return the Entry at position k of oSymTable, counting the sorted array from 1 and then the
+delta buffer. */
+static struct Entry *SymTable_entryAt(SymTable_T oSymTable, size_t k) {
+    assert(k >= 1 && k <= oSymTable->sorted + oSymTable->deltaCount);
+    if(k <= oSymTable->sorted) return &oSymTable->entries[k];
+    return &oSymTable->delta[k - oSymTable->sorted - 1];
+}
+
+/* Drop from the delta buffer of oSymTable the bindings marked REMOVED, keeping the order of
+the others. */
+static void SymTable_packDelta(SymTable_T oSymTable) {
+    size_t u;
+    size_t uKept = 0;
+    for(u = 0; u < oSymTable->deltaCount; u++) {
+        if(oSymTable->delta[u].length == REMOVED) continue;
+        oSymTable->deltaHashes[uKept] = oSymTable->deltaHashes[u];
+        oSymTable->delta[uKept] = oSymTable->delta[u];
+        uKept++;
+    }
+    oSymTable->deltaCount = uKept;
+}
+
+/* Mark psEntry of oSymTable REMOVED, in the sorted array if iSorted is 1 and in the delta
+buffer otherwise, and count it as removed; its value is left to the caller. It is dropped
+from the delta buffer by SymTable_packDelta and from the sorted array by a rebuild. */
+static void SymTable_markRemoved(SymTable_T oSymTable, struct Entry *psEntry, int iSorted) {
+    oSymTable->keyBytes -= psEntry->length + 1;
+    psEntry->length = REMOVED;
+    if(iSorted) oSymTable->removed++;
+    oSymTable->length--;
+}
+
+/* Remove from oSymTable each binding whose key oOther binds if iFound is 1, or does not bind
+if iFound is 0, calling pfRemoved with it unless pfRemoved is NULL. Return the number of
+bindings removed. */
+static size_t SymTable_filter(SymTable_T oSymTable, SymTable_T oOther, int iFound,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    struct Entry *psEntry;
+    size_t uRemoved = 0;
+    size_t k;
+    for(k = 1; k <= oSymTable->sorted + oSymTable->deltaCount; k++) {
+        psEntry = SymTable_entryAt(oSymTable, k);
+        if(psEntry->length == REMOVED) continue;
+        if(SymTable_containsN(oOther, oSymTable->pool + psEntry->offset, psEntry->length) !=
+            iFound) continue;
+        if(pfRemoved != NULL)
+            pfRemoved(oSymTable->pool + psEntry->offset, psEntry->value, (void*)pvExtra);
+        SymTable_release(oSymTable, psEntry->value);
+        SymTable_markRemoved(oSymTable, psEntry, k <= oSymTable->sorted);
+        uRemoved++;
+    }
+    SymTable_packDelta(oSymTable);
+    SymTable_shrink(oSymTable);
+    return uRemoved;
+}
+
+SymTable_T SymTable_new(void) {
+    SymTable_T out = (SymTable_T)malloc(sizeof(struct SymTable));
+    if(out == NULL) return NULL;
+    out->hashes = NULL;
+    out->entries = NULL;
+    out->deltaHashes = NULL;
+    out->delta = NULL;
+    out->deltaFilter = NULL;
+    out->pool = NULL;
+    SymTable_freeArrays(out);
+    out->ops.pfFreeValue = NULL;
+    out->ops.pfHash = NULL;
+    out->ops.pfEquals = NULL;
+    return out;
+}
+
+SymTable_T SymTable_newWithOps(const struct SymTableOps *psOps) {
+    SymTable_T out;
+    assert(psOps != NULL);
+    out = SymTable_new();
+    if(out == NULL) return NULL;
+    out->ops = *psOps;
+    return out;
+}
+
+void SymTable_free(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    SymTable_clear(oSymTable);
+    SymTable_freeArrays(oSymTable);
+    free(oSymTable);
+}
+
+void SymTable_clear(SymTable_T oSymTable) {
+    size_t k;
+    assert(oSymTable != NULL);
+    if(oSymTable->ops.pfFreeValue != NULL) {
+        for(k = 1; k <= oSymTable->sorted; k++)
+            if(oSymTable->entries[k].length != REMOVED)
+                SymTable_release(oSymTable, oSymTable->entries[k].value);
+        for(k = 0; k < oSymTable->deltaCount; k++)
+            SymTable_release(oSymTable, oSymTable->delta[k].value);
+    }
+    /* the delta buffer and the pool are kept for the bindings put next, but the sorted array
+       is built anew by the next merge */
+    free(oSymTable->hashes);
+    free(oSymTable->entries);
+    oSymTable->hashes = NULL;
+    oSymTable->entries = NULL;
+    oSymTable->sorted = 0;
+    oSymTable->removed = 0;
+    oSymTable->deltaCount = 0;
+    if(oSymTable->deltaFilter != NULL)
+        memset(oSymTable->deltaFilter, 0, oSymTable->deltaSize * FILTER_BITS / CHAR_BIT);
+    oSymTable->poolUsed = 0;
+    oSymTable->keyBytes = 0;
+    oSymTable->length = 0;
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return oSymTable->length;
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    assert(pcKey != NULL);
+    return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey, size_t uLen, const void *pvValue) {
+    size_t hash;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    hash = SymTable_hashKey(oSymTable, pcKey, uLen);
+    if(SymTable_search(oSymTable, pcKey, uLen, hash) != 0 ||
+        SymTable_scan(oSymTable, pcKey, uLen, hash) != 0) return 0;
+    if(oSymTable->deltaCount >= oSymTable->deltaMax && ! SymTable_rebuild(oSymTable, 0)) return 0;
+    if(! SymTable_growDelta(oSymTable, oSymTable->deltaMax) ||
+        ! SymTable_growPool(oSymTable, uLen + 1)) return 0;
+    SymTable_append(oSymTable, hash, pcKey, uLen, pvValue);
+    return 1;
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    struct Entry *psEntry;
+    void *oldValue;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    psEntry = SymTable_find(oSymTable, pcKey, strlen(pcKey));
+    if(psEntry == NULL) return NULL;
+    oldValue = psEntry->value;
+    psEntry->value = (void*)pvValue;
+    SymTable_release(oSymTable, oldValue);
+    return oldValue;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_find(oSymTable, pcKey, uLen) != NULL;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
+    struct Entry *psEntry;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    psEntry = SymTable_find(oSymTable, pcKey, uLen);
+    return psEntry == NULL ? NULL : psEntry->value;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
+    void *output;
+    size_t hash;
+    size_t k;
+    size_t uLast;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    hash = SymTable_hashKey(oSymTable, pcKey, uLen);
+    k = SymTable_search(oSymTable, pcKey, uLen, hash);
+    if(k != 0) {
+        output = oSymTable->entries[k].value;
+        SymTable_markRemoved(oSymTable, &oSymTable->entries[k], 1);
+    }
+    else {
+        k = SymTable_scan(oSymTable, pcKey, uLen, hash);
+        if(k == 0) return NULL;
+        output = oSymTable->delta[k - 1].value;
+        SymTable_markRemoved(oSymTable, &oSymTable->delta[k - 1], 0);
+        /* the delta buffer is unsorted, so its last binding fills the gap */
+        uLast = --oSymTable->deltaCount;
+        oSymTable->deltaHashes[k - 1] = oSymTable->deltaHashes[uLast];
+        oSymTable->delta[k - 1] = oSymTable->delta[uLast];
+    }
+    SymTable_release(oSymTable, output);
+    SymTable_shrink(oSymTable);
+    return output;
+}
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+const void *pvExtra) {
+    size_t k;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    for(k = 1; k <= oSymTable->sorted; k++)
+        if(oSymTable->entries[k].length != REMOVED)
+            pfApply(oSymTable->pool + oSymTable->entries[k].offset, oSymTable->entries[k].value,
+                (void*)pvExtra);
+    for(k = 0; k < oSymTable->deltaCount; k++)
+        pfApply(oSymTable->pool + oSymTable->delta[k].offset, oSymTable->delta[k].value,
+            (void*)pvExtra);
+}
+
+size_t SymTable_memoryUsage(SymTable_T oSymTable, struct SymTableMemory *psUsage) {
+    struct SymTableMemory sUsage;
+    assert(oSymTable != NULL);
+
+    sUsage.buckets = 0;
+    sUsage.nodes = 0;
+    if(oSymTable->hashes != NULL) {
+        sUsage.buckets += (oSymTable->sorted + 1) * sizeof(size_t);
+        sUsage.nodes += (oSymTable->sorted + 1) * sizeof(struct Entry);
+    }
+    sUsage.buckets += oSymTable->deltaSize * sizeof(size_t);
+    sUsage.nodes += oSymTable->deltaSize * sizeof(struct Entry);
+    sUsage.keys = oSymTable->poolSize;
+    sUsage.overhead = sizeof(struct SymTable) + oSymTable->deltaSize * FILTER_BITS / CHAR_BIT;
+    if(psUsage != NULL) *psUsage = sUsage;
+    return sUsage.buckets + sUsage.nodes + sUsage.keys + sUsage.overhead;
+}
+
+int SymTable_merge(SymTable_T oSymTable, SymTable_T oSource) {
+    struct Item *psItems;
+    struct Entry *psEntry;
+    const char *pcKey;
+    size_t hash;
+    size_t uItems = 0;
+    size_t uKept = 0;
+    size_t uBytes = 0;
+    size_t uDeltaCount;
+    size_t uPoolUsed;
+    size_t uKeyBytes;
+    size_t uLength;
+    size_t u;
+    size_t v;
+    size_t k;
+    int iSameHash;
+    int iDuplicate;
+    assert(oSymTable != NULL);
+    assert(oSource != NULL);
+    assert(oSymTable != oSource);
+    if(oSource->length == 0) return 1;
+
+    psItems = (struct Item*)malloc(oSource->length * sizeof(struct Item));
+    if(psItems == NULL) return 0;
+    iSameHash = oSymTable->ops.pfHash == oSource->ops.pfHash;
+    for(k = 1; k <= oSource->sorted + oSource->deltaCount; k++) {
+        psEntry = SymTable_entryAt(oSource, k);
+        if(psEntry->length == REMOVED) continue;
+        pcKey = oSource->pool + psEntry->offset;
+        /* a table that hashes keys as oSource does takes the hash codes oSource keeps */
+        if(! iSameHash) hash = SymTable_hashKey(oSymTable, pcKey, psEntry->length);
+        else if(k <= oSource->sorted) hash = oSource->hashes[k];
+        else hash = oSource->deltaHashes[k - oSource->sorted - 1];
+        if(SymTable_search(oSymTable, pcKey, psEntry->length, hash) != 0 ||
+            SymTable_scan(oSymTable, pcKey, psEntry->length, hash) != 0) continue;
+        psItems[uItems].hash = hash;
+        psItems[uItems].entry = *psEntry;
+        psItems[uItems].origin = k;
+        uItems++;
+    }
+
+    /* Keys that oSource holds apart may be the same key to oSymTable; they sort together,
+       and all but the first stay in oSource. */
+    qsort(psItems, uItems, sizeof(struct Item), SymTable_compareItems);
+    for(u = 0; u < uItems; u++) {
+        iDuplicate = 0;
+        uLength = psItems[u].entry.length;
+        for(v = uKept; v > 0 && SymTable_compareItems(&psItems[v - 1], &psItems[u]) == 0; v--)
+            if(SymTable_equals(oSymTable, oSource->pool + psItems[v - 1].entry.offset,
+                oSource->pool + psItems[u].entry.offset, uLength)) iDuplicate = 1;
+        if(iDuplicate) continue;
+        psItems[uKept++] = psItems[u];
+        uBytes += uLength + 1;
+    }
+
+    /* The bindings join the delta buffer, which is merged into the sorted array at once; if
+       that fails they leave it again. */
+    uDeltaCount = oSymTable->deltaCount;
+    uPoolUsed = oSymTable->poolUsed;
+    uKeyBytes = oSymTable->keyBytes;
+    if(! SymTable_growDelta(oSymTable, uDeltaCount + uKept) ||
+        ! SymTable_growPool(oSymTable, uBytes)) {
+        free(psItems);
+        return 0;
+    }
+    for(u = 0; u < uKept; u++)
+        SymTable_append(oSymTable, psItems[u].hash, oSource->pool + psItems[u].entry.offset,
+            psItems[u].entry.length, psItems[u].entry.value);
+    if(! SymTable_rebuild(oSymTable, 0)) {
+        oSymTable->deltaCount = uDeltaCount;
+        oSymTable->poolUsed = uPoolUsed;
+        oSymTable->keyBytes = uKeyBytes;
+        oSymTable->length -= uKept;
+        free(psItems);
+        return 0;
+    }
+
+    for(u = 0; u < uKept; u++) {
+        k = psItems[u].origin;
+        SymTable_markRemoved(oSource, SymTable_entryAt(oSource, k), k <= oSource->sorted);
+    }
+    free(psItems);
+    SymTable_packDelta(oSource);
+    SymTable_shrink(oSource);
+    return 1;
+}
+
+size_t SymTable_intersect(SymTable_T oSymTable, SymTable_T oOther,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    assert(oSymTable != NULL);
+    assert(oOther != NULL);
+    assert(oSymTable != oOther);
+    return SymTable_filter(oSymTable, oOther, 0, pfRemoved, pvExtra);
+}
+
+size_t SymTable_diff(SymTable_T oSymTable, SymTable_T oOther,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    assert(oSymTable != NULL);
+    assert(oOther != NULL);
+    assert(oSymTable != oOther);
+    return SymTable_filter(oSymTable, oOther, 1, pfRemoved, pvExtra);
+}
+
+size_t SymTable_removeIf(SymTable_T oSymTable,
+int (*pfPredicate)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    struct Entry *psEntry;
+    size_t uRemoved = 0;
+    size_t k;
+    assert(oSymTable != NULL);
+    assert(pfPredicate != NULL);
+
+    /* the bindings are only marked, and the arrays are packed once at the end */
+    for(k = 1; k <= oSymTable->sorted + oSymTable->deltaCount; k++) {
+        psEntry = SymTable_entryAt(oSymTable, k);
+        if(psEntry->length == REMOVED) continue;
+        if(!pfPredicate(oSymTable->pool + psEntry->offset, psEntry->value, (void*)pvExtra))
+            continue;
+        SymTable_release(oSymTable, psEntry->value);
+        SymTable_markRemoved(oSymTable, psEntry, k <= oSymTable->sorted);
+        uRemoved++;
+    }
+    SymTable_packDelta(oSymTable);
+    SymTable_shrink(oSymTable);
+    return uRemoved;
+}
+
+int SymTable_compact(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    /* the delta buffer is merged in and the keys are copied into a pool of their own */
+    if(! SymTable_rebuild(oSymTable, 1)) return 0;
+#ifdef __GLIBC__
+    /* hand the pages freed by the rebuild back to the system */
+    (void)malloc_trim(0);
+#endif
+    return 1;
+}
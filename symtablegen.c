@@ -0,0 +1,592 @@
+/*--------------------------------------------------------------------*/
+/* symtablegen.c                                                      */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#include "symtablehash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of keys per displacement bucket, on average */
+
+enum {KEYS_PER_BUCKET = 4};
+
+/* The most displacements tried for one bucket before the table is
+   made larger */
+
+enum {MAX_DISPLACEMENT = 1 << 16};
+
+/* The longest name of a generated table, and of a file written */
+
+enum {MAX_NAME_LENGTH = 64};
+enum {MAX_PATH_LENGTH = MAX_NAME_LENGTH + 3};
+
+/* The number of bytes of the key pool written on each line */
+
+enum {POOL_BYTES_PER_LINE = 16};
+
+/*--------------------------------------------------------------------*/
+
+/* The text of the hash functions below, written into each table with
+   GEN_ replaced by its name. The two must stay the same. */
+
+#define HASH_SOURCE \
+"/* Return the 64 bit FNV-1a hash code of the uLen characters at pcKey. */\n" \
+"static uint64_t GEN_hashKey(const char *pcKey, size_t uLen) {\n" \
+"    uint64_t uHash = 0xcbf29ce484222325u;\n" \
+"    size_t u;\n" \
+"    for(u = 0; u < uLen; u++)\n" \
+"        uHash = (uHash ^ (unsigned char)pcKey[u]) * 0x100000001b3u;\n" \
+"    return uHash;\n" \
+"}\n" \
+"\n" \
+"/* Return the hash code uHash mixed with the displacement uDisplacement. */\n" \
+"static uint64_t GEN_mix(uint64_t uHash, uint64_t uDisplacement) {\n" \
+"    uint64_t x = uHash ^ (uDisplacement * 0x9E3779B97F4A7C15u);\n" \
+"    x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdu;\n" \
+"    x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53u;\n" \
+"    return x ^ (x >> 33);\n" \
+"}\n"
+
+/* Return the 64 bit FNV-1a hash code of the uLen characters at
+   pcKey. */
+
+static uint64_t GEN_hashKey(const char *pcKey, size_t uLen)
+{
+   uint64_t uHash = 0xcbf29ce484222325u;
+   size_t u;
+   for (u = 0; u < uLen; u++)
+      uHash = (uHash ^ (unsigned char)pcKey[u]) * 0x100000001b3u;
+   return uHash;
+}
+
+/* Return the hash code uHash mixed with the displacement
+   uDisplacement. */
+
+static uint64_t GEN_mix(uint64_t uHash, uint64_t uDisplacement)
+{
+   uint64_t x = uHash ^ (uDisplacement * 0x9E3779B97F4A7C15u);
+   x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdu;
+   x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53u;
+   return x ^ (x >> 33);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A key of the list, with its value and hash code */
+
+struct Entry
+{
+   /* the key and its value, both '\0' terminated */
+   const char *pcKey;
+   const char *pcValue;
+
+   /* the number of characters in pcKey */
+   size_t uLength;
+
+   /* the hash code of pcKey */
+   uint64_t uHash;
+};
+
+/* The keys of the list, gathered by SymTable_map */
+
+struct EntryList
+{
+   /* the keys */
+   struct Entry *psEntries;
+
+   /* the number of keys */
+   size_t uCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Append pcKey, bound to the string pvValue, to the EntryList
+   pvExtra. */
+
+static void addEntry(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   struct EntryList *psList = (struct EntryList*)pvExtra;
+   struct Entry *psEntry = &psList->psEntries[psList->uCount++];
+   psEntry->pcKey = pcKey;
+   psEntry->pcValue = (const char*)pvValue;
+   psEntry->uLength = strlen(pcKey);
+   psEntry->uHash = GEN_hashKey(pcKey, psEntry->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a negative number, 0 or a positive number as the hash code
+   pv1 points to is less than, equal to or greater than the one pv2
+   points to. */
+
+static int compareHashes(const void *pv1, const void *pv2)
+{
+   uint64_t u1 = *(const uint64_t*)pv1;
+   uint64_t u2 = *(const uint64_t*)pv2;
+   return (u1 > u2) - (u1 < u2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if every key of the uCount keys psEntries has a hash code
+   of its own, and 0 otherwise. Two keys with one hash code cannot be
+   told apart by any displacement. */
+
+static int hashesDiffer(const struct Entry *psEntries, size_t uCount)
+{
+   uint64_t *puHashes;
+   size_t u;
+   int iDiffer = 1;
+
+   puHashes = (uint64_t*)malloc((uCount + 1) * sizeof(uint64_t));
+   if (puHashes == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (u = 0; u < uCount; u++)
+      puHashes[u] = psEntries[u].uHash;
+   qsort(puHashes, uCount, sizeof(uint64_t), compareHashes);
+   for (u = 1; u < uCount; u++)
+      if (puHashes[u - 1] == puHashes[u])
+         iDiffer = 0;
+   free(puHashes);
+   return iDiffer;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Find a perfect hash function for the uCount keys psEntries by hash
+   and displace: each key falls into one of uBuckets buckets, and the
+   buckets, largest first, are each given the smallest displacement
+   that sends their keys to slots of a table of *puSlots slots that no
+   other key holds. The table grows until every bucket gets one. Store
+   the displacements in puDisplacements and, in *pplSlotEntries, the
+   index of the key of each slot or -1. The keys of a bucket are few,
+   so sorting the buckets by size takes a pass per size. */
+
+static void findDisplacements(const struct Entry *psEntries,
+   size_t uCount, size_t uBuckets, size_t *puSlots,
+   uint32_t *puDisplacements, long **pplSlotEntries)
+{
+   size_t *puOrder;
+   size_t *puBucketSizes;
+   size_t *puBucketStarts;
+   size_t *puBucketKeys;
+   long *plSlotEntries = NULL;
+   size_t uBucket;
+   size_t uSlot;
+   size_t uLargest = 0;
+   size_t u;
+   size_t v;
+   size_t w;
+   uint32_t uDisplacement;
+   int iFits = 0;
+
+   puOrder = (size_t*)malloc(uBuckets * sizeof(size_t));
+   puBucketSizes = (size_t*)calloc(uBuckets, sizeof(size_t));
+   puBucketStarts = (size_t*)calloc(uBuckets + 1, sizeof(size_t));
+   puBucketKeys = (size_t*)malloc((uCount + 1) * sizeof(size_t));
+   if (puOrder == NULL || puBucketSizes == NULL ||
+      puBucketStarts == NULL || puBucketKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   /* The keys are grouped by bucket, and the buckets sorted by size
+      with a counting sort, ties broken by index. */
+   for (u = 0; u < uCount; u++)
+      puBucketSizes[GEN_mix(psEntries[u].uHash, 0) % uBuckets]++;
+   for (uBucket = 0; uBucket < uBuckets; uBucket++)
+      puBucketStarts[uBucket + 1] = puBucketStarts[uBucket] +
+         puBucketSizes[uBucket];
+   for (uBucket = 0; uBucket < uBuckets; uBucket++)
+      if (puBucketSizes[uBucket] > uLargest)
+         uLargest = puBucketSizes[uBucket];
+   memset(puBucketSizes, 0, uBuckets * sizeof(size_t));
+   for (u = 0; u < uCount; u++)
+   {
+      uBucket = GEN_mix(psEntries[u].uHash, 0) % uBuckets;
+      puBucketKeys[puBucketStarts[uBucket] + puBucketSizes[uBucket]++] =
+         u;
+   }
+   w = 0;
+   for (v = uLargest + 1; v-- > 0; )
+      for (uBucket = 0; uBucket < uBuckets; uBucket++)
+         if (puBucketSizes[uBucket] == v)
+            puOrder[w++] = uBucket;
+
+   while (! iFits)
+   {
+      free(plSlotEntries);
+      plSlotEntries = (long*)malloc(*puSlots * sizeof(long));
+      if (plSlotEntries == NULL)
+      {
+         fprintf(stderr, "Insufficient memory\n");
+         exit(EXIT_FAILURE);
+      }
+      for (uSlot = 0; uSlot < *puSlots; uSlot++)
+         plSlotEntries[uSlot] = -1;
+
+      iFits = 1;
+      for (w = 0; iFits && w < uBuckets; w++)
+      {
+         uBucket = puOrder[w];
+         for (uDisplacement = 1; uDisplacement <= MAX_DISPLACEMENT;
+            uDisplacement++)
+         {
+            /* Place the keys of the bucket, and take them out again
+               if one of them lands on a slot already taken. */
+            for (u = puBucketStarts[uBucket];
+               u < puBucketStarts[uBucket + 1]; u++)
+            {
+               uSlot = GEN_mix(psEntries[puBucketKeys[u]].uHash,
+                  uDisplacement) % *puSlots;
+               if (plSlotEntries[uSlot] >= 0)
+                  break;
+               plSlotEntries[uSlot] = (long)puBucketKeys[u];
+            }
+            if (u == puBucketStarts[uBucket + 1])
+               break;
+            for (v = puBucketStarts[uBucket]; v < u; v++)
+               plSlotEntries[GEN_mix(psEntries[puBucketKeys[v]].uHash,
+                  uDisplacement) % *puSlots] = -1;
+         }
+         if (uDisplacement > MAX_DISPLACEMENT)
+            iFits = 0;
+         puDisplacements[uBucket] = uDisplacement;
+      }
+      if (! iFits)
+         *puSlots += *puSlots / 8 + 1;
+   }
+
+   free(puOrder);
+   free(puBucketSizes);
+   free(puBucketStarts);
+   free(puBucketKeys);
+   *pplSlotEntries = plSlotEntries;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the uLength bytes at pc to psFile as the elements of an
+   unsigned char array initializer, continuing a line of which *puColumn bytes have
+   been written. */
+
+static void writeBytes(FILE *psFile, const char *pc, size_t uLength,
+   size_t *puColumn)
+{
+   size_t u;
+   for (u = 0; u < uLength; u++)
+   {
+      if (*puColumn == 0)
+         fprintf(psFile, "   ");
+      fprintf(psFile, " %u,", (unsigned)(unsigned char)pc[u]);
+      if (++*puColumn == POOL_BYTES_PER_LINE)
+      {
+         fprintf(psFile, "\n");
+         *puColumn = 0;
+      }
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the header pcName.h that declares the lookup functions of the
+   table pcName, made from the key list pcList. Exit with EXIT_FAILURE
+   if it cannot be written. */
+
+static void writeHeader(const char *pcName, const char *pcList)
+{
+   char acPath[MAX_PATH_LENGTH];
+   char acGuard[MAX_NAME_LENGTH];
+   FILE *psFile;
+   size_t u;
+
+   for (u = 0; pcName[u] != '\0'; u++)
+      acGuard[u] = (char)toupper((unsigned char)pcName[u]);
+   acGuard[u] = '\0';
+   sprintf(acPath, "%s.h", pcName);
+   psFile = fopen(acPath, "w");
+   if (psFile == NULL)
+   {
+      fprintf(stderr, "Cannot write %s\n", acPath);
+      exit(EXIT_FAILURE);
+   }
+   fprintf(psFile,
+      "/* %s.h was written by symtablegen from %s. Do not edit it. */\n"
+      "\n"
+      "#ifndef %s_INCLUDED\n"
+      "#define %s_INCLUDED\n"
+      "#include <stddef.h>\n"
+      "\n"
+      "/* Returns the value bound to the uLen characters at pcKey, or"
+      " NULL if they are not\none of the keys. Takes one hash and at most"
+      " one key comparison. */\n"
+      "const char *%s_getN(const char *pcKey, size_t uLen);\n"
+      "\n"
+      "/* Returns the value bound to the string pcKey, or NULL if pcKey"
+      " is not a key. */\n"
+      "const char *%s_get(const char *pcKey);\n"
+      "\n"
+      "/* Returns 1 if the string pcKey is a key and 0 otherwise. */\n"
+      "int %s_contains(const char *pcKey);\n"
+      "\n"
+      "/* Returns the number of keys. */\n"
+      "size_t %s_getLength(void);\n"
+      "\n"
+      "#endif\n",
+      pcName, pcList, acGuard, acGuard, pcName, pcName, pcName, pcName);
+   if (fclose(psFile) != 0)
+   {
+      fprintf(stderr, "Cannot write %s\n", acPath);
+      exit(EXIT_FAILURE);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write pcName.c, which defines the table of the uCount keys
+   psEntries in uSlots slots with the uBuckets displacements
+   puDisplacements, the key of each slot given by plSlotEntries, and
+   its lookup functions. Exit with EXIT_FAILURE if it cannot be
+   written. */
+
+static void writeSource(const char *pcName, const char *pcList,
+   const struct Entry *psEntries, size_t uCount, size_t uBuckets,
+   const uint32_t *puDisplacements, size_t uSlots,
+   const long *plSlotEntries)
+{
+   char acPath[MAX_PATH_LENGTH];
+   FILE *psFile;
+   size_t *puOffsets;
+   size_t uOffset = 0;
+   size_t uColumn = 0;
+   size_t u;
+   const char *pc;
+
+   puOffsets = (size_t*)malloc((uCount + 1) * sizeof(size_t));
+   if (puOffsets == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   /* The slots hold offsets into the pool as uint32_t. */
+   for (u = 0; u < uCount; u++)
+      uOffset += psEntries[u].uLength + strlen(psEntries[u].pcValue) + 2;
+   if (uOffset >= UINT32_MAX)
+   {
+      fprintf(stderr, "The keys and values of %s take more than %lu "
+         "bytes\n", pcList, (unsigned long)UINT32_MAX - 1);
+      exit(EXIT_FAILURE);
+   }
+   uOffset = 0;
+
+   sprintf(acPath, "%s.c", pcName);
+   psFile = fopen(acPath, "w");
+   if (psFile == NULL)
+   {
+      fprintf(stderr, "Cannot write %s\n", acPath);
+      exit(EXIT_FAILURE);
+   }
+
+   fprintf(psFile,
+      "/* %s.c was written by symtablegen from %s. Do not edit it. */\n"
+      "\n"
+      "#include <stdint.h>\n"
+      "#include <string.h>\n"
+      "#include \"%s.h\"\n"
+      "\n", pcName, pcList, pcName);
+   for (pc = HASH_SOURCE; *pc != '\0'; pc++)
+   {
+      if (strncmp(pc, "GEN_", 4) == 0)
+      {
+         fprintf(psFile, "%s_", pcName);
+         pc += 3;
+      }
+      else
+         putc(*pc, psFile);
+   }
+
+   /* Every key and value lies in one array of characters, each
+      followed by '\0', so that the table holds no pointers and can
+      be placed in read-only memory as it is. */
+   fprintf(psFile, "\n/* the keys and values, each followed by '\\0' */\n"
+      "static const unsigned char %s_acPool[] = {\n", pcName);
+   for (u = 0; u < uCount; u++)
+   {
+      puOffsets[u] = uOffset;
+      writeBytes(psFile, psEntries[u].pcKey, psEntries[u].uLength + 1,
+         &uColumn);
+      writeBytes(psFile, psEntries[u].pcValue,
+         strlen(psEntries[u].pcValue) + 1, &uColumn);
+      uOffset += psEntries[u].uLength + strlen(psEntries[u].pcValue) + 2;
+   }
+   if (uCount == 0)
+      writeBytes(psFile, "", 1, &uColumn);
+   fprintf(psFile, "%s};\n\n", uColumn == 0 ? "" : "\n");
+
+   fprintf(psFile,
+      "/* the displacement of each bucket of keys */\n"
+      "static const uint32_t %s_auDisplacements[%lu] = {",
+      pcName, (unsigned long)uBuckets);
+   for (u = 0; u < uBuckets; u++)
+      fprintf(psFile, "%s%lu,", u % 8 == 0 ? "\n   " : " ",
+         (unsigned long)puDisplacements[u]);
+   fprintf(psFile, "\n};\n\n");
+
+   fprintf(psFile,
+      "/* struct %s_Slot is a slot of the table: the offsets of its key"
+      " and value in the\npool and the length of its key, or"
+      " 0xFFFFFFFF if the slot is empty. */\n"
+      "struct %s_Slot {\n"
+      "    uint32_t uKey;\n"
+      "    uint32_t uValue;\n"
+      "    uint32_t uLength;\n"
+      "};\n\n"
+      "static const struct %s_Slot %s_asSlots[%lu] = {\n",
+      pcName, pcName, pcName, pcName, (unsigned long)uSlots);
+   for (u = 0; u < uSlots; u++)
+   {
+      if (plSlotEntries[u] < 0)
+         fprintf(psFile, "    {0, 0, 0xFFFFFFFFu},\n");
+      else
+         fprintf(psFile, "    {%lu, %lu, %lu},\n",
+            (unsigned long)puOffsets[plSlotEntries[u]],
+            (unsigned long)(puOffsets[plSlotEntries[u]] +
+            psEntries[plSlotEntries[u]].uLength + 1),
+            (unsigned long)psEntries[plSlotEntries[u]].uLength);
+   }
+   fprintf(psFile, "};\n\n");
+
+   fprintf(psFile,
+      "const char *%s_getN(const char *pcKey, size_t uLen) {\n"
+      "    uint64_t uHash = %s_hashKey(pcKey, uLen);\n"
+      "    uint32_t uDisplacement = %s_auDisplacements[%s_mix(uHash, 0)"
+      " %% %luu];\n"
+      "    const struct %s_Slot *psSlot = &%s_asSlots[%s_mix(uHash,"
+      " uDisplacement) %% %luu];\n"
+      "    if(psSlot->uLength != uLen ||"
+      " memcmp(%s_acPool + psSlot->uKey, pcKey, uLen) != 0)\n"
+      "        return NULL;\n"
+      "    return (const char*)%s_acPool + psSlot->uValue;\n"
+      "}\n\n"
+      "const char *%s_get(const char *pcKey) {\n"
+      "    return %s_getN(pcKey, strlen(pcKey));\n"
+      "}\n\n"
+      "int %s_contains(const char *pcKey) {\n"
+      "    return %s_get(pcKey) != NULL;\n"
+      "}\n\n"
+      "size_t %s_getLength(void) {\n"
+      "    return %lu;\n"
+      "}\n",
+      pcName, pcName, pcName, pcName, (unsigned long)uBuckets, pcName,
+      pcName, pcName, (unsigned long)uSlots, pcName, pcName, pcName,
+      pcName, pcName, pcName, pcName, (unsigned long)uCount);
+
+   free(puOffsets);
+   if (fclose(psFile) != 0)
+   {
+      fprintf(stderr, "Cannot write %s\n", acPath);
+      exit(EXIT_FAILURE);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write a C source file argv[2].c and its header argv[2].h that
+   define a constant perfect hash table of the keys listed in the file
+   argv[1], with functions argv[2]_get, argv[2]_getN and
+   argv[2]_contains that behave as SymTable_get and SymTable_contains
+   do on a SymTable loaded from the list with SymTable_loadFile: each
+   line is a key, followed by a tab and its value, and the first line
+   with a key binds it. argv[2] must be a C identifier. Exit with
+   EXIT_FAILURE if the arguments are invalid or a file cannot be read
+   or written. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   SymTable_T oSymTable;
+   struct EntryList sList;
+   uint32_t *puDisplacements;
+   long *plSlotEntries;
+   size_t uBuckets;
+   size_t uSlots;
+   size_t u;
+
+   if (argc != 3)
+   {
+      fprintf(stderr, "Usage: %s keylist name\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   for (u = 0; argv[2][u] != '\0'; u++)
+      if (! (isalpha((unsigned char)argv[2][u]) || argv[2][u] == '_' ||
+         (u > 0 && isdigit((unsigned char)argv[2][u]))))
+         break;
+   if (u == 0 || argv[2][u] != '\0' || u >= MAX_NAME_LENGTH)
+   {
+      fprintf(stderr, "%s is not a C identifier of at most %d "
+         "characters\n", argv[2], MAX_NAME_LENGTH - 1);
+      exit(EXIT_FAILURE);
+   }
+
+   /* The list is read as SymTable_loadFile reads it, with a fixed seed
+      so that the same list always gives the same table. */
+   oSymTable = SymTable_newWithSeed(0, 0);
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   if (! SymTable_loadFile(oSymTable, argv[1], 1, NULL))
+   {
+      fprintf(stderr, "Cannot read %s\n", argv[1]);
+      exit(EXIT_FAILURE);
+   }
+   sList.uCount = 0;
+   sList.psEntries = (struct Entry*)malloc(
+      (SymTable_getLength(oSymTable) + 1) * sizeof(struct Entry));
+   if (sList.psEntries == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   SymTable_map(oSymTable, addEntry, &sList);
+   if (! hashesDiffer(sList.psEntries, sList.uCount))
+   {
+      fprintf(stderr, "Two keys of %s have the same hash code\n",
+         argv[1]);
+      exit(EXIT_FAILURE);
+   }
+
+   uBuckets = (sList.uCount + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET;
+   if (uBuckets == 0)
+      uBuckets = 1;
+   uSlots = sList.uCount + sList.uCount / 4 + 1;
+   puDisplacements = (uint32_t*)malloc(uBuckets * sizeof(uint32_t));
+   if (puDisplacements == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+   findDisplacements(sList.psEntries, sList.uCount, uBuckets, &uSlots,
+      puDisplacements, &plSlotEntries);
+
+   writeHeader(argv[2], argv[1]);
+   writeSource(argv[2], argv[1], sList.psEntries, sList.uCount,
+      uBuckets, puDisplacements, uSlots, plSlotEntries);
+
+   free(puDisplacements);
+   free(plSlotEntries);
+   free(sList.psEntries);
+   SymTable_free(oSymTable);
+   return 0;
+}
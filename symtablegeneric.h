@@ -0,0 +1,341 @@
+/******************************************************************/
+/* symtablegeneric.h                                              */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#ifndef SYMTABLEGENERIC_INCLUDED
+#define SYMTABLEGENERIC_INCLUDED
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* symtablegeneric.h generates hash tables with the layout of symtablehash.c for any key and
+value types. SYMTABLE_DEFINE_BUCKETS generates the Buckets and the operations on chains of
+them, on which symtablehash.c builds the string keyed SymTable. SYMTABLE_DEFINE_TABLE builds a
+complete table on them whose keys and values are stored inline, so that a table of integer
+keys and struct values needs no key allocation, no boxing and no string hashing. Every
+generated function is static inline: a file can instantiate a template for each pair of
+types it needs, and the functions it does not call cost nothing. */
+
+/* number of bindings stored inline in one Bucket */
+enum {SYMTABLE_BUCKET_SLOTS = 3};
+/* average number of bindings per Bucket at which a table expands */
+enum {SYMTABLE_MAX_LOAD = 2};
+
+/* Returns the number of Buckets that a table with uCount Buckets expands to, or 0 if it
+cannot expand. A new table has SymTable_nextBucketCount(0) Buckets. */
+static inline size_t SymTable_nextBucketCount(size_t uCount) {
+    /* All possible bucket counts a table can have */
+    static const size_t auBucketCounts[] = {509, 1021, 2039, 4093, 8191, 16381, 32749, 65521,
+        131071, 262139, 524287, 1048573, 2097143, 4194301, 8388593, 16777213, 33554393,
+        67108859, 134217689, 268435399, 536870909, 1073741789};
+    size_t i;
+    if(uCount == 0) return auBucketCounts[0];
+    for(i = 0; i + 1 < sizeof(auBucketCounts)/sizeof(auBucketCounts[0]); i++)
+        if(uCount == auBucketCounts[i]) return auBucketCounts[i+1];
+    return 0;
+}
+
+/* Returns the 16 bit tag of a hash code that a Bucket keeps next to each of its keys. The
+tag is taken from the high bits of a multiplicative mix, so it does not follow the bucket
+index, which comes from the remainder of the hash code. */
+static inline uint16_t SymTable_tag(size_t hash) {
+    const uint64_t GOLDEN_RATIO = 0x9E3779B97F4A7C15u;
+    return (uint16_t)(((uint64_t)hash * GOLDEN_RATIO) >> 48);
+}
+
+/* SYMTABLE_DEFINE_BUCKETS(P, K, V, PROBE_T, KEY_HASH, MATCH) defines struct P##Bucket, which
+stores up to SYMTABLE_BUCKET_SLOTS bindings of keys of type K to values of type V inline, and
+these functions on chains of them:
+
+P##_bucketFind(bucket, probe, hash, piSlot) returns the Bucket of the chain starting at bucket
+that holds the key matching probe, of type PROBE_T and with hash code hash, and sets *piSlot
+to its slot, or returns NULL. A stored key k matches when MATCH(k, probe, hash) is nonzero.
+
+P##_bucketAdd(bucket, key, value) adds a binding to the end of a chain and returns 1, or 0 if
+an overflow Bucket was needed and insufficient memory is available.
+
+P##_bucketRemove(head, bucket, iSlot) removes a slot of the chain starting at head by moving
+the last binding of the chain into it.
+
+P##_bucketFreeOverflow(head) frees the overflow Buckets of a chain, but not its keys.
+
+P##_rehashInto(buckets, uCount, newBuckets, newCount) moves the bindings of an array of uCount
+Buckets into an array of newCount empty Buckets that the caller allocated, in time
+proportional to the number of bindings however they fall, and frees the overflow Buckets of
+the old array but not the array. It returns 1, or 0 if insufficient memory is available, in
+which case the old array is left intact and the new one empty.
+
+P##_rehash(buckets, uCount, newCount) moves the bindings of an array of uCount Buckets into a
+new array of newCount Buckets with P##_rehashInto, frees the old one and returns the new one.
+It returns NULL and leaves the old array intact if insufficient memory is available.
+
+KEY_HASH(k) is the hash code of a stored key k. */
+#define SYMTABLE_DEFINE_BUCKETS(P, K, V, PROBE_T, KEY_HASH, MATCH)                            \
+                                                                                              \
+/* struct P##Bucket stores up to SYMTABLE_BUCKET_SLOTS bindings inline, so that a successful  \
+lookup usually reads one cache line of tags, keys and values. A Bucket that is full points   \
+at an overflow Bucket for the bindings that did not fit. In a chain of Buckets every Bucket  \
+but the last is full, and a Bucket's used slots are its first ones. */                        \
+struct P##Bucket {                                                                            \
+    /* the tags of the hash codes of the used slots' keys */                                  \
+    uint16_t tags[SYMTABLE_BUCKET_SLOTS];                                                     \
+    /* number of used slots */                                                                \
+    uint16_t count;                                                                           \
+    /* the keys of the used slots */                                                          \
+    K keys[SYMTABLE_BUCKET_SLOTS];                                                            \
+    /* the values of the used slots */                                                        \
+    V values[SYMTABLE_BUCKET_SLOTS];                                                          \
+    /* Bucket that continues the chain, or NULL */                                            \
+    struct P##Bucket *overflow;                                                               \
+};                                                                                            \
+                                                                                              \
+static inline struct P##Bucket *P##_bucketFind(struct P##Bucket *bucket, PROBE_T probe,       \
+size_t hash, int *piSlot) {                                                                   \
+    uint16_t tag = SymTable_tag(hash);                                                        \
+    int i;                                                                                    \
+    for(; bucket != NULL; bucket = bucket->overflow) {                                        \
+        for(i = 0; i < bucket->count; i++) {                                                  \
+            if(bucket->tags[i] == tag && MATCH(bucket->keys[i], probe, hash)) {               \
+                *piSlot = i;                                                                  \
+                return bucket;                                                                \
+            }                                                                                 \
+        }                                                                                     \
+    }                                                                                         \
+    return NULL;                                                                              \
+}                                                                                             \
+                                                                                              \
+static inline int P##_bucketAdd(struct P##Bucket *bucket, K key, V value) {                   \
+    while(bucket->overflow != NULL) bucket = bucket->overflow;                                \
+    if(bucket->count == SYMTABLE_BUCKET_SLOTS) {                                              \
+        bucket->overflow = (struct P##Bucket*)calloc(1, sizeof(struct P##Bucket));            \
+        if(bucket->overflow == NULL) return 0;                                                \
+        bucket = bucket->overflow;                                                            \
+    }                                                                                         \
+    bucket->tags[bucket->count] = SymTable_tag(KEY_HASH(key));                                \
+    bucket->keys[bucket->count] = key;                                                        \
+    bucket->values[bucket->count] = value;                                                    \
+    bucket->count++;                                                                          \
+    return 1;                                                                                 \
+}                                                                                             \
+                                                                                              \
+static inline void P##_bucketRemove(struct P##Bucket *head, struct P##Bucket *bucket,         \
+int iSlot) {                                                                                  \
+    struct P##Bucket *last = head;                                                            \
+    struct P##Bucket *beforeLast = NULL;                                                      \
+    int iLast;                                                                                \
+    while(last->overflow != NULL) {                                                           \
+        beforeLast = last;                                                                    \
+        last = last->overflow;                                                                \
+    }                                                                                         \
+    iLast = last->count - 1;                                                                  \
+    bucket->tags[iSlot] = last->tags[iLast];                                                  \
+    bucket->keys[iSlot] = last->keys[iLast];                                                  \
+    bucket->values[iSlot] = last->values[iLast];                                              \
+    last->count--;                                                                            \
+    if(last->count == 0 && beforeLast != NULL) {                                              \
+        beforeLast->overflow = NULL;                                                          \
+        free(last);                                                                           \
+    }                                                                                         \
+}                                                                                             \
+                                                                                              \
+static inline void P##_bucketFreeOverflow(struct P##Bucket *head) {                           \
+    struct P##Bucket *bucket;                                                                 \
+    struct P##Bucket *temp;                                                                   \
+    for(bucket = head->overflow; bucket != NULL; bucket = temp) {                             \
+        temp = bucket->overflow;                                                              \
+        free(bucket);                                                                         \
+    }                                                                                         \
+}                                                                                             \
+                                                                                              \
+static inline int P##_rehashInto(struct P##Bucket *buckets, size_t uCount,                    \
+struct P##Bucket *newBuckets, size_t newCount) {                                              \
+    struct P##Bucket **tails;                                                                 \
+    struct P##Bucket *bucket;                                                                 \
+    struct P##Bucket *last;                                                                   \
+    size_t i;                                                                                 \
+    size_t uIndex;                                                                            \
+    int j;                                                                                    \
+    /* the last Bucket of each new chain, so that a chain the hash codes make long is not     \
+       walked for every binding added to it */                                                \
+    tails = (struct P##Bucket**)malloc(newCount * sizeof(struct P##Bucket*));                 \
+    if(tails == NULL) return 0;                                                               \
+    for(i = 0; i < newCount; i++) tails[i] = &newBuckets[i];                                  \
+    /* copies the bindings so that the old Buckets stay intact until every copy succeeds */   \
+    for(i = 0; i < uCount; i++) {                                                             \
+        for(bucket = &buckets[i]; bucket != NULL; bucket = bucket->overflow) {                \
+            for(j = 0; j < bucket->count; j++) {                                              \
+                uIndex = KEY_HASH(bucket->keys[j]) % newCount;                                \
+                last = tails[uIndex];                                                         \
+                if(!P##_bucketAdd(last, bucket->keys[j], bucket->values[j])) {                \
+                    for(i = 0; i < newCount; i++) {                                           \
+                        P##_bucketFreeOverflow(&newBuckets[i]);                               \
+                        memset(&newBuckets[i], 0, sizeof(struct P##Bucket));                  \
+                    }                                                                         \
+                    free(tails);                                                              \
+                    return 0;                                                                 \
+                }                                                                             \
+                if(last->overflow != NULL) tails[uIndex] = last->overflow;                    \
+            }                                                                                 \
+        }                                                                                     \
+    }                                                                                         \
+    free(tails);                                                                              \
+    for(i = 0; i < uCount; i++) P##_bucketFreeOverflow(&buckets[i]);                          \
+    return 1;                                                                                 \
+}                                                                                             \
+                                                                                              \
+static inline struct P##Bucket *P##_rehash(struct P##Bucket *buckets, size_t uCount,          \
+size_t newCount) {                                                                            \
+    struct P##Bucket *newBuckets;                                                             \
+    newBuckets = (struct P##Bucket*)calloc(newCount, sizeof(struct P##Bucket));               \
+    if(newBuckets == NULL) return NULL;                                                       \
+    if(!P##_rehashInto(buckets, uCount, newBuckets, newCount)) {                              \
+        free(newBuckets);                                                                     \
+        return NULL;                                                                          \
+    }                                                                                         \
+    free(buckets);                                                                            \
+    return newBuckets;                                                                        \
+}
+
+/* SYMTABLE_DEFINE_TABLE(P, K, V, HASH, EQUALS) defines P##_T, a handle to a hash table that
+binds keys of type K to values of type V and stores both inline in its Buckets. HASH(k)
+returns the hash code of a key as a size_t, and EQUALS(k1, k2) returns nonzero if two keys
+are the same key. The functions mirror the SymTable ADT:
+
+P##_new() returns a new table with no bindings, or NULL if insufficient memory is available.
+
+P##_free(oTable) frees all memory occupied by oTable.
+
+P##_getLength(oTable) returns the number of bindings of oTable.
+
+P##_put(oTable, key, value) adds a binding of key to value and returns 1, or returns 0 if key
+is already in oTable or insufficient memory is available.
+
+P##_get(oTable, key) returns a pointer to the value bound to key, or NULL if key is not in
+oTable. The value can be read and changed through the pointer until oTable is next changed
+by P##_put or P##_remove.
+
+P##_contains(oTable, key) returns 1 if key is in oTable and 0 otherwise.
+
+P##_remove(oTable, key, pValue) removes the binding of key, stores its value in *pValue
+unless pValue is NULL and returns 1, or returns 0 if key is not in oTable.
+
+P##_map(oTable, pfApply, pvExtra) calls (*pfApply)(key, pValue, pvExtra) for each binding of
+oTable, where pValue points at the value of the binding. */
+#define SYMTABLE_DEFINE_TABLE(P, K, V, HASH, EQUALS)                                          \
+                                                                                              \
+static inline int P##_matches(K key, K probe, size_t hash) {                                  \
+    (void)hash;                                                                               \
+    return EQUALS(key, probe);                                                                \
+}                                                                                             \
+                                                                                              \
+SYMTABLE_DEFINE_BUCKETS(P, K, V, K, HASH, P##_matches)                                        \
+                                                                                              \
+/* struct P points at the first element of an array of Buckets, each of which can start a   \
+chain of overflow Buckets. */                                                                 \
+struct P {                                                                                    \
+    /* an array of the Buckets of the table */                                                \
+    struct P##Bucket *buckets;                                                                \
+    /* number of bindings in the table */                                                     \
+    size_t length;                                                                            \
+    /* number of Buckets in buckets */                                                        \
+    size_t bucketCount;                                                                       \
+};                                                                                            \
+                                                                                              \
+typedef struct P *P##_T;                                                                      \
+                                                                                              \
+static inline P##_T P##_new(void) {                                                           \
+    P##_T oTable = (P##_T)calloc(1, sizeof(struct P));                                        \
+    if(oTable == NULL) return NULL;                                                           \
+    oTable->bucketCount = SymTable_nextBucketCount(0);                                        \
+    oTable->buckets = (struct P##Bucket*)calloc(oTable->bucketCount, sizeof(struct P##Bucket)); \
+    if(oTable->buckets == NULL) {                                                             \
+        free(oTable);                                                                         \
+        return NULL;                                                                          \
+    }                                                                                         \
+    return oTable;                                                                            \
+}                                                                                             \
+                                                                                              \
+static inline void P##_free(P##_T oTable) {                                                   \
+    size_t i;                                                                                 \
+    assert(oTable != NULL);                                                                   \
+    for(i = 0; i < oTable->bucketCount; i++) P##_bucketFreeOverflow(&oTable->buckets[i]);     \
+    free(oTable->buckets);                                                                    \
+    free(oTable);                                                                             \
+}                                                                                             \
+                                                                                              \
+static inline size_t P##_getLength(P##_T oTable) {                                            \
+    assert(oTable != NULL);                                                                   \
+    return oTable->length;                                                                    \
+}                                                                                             \
+                                                                                              \
+static inline int P##_put(P##_T oTable, K key, V value) {                                     \
+    struct P##Bucket *newBuckets;                                                             \
+    size_t newCount;                                                                          \
+    size_t hash;                                                                              \
+    int iSlot;                                                                                \
+    assert(oTable != NULL);                                                                   \
+    hash = HASH(key);                                                                         \
+    if(P##_bucketFind(&oTable->buckets[hash % oTable->bucketCount], key, hash, &iSlot)        \
+        != NULL) return 0;                                                                    \
+    if(oTable->length >= SYMTABLE_MAX_LOAD * oTable->bucketCount) {                           \
+        newCount = SymTable_nextBucketCount(oTable->bucketCount);                             \
+        newBuckets = newCount == 0 ? NULL :                                                   \
+            P##_rehash(oTable->buckets, oTable->bucketCount, newCount);                       \
+        if(newBuckets != NULL) {                                                              \
+            oTable->buckets = newBuckets;                                                     \
+            oTable->bucketCount = newCount;                                                   \
+        }                                                                                     \
+    }                                                                                         \
+    if(!P##_bucketAdd(&oTable->buckets[hash % oTable->bucketCount], key, value)) return 0;    \
+    oTable->length++;                                                                         \
+    return 1;                                                                                 \
+}                                                                                             \
+                                                                                              \
+static inline V *P##_get(P##_T oTable, K key) {                                               \
+    struct P##Bucket *bucket;                                                                 \
+    size_t hash;                                                                              \
+    int iSlot;                                                                                \
+    assert(oTable != NULL);                                                                   \
+    hash = HASH(key);                                                                         \
+    bucket = P##_bucketFind(&oTable->buckets[hash % oTable->bucketCount], key, hash, &iSlot); \
+    if(bucket == NULL) return NULL;                                                           \
+    return &bucket->values[iSlot];                                                            \
+}                                                                                             \
+                                                                                              \
+static inline int P##_contains(P##_T oTable, K key) {                                         \
+    return P##_get(oTable, key) != NULL;                                                      \
+}                                                                                             \
+                                                                                              \
+static inline int P##_remove(P##_T oTable, K key, V *pValue) {                                \
+    struct P##Bucket *head;                                                                   \
+    struct P##Bucket *bucket;                                                                 \
+    size_t hash;                                                                              \
+    int iSlot;                                                                                \
+    assert(oTable != NULL);                                                                   \
+    hash = HASH(key);                                                                         \
+    head = &oTable->buckets[hash % oTable->bucketCount];                                      \
+    bucket = P##_bucketFind(head, key, hash, &iSlot);                                         \
+    if(bucket == NULL) return 0;                                                              \
+    if(pValue != NULL) *pValue = bucket->values[iSlot];                                       \
+    P##_bucketRemove(head, bucket, iSlot);                                                    \
+    oTable->length--;                                                                         \
+    return 1;                                                                                 \
+}                                                                                             \
+                                                                                              \
+static inline void P##_map(P##_T oTable, void (*pfApply)(K key, V *pValue, void *pvExtra),    \
+const void *pvExtra) {                                                                        \
+    struct P##Bucket *bucket;                                                                 \
+    size_t i;                                                                                 \
+    int j;                                                                                    \
+    assert(oTable != NULL);                                                                   \
+    assert(pfApply != NULL);                                                                  \
+    for(i = 0; i < oTable->bucketCount; i++)                                                  \
+        for(bucket = &oTable->buckets[i]; bucket != NULL; bucket = bucket->overflow)          \
+            for(j = 0; j < bucket->count; j++)                                                \
+                pfApply(bucket->keys[j], &bucket->values[j], (void*)pvExtra);                 \
+}
+
+#endif
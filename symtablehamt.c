@@ -0,0 +1,626 @@
+/******************************************************************/
+/* symtablehamt.c                                                 */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include "symtablehamt.h"
+
+/* number of hash bits that pick a child at each level of the trie */
+enum {BITS_PER_LEVEL = 5};
+/* mask that extracts BITS_PER_LEVEL bits of a hash code */
+enum {LEVEL_MASK = (1 << BITS_PER_LEVEL) - 1};
+
+/* Return a hash code for pcKey that uses every bit of a size_t, since the trie consumes
+the low bits first and the high bits at the deeper levels. */
+static size_t SymTable_hash(const char *pcKey) {
+    const size_t HASH_MULTIPLIER = 65599;
+    size_t u;
+    size_t uHash = 0;
+    assert(pcKey != NULL);
+    for (u = 0; pcKey[u] != '\0'; u++)
+        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+    /* fold the well mixed high bits into the low bits used by the first levels */
+    return uHash ^ (uHash >> (sizeof(size_t) * CHAR_BIT / 2));
+}
+
+/* Return the number of bits that are set in u. */
+static unsigned int SymTable_popcount(uint32_t u) {
+    u = u - ((u >> 1) & 0x55555555u);
+    u = (u & 0x33333333u) + ((u >> 2) & 0x33333333u);
+    u = (u + (u >> 4)) & 0x0F0F0F0Fu;
+    return (unsigned int)((u * 0x01010101u) >> 24);
+}
+
+/* struct Leaf contains a pairing of a string key and void *value. Leaves whose keys have
+the same full hash code are chained through struct Leaf *next. A Leaf is never changed
+once it can be reached from more than one place, so it may be shared by many versions. */
+struct Leaf {
+    /* number of Nodes and Leaves that point at the Leaf */
+    size_t refs;
+    /* the full hash code of key */
+    size_t hash;
+    /* the value the Leaf stores for key */
+    void *value;
+    /* Leaf with the same hash code that comes after current Leaf */
+    struct Leaf *next;
+    /* the string key of the Leaf */
+    char key[];
+};
+
+/* struct Node is one level of the trie. Each of its 32 slots is empty, holds a chain of
+Leaves, or holds another Node; only the occupied slots are stored, in slot order. */
+struct Node {
+    /* number of SymTables and Nodes that point at the Node */
+    size_t refs;
+    /* bit i is set if slot i holds a chain of Leaves */
+    uint32_t leafMap;
+    /* bit i is set if slot i holds a Node */
+    uint32_t nodeMap;
+    /* the occupied slots of the Node */
+    void *children[];
+};
+
+/* struct SymTable points at the root of a trie that may be shared with other SymTables,
+and stores size_t length that counts the bindings reachable from the root. */
+struct SymTable {
+    /* the root of the trie, or NULL if SymTable has no bindings */
+    struct Node *root;
+    /* number of bindings in SymTable */
+    size_t length;
+};
+
+/* Return the slot bit that hash selects at the level of the trie that consumes the hash
+bits starting at bit uShift. */
+static uint32_t SymTable_slot(size_t hash, unsigned int uShift) {
+    return (uint32_t)1 << ((hash >> uShift) & LEVEL_MASK);
+}
+
+/* Return the position in node->children of the slot bit. */
+static unsigned int SymTable_index(struct Node *node, uint32_t bit) {
+    return SymTable_popcount((node->leafMap | node->nodeMap) & (bit - 1));
+}
+
+/* Returns a new Leaf binding pcKey to pvValue and followed by next, or NULL if insufficient
+memory is available. */
+static struct Leaf *SymTable_newLeaf(size_t hash, const char *pcKey, const void *pvValue,
+struct Leaf *next) {
+    size_t uLength = strlen(pcKey);
+    struct Leaf *leaf = (struct Leaf*)malloc(sizeof(struct Leaf) + uLength + 1);
+    if(leaf == NULL) return NULL;
+    leaf->refs = 1;
+    leaf->hash = hash;
+    leaf->value = (void*)pvValue;
+    leaf->next = next;
+    if(next != NULL) next->refs++;
+    memcpy(leaf->key, pcKey, uLength + 1);
+    return leaf;
+}
+
+/* Returns a new Node with the given slot maps and room for their children, or NULL if
+insufficient memory is available. */
+static struct Node *SymTable_newNode(uint32_t leafMap, uint32_t nodeMap) {
+    struct Node *node = (struct Node*)malloc(sizeof(struct Node) +
+        SymTable_popcount(leafMap | nodeMap) * sizeof(void*));
+    if(node == NULL) return NULL;
+    node->refs = 1;
+    node->leafMap = leafMap;
+    node->nodeMap = nodeMap;
+    return node;
+}
+
+/* Drops one reference to the chain that starts at leaf, freeing every Leaf that is no
+longer referenced. */
+static void SymTable_releaseLeaf(struct Leaf *leaf) {
+    struct Leaf *temp;
+    while(leaf != NULL && --leaf->refs == 0) {
+        temp = leaf->next;
+        free(leaf);
+        leaf = temp;
+    }
+}
+
+/* Drops one reference to node, freeing it and releasing its children if it is no longer
+referenced. */
+static void SymTable_releaseNode(struct Node *node) {
+    uint32_t bit;
+    unsigned int i = 0;
+    if(node == NULL || --node->refs > 0) return;
+    for(bit = 1; bit != 0; bit <<= 1) {
+        if(node->leafMap & bit) SymTable_releaseLeaf((struct Leaf*)node->children[i++]);
+        else if(node->nodeMap & bit) SymTable_releaseNode((struct Node*)node->children[i++]);
+    }
+    free(node);
+}
+
+/* Adds one reference to every child of node except the one in slot skip. */
+static void SymTable_retainChildren(struct Node *node, uint32_t skip) {
+    uint32_t bit;
+    unsigned int i = 0;
+    for(bit = 1; bit != 0; bit <<= 1) {
+        if(node->leafMap & bit) {
+            if(bit != skip) ((struct Leaf*)node->children[i])->refs++;
+            i++;
+        }
+        else if(node->nodeMap & bit) {
+            if(bit != skip) ((struct Node*)node->children[i])->refs++;
+            i++;
+        }
+    }
+}
+
+/* Returns a version of node whose slot bit holds child, a chain of Leaves if iLeaf and a
+Node otherwise, or is empty if child is NULL. The reference to child is handed over to the
+result. If iOwned, node belongs to the caller alone and is updated in place; otherwise it is
+left unchanged. Returns NULL if insufficient memory is available, leaving node unchanged. */
+static struct Node *SymTable_setChild(struct Node *node, uint32_t bit, void *child, int iLeaf,
+int iOwned) {
+    struct Node *result;
+    uint32_t leafMap = node->leafMap & ~bit;
+    uint32_t nodeMap = node->nodeMap & ~bit;
+    unsigned int uCount = SymTable_popcount(node->leafMap | node->nodeMap);
+    unsigned int uIndex = SymTable_index(node, bit);
+    unsigned int uHad = ((node->leafMap | node->nodeMap) & bit) != 0;
+    unsigned int uHas = child != NULL;
+
+    if(child != NULL) {
+        if(iLeaf) leafMap |= bit;
+        else nodeMap |= bit;
+    }
+
+    if(iOwned) {
+        if(uHad) {
+            if(node->leafMap & bit) SymTable_releaseLeaf((struct Leaf*)node->children[uIndex]);
+            else SymTable_releaseNode((struct Node*)node->children[uIndex]);
+        }
+        else {
+            result = (struct Node*)realloc(node, sizeof(struct Node) + (uCount + 1) * sizeof(void*));
+            if(result == NULL) return NULL;
+            node = result;
+        }
+        memmove(node->children + uIndex + uHas, node->children + uIndex + uHad,
+            (uCount - uIndex - uHad) * sizeof(void*));
+        if(uHas) node->children[uIndex] = child;
+        node->leafMap = leafMap;
+        node->nodeMap = nodeMap;
+        return node;
+    }
+
+    result = SymTable_newNode(leafMap, nodeMap);
+    if(result == NULL) return NULL;
+    memcpy(result->children, node->children, uIndex * sizeof(void*));
+    if(uHas) result->children[uIndex] = child;
+    memcpy(result->children + uIndex + uHas, node->children + uIndex + uHad,
+        (uCount - uIndex - uHad) * sizeof(void*));
+    SymTable_retainChildren(result, bit);
+    return result;
+}
+
+/* Returns the Leaf whose key is pcKey in the trie rooted at node, or NULL if there is none.
+If piOwned is not NULL, *piOwned is cleared unless every Node and Leaf on the way to the
+result is referenced exactly once. */
+static struct Leaf *SymTable_find(struct Node *node, size_t hash, const char *pcKey,
+int *piOwned) {
+    struct Leaf *tracer;
+    uint32_t bit;
+    unsigned int uShift = 0;
+    int iOwned = 1;
+
+    while(node != NULL) {
+        if(node->refs != 1) iOwned = 0;
+        bit = SymTable_slot(hash, uShift);
+        if(node->nodeMap & bit) {
+            node = (struct Node*)node->children[SymTable_index(node, bit)];
+            uShift += BITS_PER_LEVEL;
+            continue;
+        }
+        if(!(node->leafMap & bit)) return NULL;
+        for(tracer = (struct Leaf*)node->children[SymTable_index(node, bit)]; tracer != NULL;
+            tracer = tracer->next) {
+            if(tracer->refs != 1) iOwned = 0;
+            if(tracer->hash == hash && !strcmp(tracer->key, pcKey)) {
+                if(piOwned != NULL && !iOwned) *piOwned = 0;
+                return tracer;
+            }
+        }
+        return NULL;
+    }
+    return NULL;
+}
+
+/* Returns a chain holding leaf in place of the Leaf of chain whose key equals leaf->key,
+or holding leaf followed by chain if there is no such Leaf. The result shares the Leaves
+after the replaced one with chain and takes over the reference to leaf. Returns NULL if
+insufficient memory is available. */
+static struct Leaf *SymTable_chainWith(struct Leaf *chain, struct Leaf *leaf) {
+    struct Leaf *head = NULL;
+    struct Leaf **ppTail = &head;
+    struct Leaf *tracer;
+    struct Leaf *copy;
+
+    for(tracer = chain; tracer != NULL; tracer = tracer->next)
+        if(!strcmp(tracer->key, leaf->key)) break;
+    if(tracer == NULL) {
+        leaf->next = chain;
+        chain->refs++;
+        return leaf;
+    }
+
+    /* copies the Leaves in front of the replaced one */
+    for(copy = chain; copy != tracer; copy = copy->next) {
+        *ppTail = SymTable_newLeaf(copy->hash, copy->key, copy->value, NULL);
+        if(*ppTail == NULL) {
+            SymTable_releaseLeaf(head);
+            return NULL;
+        }
+        ppTail = &(*ppTail)->next;
+    }
+    leaf->next = tracer->next;
+    if(leaf->next != NULL) leaf->next->refs++;
+    *ppTail = leaf;
+    return head;
+}
+
+/* Sets *ppResult to a chain holding the Leaves of chain except the one whose key is pcKey,
+which must be in chain, and returns 1. The result shares the Leaves after the removed one
+with chain. Returns 0 if insufficient memory is available. */
+static int SymTable_chainWithout(struct Leaf *chain, const char *pcKey, struct Leaf **ppResult) {
+    struct Leaf *head = NULL;
+    struct Leaf **ppTail = &head;
+    struct Leaf *tracer;
+
+    for(tracer = chain; strcmp(tracer->key, pcKey) != 0; tracer = tracer->next) {
+        *ppTail = SymTable_newLeaf(tracer->hash, tracer->key, tracer->value, NULL);
+        if(*ppTail == NULL) {
+            SymTable_releaseLeaf(head);
+            return 0;
+        }
+        ppTail = &(*ppTail)->next;
+    }
+    *ppTail = tracer->next;
+    if(tracer->next != NULL) tracer->next->refs++;
+    *ppResult = head;
+    return 1;
+}
+
+/* Returns a Node, at the level that consumes hash bits starting at uShift, that holds both
+chain and leaf, whose hash codes differ. The result takes a new reference to chain and
+takes over the reference to leaf. Returns NULL if insufficient memory is available. */
+static struct Node *SymTable_pair(struct Leaf *chain, struct Leaf *leaf, unsigned int uShift) {
+    struct Node *node;
+    struct Node *child;
+    uint32_t bitChain = SymTable_slot(chain->hash, uShift);
+    uint32_t bitLeaf = SymTable_slot(leaf->hash, uShift);
+
+    if(bitChain == bitLeaf) {
+        child = SymTable_pair(chain, leaf, uShift + BITS_PER_LEVEL);
+        if(child == NULL) return NULL;
+        node = SymTable_newNode(0, bitChain);
+        if(node == NULL) {
+            leaf->refs++;
+            SymTable_releaseNode(child);
+            return NULL;
+        }
+        node->children[0] = child;
+        return node;
+    }
+
+    node = SymTable_newNode(bitChain | bitLeaf, 0);
+    if(node == NULL) return NULL;
+    chain->refs++;
+    node->children[bitChain < bitLeaf ? 0 : 1] = chain;
+    node->children[bitChain < bitLeaf ? 1 : 0] = leaf;
+    return node;
+}
+
+/* Returns a version of node, the level of the trie that consumes hash bits starting at
+uShift, in which leaf replaces the Leaf with an equal key or is added if there is none. The
+reference to leaf is handed over to the result. If iOwned, node belongs to the caller alone
+and is updated in place. Returns NULL if insufficient memory is available, leaving node
+unchanged and the reference to leaf with the caller. */
+static struct Node *SymTable_insert(struct Node *node, unsigned int uShift, struct Leaf *leaf,
+int iOwned) {
+    struct Node *result;
+    struct Node *child;
+    struct Node *newChild;
+    struct Leaf *chain;
+    struct Leaf *newChain;
+    uint32_t bit = SymTable_slot(leaf->hash, uShift);
+    unsigned int uIndex;
+    int iChildOwned;
+
+    if(node == NULL) {
+        result = SymTable_newNode(bit, 0);
+        if(result == NULL) return NULL;
+        result->children[0] = leaf;
+        return result;
+    }
+    uIndex = SymTable_index(node, bit);
+
+    if(node->nodeMap & bit) {
+        child = (struct Node*)node->children[uIndex];
+        iChildOwned = iOwned && child->refs == 1;
+        newChild = SymTable_insert(child, uShift + BITS_PER_LEVEL, leaf, iChildOwned);
+        if(newChild == NULL) return NULL;
+        if(iChildOwned) {
+            node->children[uIndex] = newChild;
+            return node;
+        }
+        result = SymTable_setChild(node, bit, newChild, 0, iOwned);
+        if(result == NULL) {
+            leaf->refs++;
+            SymTable_releaseNode(newChild);
+        }
+        return result;
+    }
+
+    if(node->leafMap & bit) {
+        chain = (struct Leaf*)node->children[uIndex];
+        if(chain->hash == leaf->hash) {
+            newChain = SymTable_chainWith(chain, leaf);
+            if(newChain == NULL) return NULL;
+            result = SymTable_setChild(node, bit, newChain, 1, iOwned);
+            if(result == NULL) {
+                leaf->refs++;
+                SymTable_releaseLeaf(newChain);
+            }
+            return result;
+        }
+        newChild = SymTable_pair(chain, leaf, uShift + BITS_PER_LEVEL);
+        if(newChild == NULL) return NULL;
+        result = SymTable_setChild(node, bit, newChild, 0, iOwned);
+        if(result == NULL) {
+            leaf->refs++;
+            SymTable_releaseNode(newChild);
+        }
+        return result;
+    }
+
+    return SymTable_setChild(node, bit, leaf, 1, iOwned);
+}
+
+/* Sets *ppResult to a version of node whose slot bit holds child instead, or to NULL if
+that leaves the version empty, and returns 1. Follows the ownership rules of
+SymTable_setChild. Returns 0 if insufficient memory is available. */
+static int SymTable_replaceSlot(struct Node *node, uint32_t bit, void *child, int iLeaf,
+int iOwned, struct Node **ppResult) {
+    if(child == NULL && SymTable_popcount(node->leafMap | node->nodeMap) == 1) {
+        if(iOwned) SymTable_releaseNode(node);
+        *ppResult = NULL;
+        return 1;
+    }
+    *ppResult = SymTable_setChild(node, bit, child, iLeaf, iOwned);
+    return *ppResult != NULL;
+}
+
+/* Sets *ppResult to a version of node, the level of the trie that consumes hash bits
+starting at uShift, without the binding whose key is pcKey, which must be in node, and
+returns 1. *ppResult is NULL if the version is empty. If iOwned, node belongs to the caller
+alone and is updated in place. Returns 0 if insufficient memory is available, leaving node
+unchanged. */
+static int SymTable_delete(struct Node *node, unsigned int uShift, size_t hash,
+const char *pcKey, int iOwned, struct Node **ppResult) {
+    struct Node *child;
+    struct Node *newChild;
+    struct Leaf *newChain;
+    struct Leaf *lone;
+    uint32_t bit = SymTable_slot(hash, uShift);
+    unsigned int uIndex = SymTable_index(node, bit);
+    int iChildOwned;
+
+    if(node->leafMap & bit) {
+        if(!SymTable_chainWithout((struct Leaf*)node->children[uIndex], pcKey, &newChain))
+            return 0;
+        if(SymTable_replaceSlot(node, bit, newChain, 1, iOwned, ppResult)) return 1;
+        SymTable_releaseLeaf(newChain);
+        return 0;
+    }
+
+    child = (struct Node*)node->children[uIndex];
+    iChildOwned = iOwned && child->refs == 1;
+    if(!SymTable_delete(child, uShift + BITS_PER_LEVEL, hash, pcKey, iChildOwned, &newChild))
+        return 0;
+    /* the recursive call has used up the reference to an owned child */
+    if(iChildOwned) node->children[uIndex] = NULL;
+
+    /* a Node left with a single chain is folded into its parent */
+    if(newChild != NULL && newChild->nodeMap == 0 &&
+        SymTable_popcount(newChild->leafMap) == 1) {
+        lone = (struct Leaf*)newChild->children[0];
+        lone->refs++;
+        SymTable_releaseNode(newChild);
+        if(SymTable_replaceSlot(node, bit, lone, 1, iOwned, ppResult)) return 1;
+        SymTable_releaseLeaf(lone);
+        return 0;
+    }
+    if(SymTable_replaceSlot(node, bit, newChild, 0, iOwned, ppResult)) return 1;
+    SymTable_releaseNode(newChild);
+    return 0;
+}
+
+/* Applies (*pfApply)(key, value, pvExtra) to every binding in the trie rooted at node. */
+static void SymTable_mapNode(struct Node *node,
+void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), void *pvExtra) {
+    struct Leaf *tracer;
+    uint32_t bit;
+    unsigned int i = 0;
+    for(bit = 1; bit != 0; bit <<= 1) {
+        if(node->leafMap & bit) {
+            for(tracer = (struct Leaf*)node->children[i++]; tracer != NULL; tracer = tracer->next)
+                pfApply((const char*)tracer->key, tracer->value, pvExtra);
+        }
+        else if(node->nodeMap & bit)
+            SymTable_mapNode((struct Node*)node->children[i++], pfApply, pvExtra);
+    }
+}
+
+SymTable_T SymTable_new(void) {
+    SymTable_T out = (SymTable_T)malloc(sizeof(struct SymTable));
+    if(out == NULL) return NULL;
+    out->root = NULL;
+    out->length = 0;
+    return out;
+}
+
+void SymTable_free(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    SymTable_releaseNode(oSymTable->root);
+    free(oSymTable);
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return oSymTable->length;
+}
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    struct Leaf *leaf;
+    struct Node *oldRoot;
+    struct Node *newRoot;
+    size_t hash;
+    int iOwned;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    hash = SymTable_hash(pcKey);
+    if(SymTable_find(oSymTable->root, hash, pcKey, NULL) != NULL) return 0;
+
+    leaf = SymTable_newLeaf(hash, pcKey, pvValue, NULL);
+    if(leaf == NULL) return 0;
+
+    oldRoot = oSymTable->root;
+    iOwned = oldRoot != NULL && oldRoot->refs == 1;
+    newRoot = SymTable_insert(oldRoot, 0, leaf, iOwned);
+    if(newRoot == NULL) {
+        SymTable_releaseLeaf(leaf);
+        return 0;
+    }
+    if(!iOwned) SymTable_releaseNode(oldRoot);
+    oSymTable->root = newRoot;
+    oSymTable->length++;
+    return 1;
+}
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    void *output;
+    struct Leaf *found;
+    struct Leaf *leaf;
+    struct Node *newRoot;
+    size_t hash;
+    int iOwned = 1;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    hash = SymTable_hash(pcKey);
+    found = SymTable_find(oSymTable->root, hash, pcKey, &iOwned);
+    if(found == NULL) return NULL;
+    output = found->value;
+
+    /* a Leaf that no other version can reach is updated in place */
+    if(iOwned) {
+        found->value = (void*)pvValue;
+        return output;
+    }
+
+    leaf = SymTable_newLeaf(hash, pcKey, pvValue, NULL);
+    if(leaf == NULL) return NULL;
+    iOwned = oSymTable->root->refs == 1;
+    newRoot = SymTable_insert(oSymTable->root, 0, leaf, iOwned);
+    if(newRoot == NULL) {
+        SymTable_releaseLeaf(leaf);
+        return NULL;
+    }
+    if(!iOwned) SymTable_releaseNode(oSymTable->root);
+    oSymTable->root = newRoot;
+    return output;
+}
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    return SymTable_find(oSymTable->root, SymTable_hash(pcKey), pcKey, NULL) != NULL;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    struct Leaf *found;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    found = SymTable_find(oSymTable->root, SymTable_hash(pcKey), pcKey, NULL);
+    if(found == NULL) return NULL;
+    return found->value;
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    void *output;
+    struct Leaf *found;
+    struct Node *oldRoot;
+    struct Node *newRoot;
+    size_t hash;
+    int iOwned;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    hash = SymTable_hash(pcKey);
+    found = SymTable_find(oSymTable->root, hash, pcKey, NULL);
+    if(found == NULL) return NULL;
+    output = found->value;
+
+    oldRoot = oSymTable->root;
+    iOwned = oldRoot->refs == 1;
+    if(!SymTable_delete(oldRoot, 0, hash, pcKey, iOwned, &newRoot)) return NULL;
+    if(!iOwned) SymTable_releaseNode(oldRoot);
+    oSymTable->root = newRoot;
+    oSymTable->length--;
+    return output;
+}
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+const void *pvExtra) {
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    if(oSymTable->root != NULL) SymTable_mapNode(oSymTable->root, pfApply, (void*)pvExtra);
+}
+
+SymTable_T SymTable_clone(SymTable_T oSymTable) {
+    SymTable_T out;
+    assert(oSymTable != NULL);
+    out = (SymTable_T)malloc(sizeof(struct SymTable));
+    if(out == NULL) return NULL;
+    out->root = oSymTable->root;
+    out->length = oSymTable->length;
+    if(out->root != NULL) out->root->refs++;
+    return out;
+}
+
+SymTable_T SymTable_putVersion(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    SymTable_T out;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    out = SymTable_clone(oSymTable);
+    if(out == NULL) return NULL;
+    if(!SymTable_put(out, pcKey, pvValue)) {
+        SymTable_free(out);
+        return NULL;
+    }
+    return out;
+}
+
+SymTable_T SymTable_removeVersion(SymTable_T oSymTable, const char *pcKey) {
+    SymTable_T out;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    out = SymTable_clone(oSymTable);
+    if(out == NULL) return NULL;
+    if(!SymTable_contains(out, pcKey)) return out;
+    (void)SymTable_remove(out, pcKey);
+    /* the length only stays the same if the path could not be copied */
+    if(out->length == oSymTable->length) {
+        SymTable_free(out);
+        return NULL;
+    }
+    return out;
+}
@@ -0,0 +1,28 @@
+/******************************************************************/
+/* symtablehamt.h                                                 */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#ifndef SYMTABLEHAMT_INCLUDED
+#define SYMTABLEHAMT_INCLUDED
+#include "symtable.h"
+
+/* The operations below are provided only by symtablehamt.c, which stores bindings in a
+persistent hash array mapped trie. Tables returned by these functions share structure with
+oSymTable, and a later SymTable_put, SymTable_replace or SymTable_remove on either table
+leaves the other one unchanged. Every returned table must be freed with SymTable_free. */
+
+/* Returns a new SymTable holding the same bindings as oSymTable in constant time, or NULL
+if insufficient memory is available. */
+SymTable_T SymTable_clone(SymTable_T oSymTable);
+
+/* Returns a new version of oSymTable that also binds pcKey to pvValue, leaving oSymTable
+unchanged. Returns NULL if pcKey is already in oSymTable or if insufficient memory is available. */
+SymTable_T SymTable_putVersion(SymTable_T oSymTable, const char *pcKey, const void *pvValue);
+
+/* Returns a new version of oSymTable without the binding whose key is pcKey, leaving
+oSymTable unchanged. If pcKey isn't in oSymTable the new version holds the same bindings.
+Returns NULL if insufficient memory is available. */
+SymTable_T SymTable_removeVersion(SymTable_T oSymTable, const char *pcKey);
+
+#endif
@@ -3,261 +3,3128 @@
 /* Author: Yavuz Gonen                                            */
 /******************************************************************/
 
+#define _POSIX_C_SOURCE 200809L
+/* MADV_HUGEPAGE, MAP_HUGETLB and syscall are extensions of the C library of Linux */
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
-#include "symtable.h"
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "symtablehash.h"
+#include "symtablegeneric.h"
+
+/* number of levels of the timer wheel */
+enum {WHEEL_LEVELS = 4};
+/* number of bits of an expiry time that select the slot on one level of the timer wheel */
+enum {WHEEL_BITS = 6};
+/* number of slots on one level of the timer wheel */
+enum {WHEEL_SLOTS = 1 << WHEEL_BITS};
+
+/* number of Buckets a chain may have before further bindings of it are kept in the tree */
+enum {MAX_CHAIN = 4};
+/* number of bytes in a huge page; bucket arrays of at least half as many bytes are mapped
+under an allocation policy */
+enum {HUGE_PAGE_SIZE = 2 * 1024 * 1024};
+/* the NUMA memory policy that allocates only from the given nodes, MPOL_BIND of Linux */
+enum {NUMA_POLICY_BIND = 2};
+/* number of bytes of log records buffered before they are written */
+enum {LOG_BUFFER_SIZE = 65536};
+/* number of bytes in the header of a log record: its kind, the lengths of its key and value
+and its checksum */
+enum {LOG_HEADER_SIZE = 13};
+/* number of bytes a log file must have before it is compacted */
+enum {LOG_MIN_COMPACT = 1 << 20};
+/* number of ArenaWords in an ArenaBlock unless a larger block is needed */
+enum {ARENA_BLOCK_WORDS = 8192};
+/* most ArenaWords in an ArenaBlock that a compaction moves Keys into, large enough that the
+C library maps each block on its own and unmaps it when it is freed */
+enum {COMPACT_BLOCK_WORDS = 1 << 17};
+/* number of values a Key of a SymTable in multimap mode holds inline */
+enum {MULTI_INLINE = 4};
+
+/* Return the 64 bit word x rotated left by b bits. */
+static uint64_t SymTable_rotate(uint64_t x, int b) {
+    return (x << b) | (x >> (64 - b));
+}
+
+/* Apply one SipRound to the SipHash state v. */
+static void SymTable_sipRound(uint64_t v[4]) {
+    v[0] += v[1]; v[1] = SymTable_rotate(v[1], 13); v[1] ^= v[0];
+    v[0] = SymTable_rotate(v[0], 32);
+    v[2] += v[3]; v[3] = SymTable_rotate(v[3], 16); v[3] ^= v[2];
+    v[0] += v[3]; v[3] = SymTable_rotate(v[3], 21); v[3] ^= v[0];
+    v[2] += v[1]; v[1] = SymTable_rotate(v[1], 17); v[1] ^= v[2];
+    v[2] = SymTable_rotate(v[2], 32);
+}
+
+/* Return the full hash code of the uLength characters at pcKey: their SipHash-1-3 under
+the 128 bit key auSeed. Without the key, which differs from table to table, an attacker
+cannot choose keys that share a bucket, as they can for an unkeyed polynomial. Words are
+read in the byte order of the machine, which only changes which codes keys get. */
+static size_t SymTable_hash(const char *pcKey, size_t uLength, const uint64_t auSeed[2]) {
+    uint64_t v[4];
+    uint64_t m;
+    size_t u;
+    size_t i;
+    assert(pcKey != NULL);
+
+    v[0] = auSeed[0] ^ 0x736f6d6570736575u;
+    v[1] = auSeed[1] ^ 0x646f72616e646f6du;
+    v[2] = auSeed[0] ^ 0x6c7967656e657261u;
+    v[3] = auSeed[1] ^ 0x7465646279746573u;
+    for(u = 0; u + 8 <= uLength; u += 8) {
+        memcpy(&m, pcKey + u, 8);
+        v[3] ^= m;
+        SymTable_sipRound(v);
+        v[0] ^= m;
+    }
+    m = (uint64_t)uLength << 56;
+    for(i = 0; u + i < uLength; i++) m |= (uint64_t)(unsigned char)pcKey[u + i] << (8 * i);
+    v[3] ^= m;
+    SymTable_sipRound(v);
+    v[0] ^= m;
+    v[2] ^= 0xff;
+    SymTable_sipRound(v);
+    SymTable_sipRound(v);
+    SymTable_sipRound(v);
+    return (size_t)(v[0] ^ v[1] ^ v[2] ^ v[3]);
+}
+
+/* struct Key holds the characters of one key with its full hash code and length. A Key is
+allocated once per binding and does not move when the binding moves between Buckets; only a
+compaction moves it, into an arena. */
+struct Key {
+    /* the full hash code of chars */
+    size_t hash;
+    /* the number of characters in chars, not counting the '\0' */
+    size_t length;
+    /* the depth of the scope that made the visible binding of the key */
+    size_t scope;
+    /* the index of the Key in the ring of a bounded SymTable */
+    size_t ring;
+    /* the Timer of the binding if it expires, or NULL */
+    struct Timer *timer;
+    /* 1 if the binding has been used since the clock hand last passed it, 0 otherwise */
+    unsigned char referenced;
+    /* 1 if the binding is kept in the tree of its SymTable rather than in a chain */
+    unsigned char spilled;
+    /* the arena mark of its SymTable if the Key lies in the arena and is freed with it, the
+       other mark if a running compaction has moved it into the arena being filled, and 0 if
+       the Key was allocated on its own */
+    unsigned char inArena;
+    /* the '\0' terminated characters of the key. A Key loaded from a file or replayed from a
+       log is followed by the '\0' terminated characters of its value. */
+    char chars[];
+};
+
+/* union ArenaWord is a unit of arena memory, aligned for a Key. */
+union ArenaWord {
+    size_t u;
+    void *p;
+};
+
+/* struct ArenaBlock is a block of memory from which Keys are carved one after another. Keys
+in a block are never freed by themselves; the blocks of a SymTable are freed with it. */
+struct ArenaBlock {
+    /* the block allocated before this one, or NULL */
+    struct ArenaBlock *next;
+    /* number of words in use */
+    size_t used;
+    /* number of words in words */
+    size_t capacity;
+    /* the memory of the block */
+    union ArenaWord words[];
+};
+
+/* struct Values holds the values of one key of a SymTable in multimap mode, in the order they
+were put, and is what the Bucket of the key binds it to. The first Values of a key lies inline
+in its Key, after the characters; a key given more values than fit there moves them to a
+Values of their own, which grows by doubling. */
+struct Values {
+    /* number of values in items */
+    size_t count;
+    /* number of values items has room for */
+    size_t max;
+    /* the values */
+    void *items[];
+};
+
+/* Return 1 if key is the uLength characters at pcKey, whose full hash code is hash, and 0
+otherwise. Keys with a different hash code or length are rejected without reading their
+characters; the remaining candidate is compared with pfEquals or, if it is NULL, with memcmp,
+which the C library runs over whole vector registers. */
+static int SymTable_matches(const struct Key *key, const char *pcKey, size_t uLength,
+size_t hash, int (*pfEquals)(const char *pcKey1, const char *pcKey2, size_t uLen)) {
+    if(key->hash != hash || key->length != uLength) return 0;
+    if(pfEquals != NULL) return pfEquals(key->chars, pcKey, uLength);
+    return memcmp(key->chars, pcKey, uLength) == 0;
+}
+
+/* struct Probe is a key that is looked up: the uLength characters at pcKey, compared with
+pfEquals or, if it is NULL, exactly. */
+struct Probe {
+    /* the characters of the key */
+    const char *pcKey;
+    /* the number of characters */
+    size_t uLength;
+    /* the function that compares keys, or NULL */
+    int (*pfEquals)(const char *pcKey1, const char *pcKey2, size_t uLen);
+};
+
+/* Return 1 if key is the key of probe, whose full hash code is hash, and 0 otherwise. */
+static int SymTable_probeMatches(const struct Key *key, const struct Probe *probe,
+size_t hash) {
+    return SymTable_matches(key, probe->pcKey, probe->uLength, hash, probe->pfEquals);
+}
+
+/* Return the full hash code of key. */
+static size_t SymTable_keyHash(const struct Key *key) {
+    return key->hash;
+}
+
+/* The Buckets of a SymTable store pointers to Keys and values inline; see symtablegeneric.h
+for the layout and the operations on chains of Buckets. */
+SYMTABLE_DEFINE_BUCKETS(SymTable, struct Key *, void *, const struct Probe *, SymTable_keyHash,
+    SymTable_probeMatches)
+
+/* struct Timer schedules the expiry of one binding in a slot of the timer wheel. The Timers
+of a slot form a doubly linked list, so that a Timer leaves its slot in constant time when
+its binding is removed or given a new expiry time. */
+struct Timer {
+    /* the Key of the binding that expires */
+    struct Key *key;
+    /* the time, in milliseconds, at which the binding expires */
+    unsigned long expires;
+    /* the next Timer in the slot, or NULL */
+    struct Timer *next;
+    /* the pointer that points at this Timer: the slot itself or the previous Timer's next */
+    struct Timer **link;
+};
+
+/* struct TreeNode is a node of the AVL tree that holds the bindings of chains that grew
+beyond MAX_CHAIN Buckets, ordered by hash code, length and characters of their keys. Its
+binding is kept in a Bucket of its own, so that a binding found in the tree is used like one
+found in a chain. */
+struct TreeNode {
+    /* a Bucket whose only slot holds the binding of the node */
+    struct SymTableBucket bucket;
+    /* the subtree of smaller keys */
+    struct TreeNode *left;
+    /* the subtree of larger keys */
+    struct TreeNode *right;
+    /* the height of the subtree rooted at the node */
+    int height;
+};
+
+/* struct Shadow is an undo log entry for a binding made inside a scope. When the scope is
+exited the binding of key is removed, or restored to the value and scope it had before if
+the binding shadowed one from an enclosing scope. */
+struct Shadow {
+    /* the Key that was bound, or NULL once the binding has been removed */
+    struct Key *key;
+    /* the value the key had in the enclosing scope */
+    void *value;
+    /* the depth of the scope of the shadowed binding */
+    size_t scope;
+    /* 1 if the binding shadowed one from an enclosing scope, 0 if the key was new */
+    int shadowed;
+};
+
+/* struct SymTable points at the first element of an array of Buckets with struct
+SymTableBucket *buckets. Each Bucket can start a chain of overflow Buckets. struct SymTable
+stores size_t length that counts the total number of bindings stored within struct SymTable,
+and size_t bucketCount, the number of Buckets in the array. */
+struct SymTable {
+    /* an array of the Buckets in SymTable */
+    struct SymTableBucket *buckets;
+    /* the functions that release values and hash and compare keys */
+    struct SymTableOps ops;
+    /* number of bindings in SymTable */
+    size_t length;
+    /* number of Buckets in buckets */
+    size_t bucketCount;
+    /* the key of the hash function, chosen at random for each SymTable */
+    uint64_t seed[2];
+    /* the root of the tree of bindings that did not fit in their chain, or NULL */
+    struct TreeNode *tree;
+    /* one bit per Bucket, set if bindings of its chain may be in the tree, or NULL if no
+       binding has been put in the tree */
+    unsigned char *spilled;
+    /* the undo log of the bindings made in the open scopes, oldest first */
+    struct Shadow *shadows;
+    /* number of entries in shadows */
+    size_t shadowCount;
+    /* number of entries shadows has room for */
+    size_t shadowMax;
+    /* for each open scope, outermost first, the index in shadows of its first entry */
+    size_t *scopeStarts;
+    /* number of open scopes */
+    size_t depth;
+    /* number of entries scopeStarts has room for */
+    size_t depthMax;
+    /* the largest number of bindings a bounded SymTable keeps, or 0 if it is unbounded */
+    size_t capacity;
+    /* the Keys of a bounded SymTable in the order the clock hand visits them */
+    struct Key **ring;
+    /* number of entries ring has room for */
+    size_t ringMax;
+    /* the index in ring of the next Key the clock hand examines */
+    size_t hand;
+    /* the function called with each binding that is evicted, or NULL */
+    void (*pfEvict)(const char *pcKey, void *pvValue, void *pvExtra);
+    /* the extra parameter passed to pfEvict */
+    void *pvEvictExtra;
+    /* number of calls of SymTable_get that found their key */
+    size_t hits;
+    /* number of calls of SymTable_get that did not find their key */
+    size_t misses;
+    /* number of bindings evicted to stay within capacity */
+    size_t evictions;
+    /* the function that returns the current time in milliseconds, or NULL to read the
+       monotonic clock */
+    unsigned long (*pfNow)(void *pvExtra);
+    /* the extra parameter passed to pfNow */
+    void *pvNowExtra;
+    /* the function called with each binding that is removed because it expired, or NULL */
+    void (*pfExpire)(const char *pcKey, void *pvValue, void *pvExtra);
+    /* the extra parameter passed to pfExpire */
+    void *pvExpireExtra;
+    /* the timer wheel, WHEEL_LEVELS levels of WHEEL_SLOTS slots, or NULL before the first
+       binding is given an expiry time. A slot on level i holds the Timers that expire within
+       WHEEL_SLOTS to the power i+1 milliseconds, by bits WHEEL_BITS*i and up of their time. */
+    struct Timer *(*wheel)[WHEEL_SLOTS];
+    /* the next millisecond whose slot the timer wheel has not yet processed */
+    unsigned long wheelTime;
+    /* number of Timers in the wheel */
+    size_t timerCount;
+    /* the newest block of the arena holding Keys loaded from files, or NULL */
+    struct ArenaBlock *arena;
+    /* the SYMTABLE_ALLOC flags that bucket arrays are allocated with */
+    int allocFlags;
+    /* the NUMA node bucket arrays are bound to if allocFlags has SYMTABLE_ALLOC_NUMA_NODE */
+    int allocNode;
+    /* number of bytes mapped for buckets, or 0 if buckets was allocated with calloc */
+    size_t bucketBytes;
+    /* the write-ahead log of a durable SymTable, or NULL */
+    struct Log *log;
+    /* 1 if SymTable is in multimap mode, where each key is bound to its Values, 0 otherwise */
+    int multi;
+    /* the inArena mark of the Keys in arena, 1 or 2 */
+    unsigned char arenaMark;
+    /* 1 while a compaction is running, 0 otherwise */
+    int compacting;
+    /* the arena the running compaction moves Keys into, which replaces arena when it ends */
+    struct ArenaBlock *compactArena;
+    /* the next Bucket whose chain the running compaction moves */
+    size_t compactNext;
+    /* number of ArenaWords the Keys the running compaction has yet to move were counted to
+       need when it started, which sizes its blocks */
+    size_t compactWords;
+    /* number of times a binding has been removed or a Key moved, which invalidates the
+       handles made before */
+    size_t generation;
+    /* number of times the Buckets have been moved, after which a handle looks its binding up
+       again */
+    size_t resizes;
+};
+
+/* struct Log is the write-ahead log of a durable SymTable. Each change is appended as a record
+with a checksum, so that a torn write at the end of the file is detected and dropped. Records
+are buffered and written and synced in groups. When the file has grown to a multiple of the
+size of the live bindings, a thread writes a snapshot of them to a new file while changes
+continue; the changes made meanwhile are appended to the new file, which then replaces the
+old one. */
+struct Log {
+    /* the log file, open for writing at its end */
+    int file;
+    /* the path of the log file */
+    char *path;
+    /* the path the new file of a compaction is written to */
+    char *compactPath;
+    /* the records not yet written to the file */
+    char *buffer;
+    /* number of bytes in buffer */
+    size_t buffered;
+    /* number of records appended since the file was last synced */
+    size_t pending;
+    /* number of records appended between syncs */
+    size_t groupSize;
+    /* a compaction starts once the file is this many times the size of the live records */
+    size_t compactRatio;
+    /* number of bytes in the file, including buffered ones */
+    size_t fileBytes;
+    /* number of bytes that records of the live bindings alone would take */
+    size_t liveBytes;
+    /* number of bytes of keys and values the caller has logged */
+    size_t payloadBytes;
+    /* number of bytes written to log files, by appends and by compactions */
+    size_t writtenBytes;
+    /* number of times a log file was synced */
+    size_t syncs;
+    /* number of compactions that replaced the file */
+    size_t compactions;
+    /* 1 once a write or a sync of the file has failed, 0 otherwise */
+    int failed;
+    /* 1 while a compaction is running, 0 otherwise */
+    int compacting;
+    /* the thread that writes the snapshot of a compaction */
+    pthread_t compactor;
+    /* guards compactDone and compactFile */
+    pthread_mutex_t mutex;
+    /* 1 once the thread of the running compaction has finished */
+    int compactDone;
+    /* the new file the thread wrote and synced, or -1 if it failed */
+    int compactFile;
+    /* the records of the live bindings when the running compaction started */
+    char *snapshot;
+    /* number of bytes in snapshot */
+    size_t snapshotBytes;
+    /* the records appended since the running compaction started */
+    char *side;
+    /* number of bytes in side */
+    size_t sideBytes;
+    /* number of bytes side has room for */
+    size_t sideMax;
+    /* 1 if side could not hold every record, so that the compaction must be abandoned */
+    int sideFailed;
+};
+
+/* struct LoadChunk is the part of a file that one thread of SymTable_loadFile parses into
+Keys. The Keys are only linked into the SymTable after every thread has finished. */
+struct LoadChunk {
+    /* the SymTable whose hash function the Keys are hashed with, which is only read */
+    SymTable_T oSymTable;
+    /* the first character of the chunk, which starts a line */
+    const char *pcStart;
+    /* the character after the chunk */
+    const char *pcEnd;
+    /* the arena the Keys of the chunk lie in */
+    struct ArenaBlock *arena;
+    /* the Keys of the lines of the chunk, in file order */
+    struct Key **keys;
+    /* number of Keys in keys */
+    size_t count;
+    /* number of Keys keys has room for */
+    size_t max;
+    /* 1 if the chunk was parsed, 0 if insufficient memory was available */
+    int iSuccessful;
+    /* 1 if the chunk is parsed by a thread of its own, 0 if by the calling thread */
+    int iThreaded;
+};
+
+/* struct RemoveIf is a call of SymTable_removeIf or SymTable_removeIfParallel. */
+struct RemoveIf {
+    /* the function that selects the bindings to remove */
+    int (*pfPredicate)(const char *pcKey, void *pvValue, void *pvExtra);
+    /* the extra argument of pfPredicate */
+    void *pvExtra;
+    /* number of bindings removed */
+    size_t count;
+};
+
+/* struct Sweeper is the share of the Buckets of a SymTable that one thread of
+SymTable_removeIfParallel sweeps, with the bindings it took out of their chains. */
+struct Sweeper {
+    /* the SymTable swept, whose chains outside the share are not touched */
+    SymTable_T oSymTable;
+    /* the first Bucket of the share */
+    size_t first;
+    /* the Bucket after the share */
+    size_t end;
+    /* the predicate and its extra argument */
+    struct RemoveIf call;
+    /* the Keys of the bindings taken out */
+    struct Key **keys;
+    /* the values of the bindings taken out */
+    void **values;
+    /* number of bindings taken out */
+    size_t count;
+    /* number of bindings keys and values have room for */
+    size_t max;
+    /* 1 if a selected binding was kept for lack of memory, 0 otherwise */
+    int failed;
+    /* 1 if the share is swept by a thread of its own, 0 if by the calling thread */
+    int threaded;
+};
+
+/* struct MapCall is a call of SymTable_map on a SymTable in multimap mode, made once for each
+key. */
+struct MapCall {
+    /* the SymTable mapped */
+    SymTable_T oSymTable;
+    /* the function applied to each value */
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+    /* the extra parameter passed to pfApply */
+    void *pvExtra;
+};
+
+/* struct SetOp is the state of a merge, intersection or difference of two SymTables while
+the bindings of the first are swept. */
+struct SetOp {
+    /* the SymTable the keys of the swept one are looked up in, or merged into */
+    SymTable_T oOther;
+    /* 1 if the bindings whose keys oOther has leave, 0 if those whose keys it lacks */
+    int iLeaveFound;
+    /* the function called with each binding removed, or NULL */
+    void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra);
+    /* the extra argument of pfRemoved */
+    void *pvExtra;
+    /* number of bindings that left the swept SymTable */
+    size_t count;
+    /* 1 if a binding could not be merged for lack of memory, 0 otherwise */
+    int failed;
+};
+
+/* Return the hash code of the uLength characters at pcKey under the hash function of
+oSymTable. */
+static size_t SymTable_hashKey(SymTable_T oSymTable, const char *pcKey, size_t uLength) {
+    if(oSymTable->ops.pfHash != NULL) return oSymTable->ops.pfHash(pcKey, uLength);
+    return SymTable_hash(pcKey, uLength, oSymTable->seed);
+}
+
+/* the random bits the seeds of the SymTables of the process are derived from */
+static uint64_t auProcessKey[2];
+/* makes the first SymTable of the process fill auProcessKey */
+static pthread_once_t sProcessKeyOnce = PTHREAD_ONCE_INIT;
+/* number of seeds derived from auProcessKey so far */
+static uint64_t uSeedCount;
+
+/* Return the next output of splitmix64 with state *puState, which it advances. */
+static uint64_t SymTable_splitmix(uint64_t *puState) {
+    const uint64_t GOLDEN_RATIO = 0x9E3779B97F4A7C15u;
+    uint64_t z;
+    *puState += GOLDEN_RATIO;
+    z = (*puState ^ (*puState >> 30)) * 0xBF58476D1CE4E5B9u;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+    return z ^ (z >> 31);
+}
+
+/* Fill auProcessKey with 16 bytes read from /dev/urandom or, where that cannot be read, with
+bits mixed from the clock and the process ID. */
+static void SymTable_makeProcessKey(void) {
+    struct timespec sTime;
+    uint64_t x;
+    ssize_t iRead = -1;
+    int iFile;
+
+    iFile = open("/dev/urandom", O_RDONLY);
+    if(iFile >= 0) {
+        iRead = read(iFile, auProcessKey, sizeof(auProcessKey));
+        close(iFile);
+    }
+    if(iRead == (ssize_t)sizeof(auProcessKey)) return;
+    clock_gettime(CLOCK_REALTIME, &sTime);
+    x = ((uint64_t)sTime.tv_sec << 32) ^ (uint64_t)sTime.tv_nsec ^ (uint64_t)getpid();
+    auProcessKey[0] = SymTable_splitmix(&x);
+    auProcessKey[1] = SymTable_splitmix(&x);
+}
+
+/* Fill the seed of oSymTable with bits derived from the key of the process, read once for
+all SymTables, and a count of the seeds made, so that no two SymTables share a seed. */
+static void SymTable_makeSeed(SymTable_T oSymTable) {
+    uint64_t x;
+    int i;
+    (void)pthread_once(&sProcessKeyOnce, SymTable_makeProcessKey);
+    x = __atomic_fetch_add(&uSeedCount, 1, __ATOMIC_RELAXED);
+    for(i = 0; i < 2; i++) {
+        x ^= auProcessKey[i];
+        oSymTable->seed[i] = SymTable_splitmix(&x);
+    }
+}
+
+/* Free key unless it lies in an arena, which frees it with its SymTable. */
+static void SymTable_freeKey(struct Key *key) {
+    if(!key->inArena) free(key);
+}
+
+/* Return uBytes of memory from the arena whose newest block is *pArena, adding a block of at
+least uBlockWords ArenaWords to it if needed, or NULL if insufficient memory is available. */
+static void *SymTable_arenaAlloc(struct ArenaBlock **pArena, size_t uBytes, size_t uBlockWords) {
+    struct ArenaBlock *block = *pArena;
+    size_t uWords = (uBytes + sizeof(union ArenaWord) - 1) / sizeof(union ArenaWord);
+    size_t uCapacity;
+    if(block == NULL || block->capacity - block->used < uWords) {
+        uCapacity = uWords > uBlockWords ? uWords : uBlockWords;
+        block = (struct ArenaBlock*)malloc(sizeof(struct ArenaBlock)
+            + uCapacity * sizeof(union ArenaWord));
+        if(block == NULL) return NULL;
+        block->next = *pArena;
+        block->used = 0;
+        block->capacity = uCapacity;
+        *pArena = block;
+    }
+    block->used += uWords;
+    return block->words + block->used - uWords;
+}
+
+/* Free the blocks of the arena whose newest block is block. */
+static void SymTable_arenaFree(struct ArenaBlock *block) {
+    struct ArenaBlock *next;
+    for(; block != NULL; block = next) {
+        next = block->next;
+        free(block);
+    }
+}
+
+/* Return a negative number, 0 or a positive number as the uLength characters at pcKey, whose
+full hash code is hash, come before, are or come after key in the order of the tree. */
+static int SymTable_compareKey(const char *pcKey, size_t uLength, size_t hash,
+const struct Key *key) {
+    if(hash != key->hash) return hash < key->hash ? -1 : 1;
+    if(uLength != key->length) return uLength < key->length ? -1 : 1;
+    return memcmp(pcKey, key->chars, uLength);
+}
+
+/* Return the node of the tree rooted at node that holds the uLength characters at pcKey,
+whose full hash code is hash, or NULL if there is none. */
+static struct TreeNode *SymTable_treeFind(struct TreeNode *node, const char *pcKey,
+size_t uLength, size_t hash) {
+    int iComparison;
+    while(node != NULL) {
+        iComparison = SymTable_compareKey(pcKey, uLength, hash, node->bucket.keys[0]);
+        if(iComparison == 0) return node;
+        node = iComparison < 0 ? node->left : node->right;
+    }
+    return NULL;
+}
+
+/* Return the height of the tree rooted at node. */
+static int SymTable_treeHeight(const struct TreeNode *node) {
+    return node == NULL ? 0 : node->height;
+}
+
+/* Recompute the height of node from the heights of its subtrees. */
+static void SymTable_treeFix(struct TreeNode *node) {
+    int iLeft = SymTable_treeHeight(node->left);
+    int iRight = SymTable_treeHeight(node->right);
+    node->height = 1 + (iLeft > iRight ? iLeft : iRight);
+}
+
+/* Return the root of the subtree rooted at node after rotating it so that its subtrees
+differ in height by at most 1, given that they differed by at most 2. */
+static struct TreeNode *SymTable_treeBalance(struct TreeNode *node) {
+    struct TreeNode *pivot;
+    int iBalance = SymTable_treeHeight(node->left) - SymTable_treeHeight(node->right);
+    if(iBalance > 1) {
+        if(SymTable_treeHeight(node->left->left) < SymTable_treeHeight(node->left->right)) {
+            pivot = node->left->right;
+            node->left->right = pivot->left;
+            SymTable_treeFix(node->left);
+            pivot->left = node->left;
+            node->left = pivot;
+        }
+        pivot = node->left;
+        node->left = pivot->right;
+        pivot->right = node;
+    }
+    else if(iBalance < -1) {
+        if(SymTable_treeHeight(node->right->right) < SymTable_treeHeight(node->right->left)) {
+            pivot = node->right->left;
+            node->right->left = pivot->right;
+            SymTable_treeFix(node->right);
+            pivot->right = node->right;
+            node->right = pivot;
+        }
+        pivot = node->right;
+        node->right = pivot->left;
+        pivot->left = node;
+    }
+    else {
+        SymTable_treeFix(node);
+        return node;
+    }
+    SymTable_treeFix(node);
+    SymTable_treeFix(pivot);
+    return pivot;
+}
+
+/* Return the root of the tree rooted at node after inserting newNode, whose key is not in
+the tree. */
+static struct TreeNode *SymTable_treeInsert(struct TreeNode *node, struct TreeNode *newNode) {
+    const struct Key *key = newNode->bucket.keys[0];
+    if(node == NULL) return newNode;
+    if(SymTable_compareKey(key->chars, key->length, key->hash, node->bucket.keys[0]) < 0)
+        node->left = SymTable_treeInsert(node->left, newNode);
+    else node->right = SymTable_treeInsert(node->right, newNode);
+    return SymTable_treeBalance(node);
+}
+
+/* Return the root of the tree rooted at node after unlinking its smallest node, which is
+stored in *pMin. */
+static struct TreeNode *SymTable_treeRemoveMin(struct TreeNode *node, struct TreeNode **pMin) {
+    if(node->left == NULL) {
+        *pMin = node;
+        return node->right;
+    }
+    node->left = SymTable_treeRemoveMin(node->left, pMin);
+    return SymTable_treeBalance(node);
+}
+
+/* Return the root of the tree rooted at node after unlinking the node of key, which must be
+in the tree. The unlinked node is not freed. */
+static struct TreeNode *SymTable_treeRemove(struct TreeNode *node, const struct Key *key) {
+    struct TreeNode *min;
+    int iComparison = SymTable_compareKey(key->chars, key->length, key->hash,
+        node->bucket.keys[0]);
+    if(iComparison < 0) node->left = SymTable_treeRemove(node->left, key);
+    else if(iComparison > 0) node->right = SymTable_treeRemove(node->right, key);
+    else {
+        if(node->right == NULL) return node->left;
+        min = NULL;
+        node->right = SymTable_treeRemoveMin(node->right, &min);
+        min->left = node->left;
+        min->right = node->right;
+        node = min;
+    }
+    return SymTable_treeBalance(node);
+}
+
+/* Free the Keys and the nodes of the tree rooted at node, passing their values to
+pfFreeValue unless it is NULL. */
+static void SymTable_treeFree(struct TreeNode *node, void (*pfFreeValue)(void *pvValue)) {
+    if(node == NULL) return;
+    SymTable_treeFree(node->left, pfFreeValue);
+    SymTable_treeFree(node->right, pfFreeValue);
+    free(node->bucket.keys[0]->timer);
+    SymTable_freeKey(node->bucket.keys[0]);
+    if(pfFreeValue != NULL) pfFreeValue(node->bucket.values[0]);
+    free(node);
+}
+
+/* Set the bit of the Bucket of each binding of the tree rooted at node in spilled, for a
+SymTable with uBucketCount Buckets. */
+static void SymTable_treeMark(const struct TreeNode *node, unsigned char *spilled,
+size_t uBucketCount) {
+    size_t uIndex;
+    for(; node != NULL; node = node->right) {
+        SymTable_treeMark(node->left, spilled, uBucketCount);
+        uIndex = node->bucket.keys[0]->hash % uBucketCount;
+        spilled[uIndex / 8] |= (unsigned char)(1 << (uIndex % 8));
+    }
+}
+
+/* Apply pfApply to each binding of the tree rooted at node, passing pvExtra as an extra
+parameter. */
+static void SymTable_treeMap(const struct TreeNode *node,
+void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    for(; node != NULL; node = node->right) {
+        SymTable_treeMap(node->left, pfApply, pvExtra);
+        pfApply((const char*)node->bucket.keys[0]->chars, node->bucket.values[0],
+            (void*)pvExtra);
+    }
+}
+
+/* Put the binding of key to value into the tree of oSymTable instead of the chain of Bucket
+uIndex, which is long. Return 1 if successful or 0 if insufficient memory is available. */
+static int SymTable_spill(SymTable_T oSymTable, size_t uIndex, struct Key *key, void *value) {
+    struct TreeNode *node;
+    if(oSymTable->spilled == NULL) {
+        oSymTable->spilled = (unsigned char*)calloc((oSymTable->bucketCount + 7) / 8, 1);
+        if(oSymTable->spilled == NULL) return 0;
+    }
+    node = (struct TreeNode*)calloc(1, sizeof(struct TreeNode));
+    if(node == NULL) return 0;
+    node->bucket.count = 1;
+    node->bucket.tags[0] = SymTable_tag(key->hash);
+    node->bucket.keys[0] = key;
+    node->bucket.values[0] = value;
+    node->height = 1;
+    key->spilled = 1;
+    oSymTable->tree = SymTable_treeInsert(oSymTable->tree, node);
+    oSymTable->spilled[uIndex / 8] |= (unsigned char)(1 << (uIndex % 8));
+    return 1;
+}
+
+/* Return 1 if the chain starting at head has MAX_CHAIN full Buckets, so that another
+binding would make it longer than it may be, and 0 otherwise. Trees are only used when keys
+are compared exactly, since the order of the tree must agree with equality of keys. */
+static int SymTable_chainIsFull(SymTable_T oSymTable, const struct SymTableBucket *head) {
+    int iBuckets = 1;
+    if(head->overflow == NULL || oSymTable->ops.pfEquals != NULL) return 0;
+    for(; head->overflow != NULL; head = head->overflow) iBuckets++;
+    return iBuckets >= MAX_CHAIN && head->count == SYMTABLE_BUCKET_SLOTS;
+}
+
+/* Move the bindings of the chain of Bucket uIndex of oSymTable that lie beyond its first
+MAX_CHAIN Buckets to its tree. Bindings that cannot be moved for lack of memory stay in the
+chain. */
+static void SymTable_trimChain(SymTable_T oSymTable, size_t uIndex) {
+    struct SymTableBucket *keep = &oSymTable->buckets[uIndex];
+    struct SymTableBucket *from;
+    struct SymTableBucket *to;
+    struct SymTableBucket *toPrevious;
+    struct SymTableBucket *temp;
+    int iBuckets;
+    int i = 0;
+    int j = 0;
+
+    for(iBuckets = 1; iBuckets < MAX_CHAIN; iBuckets++) {
+        if(keep->overflow == NULL) return;
+        keep = keep->overflow;
+    }
+    for(from = keep->overflow; from != NULL; from = from->overflow) {
+        for(i = 0; i < from->count; i++)
+            if(!SymTable_spill(oSymTable, uIndex, from->keys[i], from->values[i])) break;
+        if(i < from->count) break;
+    }
+
+    /* The bindings from slot i of from on were not moved; they are shifted to the front of
+       the Buckets beyond keep and the Buckets left empty are freed. */
+    toPrevious = keep;
+    to = keep->overflow;
+    for(; from != NULL; from = from->overflow, i = 0) {
+        for(; i < from->count; i++) {
+            to->tags[j] = from->tags[i];
+            to->keys[j] = from->keys[i];
+            to->values[j] = from->values[i];
+            if(++j == SYMTABLE_BUCKET_SLOTS) {
+                toPrevious = to;
+                to = to->overflow;
+                j = 0;
+            }
+        }
+    }
+    if(j > 0) {
+        to->count = (uint16_t)j;
+        toPrevious = to;
+        to = to->overflow;
+    }
+    toPrevious->overflow = NULL;
+    for(; to != NULL; to = temp) {
+        temp = to->overflow;
+        free(to);
+    }
+}
+
+/* Release value, which oSymTable no longer binds, with the value-free function of
+oSymTable if it has one. */
+static void SymTable_release(SymTable_T oSymTable, void *value) {
+    if(oSymTable->ops.pfFreeValue != NULL) oSymTable->ops.pfFreeValue(value);
+}
+
+/* Return the offset in a Key with uLength characters of the Values that lies inline in it in
+multimap mode. */
+static size_t SymTable_valuesOffset(size_t uLength) {
+    size_t uOffset = sizeof(struct Key) + uLength + 1;
+    return (uOffset + sizeof(union ArenaWord) - 1) / sizeof(union ArenaWord)
+        * sizeof(union ArenaWord);
+}
+
+/* Return the number of bytes of a Key with uLength characters in oSymTable. */
+static size_t SymTable_keySize(SymTable_T oSymTable, size_t uLength) {
+    if(!oSymTable->multi) return sizeof(struct Key) + uLength + 1;
+    return SymTable_valuesOffset(uLength) + sizeof(struct Values) + MULTI_INLINE * sizeof(void*);
+}
+
+/* Return the Values that lies inline in key, a Key of a SymTable in multimap mode. */
+static struct Values *SymTable_inlineValues(const struct Key *key) {
+    return (struct Values*)(void*)((char*)key + SymTable_valuesOffset(key->length));
+}
+
+/* Call pfApply with the characters of key, each value of its binding to value in oSymTable
+and pvExtra. In multimap mode value is the Values of key, otherwise the one value. */
+static void SymTable_eachValue(SymTable_T oSymTable, const struct Key *key, void *value,
+void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), void *pvExtra) {
+    struct Values *values = (struct Values*)value;
+    size_t u;
+    if(!oSymTable->multi) {
+        pfApply(key->chars, value, pvExtra);
+        return;
+    }
+    for(u = 0; u < values->count; u++) pfApply(key->chars, values->items[u], pvExtra);
+}
+
+/* Release each value of the binding of key to value, which oSymTable no longer binds, as
+SymTable_eachValue lists them, and free the Values of key unless it lies inline. */
+static void SymTable_releaseAll(SymTable_T oSymTable, const struct Key *key, void *value) {
+    struct Values *values = (struct Values*)value;
+    size_t u;
+    if(!oSymTable->multi) {
+        SymTable_release(oSymTable, value);
+        return;
+    }
+    for(u = 0; u < values->count; u++) SymTable_release(oSymTable, values->items[u]);
+    if(values != SymTable_inlineValues(key)) free(values);
+}
+
+/* Return the Bucket of oSymTable, in the chain starting at bucket or in the tree, that
+holds key itself and set *piSlot to its slot. key must be in oSymTable. */
+static struct SymTableBucket *SymTable_bucketLocate(SymTable_T oSymTable,
+struct SymTableBucket *bucket, const struct Key *key, int *piSlot) {
+    int i;
+    if(key->spilled) {
+        *piSlot = 0;
+        return &SymTable_treeFind(oSymTable->tree, key->chars, key->length, key->hash)->bucket;
+    }
+    for(; bucket != NULL; bucket = bucket->overflow) {
+        for(i = 0; i < bucket->count; i++) {
+            if(bucket->keys[i] == key) {
+                *piSlot = i;
+                return bucket;
+            }
+        }
+    }
+    assert(0);
+    return NULL;
+}
+
+/* Free the Keys and the overflow Buckets of the chain starting at head. The values of the
+chain are passed to pfFreeValue unless it is NULL. */
+static void SymTable_bucketFree(struct SymTableBucket *head, void (*pfFreeValue)(void *pvValue)) {
+    struct SymTableBucket *bucket;
+    int i;
+    for(bucket = head; bucket != NULL; bucket = bucket->overflow) {
+        for(i = 0; i < bucket->count; i++) {
+            free(bucket->keys[i]->timer);
+            SymTable_freeKey(bucket->keys[i]);
+            if(pfFreeValue != NULL) pfFreeValue(bucket->values[i]);
+        }
+    }
+    SymTable_bucketFreeOverflow(head);
+}
+
+/* Return an array of uCount empty Buckets allocated under the allocation policy of oSymTable,
+and store in *puBytes the number of bytes mapped for it, or 0 if it was allocated with calloc.
+Return NULL if insufficient memory is available. Arrays smaller than half a huge page, and all
+arrays of a SymTable without policy flags, come from calloc. Huge pages and NUMA binding are
+requested where the system provides them and silently go without otherwise. */
+static struct SymTableBucket *SymTable_allocBuckets(SymTable_T oSymTable, size_t uCount,
+size_t *puBytes) {
+    size_t uBytes = uCount * sizeof(struct SymTableBucket);
+    unsigned long ulNodeMask;
+    void *pvMemory = MAP_FAILED;
+
+    *puBytes = 0;
+    if(oSymTable->allocFlags == 0 || uBytes < HUGE_PAGE_SIZE / 2)
+        return (struct SymTableBucket*)calloc(uCount, sizeof(struct SymTableBucket));
+    uBytes = (uBytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#ifdef MAP_HUGETLB
+    if(oSymTable->allocFlags & SYMTABLE_ALLOC_EXPLICIT_HUGE_PAGES)
+        pvMemory = mmap(NULL, uBytes, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if(pvMemory == MAP_FAILED) {
+        pvMemory = mmap(NULL, uBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+            -1, 0);
+        if(pvMemory == MAP_FAILED) return NULL;
+#ifdef MADV_HUGEPAGE
+        (void)madvise(pvMemory, uBytes, MADV_HUGEPAGE);
+#endif
+    }
+#ifdef SYS_mbind
+    /* binds the pages before they are first touched, which is when they are placed */
+    if((oSymTable->allocFlags & SYMTABLE_ALLOC_NUMA_NODE) &&
+        oSymTable->allocNode < (int)(8 * sizeof(unsigned long))) {
+        ulNodeMask = 1UL << oSymTable->allocNode;
+        (void)syscall(SYS_mbind, pvMemory, uBytes, NUMA_POLICY_BIND, &ulNodeMask,
+            8 * sizeof(unsigned long) + 1, 0);
+    }
+#else
+    (void)ulNodeMask;
+#endif
+    *puBytes = uBytes;
+    return (struct SymTableBucket*)pvMemory;
+}
+
+/* Free buckets, an array allocated by SymTable_allocBuckets for which uBytes were mapped. */
+static void SymTable_freeBuckets(struct SymTableBucket *buckets, size_t uBytes) {
+    if(uBytes == 0) free(buckets);
+    else munmap(buckets, uBytes);
+}
+
+/* Move the bindings of oSymTable into newCount new Buckets allocated under its allocation
+policy. Chains that the move makes too long are trimmed into the tree. Return 1 if
+successful, or 0 if insufficient memory is available, in which case oSymTable is unchanged. */
+static int SymTable_resize(SymTable_T oSymTable, size_t newCount) {
+    struct SymTableBucket *newBuckets;
+    unsigned char *newSpilled = NULL;
+    size_t uBytes;
+    size_t i;
+
+    if(oSymTable->spilled != NULL) {
+        newSpilled = (unsigned char*)calloc((newCount + 7) / 8, 1);
+        if(newSpilled == NULL) return 0;
+    }
+    newBuckets = SymTable_allocBuckets(oSymTable, newCount, &uBytes);
+    if(newBuckets == NULL || !SymTable_rehashInto(oSymTable->buckets, oSymTable->bucketCount,
+        newBuckets, newCount)) {
+        if(newBuckets != NULL) SymTable_freeBuckets(newBuckets, uBytes);
+        free(newSpilled);
+        return 0;
+    }
+    SymTable_freeBuckets(oSymTable->buckets, oSymTable->bucketBytes);
+    oSymTable->bucketCount = newCount;
+    oSymTable->buckets = newBuckets;
+    oSymTable->bucketBytes = uBytes;
+    free(oSymTable->spilled);
+    oSymTable->spilled = newSpilled;
+    if(newSpilled != NULL) SymTable_treeMark(oSymTable->tree, newSpilled, newCount);
+    /* a running compaction walks the new Buckets from the start */
+    oSymTable->compactNext = 0;
+    oSymTable->resizes++;
+
+    if(oSymTable->ops.pfEquals == NULL)
+        for(i = 0; i < newCount; i++)
+            if(newBuckets[i].overflow != NULL) SymTable_trimChain(oSymTable, i);
+    return 1;
+}
+
+/* increases the number of Buckets oSymTable has, moving its bindings into the new Buckets
+by their cached hash codes. Leaves oSymTable unchanged if the number of Buckets cannot be
+increased or if insufficient memory is available. */
+static void SymTable_expand(SymTable_T oSymTable) {
+    size_t newCount;
+    assert(oSymTable != NULL);
+
+    newCount = SymTable_nextBucketCount(oSymTable->bucketCount);
+    if(newCount == 0) return;
+    (void)SymTable_resize(oSymTable, newCount);
+}
+
+/* Return the current time of oSymTable in milliseconds. */
+static unsigned long SymTable_now(SymTable_T oSymTable) {
+    struct timespec sTime;
+    if(oSymTable->pfNow != NULL) return oSymTable->pfNow(oSymTable->pvNowExtra);
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+    return (unsigned long)sTime.tv_sec * 1000 + (unsigned long)sTime.tv_nsec / 1000000;
+}
+
+/* Add timer to the slot of the timer wheel of oSymTable that its expiry time falls in. The
+level is the lowest one whose slots span the time left; a time beyond the top level is
+placed in the last slot it reaches and moved again when that slot is cascaded. */
+static void SymTable_timerAdd(SymTable_T oSymTable, struct Timer *timer) {
+    unsigned long expires = timer->expires;
+    unsigned long delta;
+    struct Timer **slot;
+    int level;
+
+    if(expires < oSymTable->wheelTime) expires = oSymTable->wheelTime;
+    delta = expires - oSymTable->wheelTime;
+    for(level = 0; level < WHEEL_LEVELS - 1; level++)
+        if((delta >> (WHEEL_BITS * (level + 1))) == 0) break;
+    if((delta >> (WHEEL_BITS * WHEEL_LEVELS)) != 0)
+        expires = oSymTable->wheelTime + ((1UL << (WHEEL_BITS * WHEEL_LEVELS)) - 1);
+
+    slot = &oSymTable->wheel[level][(expires >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)];
+    timer->next = *slot;
+    if(timer->next != NULL) timer->next->link = &timer->next;
+    timer->link = slot;
+    *slot = timer;
+}
+
+/* Remove timer from its slot of the timer wheel. */
+static void SymTable_timerUnlink(struct Timer *timer) {
+    *timer->link = timer->next;
+    if(timer->next != NULL) timer->next->link = timer->link;
+}
+
+/* Drop key, whose binding is leaving oSymTable, from the ring and the timer wheel of
+oSymTable and count it out, but leave it in its chain or tree. In a bounded SymTable the last
+Key of the ring takes the place of key. */
+static void SymTable_detach(SymTable_T oSymTable, struct Key *key) {
+    struct Key *last;
+    if(oSymTable->capacity != 0) {
+        last = oSymTable->ring[oSymTable->length - 1];
+        last->ring = key->ring;
+        oSymTable->ring[last->ring] = last;
+        if(oSymTable->hand >= oSymTable->length - 1) oSymTable->hand = 0;
+    }
+    if(key->timer != NULL) {
+        SymTable_timerUnlink(key->timer);
+        free(key->timer);
+        key->timer = NULL;
+        oSymTable->timerCount--;
+    }
+    oSymTable->length--;
+    oSymTable->generation++;
+}
+
+/* Remove the binding in slot iSlot of bucket, part of the chain starting at head or a node
+of the tree, from oSymTable and return its Key, which the caller frees. */
+static struct Key *SymTable_unlink(SymTable_T oSymTable, struct SymTableBucket *head,
+struct SymTableBucket *bucket, int iSlot) {
+    struct Key *key = bucket->keys[iSlot];
+    SymTable_detach(oSymTable, key);
+    if(key->spilled) {
+        oSymTable->tree = SymTable_treeRemove(oSymTable->tree, key);
+        /* the Bucket of a tree binding is the first member of its TreeNode */
+        free((struct TreeNode*)(void*)bucket);
+    }
+    else SymTable_bucketRemove(head, bucket, iSlot);
+    return key;
+}
+
+/* Remove the binding in slot iSlot of bucket, part of the chain starting at head or a node
+of the tree, from oSymTable and free its Key. */
+static void SymTable_unbind(SymTable_T oSymTable, struct SymTableBucket *head,
+struct SymTableBucket *bucket, int iSlot) {
+    SymTable_freeKey(SymTable_unlink(oSymTable, head, bucket, iSlot));
+}
+
+/* Append to the undo log of oSymTable an entry for the binding of key made in the innermost
+scope. If iShadowed, the binding replaced value bound in scope uScope. Return 1 if
+successful or 0 if insufficient memory is available. */
+static int SymTable_logShadow(SymTable_T oSymTable, struct Key *key, void *value,
+size_t uScope, int iShadowed) {
+    struct Shadow *newShadows;
+    size_t newMax;
+    if(oSymTable->shadowCount == oSymTable->shadowMax) {
+        newMax = oSymTable->shadowMax == 0 ? 16 : 2 * oSymTable->shadowMax;
+        newShadows = (struct Shadow*)realloc(oSymTable->shadows, newMax * sizeof(struct Shadow));
+        if(newShadows == NULL) return 0;
+        oSymTable->shadows = newShadows;
+        oSymTable->shadowMax = newMax;
+    }
+    oSymTable->shadows[oSymTable->shadowCount].key = key;
+    oSymTable->shadows[oSymTable->shadowCount].value = value;
+    oSymTable->shadows[oSymTable->shadowCount].scope = uScope;
+    oSymTable->shadows[oSymTable->shadowCount].shadowed = iShadowed;
+    oSymTable->shadowCount++;
+    return 1;
+}
+
+/* Remove the expired binding in slot iSlot of bucket, part of the chain starting at head,
+from oSymTable, passing it to pfExpire before its Key is freed. */
+static void SymTable_expireBinding(SymTable_T oSymTable, struct SymTableBucket *head,
+struct SymTableBucket *bucket, int iSlot) {
+    if(oSymTable->pfExpire != NULL)
+        oSymTable->pfExpire(bucket->keys[iSlot]->chars, bucket->values[iSlot],
+            oSymTable->pvExpireExtra);
+    SymTable_release(oSymTable, bucket->values[iSlot]);
+    SymTable_unbind(oSymTable, head, bucket, iSlot);
+}
+
+/* Return the Bucket of the chain starting at head that holds the uLength characters at
+pcKey, whose full hash code is hash, and set *piSlot to its slot, like SymTable_bucketFind.
+A binding found that has expired is removed from oSymTable, and NULL is returned for it. */
+static struct SymTableBucket *SymTable_lookup(SymTable_T oSymTable, struct SymTableBucket *head,
+const char *pcKey, size_t uLength, size_t hash, int *piSlot) {
+    struct SymTableBucket *bucket;
+    struct TreeNode *node;
+    struct Probe probe;
+    size_t uIndex;
+    probe.pcKey = pcKey;
+    probe.uLength = uLength;
+    probe.pfEquals = oSymTable->ops.pfEquals;
+    bucket = SymTable_bucketFind(head, &probe, hash, piSlot);
+    if(bucket == NULL && oSymTable->spilled != NULL) {
+        uIndex = (size_t)(head - oSymTable->buckets);
+        if(oSymTable->spilled[uIndex / 8] & (1 << (uIndex % 8))) {
+            node = SymTable_treeFind(oSymTable->tree, pcKey, uLength, hash);
+            if(node != NULL) {
+                bucket = &node->bucket;
+                *piSlot = 0;
+            }
+        }
+    }
+    if(bucket != NULL && bucket->keys[*piSlot]->timer != NULL &&
+        SymTable_now(oSymTable) >= bucket->keys[*piSlot]->timer->expires) {
+        SymTable_expireBinding(oSymTable, head, bucket, *piSlot);
+        return NULL;
+    }
+    return bucket;
+}
+
+/* Make room in the ring of the bounded oSymTable for one more Key. Return 1 if successful
+or 0 if insufficient memory is available. */
+static int SymTable_reserveRing(SymTable_T oSymTable) {
+    struct Key **newRing;
+    size_t newMax;
+    if(oSymTable->length < oSymTable->ringMax) return 1;
+    newMax = oSymTable->ringMax == 0 ? 16 : 2 * oSymTable->ringMax;
+    /* one Key more than capacity is held between adding a binding and evicting another */
+    if(newMax > oSymTable->capacity + 1) newMax = oSymTable->capacity + 1;
+    newRing = (struct Key**)realloc(oSymTable->ring, newMax * sizeof(struct Key*));
+    if(newRing == NULL) return 0;
+    oSymTable->ring = newRing;
+    oSymTable->ringMax = newMax;
+    return 1;
+}
+
+/* Evict one binding of the bounded oSymTable other than the one of keep. The clock hand
+sweeps the ring, clearing the referenced flags it passes, and stops at the first Key whose
+flag is already clear, so that a binding used since the last sweep gets a second chance.
+The evicted binding is passed to pfEvict before its Key is freed. */
+static void SymTable_evict(SymTable_T oSymTable, struct Key *keep) {
+    struct Key *victim;
+    struct SymTableBucket *head;
+    struct SymTableBucket *bucket;
+    int iSlot;
+    for(;;) {
+        victim = oSymTable->ring[oSymTable->hand];
+        if(victim != keep && !victim->referenced) break;
+        victim->referenced = 0;
+        if(++oSymTable->hand == oSymTable->length) oSymTable->hand = 0;
+    }
+
+    head = &oSymTable->buckets[victim->hash % oSymTable->bucketCount];
+    bucket = SymTable_bucketLocate(oSymTable, head, victim, &iSlot);
+    if(oSymTable->pfEvict != NULL)
+        oSymTable->pfEvict(victim->chars, bucket->values[iSlot], oSymTable->pvEvictExtra);
+    SymTable_release(oSymTable, bucket->values[iSlot]);
+    SymTable_unbind(oSymTable, head, bucket, iSlot);
+    oSymTable->evictions++;
+
+    /* the Key that took the victim's place in the ring is the newest, so the hand moves on */
+    if(++oSymTable->hand == oSymTable->length) oSymTable->hand = 0;
+}
+
+/* Return the undo log entry of oSymTable for the visible binding of key, which was made in
+an open scope. */
+static struct Shadow *SymTable_findShadow(SymTable_T oSymTable, const struct Key *key) {
+    size_t i;
+    size_t uEnd = key->scope < oSymTable->depth ?
+        oSymTable->scopeStarts[key->scope] : oSymTable->shadowCount;
+    for(i = oSymTable->scopeStarts[key->scope - 1]; i < uEnd; i++)
+        if(oSymTable->shadows[i].key == key) return &oSymTable->shadows[i];
+    assert(0);
+    return NULL;
+}
+
+/* Return the number of bytes of a log record with a key of uKeyLength characters and a value
+of uValueLength characters. */
+static size_t SymTable_recordSize(size_t uKeyLength, size_t uValueLength) {
+    return LOG_HEADER_SIZE + uKeyLength + uValueLength;
+}
+
+/* Store the low 32 bits of u at pcOut, least significant byte first. */
+static void SymTable_put32(char *pcOut, size_t u) {
+    int i;
+    for(i = 0; i < 4; i++) pcOut[i] = (char)((u >> (8 * i)) & 0xff);
+}
+
+/* Return the 32 bit number stored at pcIn, least significant byte first. */
+static size_t SymTable_get32(const char *pcIn) {
+    size_t u = 0;
+    int i;
+    for(i = 3; i >= 0; i--) u = (u << 8) | (unsigned char)pcIn[i];
+    return u;
+}
+
+/* Return the FNV-1a checksum of the uLength bytes at pc, continuing from uSum. */
+static size_t SymTable_checksum(size_t uSum, const char *pc, size_t uLength) {
+    size_t u;
+    for(u = 0; u < uLength; u++) uSum = ((uSum ^ (unsigned char)pc[u]) * 16777619u) & 0xffffffffu;
+    return uSum;
+}
+
+/* Store at pcOut the header of a log record of kind cKind for the uKeyLength characters at
+pcKey and the uValueLength characters at pcValue. */
+static void SymTable_recordHeader(char *pcOut, char cKind, const char *pcKey,
+size_t uKeyLength, const char *pcValue, size_t uValueLength) {
+    size_t uSum;
+    pcOut[0] = cKind;
+    SymTable_put32(pcOut + 1, uKeyLength);
+    SymTable_put32(pcOut + 5, uValueLength);
+    uSum = SymTable_checksum(2166136261u, pcOut, 9);
+    uSum = SymTable_checksum(uSum, pcKey, uKeyLength);
+    uSum = SymTable_checksum(uSum, pcValue, uValueLength);
+    SymTable_put32(pcOut + 9, uSum);
+}
+
+/* Free psLog and its buffer and paths. */
+static void SymTable_logFree(struct Log *psLog) {
+    free(psLog->buffer);
+    free(psLog->path);
+    free(psLog->compactPath);
+    free(psLog);
+}
+
+/* Sync the directory that holds the file at pcPath, so that a file created in it or renamed
+into it is still there after a crash. Return 1 if successful or 0 otherwise. */
+static int SymTable_syncDirectory(const char *pcPath) {
+    const char *pcSlash = strrchr(pcPath, '/');
+    char *pcDirectory;
+    size_t uLength;
+    int iSuccessful;
+    int iFile;
+
+    if(pcSlash == NULL) {
+        pcPath = ".";
+        uLength = 1;
+    }
+    else uLength = pcSlash == pcPath ? 1 : (size_t)(pcSlash - pcPath);
+    pcDirectory = (char*)malloc(uLength + 1);
+    if(pcDirectory == NULL) return 0;
+    memcpy(pcDirectory, pcPath, uLength);
+    pcDirectory[uLength] = '\0';
+    iFile = open(pcDirectory, O_RDONLY);
+    free(pcDirectory);
+    if(iFile < 0) return 0;
+    iSuccessful = fsync(iFile) == 0;
+    close(iFile);
+    return iSuccessful;
+}
+
+/* Write the uLength bytes at pc to the file iFile of psLog. Return 1 if successful or 0 if
+the write failed. */
+static int SymTable_logWrite(struct Log *psLog, int iFile, const char *pc, size_t uLength) {
+    ssize_t lWritten;
+    while(uLength > 0) {
+        lWritten = write(iFile, pc, uLength);
+        if(lWritten < 0) return 0;
+        pc += lWritten;
+        uLength -= (size_t)lWritten;
+        psLog->writtenBytes += (size_t)lWritten;
+    }
+    return 1;
+}
+
+/* Write the records buffered in psLog to its file. */
+static void SymTable_logFlush(struct Log *psLog) {
+    if(psLog->buffered > 0 && !SymTable_logWrite(psLog, psLog->file, psLog->buffer,
+        psLog->buffered)) psLog->failed = 1;
+    psLog->buffered = 0;
+}
+
+/* Append the uLength bytes at pc to the side buffer of the running compaction of psLog. */
+static void SymTable_logSide(struct Log *psLog, const char *pc, size_t uLength) {
+    char *newSide;
+    size_t newMax;
+    if(psLog->sideFailed) return;
+    if(psLog->sideBytes + uLength > psLog->sideMax) {
+        newMax = psLog->sideMax == 0 ? LOG_BUFFER_SIZE : 2 * psLog->sideMax;
+        while(newMax < psLog->sideBytes + uLength) newMax *= 2;
+        newSide = (char*)realloc(psLog->side, newMax);
+        if(newSide == NULL) {
+            psLog->sideFailed = 1;
+            return;
+        }
+        psLog->side = newSide;
+        psLog->sideMax = newMax;
+    }
+    memcpy(psLog->side + psLog->sideBytes, pc, uLength);
+    psLog->sideBytes += uLength;
+}
+
+/* Write the snapshot of the compaction of the Log pvLog to its new file and sync it. Return
+NULL. Only touches the snapshot and the fields guarded by the mutex of the Log. */
+static void *SymTable_writeSnapshot(void *pvLog) {
+    struct Log *psLog = (struct Log*)pvLog;
+    const char *pc = psLog->snapshot;
+    size_t uLength = psLog->snapshotBytes;
+    ssize_t lWritten = 0;
+    int iFile;
+
+    iFile = open(psLog->compactPath, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    while(iFile >= 0 && uLength > 0) {
+        lWritten = write(iFile, pc, uLength);
+        if(lWritten < 0) break;
+        pc += lWritten;
+        uLength -= (size_t)lWritten;
+    }
+    if(iFile >= 0 && (lWritten < 0 || fdatasync(iFile) != 0)) {
+        close(iFile);
+        iFile = -1;
+    }
+    pthread_mutex_lock(&psLog->mutex);
+    psLog->compactFile = iFile;
+    psLog->compactDone = 1;
+    pthread_mutex_unlock(&psLog->mutex);
+    return NULL;
+}
+
+/* Finish the running compaction of psLog, whose buffer must be empty, once its thread has
+finished or, if iWait, after waiting for it. The records appended meanwhile are added to the
+new file, which then replaces the old one. A compaction that failed is abandoned and the old
+file kept. */
+static void SymTable_finishCompaction(struct Log *psLog, int iWait) {
+    int iDone;
+    int iFile;
+    pthread_mutex_lock(&psLog->mutex);
+    iDone = psLog->compactDone;
+    iFile = psLog->compactFile;
+    pthread_mutex_unlock(&psLog->mutex);
+    if(!iDone && !iWait) return;
+
+    pthread_join(psLog->compactor, NULL);
+    iFile = psLog->compactFile;
+    if(iFile >= 0 && !psLog->sideFailed && SymTable_logWrite(psLog, iFile, psLog->side,
+        psLog->sideBytes) && fdatasync(iFile) == 0 &&
+        rename(psLog->compactPath, psLog->path) == 0) {
+        close(psLog->file);
+        psLog->file = iFile;
+        psLog->fileBytes = psLog->snapshotBytes + psLog->sideBytes;
+        psLog->writtenBytes += psLog->snapshotBytes;
+        psLog->syncs += 2;
+        /* Until the directory is synced, a crash may bring the old file back. */
+        if(SymTable_syncDirectory(psLog->path)) {
+            psLog->syncs++;
+            psLog->compactions++;
+        }
+        else psLog->failed = 1;
+    }
+    else {
+        /* a snapshot that failed may have left part of the new file behind */
+        if(iFile >= 0) close(iFile);
+        unlink(psLog->compactPath);
+    }
+    free(psLog->snapshot);
+    free(psLog->side);
+    psLog->snapshot = NULL;
+    psLog->side = NULL;
+    psLog->sideBytes = 0;
+    psLog->sideMax = 0;
+    psLog->sideFailed = 0;
+    psLog->compacting = 0;
+}
+
+/* Append a put record for key, bound to the '\0' terminated value, to the snapshot buffer
+pvExtra, a char ** that points at the next free byte. */
+static void SymTable_snapshotKey(const struct Key *key, void *value, void *pvExtra) {
+    char **ppcOut = (char**)pvExtra;
+    size_t uValueLength = strlen((const char*)value);
+    SymTable_recordHeader(*ppcOut, 'P', key->chars, key->length, (const char*)value,
+        uValueLength);
+    memcpy(*ppcOut + LOG_HEADER_SIZE, key->chars, key->length);
+    memcpy(*ppcOut + LOG_HEADER_SIZE + key->length, value, uValueLength);
+    *ppcOut += SymTable_recordSize(key->length, uValueLength);
+}
+
+/* Call pfApply with each Key of the tree rooted at node, its value and pvExtra. */
+static void SymTable_treeEach(const struct TreeNode *node,
+void (*pfApply)(const struct Key *key, void *value, void *pvExtra), void *pvExtra) {
+    for(; node != NULL; node = node->right) {
+        SymTable_treeEach(node->left, pfApply, pvExtra);
+        pfApply(node->bucket.keys[0], node->bucket.values[0], pvExtra);
+    }
+}
+
+/* Call pfApply with each Key of oSymTable, its value and pvExtra. Unlike SymTable_map this
+passes the length of keys that contain '\0'. */
+static void SymTable_eachKey(SymTable_T oSymTable,
+void (*pfApply)(const struct Key *key, void *value, void *pvExtra), void *pvExtra) {
+    struct SymTableBucket *bucket;
+    size_t i;
+    int j;
+    for(i = 0; i < oSymTable->bucketCount; i++)
+        for(bucket = &oSymTable->buckets[i]; bucket != NULL; bucket = bucket->overflow)
+            for(j = 0; j < bucket->count; j++) pfApply(bucket->keys[j], bucket->values[j], pvExtra);
+    SymTable_treeEach(oSymTable->tree, pfApply, pvExtra);
+}
+
+/* Release the values of the binding of key to value in the SymTable pvExtra, which is in
+multimap mode, before the Key is freed. */
+static void SymTable_releaseKey(const struct Key *key, void *value, void *pvExtra) {
+    SymTable_releaseAll((SymTable_T)pvExtra, key, value);
+}
+
+/* Add the bytes of the values of the binding of key to value, a binding of a SymTable in
+multimap mode, that SymTable_memoryUsage does not count with the Key itself to the count
+pvExtra points to. */
+static void SymTable_countValues(const struct Key *key, void *value, void *pvExtra) {
+    struct Values *values = (struct Values*)value;
+    *(size_t*)pvExtra += SymTable_valuesOffset(key->length) - (sizeof(struct Key) + key->length + 1)
+        + sizeof(struct Values) + MULTI_INLINE * sizeof(void*);
+    if(values != SymTable_inlineValues(key))
+        *(size_t*)pvExtra += sizeof(struct Values) + values->max * sizeof(void*);
+}
+
+/* Apply the function of the MapCall pvCall to each value of the binding of key to value. */
+static void SymTable_mapKey(const struct Key *key, void *value, void *pvCall) {
+    struct MapCall *psCall = (struct MapCall*)pvCall;
+    SymTable_eachValue(psCall->oSymTable, key, value, psCall->pfApply, psCall->pvExtra);
+}
+
+/* Add the size of the log record of the binding of key to value to the count pvExtra points
+to. */
+static void SymTable_countRecord(const struct Key *key, void *value, void *pvExtra) {
+    *(size_t*)pvExtra += SymTable_recordSize(key->length, strlen((const char*)value));
+}
+
+/* Start a compaction of the log of oSymTable: serialize its live bindings and start the
+thread that writes them to a new file. Leave the log as it is if insufficient memory is
+available or the thread cannot be created. */
+static void SymTable_startCompaction(SymTable_T oSymTable) {
+    struct Log *psLog = oSymTable->log;
+    char *pcOut;
+    /* the records are counted again in case a caller changed a value in place */
+    psLog->liveBytes = 0;
+    SymTable_eachKey(oSymTable, SymTable_countRecord, &psLog->liveBytes);
+    psLog->snapshot = (char*)malloc(psLog->liveBytes > 0 ? psLog->liveBytes : 1);
+    if(psLog->snapshot == NULL) return;
+    pcOut = psLog->snapshot;
+    SymTable_eachKey(oSymTable, SymTable_snapshotKey, &pcOut);
+    psLog->snapshotBytes = (size_t)(pcOut - psLog->snapshot);
+    psLog->compactDone = 0;
+    psLog->compactFile = -1;
+    if(pthread_create(&psLog->compactor, NULL, SymTable_writeSnapshot, psLog) != 0) {
+        free(psLog->snapshot);
+        psLog->snapshot = NULL;
+        return;
+    }
+    psLog->compacting = 1;
+}
+
+/* Write the buffered records of the log of oSymTable and sync its file. Then finish a
+compaction whose thread has finished, or start one if the file has grown large enough. */
+static void SymTable_logCommit(SymTable_T oSymTable) {
+    struct Log *psLog = oSymTable->log;
+    SymTable_logFlush(psLog);
+    if(psLog->pending > 0) {
+        if(fdatasync(psLog->file) != 0) psLog->failed = 1;
+        psLog->syncs++;
+        psLog->pending = 0;
+    }
+    if(psLog->compacting) SymTable_finishCompaction(psLog, 0);
+    else if(psLog->compactRatio > 0 && psLog->fileBytes >= LOG_MIN_COMPACT &&
+        psLog->fileBytes > psLog->compactRatio * psLog->liveBytes)
+        SymTable_startCompaction(oSymTable);
+}
+
+/* Append a record of kind cKind for the uKeyLength characters at pcKey and the '\0'
+terminated pcValue, or an empty value if it is NULL, to the log of oSymTable. The records are
+written and synced once groupSize of them have been appended. */
+static void SymTable_logRecord(SymTable_T oSymTable, char cKind, const char *pcKey,
+size_t uKeyLength, const char *pcValue) {
+    struct Log *psLog = oSymTable->log;
+    char acHeader[LOG_HEADER_SIZE];
+    size_t uValueLength;
+    size_t uSize;
+
+    if(pcValue == NULL) pcValue = "";
+    uValueLength = strlen(pcValue);
+    uSize = SymTable_recordSize(uKeyLength, uValueLength);
+
+    SymTable_recordHeader(acHeader, cKind, pcKey, uKeyLength, pcValue, uValueLength);
+    if(psLog->compacting) {
+        SymTable_logSide(psLog, acHeader, LOG_HEADER_SIZE);
+        SymTable_logSide(psLog, pcKey, uKeyLength);
+        SymTable_logSide(psLog, pcValue, uValueLength);
+    }
+    if(psLog->buffered + uSize > LOG_BUFFER_SIZE) SymTable_logFlush(psLog);
+    if(uSize > LOG_BUFFER_SIZE) {
+        if(!SymTable_logWrite(psLog, psLog->file, acHeader, LOG_HEADER_SIZE) ||
+            !SymTable_logWrite(psLog, psLog->file, pcKey, uKeyLength) ||
+            !SymTable_logWrite(psLog, psLog->file, pcValue, uValueLength)) psLog->failed = 1;
+    }
+    else {
+        memcpy(psLog->buffer + psLog->buffered, acHeader, LOG_HEADER_SIZE);
+        memcpy(psLog->buffer + psLog->buffered + LOG_HEADER_SIZE, pcKey, uKeyLength);
+        memcpy(psLog->buffer + psLog->buffered + LOG_HEADER_SIZE + uKeyLength, pcValue,
+            uValueLength);
+        psLog->buffered += uSize;
+    }
+    psLog->fileBytes += uSize;
+    psLog->payloadBytes += uKeyLength + uValueLength;
+    if(++psLog->pending >= psLog->groupSize) SymTable_logCommit(oSymTable);
+}
+
+/* Append to the log of oSymTable, if it has one, a record of the removal of the binding of
+the uLength characters at pcKey to value. */
+static void SymTable_logRemove(SymTable_T oSymTable, const char *pcKey, size_t uLength,
+const void *value) {
+    if(oSymTable->log == NULL) return;
+    oSymTable->log->liveBytes -= SymTable_recordSize(uLength, strlen((const char*)value));
+    SymTable_logRecord(oSymTable, 'D', pcKey, uLength, NULL);
+}
+
+/* Free the log of oSymTable after writing and syncing its records and finishing its
+compaction. Return 1 if every record reached the file, or 0 if a write or sync failed. */
+static int SymTable_logClose(SymTable_T oSymTable) {
+    struct Log *psLog = oSymTable->log;
+    int iSuccessful;
+    psLog->compactRatio = 0;
+    SymTable_logCommit(oSymTable);
+    if(psLog->compacting) SymTable_finishCompaction(psLog, 1);
+    iSuccessful = !psLog->failed;
+    close(psLog->file);
+    pthread_mutex_destroy(&psLog->mutex);
+    SymTable_logFree(psLog);
+    oSymTable->log = NULL;
+    return iSuccessful;
+}
+
+/* Return a Key of oSymTable, allocated from the arena whose newest block is *pArena, for the
+uLength characters at pcKey followed by the uValueLength characters at pcValue as its value,
+or NULL if insufficient memory is available. */
+static struct Key *SymTable_arenaKey(SymTable_T oSymTable, struct ArenaBlock **pArena,
+const char *pcKey, size_t uLength, const char *pcValue, size_t uValueLength) {
+    struct Key *key = (struct Key*)SymTable_arenaAlloc(pArena,
+        sizeof(struct Key) + uLength + uValueLength + 2, ARENA_BLOCK_WORDS);
+    if(key == NULL) return NULL;
+    key->hash = SymTable_hashKey(oSymTable, pcKey, uLength);
+    key->length = uLength;
+    key->scope = 0;
+    key->timer = NULL;
+    key->referenced = 0;
+    key->spilled = 0;
+    key->inArena = oSymTable->arenaMark;
+    memcpy(key->chars, pcKey, uLength);
+    key->chars[uLength] = '\0';
+    memcpy(key->chars + uLength + 1, pcValue, uValueLength);
+    key->chars[uLength + 1 + uValueLength] = '\0';
+    return key;
+}
+
+/* Add the binding of newKey, which is not bound in oSymTable and whose hash code is set, to
+pvValue in the innermost scope of oSymTable. Return 1 if successful or 0 if insufficient
+memory is available, in which case newKey is not freed. */
+static int SymTable_link(SymTable_T oSymTable, struct Key *newKey, void *pvValue) {
+    size_t uIndex;
+    int iSuccessful;
+
+    if(oSymTable->capacity != 0 && !SymTable_reserveRing(oSymTable)) return 0;
+    if(oSymTable->depth > 0 && !SymTable_logShadow(oSymTable, newKey, NULL, 0, 0)) return 0;
+
+    if(oSymTable->length >= SYMTABLE_MAX_LOAD * oSymTable->bucketCount)
+        SymTable_expand(oSymTable);
+    
+    uIndex = newKey->hash % oSymTable->bucketCount;
+    if(SymTable_chainIsFull(oSymTable, &oSymTable->buckets[uIndex]))
+        iSuccessful = SymTable_spill(oSymTable, uIndex, newKey, pvValue);
+    else iSuccessful = SymTable_bucketAdd(&oSymTable->buckets[uIndex], newKey, pvValue);
+    if(!iSuccessful) {
+        if(oSymTable->depth > 0) oSymTable->shadowCount--;
+        return 0;
+    }
+    oSymTable->length++;
+
+    if(oSymTable->capacity != 0) {
+        newKey->ring = oSymTable->length - 1;
+        oSymTable->ring[newKey->ring] = newKey;
+        if(oSymTable->length > oSymTable->capacity) SymTable_evict(oSymTable, newKey);
+    }
+    if(oSymTable->log != NULL) {
+        assert(pvValue != NULL);
+        oSymTable->log->liveBytes += SymTable_recordSize(newKey->length, strlen(pvValue));
+        SymTable_logRecord(oSymTable, 'P', newKey->chars, newKey->length, pvValue);
+    }
+    return 1;
+}
+
+/* Apply the records in the uSize bytes at pcRecords to oSymTable, which has no log. Each key
+that is put is copied into the arena of oSymTable together with its value, so that a
+compaction moves the two as one. Return the number of bytes of whole records with a valid
+checksum before the first torn or corrupt one, or 0 with *piSuccessful set to 0 if
+insufficient memory is available. */
+static size_t SymTable_replay(SymTable_T oSymTable, const char *pcRecords, size_t uSize,
+int *piSuccessful) {
+    struct Key *key;
+    const char *pcKey;
+    size_t uOffset = 0;
+    size_t uKeyLength;
+    size_t uValueLength;
+    size_t uSum;
+
+    *piSuccessful = 1;
+    while(uSize - uOffset >= LOG_HEADER_SIZE) {
+        uKeyLength = SymTable_get32(pcRecords + uOffset + 1);
+        uValueLength = SymTable_get32(pcRecords + uOffset + 5);
+        if(uKeyLength > uSize - uOffset - LOG_HEADER_SIZE ||
+            uValueLength > uSize - uOffset - LOG_HEADER_SIZE - uKeyLength) break;
+        pcKey = pcRecords + uOffset + LOG_HEADER_SIZE;
+        uSum = SymTable_checksum(2166136261u, pcRecords + uOffset, 9);
+        uSum = SymTable_checksum(uSum, pcKey, uKeyLength + uValueLength);
+        if(uSum != SymTable_get32(pcRecords + uOffset + 9)) break;
+
+        if(pcRecords[uOffset] == 'C') SymTable_clear(oSymTable);
+        else if(pcRecords[uOffset] == 'D') (void)SymTable_removeN(oSymTable, pcKey, uKeyLength);
+        else if(pcRecords[uOffset] == 'P' || pcRecords[uOffset] == 'R') {
+            /* a key bound already is bound again, to a Key that holds the new value */
+            (void)SymTable_removeN(oSymTable, pcKey, uKeyLength);
+            key = SymTable_arenaKey(oSymTable, &oSymTable->arena, pcKey, uKeyLength,
+                pcKey + uKeyLength, uValueLength);
+            if(key == NULL || !SymTable_link(oSymTable, key, key->chars + uKeyLength + 1)) {
+                *piSuccessful = 0;
+                return 0;
+            }
+        }
+        else break;
+        uOffset += SymTable_recordSize(uKeyLength, uValueLength);
+    }
+    return uOffset;
+}
+
+/* Bind the uLength characters at pcKey, whose hash code is hash and which are not bound in
+oSymTable, to pvValue in the innermost scope of oSymTable; in multimap mode pvValue becomes the
+first of the values of the key. Return 1 if successful or 0 if insufficient memory is
+available. */
+static int SymTable_bindNew(SymTable_T oSymTable, const char *pcKey, size_t uLength, size_t hash,
+const void *pvValue) {
+    struct Key *newKey;
+    struct Values *values;
+    void *value = (void*)pvValue;
+
+    newKey = (struct Key*)malloc(SymTable_keySize(oSymTable, uLength));
+    if (newKey == NULL) return 0;
+    memcpy(newKey->chars, pcKey, uLength);
+    newKey->chars[uLength] = '\0';
+    newKey->hash = hash;
+    newKey->length = uLength;
+    newKey->scope = oSymTable->depth;
+    newKey->timer = NULL;
+    newKey->referenced = 0;
+    newKey->spilled = 0;
+    newKey->inArena = 0;
+    if(oSymTable->multi) {
+        values = SymTable_inlineValues(newKey);
+        values->count = 1;
+        values->max = MULTI_INLINE;
+        values->items[0] = (void*)pvValue;
+        value = values;
+    }
+
+    if(!SymTable_link(oSymTable, newKey, value)) {
+        free(newKey);
+        return 0;
+    }
+    return 1;
+}
+
+/* Parse the lines of the LoadChunk pvChunk into Keys, each followed by its value, hashing
+each key where it lies in the file. Return NULL. Only reads the SymTable of the chunk, so
+that chunks can be parsed by several threads at once. */
+static void *SymTable_parseChunk(void *pvChunk) {
+    struct LoadChunk *psChunk = (struct LoadChunk*)pvChunk;
+    const char *pcLine;
+    const char *pcEnd;
+    const char *pcTab;
+    struct Key **newKeys;
+    struct Key *key;
+    size_t uLength;
+    size_t uValueLength;
+    size_t newMax;
+
+    psChunk->iSuccessful = 0;
+    for(pcLine = psChunk->pcStart; pcLine < psChunk->pcEnd; pcLine = pcEnd + 1) {
+        pcEnd = (const char*)memchr(pcLine, '\n', (size_t)(psChunk->pcEnd - pcLine));
+        if(pcEnd == NULL) pcEnd = psChunk->pcEnd;
+        uLength = (size_t)(pcEnd - pcLine);
+        if(uLength > 0 && pcLine[uLength - 1] == '\r') uLength--;
+        if(uLength == 0) continue;
+        pcTab = (const char*)memchr(pcLine, '\t', uLength);
+        uValueLength = pcTab == NULL ? 0 : uLength - (size_t)(pcTab - pcLine) - 1;
+        if(pcTab != NULL) uLength = (size_t)(pcTab - pcLine);
+
+        if(psChunk->count == psChunk->max) {
+            newMax = psChunk->max == 0 ? 1024 : 2 * psChunk->max;
+            newKeys = (struct Key**)realloc(psChunk->keys, newMax * sizeof(struct Key*));
+            if(newKeys == NULL) return NULL;
+            psChunk->keys = newKeys;
+            psChunk->max = newMax;
+        }
+        key = SymTable_arenaKey(psChunk->oSymTable, &psChunk->arena, pcLine, uLength,
+            pcTab == NULL ? "" : pcTab + 1, uValueLength);
+        if(key == NULL) return NULL;
+        psChunk->keys[psChunk->count++] = key;
+    }
+    psChunk->iSuccessful = 1;
+    return NULL;
+}
+
+/* Add the bytes of the nodes of the tree rooted at node, and of their Keys and Timers, to
+*psUsage. Keys in an arena are counted with the arena. */
+static void SymTable_treeUsage(const struct TreeNode *node, struct SymTableMemory *psUsage) {
+    for(; node != NULL; node = node->right) {
+        SymTable_treeUsage(node->left, psUsage);
+        psUsage->nodes += sizeof(struct TreeNode);
+        if(!node->bucket.keys[0]->inArena)
+            psUsage->keys += sizeof(struct Key) + node->bucket.keys[0]->length + 1;
+        if(node->bucket.keys[0]->timer != NULL) psUsage->overhead += sizeof(struct Timer);
+    }
+}
+
+/* Return 1 if oSymTable1 and oSymTable2 give every key the same hash code, so that the hash
+codes cached in the Keys of one are valid in the other, and 0 otherwise. */
+static int SymTable_sameHash(SymTable_T oSymTable1, SymTable_T oSymTable2) {
+    if(oSymTable1->ops.pfHash != oSymTable2->ops.pfHash) return 0;
+    return oSymTable1->ops.pfHash != NULL || (oSymTable1->seed[0] == oSymTable2->seed[0] &&
+        oSymTable1->seed[1] == oSymTable2->seed[1]);
+}
+
+/* Return 1 if oOther binds the key of key, a Key of oSymTable, and 0 otherwise. The hash code
+cached in key is used unless the two SymTables hash differently; when they also have as many
+Buckets, the key is looked up in the Bucket of oOther with the same index as its own, so
+sweeping oSymTable walks both bucket arrays in step. */
+static int SymTable_findIn(SymTable_T oOther, SymTable_T oSymTable, const struct Key *key) {
+    size_t hash;
+    int iSlot;
+    hash = SymTable_sameHash(oSymTable, oOther) ? key->hash :
+        SymTable_hashKey(oOther, key->chars, key->length);
+    return SymTable_lookup(oOther, &oOther->buckets[hash % oOther->bucketCount], key->chars,
+        key->length, hash, &iSlot) != NULL;
+}
+
+/* Return 0, keeping the binding of key to value in oSymTable, unless the SetOp pvOp has it
+leave. Otherwise detach key, pass the binding to the pfRemoved of the SetOp, release value and
+return 1. */
+static int SymTable_dropBinding(SymTable_T oSymTable, struct Key *key, void *value,
+void *pvOp) {
+    struct SetOp *psOp = (struct SetOp*)pvOp;
+    if(SymTable_findIn(psOp->oOther, oSymTable, key) != psOp->iLeaveFound) return 0;
+    SymTable_detach(oSymTable, key);
+    SymTable_logRemove(oSymTable, key->chars, key->length, value);
+    if(psOp->pfRemoved != NULL)
+        SymTable_eachValue(oSymTable, key, value, psOp->pfRemoved, psOp->pvExtra);
+    SymTable_releaseAll(oSymTable, key, value);
+    psOp->count++;
+    return 1;
+}
+
+/* Return 0, keeping the binding of key to value in oSymTable, if the oOther of the SetOp pvOp
+binds its key or the binding cannot be moved for lack of memory. Otherwise move the binding
+to oOther and return 2, since oOther now owns key, or 1 if key lay in an arena of oSymTable
+and oOther was given a copy of it. */
+static int SymTable_moveBinding(SymTable_T oSymTable, struct Key *key, void *value,
+void *pvOp) {
+    struct SetOp *psOp = (struct SetOp*)pvOp;
+    struct Key *moved = key;
+    size_t oldHash = key->hash;
+    unsigned oldSpilled = key->spilled;
+    size_t uBytes = SymTable_keySize(oSymTable, key->length);
+
+    if(SymTable_findIn(psOp->oOther, oSymTable, key)) return 0;
+    if(key->inArena) {
+        /* the inline Values of a Key in multimap mode move with it */
+        moved = (struct Key*)malloc(uBytes);
+        if(moved == NULL) {
+            psOp->failed = 1;
+            return 0;
+        }
+        memcpy(moved, key, uBytes);
+        moved->inArena = 0;
+        if(oSymTable->multi && value == (void*)SymTable_inlineValues(key))
+            value = SymTable_inlineValues(moved);
+    }
+    if(!SymTable_sameHash(oSymTable, psOp->oOther))
+        moved->hash = SymTable_hashKey(psOp->oOther, key->chars, key->length);
+    moved->spilled = 0;
+    if(!SymTable_link(psOp->oOther, moved, value)) {
+        if(moved != key) free(moved);
+        key->hash = oldHash;
+        key->spilled = oldSpilled;
+        psOp->failed = 1;
+        return 0;
+    }
+    SymTable_detach(oSymTable, key);
+    SymTable_logRemove(oSymTable, key->chars, key->length, value);
+    psOp->count++;
+    return moved == key ? 2 : 1;
+}
+
+/* Return the root of the tree made of the nodes of kept and those of the tree rooted at node
+whose bindings pfLeaves keeps, as SymTable_sweep does for the Buckets of oSymTable. */
+static struct TreeNode *SymTable_treeSweep(SymTable_T oSymTable, struct TreeNode *node,
+struct TreeNode *kept, int (*pfLeaves)(SymTable_T oSymTable, struct Key *key, void *value,
+void *pvExtra), void *pvExtra) {
+    struct TreeNode *right;
+    int iLeaves;
+    if(node == NULL) return kept;
+    right = node->right;
+    kept = SymTable_treeSweep(oSymTable, node->left, kept, pfLeaves, pvExtra);
+    kept = SymTable_treeSweep(oSymTable, right, kept, pfLeaves, pvExtra);
+    iLeaves = pfLeaves(oSymTable, node->bucket.keys[0], node->bucket.values[0], pvExtra);
+    if(iLeaves == 0) {
+        node->left = NULL;
+        node->right = NULL;
+        node->height = 1;
+        return SymTable_treeInsert(kept, node);
+    }
+    if(iLeaves == 1) SymTable_freeKey(node->bucket.keys[0]);
+    free(node);
+    return kept;
+}
+
+/* Sweep the chains of Buckets uFirst to uEnd - 1 of oSymTable as SymTable_sweep does. Only
+those chains are changed, so that threads can sweep disjoint ranges of Buckets at once if
+pfLeaves allows it. */
+static void SymTable_sweepChains(SymTable_T oSymTable, size_t uFirst, size_t uEnd,
+int (*pfLeaves)(SymTable_T oSymTable, struct Key *key, void *value, void *pvExtra),
+void *pvExtra) {
+    struct SymTableBucket *from;
+    struct SymTableBucket *to;
+    struct SymTableBucket *toPrevious;
+    struct SymTableBucket *temp;
+    size_t i;
+    int iLeaves;
+    int j;
+    int k;
+
+    for(i = uFirst; i < uEnd; i++) {
+        toPrevious = NULL;
+        to = &oSymTable->buckets[i];
+        j = 0;
+        for(from = &oSymTable->buckets[i]; from != NULL; from = from->overflow) {
+            for(k = 0; k < from->count; k++) {
+                iLeaves = pfLeaves(oSymTable, from->keys[k], from->values[k], pvExtra);
+                if(iLeaves == 1) SymTable_freeKey(from->keys[k]);
+                if(iLeaves != 0) continue;
+                to->tags[j] = from->tags[k];
+                to->keys[j] = from->keys[k];
+                to->values[j] = from->values[k];
+                if(++j == SYMTABLE_BUCKET_SLOTS) {
+                    toPrevious = to;
+                    to = to->overflow;
+                    j = 0;
+                }
+            }
+        }
+        if(to == NULL) continue;
+        to->count = (uint16_t)j;
+        if(j > 0 || toPrevious == NULL) {
+            toPrevious = to;
+            to = to->overflow;
+        }
+        toPrevious->overflow = NULL;
+        for(; to != NULL; to = temp) {
+            temp = to->overflow;
+            free(to);
+        }
+    }
+}
+
+/* Call pfLeaves with each binding of oSymTable and pvExtra, and remove from oSymTable each
+binding for which it returns 1 or 2, freeing the Key if it returned 1. pfLeaves detaches the
+Key itself and may only look at other SymTables. The bindings kept are shifted to the front
+of their chains and Buckets left empty are freed, as SymTable_trimChain does, so the sweep
+takes time proportional to the number of bindings. */
+static void SymTable_sweep(SymTable_T oSymTable, int (*pfLeaves)(SymTable_T oSymTable,
+struct Key *key, void *value, void *pvExtra), void *pvExtra) {
+    size_t uRatio = 0;
+
+    /* A compaction started in the middle would see a half swept table. */
+    if(oSymTable->log != NULL) {
+        uRatio = oSymTable->log->compactRatio;
+        oSymTable->log->compactRatio = 0;
+    }
+    SymTable_sweepChains(oSymTable, 0, oSymTable->bucketCount, pfLeaves, pvExtra);
+    oSymTable->tree = SymTable_treeSweep(oSymTable, oSymTable->tree, NULL, pfLeaves, pvExtra);
+    if(oSymTable->log != NULL) oSymTable->log->compactRatio = uRatio;
+}
+
+/* Remove the binding of key to value, which has left the chains and tree of oSymTable, from
+the rest of oSymTable, as SymTable_remove does, and release its values, but leave key to
+the caller. */
+static void SymTable_dropKey(SymTable_T oSymTable, struct Key *key, void *value) {
+    SymTable_detach(oSymTable, key);
+    SymTable_logRemove(oSymTable, key->chars, key->length, value);
+    SymTable_releaseAll(oSymTable, key, value);
+}
+
+/* Return 1 if the predicate of the RemoveIf psCall selects the binding of key to value in
+oSymTable, passing it the first value of the key in multimap mode, and 0 otherwise. */
+static int SymTable_selects(SymTable_T oSymTable, const struct Key *key, void *value,
+const struct RemoveIf *psCall) {
+    if(oSymTable->multi) value = ((struct Values*)value)->items[0];
+    return psCall->pfPredicate(key->chars, value, psCall->pvExtra) != 0;
+}
+
+/* Return 0, keeping the binding of key to value in oSymTable, unless the predicate of the
+RemoveIf pvCall selects it. Otherwise drop the binding with SymTable_dropKey, count it and
+return 1. */
+static int SymTable_dropSelected(SymTable_T oSymTable, struct Key *key, void *value,
+void *pvCall) {
+    struct RemoveIf *psCall = (struct RemoveIf*)pvCall;
+    if(!SymTable_selects(oSymTable, key, value, psCall)) return 0;
+    SymTable_dropKey(oSymTable, key, value);
+    psCall->count++;
+    return 1;
+}
+
+/* Return 0, keeping the binding of key to value in oSymTable, unless the predicate of the
+Sweeper pvSweeper selects it. Otherwise add the binding to the Sweeper, leaving everything
+but its chain to the calling thread, and return 2. A binding that cannot be added for lack
+of memory is kept. */
+static int SymTable_collectSelected(SymTable_T oSymTable, struct Key *key, void *value,
+void *pvSweeper) {
+    struct Sweeper *psSweeper = (struct Sweeper*)pvSweeper;
+    struct Key **newKeys;
+    void **newValues;
+    size_t newMax;
+    if(!SymTable_selects(oSymTable, key, value, &psSweeper->call)) return 0;
+    if(psSweeper->count == psSweeper->max) {
+        newMax = psSweeper->max == 0 ? 64 : 2 * psSweeper->max;
+        newKeys = (struct Key**)realloc(psSweeper->keys, newMax * sizeof(struct Key*));
+        if(newKeys != NULL) psSweeper->keys = newKeys;
+        newValues = (void**)realloc(psSweeper->values, newMax * sizeof(void*));
+        if(newValues != NULL) psSweeper->values = newValues;
+        if(newKeys == NULL || newValues == NULL) {
+            psSweeper->failed = 1;
+            return 0;
+        }
+        psSweeper->max = newMax;
+    }
+    psSweeper->keys[psSweeper->count] = key;
+    psSweeper->values[psSweeper->count] = value;
+    psSweeper->count++;
+    return 2;
+}
+
+/* Sweep the chains of the share of Buckets of the Sweeper pvSweeper with
+SymTable_collectSelected. Return NULL. Only changes those chains, so that shares can be swept
+by several threads at once. */
+static void *SymTable_sweepShare(void *pvSweeper) {
+    struct Sweeper *psSweeper = (struct Sweeper*)pvSweeper;
+    SymTable_sweepChains(psSweeper->oSymTable, psSweeper->first, psSweeper->end,
+        SymTable_collectSelected, psSweeper);
+    return NULL;
+}
+
+/* Bind the Key in slot iSlot of bucket of oSymTable, which must not be in multimap mode, to
+pvValue instead of its value, and release and return that value. */
+static void *SymTable_replaceAt(SymTable_T oSymTable, struct SymTableBucket *bucket, int iSlot,
+const void *pvValue) {
+    struct Key *key = bucket->keys[iSlot];
+    void *output = bucket->values[iSlot];
+    bucket->values[iSlot] = (void*)pvValue;
+    key->referenced = 1;
+    if(oSymTable->log != NULL) {
+        assert(pvValue != NULL);
+        oSymTable->log->liveBytes += strlen(pvValue);
+        oSymTable->log->liveBytes -= strlen(output);
+        SymTable_logRecord(oSymTable, 'R', key->chars, key->length, pvValue);
+    }
+    SymTable_release(oSymTable, output);
+    return output;
+}
+
+/* Remove the binding in slot iSlot of bucket, part of the chain starting at head or a node of
+the tree, from oSymTable as SymTable_remove does, and return its value, or its first value in
+multimap mode. A binding made in an open scope that shadowed another uncovers it instead. */
+static void *SymTable_removeAt(SymTable_T oSymTable, struct SymTableBucket *head,
+struct SymTableBucket *bucket, int iSlot) {
+    void *output = bucket->values[iSlot];
+    struct Shadow *shadow;
+    struct Key *key;
+    if(oSymTable->multi) {
+        output = ((struct Values*)bucket->values[iSlot])->items[0];
+        SymTable_releaseAll(oSymTable, bucket->keys[iSlot], bucket->values[iSlot]);
+        SymTable_unbind(oSymTable, head, bucket, iSlot);
+        return output;
+    }
+
+    /* a binding made in an open scope is dropped from the undo log, and a shadowed
+       binding becomes visible again */
+    if(bucket->keys[iSlot]->scope > 0) {
+        shadow = SymTable_findShadow(oSymTable, bucket->keys[iSlot]);
+        shadow->key = NULL;
+        if(shadow->shadowed) {
+            bucket->keys[iSlot]->scope = shadow->scope;
+            bucket->values[iSlot] = shadow->value;
+            SymTable_release(oSymTable, output);
+            return output;
+        }
+    }
+
+    key = SymTable_unlink(oSymTable, head, bucket, iSlot);
+    /* the record follows the change, so that a compaction started by it sees the change */
+    SymTable_logRemove(oSymTable, key->chars, key->length, output);
+    SymTable_freeKey(key);
+    SymTable_release(oSymTable, output);
+    return output;
+}
+
+/* Return the Bucket of oSymTable that holds the binding psHandle refers to, and set *pHead
+to the first Bucket of its chain and *piSlot to its slot, or return NULL if psHandle refers
+to no binding or oSymTable has removed a binding since SymTable_find made psHandle. If the
+Buckets have moved since psHandle was last used, the binding is found again by the hash code
+and address of its Key, without hashing or comparing characters. A binding that has expired
+is removed, and NULL is returned for it. */
+static struct SymTableBucket *SymTable_resolve(SymTable_T oSymTable,
+struct SymTableHandle *psHandle, struct SymTableBucket **pHead, int *piSlot) {
+    struct Key *key = (struct Key*)psHandle->key;
+    struct SymTableBucket *bucket;
+    if(key == NULL || psHandle->generation != oSymTable->generation) return NULL;
+    *pHead = &oSymTable->buckets[key->hash % oSymTable->bucketCount];
+    if(psHandle->resizes != oSymTable->resizes) {
+        psHandle->bucket = SymTable_bucketLocate(oSymTable, *pHead, key, &psHandle->slot);
+        psHandle->resizes = oSymTable->resizes;
+    }
+    bucket = (struct SymTableBucket*)psHandle->bucket;
+    *piSlot = psHandle->slot;
+    if(key->timer != NULL && SymTable_now(oSymTable) >= key->timer->expires) {
+        SymTable_expireBinding(oSymTable, *pHead, bucket, *piSlot);
+        return NULL;
+    }
+    return bucket;
+}
+
+SymTable_T SymTable_new(void) {
+    SymTable_T newHashTable = (SymTable_T)calloc(1, sizeof(struct SymTable));
+    if(newHashTable == NULL) return NULL;
+    
+    newHashTable->length = 0;
+    newHashTable->bucketCount = SymTable_nextBucketCount(0);
+    
+    newHashTable->buckets = (struct SymTableBucket*)calloc(newHashTable->bucketCount,
+        sizeof(struct SymTableBucket));
+    if(newHashTable->buckets == NULL) {
+        free(newHashTable);
+        return NULL;
+    }
+    newHashTable->arenaMark = 1;
+    SymTable_makeSeed(newHashTable);
+    return newHashTable;
+}
+
+SymTable_T SymTable_newWithSeed(uint64_t uSeed0, uint64_t uSeed1) {
+    SymTable_T newHashTable = SymTable_new();
+    if(newHashTable == NULL) return NULL;
+    newHashTable->seed[0] = uSeed0;
+    newHashTable->seed[1] = uSeed1;
+    return newHashTable;
+}
+
+SymTable_T SymTable_newWithOps(const struct SymTableOps *psOps) {
+    SymTable_T newHashTable;
+    assert(psOps != NULL);
+    newHashTable = SymTable_new();
+    if(newHashTable == NULL) return NULL;
+    newHashTable->ops = *psOps;
+    return newHashTable;
+}
+
+void SymTable_free(SymTable_T oSymTable) {
+    size_t i;
+    assert(oSymTable != NULL);
+    
+    if(oSymTable->log != NULL) (void)SymTable_logClose(oSymTable);
+    if(oSymTable->multi) SymTable_eachKey(oSymTable, SymTable_releaseKey, oSymTable);
+    for(i = 0; i < oSymTable->bucketCount; i++) SymTable_bucketFree(&oSymTable->buckets[i],
+        oSymTable->multi ? NULL : oSymTable->ops.pfFreeValue);
+    SymTable_treeFree(oSymTable->tree, oSymTable->multi ? NULL : oSymTable->ops.pfFreeValue);
+    SymTable_freeBuckets(oSymTable->buckets, oSymTable->bucketBytes);
+    free(oSymTable->spilled);
+    free(oSymTable->shadows);
+    free(oSymTable->scopeStarts);
+    free(oSymTable->ring);
+    free(oSymTable->wheel);
+    SymTable_arenaFree(oSymTable->arena);
+    SymTable_arenaFree(oSymTable->compactArena);
+    free(oSymTable);
+}
+
+void SymTable_clear(SymTable_T oSymTable) {
+    size_t i;
+    assert(oSymTable != NULL);
+
+    if(oSymTable->multi) SymTable_eachKey(oSymTable, SymTable_releaseKey, oSymTable);
+    for(i = 0; i < oSymTable->bucketCount; i++) SymTable_bucketFree(&oSymTable->buckets[i],
+        oSymTable->multi ? NULL : oSymTable->ops.pfFreeValue);
+    memset(oSymTable->buckets, 0, oSymTable->bucketCount * sizeof(struct SymTableBucket));
+    SymTable_treeFree(oSymTable->tree, oSymTable->multi ? NULL : oSymTable->ops.pfFreeValue);
+    oSymTable->tree = NULL;
+    free(oSymTable->spilled);
+    oSymTable->spilled = NULL;
+    SymTable_arenaFree(oSymTable->arena);
+    oSymTable->arena = NULL;
+    SymTable_arenaFree(oSymTable->compactArena);
+    oSymTable->compactArena = NULL;
+    oSymTable->compacting = 0;
+    oSymTable->length = 0;
+    oSymTable->generation++;
+    oSymTable->shadowCount = 0;
+    oSymTable->depth = 0;
+    oSymTable->hand = 0;
+    if(oSymTable->wheel != NULL)
+        memset(oSymTable->wheel, 0, WHEEL_LEVELS * sizeof(*oSymTable->wheel));
+    oSymTable->timerCount = 0;
+    if(oSymTable->log != NULL) {
+        oSymTable->log->liveBytes = 0;
+        SymTable_logRecord(oSymTable, 'C', "", 0, NULL);
+    }
+}
+
+size_t SymTable_getLength(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return oSymTable->length;
+}
 
-/* All possible maximum sizes a SymTable can have */
-static const size_t auBucketCounts[] = {509, 1021, 2039, 4093, 8191, 16381, 32749, 65521};
-/* the total number of possible maximum sizes a SymTable can have */
-static const size_t numBucketCounts = sizeof(auBucketCounts)/sizeof(auBucketCounts[0]);
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    assert(pcKey != NULL);
+    return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
 
-/* Return a hash code for pcKey that is between 0 and uBucketCount-1, inclusive. */
-static size_t SymTable_hash(const char *pcKey, size_t uBucketCount) {
-    const size_t HASH_MULTIPLIER = 65599;
-    size_t u;
-    size_t uHash = 0;
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey, size_t uLen, const void *pvValue) {
+    struct SymTableBucket *bucket;
+    size_t hash;
+    int iSlot;
+    assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    for (u = 0; pcKey[u] != '\0'; u++)
-        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
-    return uHash % uBucketCount;
-}
-
-/* struct Binding contains a pairing of char *key and void *value. 
-struct Binding points at another struct Binding that comes after it with
-struct Binding *next */
-struct Binding {
-    /* the string key of the Binding */
-    char *key; 
-    /* the value the Binding stores for a key */
-    void *value; 
-    /* Binding that comes after current Binding */
-    struct Binding *next; 
-};
+    
+    hash = SymTable_hashKey(oSymTable, pcKey, uLen);
+    bucket = SymTable_lookup(oSymTable, &oSymTable->buckets[hash % oSymTable->bucketCount],
+        pcKey, uLen, hash, &iSlot);
+    if(bucket != NULL) {
+        /* a key bound in an enclosing scope is shadowed in the innermost one */
+        if(bucket->keys[iSlot]->scope == oSymTable->depth) return 0;
+        if(!SymTable_logShadow(oSymTable, bucket->keys[iSlot], bucket->values[iSlot],
+            bucket->keys[iSlot]->scope, 1)) return 0;
+        bucket->keys[iSlot]->scope = oSymTable->depth;
+        bucket->values[iSlot] = (void*)pvValue;
+        return 1;
+    }
+    return SymTable_bindNew(oSymTable, pcKey, uLen, hash, pvValue);
+}
 
-/* struct SymTable points at the first element of an array of pointers to a Binding
-with struct Binding **buckets. Each pointer in the array can be used to start a linked 
-list of Bindings. struct SymTable stores size_t length that counts the total number 
-of Bindings stored within struct Symtable. struct SymTable also stores size_t max which is the 
-maximum number of Bindings struct SymTable can store. */
-struct SymTable {
-    /* an array of pointers to the Bindings in SymTable */
-    struct Binding **buckets;
-    /* number of bindings in SymTable */
-    size_t length;
-    /* the maximum number of bindings SymTable can have */
-    size_t max; 
-};
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    size_t uLength;
+    size_t hash;
+    struct SymTableBucket *bucket;
+    int iSlot;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(!oSymTable->multi);
+    
+    uLength = strlen(pcKey);
+    hash = SymTable_hashKey(oSymTable, pcKey, uLength);
+    bucket = SymTable_lookup(oSymTable, &oSymTable->buckets[hash % oSymTable->bucketCount], pcKey,
+        uLength, hash, &iSlot);
+    if(bucket == NULL) return NULL;
+    return SymTable_replaceAt(oSymTable, bucket, iSlot, pvValue);
+}
 
-/* increases the maximum number of bindings oSymTable can have attached to it */
-static void SymTable_expand(SymTable_T oSymTable) {
-    struct Binding **newBuckets;
-    struct Binding **oldBuckets;
-    struct Binding *oldTracer;
-    struct Binding *temp;
-    size_t newHash;
-    size_t i;
-    size_t newMax = 0;
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
+    size_t hash;
+    int iSlot;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    hash = SymTable_hashKey(oSymTable, pcKey, uLen);
+    return SymTable_lookup(oSymTable, &oSymTable->buckets[hash % oSymTable->bucketCount], pcKey,
+        uLen, hash, &iSlot) != NULL;
+}
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
+    size_t hash;
+    struct SymTableBucket *bucket;
+    int iSlot;
     assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    hash = SymTable_hashKey(oSymTable, pcKey, uLen);
+    bucket = SymTable_lookup(oSymTable, &oSymTable->buckets[hash % oSymTable->bucketCount], pcKey,
+        uLen, hash, &iSlot);
+    if(bucket == NULL) {
+        oSymTable->misses++;
+        return NULL;
+    }
+    oSymTable->hits++;
+    bucket->keys[iSlot]->referenced = 1;
+    if(oSymTable->multi) return ((struct Values*)bucket->values[iSlot])->items[0];
+    return bucket->values[iSlot];
+}
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
 
-    /* breaks function if max cannot be increased */
-    if(oSymTable->length == auBucketCounts[numBucketCounts-1]) return;
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
+    size_t hash;
+    struct SymTableBucket *head;
+    struct SymTableBucket *bucket;
+    int iSlot;
     
-    /* gets the maximum number of bindings oSymTable can have */
-    for(i = 0; i < numBucketCounts-1; i++) {
-        if(oSymTable->length == auBucketCounts[i]) {
-            newMax = auBucketCounts[i+1];
-            break;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    hash = SymTable_hashKey(oSymTable, pcKey, uLen);
+    head = &oSymTable->buckets[hash % oSymTable->bucketCount];
+    bucket = SymTable_lookup(oSymTable, head, pcKey, uLen, hash, &iSlot);
+    if(bucket == NULL) return NULL;
+    return SymTable_removeAt(oSymTable, head, bucket, iSlot);
+}
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), 
+const void *pvExtra) {
+    struct MapCall sCall;
+    size_t i;
+    struct SymTableBucket *bucket;
+    int j;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    if(oSymTable->multi) {
+        sCall.oSymTable = oSymTable;
+        sCall.pfApply = pfApply;
+        sCall.pvExtra = (void*)pvExtra;
+        SymTable_eachKey(oSymTable, SymTable_mapKey, &sCall);
+        return;
+    }
+    for(i = 0; i < oSymTable->bucketCount; i++) {
+        for(bucket = &oSymTable->buckets[i]; bucket != NULL; bucket = bucket->overflow) {
+            for(j = 0; j < bucket->count; j++)
+                pfApply((const char*)bucket->keys[j]->chars, bucket->values[j], (void*)pvExtra);
         }
     }
+    SymTable_treeMap(oSymTable->tree, pfApply, pvExtra);
+}
+
+int SymTable_enterScope(SymTable_T oSymTable) {
+    size_t *newStarts;
+    size_t newMax;
+    assert(oSymTable != NULL);
+    assert(oSymTable->capacity == 0);
+    assert(oSymTable->timerCount == 0);
+    assert(oSymTable->log == NULL);
+    assert(!oSymTable->multi);
+    if(oSymTable->depth == oSymTable->depthMax) {
+        newMax = oSymTable->depthMax == 0 ? 8 : 2 * oSymTable->depthMax;
+        newStarts = (size_t*)realloc(oSymTable->scopeStarts, newMax * sizeof(size_t));
+        if(newStarts == NULL) return 0;
+        oSymTable->scopeStarts = newStarts;
+        oSymTable->depthMax = newMax;
+    }
+    oSymTable->scopeStarts[oSymTable->depth] = oSymTable->shadowCount;
+    oSymTable->depth++;
+    return 1;
+}
 
-    oldBuckets = oSymTable->buckets;
-    newBuckets = (struct Binding**)calloc(newMax, sizeof(struct Binding));
-    if (newBuckets == NULL) return;
+void SymTable_exitScope(SymTable_T oSymTable) {
+    struct Shadow *shadow;
+    struct SymTableBucket *head;
+    struct SymTableBucket *bucket;
+    size_t uStart;
+    int iSlot;
+    assert(oSymTable != NULL);
+    assert(oSymTable->depth > 0);
 
-    /* rearranges the oldBuckets onto the newBucjets with new hash values */
-    for(i=0; i < oSymTable->max; i++) {
-        for(oldTracer = oldBuckets[i]; oldTracer != NULL; oldTracer = temp) {
-            temp = oldTracer->next;
-            newHash = SymTable_hash(oldTracer->key, newMax);
-            oldTracer->next = newBuckets[newHash];
-            newBuckets[newHash] = oldTracer;
+    /* undoes the bindings of the scope, newest first */
+    uStart = oSymTable->scopeStarts[oSymTable->depth - 1];
+    while(oSymTable->shadowCount > uStart) {
+        shadow = &oSymTable->shadows[--oSymTable->shadowCount];
+        if(shadow->key == NULL) continue;
+        head = &oSymTable->buckets[shadow->key->hash % oSymTable->bucketCount];
+        bucket = SymTable_bucketLocate(oSymTable, head, shadow->key, &iSlot);
+        SymTable_release(oSymTable, bucket->values[iSlot]);
+        if(shadow->shadowed) {
+            shadow->key->scope = shadow->scope;
+            bucket->values[iSlot] = shadow->value;
         }
+        else SymTable_unbind(oSymTable, head, bucket, iSlot);
     }
-    
-    free(oldBuckets);
-    oSymTable->max = newMax;
-    oSymTable->buckets = newBuckets;
+    oSymTable->depth--;
 }
 
-SymTable_T SymTable_new(void) {
-    SymTable_T newHashTable = (SymTable_T)calloc(1, sizeof(struct SymTable));
+size_t SymTable_getScopeDepth(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    return oSymTable->depth;
+}
+
+SymTable_T SymTable_newBounded(size_t uCapacity,
+void (*pfEvict)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    SymTable_T newHashTable;
+    assert(uCapacity > 0);
+    newHashTable = SymTable_new();
     if(newHashTable == NULL) return NULL;
-    
-    newHashTable->length = 0;
-    newHashTable->max = auBucketCounts[0];
-    
-    newHashTable->buckets = (struct Binding**)calloc(auBucketCounts[0], sizeof(struct Binding));
-    if(newHashTable->buckets == NULL) return NULL;
+    newHashTable->capacity = uCapacity;
+    newHashTable->pfEvict = pfEvict;
+    newHashTable->pvEvictExtra = (void*)pvExtra;
     return newHashTable;
 }
 
-void SymTable_free(SymTable_T oSymTable) {
+void SymTable_getCacheStats(SymTable_T oSymTable, size_t *puHits, size_t *puMisses,
+size_t *puEvictions) {
+    assert(oSymTable != NULL);
+    if(puHits != NULL) *puHits = oSymTable->hits;
+    if(puMisses != NULL) *puMisses = oSymTable->misses;
+    if(puEvictions != NULL) *puEvictions = oSymTable->evictions;
+}
+
+void SymTable_setClock(SymTable_T oSymTable, unsigned long (*pfNow)(void *pvExtra),
+const void *pvExtra) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->timerCount == 0);
+    oSymTable->pfNow = pfNow;
+    oSymTable->pvNowExtra = (void*)pvExtra;
+}
+
+void SymTable_setExpireHandler(SymTable_T oSymTable,
+void (*pfExpire)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    assert(oSymTable != NULL);
+    oSymTable->pfExpire = pfExpire;
+    oSymTable->pvExpireExtra = (void*)pvExtra;
+}
+
+int SymTable_setExpiry(SymTable_T oSymTable, const char *pcKey, unsigned long ulLifetime) {
+    struct Key *key;
+    struct SymTableBucket *bucket;
+    size_t uLength;
+    size_t hash;
+    unsigned long now;
+    int iSlot;
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(oSymTable->depth == 0);
+    assert(oSymTable->log == NULL);
+    assert(!oSymTable->multi);
+
+    uLength = strlen(pcKey);
+    hash = SymTable_hashKey(oSymTable, pcKey, uLength);
+    bucket = SymTable_lookup(oSymTable, &oSymTable->buckets[hash % oSymTable->bucketCount], pcKey,
+        uLength, hash, &iSlot);
+    if(bucket == NULL) return 0;
+    key = bucket->keys[iSlot];
+
+    if(oSymTable->wheel == NULL) {
+        oSymTable->wheel = (struct Timer*(*)[WHEEL_SLOTS])calloc(WHEEL_LEVELS,
+            sizeof(*oSymTable->wheel));
+        if(oSymTable->wheel == NULL) return 0;
+    }
+    if(key->timer == NULL) {
+        key->timer = (struct Timer*)malloc(sizeof(struct Timer));
+        if(key->timer == NULL) return 0;
+        key->timer->key = key;
+        oSymTable->timerCount++;
+    }
+    else SymTable_timerUnlink(key->timer);
+
+    now = SymTable_now(oSymTable);
+    /* an empty wheel has nothing to catch up on */
+    if(oSymTable->timerCount == 1) oSymTable->wheelTime = now;
+    key->timer->expires = now + ulLifetime;
+    SymTable_timerAdd(oSymTable, key->timer);
+    return 1;
+}
+
+size_t SymTable_expire(SymTable_T oSymTable) {
+    struct Timer *timer;
+    struct Timer *next;
+    struct SymTableBucket *head;
+    struct SymTableBucket *bucket;
+    unsigned long now;
+    size_t uIndex;
+    size_t uExpired = 0;
+    int level;
+    int iSlot;
+    assert(oSymTable != NULL);
+
+    if(oSymTable->timerCount == 0) return 0;
+    now = SymTable_now(oSymTable);
+    while(oSymTable->wheelTime <= now && oSymTable->timerCount > 0) {
+        /* each time a level wraps around, the next slot of the level above is spread out
+           over the levels below */
+        uIndex = oSymTable->wheelTime & (WHEEL_SLOTS - 1);
+        for(level = 1; uIndex == 0 && level < WHEEL_LEVELS; level++) {
+            uIndex = (oSymTable->wheelTime >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1);
+            timer = oSymTable->wheel[level][uIndex];
+            oSymTable->wheel[level][uIndex] = NULL;
+            for(; timer != NULL; timer = next) {
+                next = timer->next;
+                SymTable_timerAdd(oSymTable, timer);
+            }
+        }
+
+        /* every Timer left in the slot of this millisecond is due */
+        while((timer = oSymTable->wheel[0][oSymTable->wheelTime & (WHEEL_SLOTS - 1)]) != NULL) {
+            head = &oSymTable->buckets[timer->key->hash % oSymTable->bucketCount];
+            bucket = SymTable_bucketLocate(oSymTable, head, timer->key, &iSlot);
+            SymTable_expireBinding(oSymTable, head, bucket, iSlot);
+            uExpired++;
+        }
+        oSymTable->wheelTime++;
+    }
+    return uExpired;
+}
+
+int SymTable_loadFile(SymTable_T oSymTable, const char *pcPath, int iThreadCount,
+size_t *puLoaded) {
+    struct LoadChunk *psChunks;
+    pthread_t *psThreads;
+    struct stat sStat;
+    struct SymTableBucket *bucket;
+    struct ArenaBlock *block;
+    struct Key *key;
+    const char *pcMap;
+    const char *pcStart;
+    const char *pcEnd;
+    size_t uSize;
+    size_t u;
+    int iParsed = 1;
+    int iSuccessful;
+    int iSlot;
+    int iFile;
+    int i;
+    assert(oSymTable != NULL);
+    assert(pcPath != NULL);
+    assert(iThreadCount > 0);
+    assert(oSymTable->ops.pfFreeValue == NULL);
+    assert(oSymTable->depth == 0);
+    assert(!oSymTable->multi);
+
+    if(puLoaded != NULL) *puLoaded = 0;
+    iFile = open(pcPath, O_RDONLY);
+    if(iFile < 0) return 0;
+    if(fstat(iFile, &sStat) != 0) {
+        close(iFile);
+        return 0;
+    }
+    uSize = (size_t)sStat.st_size;
+    if(uSize == 0) {
+        close(iFile);
+        return 1;
+    }
+    pcMap = (const char*)mmap(NULL, uSize, PROT_READ, MAP_PRIVATE, iFile, 0);
+    close(iFile);
+    if(pcMap == (const char*)MAP_FAILED) return 0;
+    (void)posix_madvise((void*)pcMap, uSize, POSIX_MADV_SEQUENTIAL);
+
+    psChunks = (struct LoadChunk*)calloc((size_t)iThreadCount, sizeof(struct LoadChunk));
+    psThreads = (pthread_t*)malloc((size_t)iThreadCount * sizeof(pthread_t));
+    if(psChunks == NULL || psThreads == NULL) {
+        free(psChunks);
+        free(psThreads);
+        munmap((void*)pcMap, uSize);
+        return 0;
+    }
+
+    /* Each chunk ends after the first newline past its share of the file, and the chunks are
+       parsed at once. The first is parsed by the calling thread, as is any chunk whose thread
+       cannot be created. */
+    pcStart = pcMap;
+    for(i = 0; i < iThreadCount; i++) {
+        if(i == iThreadCount - 1) pcEnd = pcMap + uSize;
+        else {
+            pcEnd = pcMap + uSize / (size_t)iThreadCount * (size_t)(i + 1);
+            if(pcEnd < pcStart) pcEnd = pcStart;
+            pcEnd = (const char*)memchr(pcEnd, '\n', (size_t)(pcMap + uSize - pcEnd));
+            pcEnd = pcEnd == NULL ? pcMap + uSize : pcEnd + 1;
+        }
+        psChunks[i].oSymTable = oSymTable;
+        psChunks[i].pcStart = pcStart;
+        psChunks[i].pcEnd = pcEnd;
+        if(i > 0) psChunks[i].iThreaded =
+            pthread_create(&psThreads[i], NULL, SymTable_parseChunk, &psChunks[i]) == 0;
+        pcStart = pcEnd;
+    }
+    for(i = 0; i < iThreadCount; i++)
+        if(!psChunks[i].iThreaded) SymTable_parseChunk(&psChunks[i]);
+    for(i = 1; i < iThreadCount; i++)
+        if(psChunks[i].iThreaded) pthread_join(psThreads[i], NULL);
+    munmap((void*)pcMap, uSize);
+
+    for(i = 0; i < iThreadCount; i++) iParsed = iParsed && psChunks[i].iSuccessful;
+    iSuccessful = iParsed;
+    /* The Keys are linked in file order, so that the first line with a key binds it. */
+    for(i = 0; iSuccessful && i < iThreadCount; i++) {
+        for(u = 0; iSuccessful && u < psChunks[i].count; u++) {
+            key = psChunks[i].keys[u];
+            bucket = SymTable_lookup(oSymTable, &oSymTable->buckets[key->hash %
+                oSymTable->bucketCount], key->chars, key->length, key->hash, &iSlot);
+            if(bucket != NULL) continue;
+            iSuccessful = SymTable_link(oSymTable, key, key->chars + key->length + 1);
+            if(iSuccessful && puLoaded != NULL) (*puLoaded)++;
+        }
+    }
+
+    /* Once Keys have been linked the arenas of the chunks join the arena of oSymTable. */
+    for(i = 0; i < iThreadCount; i++) {
+        free(psChunks[i].keys);
+        if(!iParsed) SymTable_arenaFree(psChunks[i].arena);
+        else while(psChunks[i].arena != NULL) {
+            block = psChunks[i].arena;
+            psChunks[i].arena = block->next;
+            block->next = oSymTable->arena;
+            oSymTable->arena = block;
+        }
+    }
+    /* Keys loaded into Buckets a running compaction has passed are moved when it walks them
+       again. */
+    oSymTable->compactNext = 0;
+    free(psChunks);
+    free(psThreads);
+    return iSuccessful;
+}
+
+int SymTable_setAllocPolicy(SymTable_T oSymTable, int iFlags, int iNode) {
+    int oldFlags;
+    int oldNode;
+    assert(oSymTable != NULL);
+    assert((iFlags & ~(SYMTABLE_ALLOC_HUGE_PAGES | SYMTABLE_ALLOC_EXPLICIT_HUGE_PAGES |
+        SYMTABLE_ALLOC_NUMA_NODE)) == 0);
+    assert(!(iFlags & SYMTABLE_ALLOC_NUMA_NODE) || iNode >= 0);
+
+    oldFlags = oSymTable->allocFlags;
+    oldNode = oSymTable->allocNode;
+    oSymTable->allocFlags = iFlags;
+    oSymTable->allocNode = iNode;
+    /* the current Buckets move to an array allocated under the new policy */
+    if(!SymTable_resize(oSymTable, oSymTable->bucketCount)) {
+        oSymTable->allocFlags = oldFlags;
+        oSymTable->allocNode = oldNode;
+        return 0;
+    }
+    return 1;
+}
+
+size_t SymTable_memoryUsage(SymTable_T oSymTable, struct SymTableMemory *psUsage) {
+    struct SymTableMemory sUsage;
+    struct SymTableBucket *bucket;
+    struct ArenaBlock *block;
     size_t i;
-    struct Binding* tracer;
-    struct Binding* temp;
+    int j;
     assert(oSymTable != NULL);
-    
-    for(i = 0; i < oSymTable->max; i++) {
-        tracer = oSymTable->buckets[i];
-        while(tracer != NULL) {
-            temp = tracer->next;
-            free(tracer->key);
-            free(tracer);
-            tracer = temp;
+
+    sUsage.buckets = oSymTable->bucketBytes != 0 ? oSymTable->bucketBytes :
+        oSymTable->bucketCount * sizeof(struct SymTableBucket);
+    sUsage.nodes = 0;
+    sUsage.keys = 0;
+    sUsage.overhead = sizeof(struct SymTable) + oSymTable->shadowMax * sizeof(struct Shadow)
+        + oSymTable->depthMax * sizeof(size_t) + oSymTable->ringMax * sizeof(struct Key*);
+    if(oSymTable->spilled != NULL) sUsage.overhead += (oSymTable->bucketCount + 7) / 8;
+    if(oSymTable->wheel != NULL) sUsage.overhead += WHEEL_LEVELS * sizeof(*oSymTable->wheel);
+    if(oSymTable->log != NULL) sUsage.overhead += sizeof(struct Log) + LOG_BUFFER_SIZE
+        + oSymTable->log->sideMax;
+
+    for(i = 0; i < oSymTable->bucketCount; i++) {
+        for(bucket = &oSymTable->buckets[i]; bucket != NULL; bucket = bucket->overflow) {
+            if(bucket != &oSymTable->buckets[i]) sUsage.nodes += sizeof(struct SymTableBucket);
+            for(j = 0; j < bucket->count; j++) {
+                if(!bucket->keys[j]->inArena)
+                    sUsage.keys += sizeof(struct Key) + bucket->keys[j]->length + 1;
+                if(bucket->keys[j]->timer != NULL) sUsage.overhead += sizeof(struct Timer);
+            }
         }
     }
-    free(oSymTable->buckets);
-    free(oSymTable);
+    SymTable_treeUsage(oSymTable->tree, &sUsage);
+    for(block = oSymTable->arena; block != NULL; block = block->next)
+        sUsage.keys += sizeof(struct ArenaBlock) + block->capacity * sizeof(union ArenaWord);
+    for(block = oSymTable->compactArena; block != NULL; block = block->next)
+        sUsage.keys += sizeof(struct ArenaBlock) + block->capacity * sizeof(union ArenaWord);
+    if(oSymTable->multi) SymTable_eachKey(oSymTable, SymTable_countValues, &sUsage.keys);
+
+    if(psUsage != NULL) *psUsage = sUsage;
+    return sUsage.buckets + sUsage.nodes + sUsage.keys + sUsage.overhead;
 }
 
-size_t SymTable_getLength(SymTable_T oSymTable) {
+/* Return the number of bytes of the value of key, bound to value in oSymTable, including its
+'\0', if it follows the characters of key in an arena, or 0 otherwise. Only a table outside
+multimap mode loads or replays Keys, whose values follow their characters. */
+static size_t SymTable_ownedValueBytes(SymTable_T oSymTable, const struct Key *key,
+const void *value) {
+    if(!key->inArena || oSymTable->multi || value != (const void*)(key->chars + key->length + 1))
+        return 0;
+    return strlen((const char*)value) + 1;
+}
+
+/* Add the number of ArenaWords SymTable_moveKey needs to move key, bound to value, to the
+compactWords of the SymTable pvExtra. */
+static void SymTable_countMoved(const struct Key *key, void *value, void *pvExtra) {
+    SymTable_T oSymTable = (SymTable_T)pvExtra;
+    size_t uBytes = SymTable_keySize(oSymTable, key->length)
+        + SymTable_ownedValueBytes(oSymTable, key, value);
+    oSymTable->compactWords += (uBytes + sizeof(union ArenaWord) - 1) / sizeof(union ArenaWord);
+}
+
+/* Move key, bound to *pValue in oSymTable, into the arena of the running compaction unless it
+is there already, and point *pKey and the Timer and ring entry of key at the moved Key. The
+value of a Key loaded from a file or replayed from a log and the inline Values of a Key in
+multimap mode move with it, and *pValue follows them. A new block of the arena is sized for
+the Keys left to move, up to COMPACT_BLOCK_WORDS. Return 1 if successful or 0 if
+insufficient memory is available, in which case key stays where it is. */
+static int SymTable_moveKey(SymTable_T oSymTable, struct Key **pKey, void **pValue) {
+    struct Key *key = *pKey;
+    struct Key *moved;
+    size_t uBytes;
+    size_t uValueBytes;
+    size_t uWords;
+
+    if(key->inArena == 3 - oSymTable->arenaMark) return 1;
+    uBytes = SymTable_keySize(oSymTable, key->length);
+    uValueBytes = SymTable_ownedValueBytes(oSymTable, key, *pValue);
+    moved = (struct Key*)SymTable_arenaAlloc(&oSymTable->compactArena, uBytes + uValueBytes,
+        oSymTable->compactWords < COMPACT_BLOCK_WORDS ? oSymTable->compactWords :
+        COMPACT_BLOCK_WORDS);
+    if(moved == NULL) return 0;
+    uWords = (uBytes + uValueBytes + sizeof(union ArenaWord) - 1) / sizeof(union ArenaWord);
+    oSymTable->compactWords -= uWords < oSymTable->compactWords ? uWords :
+        oSymTable->compactWords;
+    memcpy(moved, key, uBytes + uValueBytes);
+    if(uValueBytes != 0) *pValue = moved->chars + moved->length + 1;
+    else if(oSymTable->multi && *pValue == (void*)SymTable_inlineValues(key))
+        *pValue = SymTable_inlineValues(moved);
+    if(key->timer != NULL) key->timer->key = moved;
+    if(oSymTable->capacity != 0) oSymTable->ring[key->ring] = moved;
+    moved->inArena = (unsigned char)(3 - oSymTable->arenaMark);
+    SymTable_freeKey(key);
+    *pKey = moved;
+    oSymTable->generation++;
+    return 1;
+}
+
+/* Move the Keys of the tree rooted at node of oSymTable as SymTable_moveKey does. Return 1 if
+successful or 0 if insufficient memory is available. */
+static int SymTable_treeCompact(SymTable_T oSymTable, struct TreeNode *node) {
+    for(; node != NULL; node = node->right)
+        if(!SymTable_treeCompact(oSymTable, node->left) ||
+            !SymTable_moveKey(oSymTable, &node->bucket.keys[0], &node->bucket.values[0]))
+            return 0;
+    return 1;
+}
+
+int SymTable_compactStep(SymTable_T oSymTable, size_t uBudget) {
+    struct SymTableBucket *bucket;
+    size_t uVisited = 0;
+    int j;
     assert(oSymTable != NULL);
-    return oSymTable->length;
+    assert(oSymTable->depth == 0);
+
+    if(!oSymTable->compacting) {
+        oSymTable->compacting = 1;
+        oSymTable->compactNext = 0;
+        oSymTable->compactWords = 0;
+        SymTable_eachKey(oSymTable, SymTable_countMoved, oSymTable);
+    }
+    /* A chain is moved whole, so that the Keys of a Bucket lie next to each other. */
+    while(oSymTable->compactNext < oSymTable->bucketCount) {
+        if(uBudget != 0 && uVisited >= uBudget) return 0;
+        for(bucket = &oSymTable->buckets[oSymTable->compactNext]; bucket != NULL;
+            bucket = bucket->overflow) {
+            for(j = 0; j < bucket->count; j++)
+                if(!SymTable_moveKey(oSymTable, &bucket->keys[j], &bucket->values[j])) return -1;
+            uVisited += (size_t)bucket->count;
+        }
+        oSymTable->compactNext++;
+    }
+    if(!SymTable_treeCompact(oSymTable, oSymTable->tree)) return -1;
+
+    /* Every Key has left the old arena, taking along any value that lay in it. */
+    SymTable_arenaFree(oSymTable->arena);
+    oSymTable->arena = oSymTable->compactArena;
+    oSymTable->compactArena = NULL;
+    oSymTable->arenaMark = (unsigned char)(3 - oSymTable->arenaMark);
+    oSymTable->compacting = 0;
+#ifdef __GLIBC__
+    /* hand the pages freed by the moves back to the system */
+    (void)malloc_trim(0);
+#endif
+    return 1;
 }
 
-int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
-    struct Binding *newEntry;
-    size_t hash;
+int SymTable_compact(SymTable_T oSymTable) {
     assert(oSymTable != NULL);
-    assert(pcKey != NULL);
-    
-    if(SymTable_contains(oSymTable, pcKey)) return 0;
+    return SymTable_compactStep(oSymTable, 0) == 1;
+}
+
+int SymTable_openLog(SymTable_T oSymTable, const char *pcPath, size_t uGroupSize,
+size_t uCompactRatio) {
+    struct Log *psLog;
+    struct stat sStat;
+    const char *pcMap;
+    size_t uSize;
+    size_t uValid = 0;
+    int iSuccessful = 1;
+    int iFile;
+    assert(oSymTable != NULL);
+    assert(pcPath != NULL);
+    assert(uGroupSize > 0);
+    assert(oSymTable->log == NULL);
+    assert(!oSymTable->multi);
+    assert(oSymTable->length == 0);
+    assert(oSymTable->ops.pfFreeValue == NULL);
+    assert(oSymTable->capacity == 0);
+    assert(oSymTable->depth == 0);
 
-    newEntry = (struct Binding*)malloc(sizeof(struct Binding));
-    if (newEntry == NULL) return 0;
-    newEntry->key = (char*)malloc(strlen(pcKey) + 1);
-    if (newEntry->key == NULL) {
-        free(newEntry);
+    psLog = (struct Log*)calloc(1, sizeof(struct Log));
+    if(psLog == NULL) return 0;
+    psLog->path = (char*)malloc(strlen(pcPath) + 1);
+    psLog->compactPath = (char*)malloc(strlen(pcPath) + sizeof(".compact"));
+    psLog->buffer = (char*)malloc(LOG_BUFFER_SIZE);
+    if(psLog->path == NULL || psLog->compactPath == NULL || psLog->buffer == NULL) {
+        SymTable_logFree(psLog);
         return 0;
     }
+    strcpy(psLog->path, pcPath);
+    strcpy(psLog->compactPath, pcPath);
+    strcat(psLog->compactPath, ".compact");
 
-    if(oSymTable->length == oSymTable->max) SymTable_expand(oSymTable);
-    hash = SymTable_hash(pcKey, oSymTable->max);
-    
-    strcpy((char*)newEntry->key, pcKey);
-    newEntry->value = (void*)pvValue;
+    iFile = open(pcPath, O_RDWR | O_CREAT, 0666);
+    if(iFile < 0 || fstat(iFile, &sStat) != 0) {
+        if(iFile >= 0) close(iFile);
+        SymTable_logFree(psLog);
+        return 0;
+    }
+    uSize = (size_t)sStat.st_size;
+    /* A file that was just created is empty, and only lasts through a crash once its
+       directory has been synced. */
+    if(uSize == 0) iSuccessful = SymTable_syncDirectory(pcPath);
+    else {
+        pcMap = (const char*)mmap(NULL, uSize, PROT_READ, MAP_PRIVATE, iFile, 0);
+        if(pcMap == (const char*)MAP_FAILED) iSuccessful = 0;
+        else {
+            (void)posix_madvise((void*)pcMap, uSize, POSIX_MADV_SEQUENTIAL);
+            uValid = SymTable_replay(oSymTable, pcMap, uSize, &iSuccessful);
+            munmap((void*)pcMap, uSize);
+        }
+    }
+    /* a torn or corrupt record ends the log, and later appends overwrite it */
+    if(iSuccessful && uValid < uSize) iSuccessful = ftruncate(iFile, (off_t)uValid) == 0;
+    if(iSuccessful) iSuccessful = lseek(iFile, 0, SEEK_END) >= 0;
+    if(iSuccessful) iSuccessful = pthread_mutex_init(&psLog->mutex, NULL) == 0;
+    if(!iSuccessful) {
+        close(iFile);
+        SymTable_logFree(psLog);
+        SymTable_clear(oSymTable);
+        return 0;
+    }
 
-    newEntry->next = oSymTable->buckets[hash];
-    oSymTable->buckets[hash] = newEntry;
-    oSymTable->length++;
+    psLog->file = iFile;
+    psLog->groupSize = uGroupSize;
+    psLog->compactRatio = uCompactRatio;
+    psLog->fileBytes = uValid;
+    SymTable_eachKey(oSymTable, SymTable_countRecord, &psLog->liveBytes);
+    oSymTable->log = psLog;
     return 1;
 }
 
-void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
-    void *output;
+int SymTable_sync(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->log != NULL);
+    SymTable_logCommit(oSymTable);
+    return !oSymTable->log->failed;
+}
+
+void SymTable_getLogStats(SymTable_T oSymTable, size_t *puLogged, size_t *puWritten,
+size_t *puSyncs, size_t *puCompactions) {
+    assert(oSymTable != NULL);
+    assert(oSymTable->log != NULL);
+    if(puLogged != NULL) *puLogged = oSymTable->log->payloadBytes;
+    if(puWritten != NULL) *puWritten = oSymTable->log->writtenBytes;
+    if(puSyncs != NULL) *puSyncs = oSymTable->log->syncs;
+    if(puCompactions != NULL) *puCompactions = oSymTable->log->compactions;
+}
+
+int SymTable_merge(SymTable_T oSymTable, SymTable_T oSource) {
+    struct SetOp sOp;
+    assert(oSymTable != NULL);
+    assert(oSource != NULL);
+    assert(oSymTable != oSource);
+    assert(oSymTable->depth == 0);
+    assert(oSource->depth == 0);
+    assert(oSource->capacity == 0);
+    assert(oSource->timerCount == 0);
+    assert(oSymTable->multi == oSource->multi);
+
+    sOp.oOther = oSymTable;
+    sOp.iLeaveFound = 0;
+    sOp.pfRemoved = NULL;
+    sOp.pvExtra = NULL;
+    sOp.count = 0;
+    sOp.failed = 0;
+    SymTable_sweep(oSource, SymTable_moveBinding, &sOp);
+    return !sOp.failed;
+}
+
+size_t SymTable_intersect(SymTable_T oSymTable, SymTable_T oOther,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    struct SetOp sOp;
+    assert(oSymTable != NULL);
+    assert(oOther != NULL);
+    assert(oSymTable != oOther);
+    assert(oSymTable->depth == 0);
+
+    sOp.oOther = oOther;
+    sOp.iLeaveFound = 0;
+    sOp.pfRemoved = pfRemoved;
+    sOp.pvExtra = (void*)pvExtra;
+    sOp.count = 0;
+    sOp.failed = 0;
+    SymTable_sweep(oSymTable, SymTable_dropBinding, &sOp);
+    return sOp.count;
+}
+
+size_t SymTable_diff(SymTable_T oSymTable, SymTable_T oOther,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    struct SetOp sOp;
+    assert(oSymTable != NULL);
+    assert(oOther != NULL);
+    assert(oSymTable != oOther);
+    assert(oSymTable->depth == 0);
+
+    sOp.oOther = oOther;
+    sOp.iLeaveFound = 1;
+    sOp.pfRemoved = pfRemoved;
+    sOp.pvExtra = (void*)pvExtra;
+    sOp.count = 0;
+    sOp.failed = 0;
+    SymTable_sweep(oSymTable, SymTable_dropBinding, &sOp);
+    return sOp.count;
+}
+
+size_t SymTable_removeIf(SymTable_T oSymTable,
+int (*pfPredicate)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    struct RemoveIf sCall;
+    assert(oSymTable != NULL);
+    assert(pfPredicate != NULL);
+    assert(oSymTable->depth == 0);
+
+    sCall.pfPredicate = pfPredicate;
+    sCall.pvExtra = (void*)pvExtra;
+    sCall.count = 0;
+    SymTable_sweep(oSymTable, SymTable_dropSelected, &sCall);
+    return sCall.count;
+}
+
+int SymTable_removeIfParallel(SymTable_T oSymTable,
+int (*pfPredicate)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra,
+int iThreadCount, size_t *puRemoved) {
+    struct Sweeper *psSweepers;
+    pthread_t *psThreads;
+    struct RemoveIf sCall;
+    size_t uRatio = 0;
+    size_t u;
+    int iSuccessful = 1;
+    int i;
+    assert(oSymTable != NULL);
+    assert(pfPredicate != NULL);
+    assert(iThreadCount > 0);
+    assert(oSymTable->depth == 0);
+
+    if(puRemoved != NULL) *puRemoved = 0;
+    psSweepers = (struct Sweeper*)calloc((size_t)iThreadCount, sizeof(struct Sweeper));
+    psThreads = (pthread_t*)malloc((size_t)iThreadCount * sizeof(pthread_t));
+    if(psSweepers == NULL || psThreads == NULL) {
+        free(psSweepers);
+        free(psThreads);
+        return 0;
+    }
+    sCall.pfPredicate = pfPredicate;
+    sCall.pvExtra = (void*)pvExtra;
+    sCall.count = 0;
+    /* A compaction started in the middle would see a half swept table. */
+    if(oSymTable->log != NULL) {
+        uRatio = oSymTable->log->compactRatio;
+        oSymTable->log->compactRatio = 0;
+    }
+
+    /* Each thread sweeps an equal share of the Buckets. The first share is swept by the
+       calling thread, as is any share whose thread cannot be created. */
+    for(i = 0; i < iThreadCount; i++) {
+        psSweepers[i].oSymTable = oSymTable;
+        psSweepers[i].first = oSymTable->bucketCount * (size_t)i / (size_t)iThreadCount;
+        psSweepers[i].end = oSymTable->bucketCount * (size_t)(i + 1) / (size_t)iThreadCount;
+        psSweepers[i].call = sCall;
+        if(i > 0) psSweepers[i].threaded =
+            pthread_create(&psThreads[i], NULL, SymTable_sweepShare, &psSweepers[i]) == 0;
+    }
+    for(i = 0; i < iThreadCount; i++)
+        if(!psSweepers[i].threaded) SymTable_sweepShare(&psSweepers[i]);
+    for(i = 1; i < iThreadCount; i++)
+        if(psSweepers[i].threaded) pthread_join(psThreads[i], NULL);
+
+    /* The ring, the timer wheel, the log and the value-free function are not shared, so the
+       bindings taken out are dropped by the calling thread, which sweeps the tree as well. */
+    for(i = 0; i < iThreadCount; i++) {
+        for(u = 0; u < psSweepers[i].count; u++) {
+            SymTable_dropKey(oSymTable, psSweepers[i].keys[u], psSweepers[i].values[u]);
+            SymTable_freeKey(psSweepers[i].keys[u]);
+        }
+        sCall.count += psSweepers[i].count;
+        iSuccessful = iSuccessful && !psSweepers[i].failed;
+        free(psSweepers[i].keys);
+        free(psSweepers[i].values);
+    }
+    oSymTable->tree = SymTable_treeSweep(oSymTable, oSymTable->tree, NULL,
+        SymTable_dropSelected, &sCall);
+    if(oSymTable->log != NULL) oSymTable->log->compactRatio = uRatio;
+
+    free(psSweepers);
+    free(psThreads);
+    if(puRemoved != NULL) *puRemoved = sCall.count;
+    return iSuccessful;
+}
+
+SymTable_T SymTable_newMulti(const struct SymTableOps *psOps) {
+    SymTable_T newHashTable = SymTable_new();
+    if(newHashTable == NULL) return NULL;
+    if(psOps != NULL) newHashTable->ops = *psOps;
+    newHashTable->multi = 1;
+    return newHashTable;
+}
+
+int SymTable_putMulti(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    struct SymTableBucket *bucket;
+    struct Values *values;
+    struct Values *newValues;
+    size_t uLength;
     size_t hash;
-    struct Binding *trace;
+    int iSlot;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    
-    hash = SymTable_hash(pcKey, oSymTable->max);
-    trace = oSymTable->buckets[hash];
-    if(trace == NULL) return NULL;
-    
-    while(trace != NULL) {
-        if(!strcmp(trace->key,pcKey)) {
-            output = trace->value;
-            trace->value = (void*)pvValue;
-            return output;
+    assert(oSymTable->multi);
+
+    uLength = strlen(pcKey);
+    hash = SymTable_hashKey(oSymTable, pcKey, uLength);
+    bucket = SymTable_lookup(oSymTable, &oSymTable->buckets[hash % oSymTable->bucketCount], pcKey,
+        uLength, hash, &iSlot);
+    if(bucket == NULL) return SymTable_bindNew(oSymTable, pcKey, uLength, hash, pvValue);
+
+    values = (struct Values*)bucket->values[iSlot];
+    if(values->count == values->max) {
+        /* the values move out of the Key once, and are reallocated from then on */
+        if(values == SymTable_inlineValues(bucket->keys[iSlot])) {
+            newValues = (struct Values*)malloc(sizeof(struct Values)
+                + 2 * values->max * sizeof(void*));
+            if(newValues == NULL) return 0;
+            memcpy(newValues->items, values->items, values->count * sizeof(void*));
+            newValues->count = values->count;
         }
-        trace = trace->next;
+        else {
+            newValues = (struct Values*)realloc(values, sizeof(struct Values)
+                + 2 * values->max * sizeof(void*));
+            if(newValues == NULL) return 0;
+        }
+        newValues->max = 2 * values->max;
+        values = newValues;
+        bucket->values[iSlot] = values;
     }
-    return NULL;
+    values->items[values->count++] = (void*)pvValue;
+    return 1;
 }
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+void *const *SymTable_getAll(SymTable_T oSymTable, const char *pcKey, size_t *puCount) {
+    struct SymTableBucket *bucket;
+    struct Values *values;
+    size_t uLength;
     size_t hash;
-    struct Binding *trace;
+    int iSlot;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    hash = SymTable_hash(pcKey, oSymTable->max);
-    trace = oSymTable->buckets[hash];
+    assert(puCount != NULL);
+    assert(oSymTable->multi);
 
-    if(trace == NULL) return 0;
-    while(trace != NULL) {
-        if(!strcmp(trace->key,pcKey)) return 1;
-        trace = trace->next;
+    uLength = strlen(pcKey);
+    hash = SymTable_hashKey(oSymTable, pcKey, uLength);
+    bucket = SymTable_lookup(oSymTable, &oSymTable->buckets[hash % oSymTable->bucketCount], pcKey,
+        uLength, hash, &iSlot);
+    if(bucket == NULL) {
+        oSymTable->misses++;
+        *puCount = 0;
+        return NULL;
     }
-    return 0;
+    oSymTable->hits++;
+    values = (struct Values*)bucket->values[iSlot];
+    *puCount = values->count;
+    return values->items;
 }
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+int SymTable_removeOne(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    struct SymTableBucket *head;
+    struct SymTableBucket *bucket;
+    struct Values *values;
+    size_t uLength;
     size_t hash;
-    struct Binding *tracer;
+    size_t u;
+    int iSlot;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    hash = SymTable_hash(pcKey, oSymTable->max);
-    tracer = oSymTable->buckets[hash];
-    if(tracer == NULL) return NULL;
-    
-    while(tracer != NULL) {
-        if(!strcmp(tracer->key,pcKey)) return tracer->value;
-        tracer = tracer->next;
+    assert(oSymTable->multi);
+
+    uLength = strlen(pcKey);
+    hash = SymTable_hashKey(oSymTable, pcKey, uLength);
+    head = &oSymTable->buckets[hash % oSymTable->bucketCount];
+    bucket = SymTable_lookup(oSymTable, head, pcKey, uLength, hash, &iSlot);
+    if(bucket == NULL) return 0;
+    values = (struct Values*)bucket->values[iSlot];
+    for(u = 0; u < values->count && values->items[u] != pvValue; u++);
+    if(u == values->count) return 0;
+
+    if(values->count == 1) {
+        SymTable_releaseAll(oSymTable, bucket->keys[iSlot], values);
+        SymTable_unbind(oSymTable, head, bucket, iSlot);
+        return 1;
     }
-    return NULL;
+    /* the values after the one removed move down, so the rest keep their order */
+    memmove(&values->items[u], &values->items[u + 1], (values->count - u - 1) * sizeof(void*));
+    values->count--;
+    SymTable_release(oSymTable, (void*)pvValue);
+    return 1;
 }
 
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
-    void *output;
+int SymTable_find(SymTable_T oSymTable, const char *pcKey, struct SymTableHandle *psHandle) {
+    struct SymTableBucket *bucket;
+    size_t uLength;
     size_t hash;
-    struct Binding* tracer1; 
-    struct Binding* tracer2;
-    
+    int iSlot;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
+    assert(psHandle != NULL);
 
-    hash = SymTable_hash(pcKey, oSymTable->max);
-    tracer1 = oSymTable->buckets[hash]; 
-    if(tracer1 == NULL) return NULL;
-    tracer2 = tracer1->next;
-
-    if(!strcmp(tracer1->key,pcKey)) {
-        output = tracer1->value;
-        oSymTable->buckets[hash] = tracer2;
-        free(tracer1->key);
-        free(tracer1);
-        oSymTable->length--;
-        return output;
+    uLength = strlen(pcKey);
+    hash = SymTable_hashKey(oSymTable, pcKey, uLength);
+    bucket = SymTable_lookup(oSymTable, &oSymTable->buckets[hash % oSymTable->bucketCount], pcKey,
+        uLength, hash, &iSlot);
+    psHandle->key = NULL;
+    if(bucket == NULL) {
+        oSymTable->misses++;
+        return 0;
     }
+    oSymTable->hits++;
+    bucket->keys[iSlot]->referenced = 1;
+    psHandle->key = bucket->keys[iSlot];
+    psHandle->bucket = bucket;
+    psHandle->slot = iSlot;
+    psHandle->generation = oSymTable->generation;
+    psHandle->resizes = oSymTable->resizes;
+    return 1;
+}
 
-    while(tracer2 != NULL) {
-        if(!strcmp(tracer2->key,pcKey)) {
-            output = tracer2->value;
-            tracer1->next = tracer2->next;
-            free(tracer2->key);
-            free(tracer2);
-            oSymTable->length--;
-            return output;
-        }
-        tracer1 = tracer2;
-        tracer2 = tracer2->next;
-    }
-    return NULL;
+int SymTable_handleIsValid(SymTable_T oSymTable, struct SymTableHandle *psHandle) {
+    struct SymTableBucket *head;
+    int iSlot;
+    assert(oSymTable != NULL);
+    assert(psHandle != NULL);
+    return SymTable_resolve(oSymTable, psHandle, &head, &iSlot) != NULL;
 }
 
-void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), 
-const void *pvExtra) {
-    size_t i;
-    struct Binding* bucketTracer;
+void *SymTable_handleValue(SymTable_T oSymTable, struct SymTableHandle *psHandle) {
+    struct SymTableBucket *head;
+    struct SymTableBucket *bucket;
+    int iSlot;
     assert(oSymTable != NULL);
-    assert(pfApply != NULL);
-    for(i = 0; i < oSymTable->max; i++) {
-        bucketTracer = oSymTable->buckets[i];
-        while(bucketTracer != NULL) {
-            pfApply((const char*)bucketTracer->key, (void*)bucketTracer->value, (void*)pvExtra);
-            bucketTracer = bucketTracer->next;
-        }
-    }
-}
\ No newline at end of file
+    assert(psHandle != NULL);
+
+    bucket = SymTable_resolve(oSymTable, psHandle, &head, &iSlot);
+    if(bucket == NULL) return NULL;
+    bucket->keys[iSlot]->referenced = 1;
+    if(oSymTable->multi) return ((struct Values*)bucket->values[iSlot])->items[0];
+    return bucket->values[iSlot];
+}
+
+void *SymTable_handleSet(SymTable_T oSymTable, struct SymTableHandle *psHandle,
+const void *pvValue) {
+    struct SymTableBucket *head;
+    struct SymTableBucket *bucket;
+    int iSlot;
+    assert(oSymTable != NULL);
+    assert(psHandle != NULL);
+    assert(!oSymTable->multi);
+
+    bucket = SymTable_resolve(oSymTable, psHandle, &head, &iSlot);
+    if(bucket == NULL) return NULL;
+    return SymTable_replaceAt(oSymTable, bucket, iSlot, pvValue);
+}
+
+void *SymTable_handleRemove(SymTable_T oSymTable, struct SymTableHandle *psHandle) {
+    struct SymTableBucket *head;
+    struct SymTableBucket *bucket;
+    int iSlot;
+    assert(oSymTable != NULL);
+    assert(psHandle != NULL);
+
+    bucket = SymTable_resolve(oSymTable, psHandle, &head, &iSlot);
+    psHandle->key = NULL;
+    if(bucket == NULL) return NULL;
+    return SymTable_removeAt(oSymTable, head, bucket, iSlot);
+}
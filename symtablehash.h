@@ -0,0 +1,231 @@
+/******************************************************************/
+/* symtablehash.h                                                 */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#ifndef SYMTABLEHASH_INCLUDED
+#define SYMTABLEHASH_INCLUDED
+#include <stdint.h>
+#include "symtable.h"
+
+/* The functions below are provided only by symtablehash.c. */
+
+/* Returns a new SymTable object with no bindings whose keys are hashed with the 128 bit key
+uSeed0, uSeed1, or NULL if insufficient memory is available. SymTable_new chooses that key at
+random for each SymTable, so that the buckets keys fall into cannot be predicted; a fixed one
+makes the layout of a SymTable reproducible, and should only be used where keys cannot be
+chosen by an attacker. */
+SymTable_T SymTable_newWithSeed(uint64_t uSeed0, uint64_t uSeed1);
+
+/* Opens a new innermost scope in oSymTable, which must not be bounded or have bindings that
+expire. Until the matching SymTable_exitScope, a SymTable_put of a key that is bound in an
+enclosing scope succeeds and shadows that binding, while a key that is already bound in the
+innermost scope is still rejected. Lookups always see the innermost binding of a key and take
+one probe whatever the depth, and SymTable_remove removes the innermost binding, uncovering
+the one it shadowed. Returns 1 if successful or 0 if insufficient memory is available. */
+int SymTable_enterScope(SymTable_T oSymTable);
+
+/* Closes the innermost scope of oSymTable, which must have one open. The bindings made in
+that scope are removed and the ones they shadowed become visible again, in time proportional
+to the number of bindings made in the scope. The values of those bindings are released as
+SymTable_remove releases them. SymTable_replace changes the visible binding and is not
+undone. */
+void SymTable_exitScope(SymTable_T oSymTable);
+
+/* Returns the number of scopes open in oSymTable */
+size_t SymTable_getScopeDepth(SymTable_T oSymTable);
+
+/* Returns a new SymTable object with no bindings that holds at most uCapacity bindings, or
+NULL if insufficient memory is available. uCapacity must be positive. When SymTable_put adds
+a key to a SymTable that is full, a binding that has not been used recently is evicted: it
+is removed and (*pfEvict)(pcKey, pvValue, pvExtra) is called with it first, unless pfEvict
+is NULL, so that the caller can free pvValue if the SymTable does not release its values.
+pcKey is only valid during the call. A binding is used when SymTable_get finds it or
+SymTable_replace changes it. Eviction takes amortized constant time. */
+SymTable_T SymTable_newBounded(size_t uCapacity,
+void (*pfEvict)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra);
+
+/* Stores in *puHits and *puMisses the number of calls of SymTable_get on oSymTable that did
+and did not find their key, and in *puEvictions the number of bindings oSymTable has
+evicted. Any of the pointers may be NULL. */
+void SymTable_getCacheStats(SymTable_T oSymTable, size_t *puHits, size_t *puMisses,
+size_t *puEvictions);
+
+/* Makes oSymTable read the current time, in milliseconds, from (*pfNow)(pvExtra) instead of
+the monotonic clock of the system. pfNow may be NULL to go back to that clock. No binding of
+oSymTable may have an expiry time yet. */
+void SymTable_setClock(SymTable_T oSymTable, unsigned long (*pfNow)(void *pvExtra),
+const void *pvExtra);
+
+/* Makes oSymTable call (*pfExpire)(pcKey, pvValue, pvExtra) with each binding it removes
+because the binding expired, so that the caller can free pvValue if oSymTable does not
+release its values. pcKey is only valid during the call. pfExpire may be NULL. */
+void SymTable_setExpireHandler(SymTable_T oSymTable,
+void (*pfExpire)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra);
+
+/* Makes the binding of pcKey in oSymTable expire ulLifetime milliseconds from now, replacing
+any expiry time it had. oSymTable must have no open scope. Once a binding has expired every
+function treats it as absent, and the first one to find it removes it; SymTable_getLength and
+SymTable_map still count and visit it until then. Returns 1 if successful or 0 if pcKey is not
+in oSymTable or insufficient memory is available. */
+int SymTable_setExpiry(SymTable_T oSymTable, const char *pcKey, unsigned long ulLifetime);
+
+/* Removes every binding of oSymTable that has expired and returns how many were removed. The
+expiry times are kept in a hierarchical timer wheel, so the time taken is proportional to the
+number of bindings removed and the milliseconds elapsed since the last call, not to the
+number of bindings in oSymTable. */
+size_t SymTable_expire(SymTable_T oSymTable);
+
+/* Adds to oSymTable a binding for each line of the file at pcPath, whose key is the text of
+the line before its first tab and whose value is a '\0' terminated copy of the text after it,
+or "" if the line has no tab. Line ends may be "\n" or "\r\n", and empty lines are skipped.
+A key already bound in oSymTable, or bound by an earlier line, is skipped. The file is mapped
+into memory and split into iThreadCount chunks that as many threads parse and hash at once;
+the bindings are then added by the calling thread. Keys and values are copied once, into
+large blocks that oSymTable frees when it is cleared or freed, not when a binding is removed.
+oSymTable must have no value-free function and no open scope. Stores the number of bindings
+added in *puLoaded unless puLoaded is NULL. Returns 1 if successful, or 0 if the file cannot
+be read or insufficient memory is available, in which case only some lines may have been
+added. */
+int SymTable_loadFile(SymTable_T oSymTable, const char *pcPath, int iThreadCount,
+size_t *puLoaded);
+
+/* the flags of an allocation policy: back bucket arrays with transparent huge pages, try
+reserved huge pages first, and bind bucket arrays to one NUMA node */
+enum {SYMTABLE_ALLOC_HUGE_PAGES = 1, SYMTABLE_ALLOC_EXPLICIT_HUGE_PAGES = 2,
+    SYMTABLE_ALLOC_NUMA_NODE = 4};
+
+/* Makes oSymTable allocate its bucket arrays under the policy iFlags, a combination of the
+SYMTABLE_ALLOC flags, and moves its current Buckets to an array allocated that way. With any
+flag, a bucket array of at least half a huge page is mapped on its own, rounded up to whole huge
+pages, and advised to be backed by transparent huge pages, which cuts the TLB entries a
+lookup needs. With SYMTABLE_ALLOC_EXPLICIT_HUGE_PAGES it is taken from the reserved huge
+pages first, and with SYMTABLE_ALLOC_NUMA_NODE its pages are bound to NUMA node iNode. Each
+of these is a request that the system may not grant, in which case ordinary pages are used.
+Smaller arrays and the Keys and overflow Buckets of bindings are allocated as before. 0
+restores the default policy. Returns 1 if successful or 0 if insufficient memory is
+available, in which case the policy is unchanged. */
+int SymTable_setAllocPolicy(SymTable_T oSymTable, int iFlags, int iNode);
+
+/* Makes the empty oSymTable durable: loads the bindings recorded in the log file at pcPath,
+creating it if needed, and from then on appends a record of each change that SymTable_put,
+SymTable_replace, SymTable_remove, SymTable_clear and SymTable_loadFile make to it. Values
+must be '\0' terminated strings, and the log records their characters. Records are buffered,
+and the file is written and synced once every uGroupSize records, by SymTable_sync and by
+SymTable_free, so a crash loses at most the changes since the last sync. A record torn by a
+crash, and everything after it, is dropped when the log is loaded. If uCompactRatio is not 0,
+once the file is that many times the size of the live bindings' records, their records are
+written to a new file by a thread of its own, which then replaces the old file. The values
+loaded are copied into blocks that oSymTable frees when it is cleared or freed. oSymTable
+must have no value-free function, no capacity and no open scope, and neither scopes nor expiry
+times may be used with it. Returns 1 if successful, or 0 if the file cannot be read or
+written or insufficient memory is available, in which case oSymTable is left empty. */
+int SymTable_openLog(SymTable_T oSymTable, const char *pcPath, size_t uGroupSize,
+size_t uCompactRatio);
+
+/* Writes the buffered records of the log of oSymTable to its file and syncs it. Returns 1 if
+every record appended so far reached the file, or 0 if a write or sync has failed. */
+int SymTable_sync(SymTable_T oSymTable);
+
+/* Stores, unless the pointer is NULL, the number of bytes of keys and values recorded in the
+log of oSymTable in *puLogged, the number of bytes written to its files, compactions
+included, in *puWritten, the number of times they were synced in *puSyncs, and the number of
+compactions that replaced the file in *puCompactions. */
+void SymTable_getLogStats(SymTable_T oSymTable, size_t *puLogged, size_t *puWritten,
+size_t *puSyncs, size_t *puCompactions);
+
+
+/* Returns a new SymTable object with no bindings in multimap mode that uses the functions of
+*psOps, or the built-in ones if psOps is NULL, or NULL if insufficient memory is available. In
+multimap mode a key is bound to one or more values, kept in the order they were added and
+stored together with the key, so that all of them are found with one lookup. SymTable_put binds
+a key that is not bound to its first value, SymTable_get returns the first value of a key,
+SymTable_remove removes a key with all of its values and returns the first, and SymTable_map,
+SymTable_intersect and SymTable_diff pass each value of a key on its own. SymTable_getLength
+counts keys, and a value-free function is called once for each value. SymTable_replace,
+SymTable_enterScope, SymTable_setExpiry, SymTable_loadFile and SymTable_openLog may not be
+used, and SymTable_merge only merges two SymTables in multimap mode, leaving in the source the
+values of keys that both bind. */
+SymTable_T SymTable_newMulti(const struct SymTableOps *psOps);
+
+/* Adds pvValue to the values of pcKey in oSymTable, which must be in multimap mode, after
+those it has, binding pcKey if it is not bound. A key may be given the same value more than
+once. Returns 1 if successful or 0 if insufficient memory is available. */
+int SymTable_putMulti(SymTable_T oSymTable, const char *pcKey, const void *pvValue);
+
+/* Returns the values of pcKey in oSymTable, which must be in multimap mode, as an array of
+*puCount values in the order they were added, or NULL with *puCount set to 0 if pcKey is not
+bound. The array is only valid until oSymTable is next changed. */
+void *const *SymTable_getAll(SymTable_T oSymTable, const char *pcKey, size_t *puCount);
+
+/* Removes the first of the values of pcKey in oSymTable, which must be in multimap mode, that
+is pvValue, releasing it as SymTable_remove would, and removes pcKey with its last value.
+Returns 1 if a value was removed or 0 if pcKey is not bound or pvValue is not among its
+values. */
+int SymTable_removeOne(SymTable_T oSymTable, const char *pcKey, const void *pvValue);
+
+/* Does part of the work of SymTable_compact: moves the keys of the chains of oSymTable, a
+whole chain at a time, until uBudget bindings have been visited, or all of them if uBudget is
+0, starting a compaction if none is running and finishing it once every chain has been walked,
+when the keys of the tree move as well. oSymTable may be used and changed between steps, but
+must have no open scope during one. Returns 1 if the compaction has finished, 0 if it has more
+work left and -1 if insufficient memory is available, in which case the next step tries
+again. */
+int SymTable_compactStep(SymTable_T oSymTable, size_t uBudget);
+
+/* struct SymTableHandle refers to one binding of a SymTable, so that the binding can be read,
+changed and removed again without hashing its key or walking its chain. SymTable_find fills
+it in; its members are private to symtablehash.c. */
+struct SymTableHandle {
+    /* the Key of the binding, or NULL if the handle refers to none */
+    void *key;
+    /* the Bucket that held the binding when the handle was last used */
+    void *bucket;
+    /* the slot of the binding in bucket */
+    int slot;
+    /* the number of removals from the SymTable when the handle was made */
+    size_t generation;
+    /* the number of times the Buckets of the SymTable had moved when bucket was found */
+    size_t resizes;
+};
+
+/* Makes *psHandle refer to the binding of pcKey in oSymTable and returns 1, counting a use of
+the binding as SymTable_get does, or makes it refer to none and returns 0 if pcKey is not
+bound. The handle stays valid while bindings are added and while oSymTable expands, and the
+functions below find the binding again in constant time. Any removal of a binding from
+oSymTable, by SymTable_remove, eviction, expiry, SymTable_exitScope, SymTable_clear or the
+set operations, and SymTable_compact or SymTable_compactStep, invalidates every handle made
+before it, as the functions below detect. */
+int SymTable_find(SymTable_T oSymTable, const char *pcKey, struct SymTableHandle *psHandle);
+
+/* Returns 1 if *psHandle, made by SymTable_find on oSymTable, is still valid, and 0 if it
+refers to no binding or has been invalidated. A binding that has expired is removed, and 0
+is returned for it. */
+int SymTable_handleIsValid(SymTable_T oSymTable, struct SymTableHandle *psHandle);
+
+/* Returns the value of the binding *psHandle refers to in oSymTable, or its first value in
+multimap mode, counting a use of the binding, or NULL if *psHandle is not valid. */
+void *SymTable_handleValue(SymTable_T oSymTable, struct SymTableHandle *psHandle);
+
+/* Changes the value of the binding *psHandle refers to in oSymTable, which must not be in
+multimap mode, to pvValue as SymTable_replace does, and returns the old value, or returns NULL
+if *psHandle is not valid. */
+void *SymTable_handleSet(SymTable_T oSymTable, struct SymTableHandle *psHandle,
+const void *pvValue);
+
+/* Removes the binding *psHandle refers to from oSymTable as SymTable_remove does, returns its
+value and makes *psHandle refer to no binding, or returns NULL if *psHandle is not valid. */
+void *SymTable_handleRemove(SymTable_T oSymTable, struct SymTableHandle *psHandle);
+
+/* Removes from oSymTable each binding for which (*pfPredicate)(pcKey, pvValue, pvExtra)
+returns nonzero, as SymTable_removeIf does, with iThreadCount threads that each sweep an equal
+share of the Buckets at once, so pfPredicate must be safe to call from several threads. The
+bindings kept in the tree are swept, and those selected are counted out and their values
+released, by the calling thread. Stores the number of bindings removed in *puRemoved unless
+puRemoved is NULL. Returns 1 if successful or 0 if insufficient memory is available, in which
+case some of the bindings pfPredicate selected may remain. */
+int SymTable_removeIfParallel(SymTable_T oSymTable,
+int (*pfPredicate)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra,
+int iThreadCount, size_t *puRemoved);
+
+#endif
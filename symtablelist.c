@@ -6,11 +6,15 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 #include "symtable.h"
 
 /* struct Node contains a pairing of char *key and void *value. 
 struct Node points at another struct Node that comes after it with
-struct Node *next */
+struct Node *next. The length of key is kept so that most other keys
+are rejected without reading their characters. */
 struct Node {
     /* the string key of the node */
     char *key;
@@ -18,6 +22,17 @@ struct Node {
     void *value; 
     /* node that comes after current node */
     struct Node *next; 
+    /* the number of characters in key */
+    size_t length;
+    /* 1 if the node and its key lie in the block of its SymTable, 0 if each was allocated on
+       its own */
+    int inBlock;
+};
+
+/* union BlockWord is a unit of the block of a compacted SymTable, aligned for a Node. */
+union BlockWord {
+    size_t u;
+    void *p;
 };
 
 /* struct SymTable points at a linked list with struct Node *first, pointing 
@@ -28,26 +43,111 @@ struct SymTable {
     struct Node *first; 
     /* the number of nodes in the SymTable */
     size_t length;
+    /* the functions that release values and compare keys */
+    struct SymTableOps ops;
+    /* the block SymTable_compact moved the nodes into, each followed by its key, or NULL */
+    union BlockWord *block;
+    /* number of bytes in block */
+    size_t blockBytes;
 };
 
+/* Return 1 if node of oSymTable holds the uLength characters at pcKey and 0 otherwise. Keys
+of another length are rejected first; keys of the same length are compared with the pfEquals
+of oSymTable or, if it is NULL, with memcmp, which the C library runs over whole vector
+registers. */
+static int SymTable_matches(SymTable_T oSymTable, const struct Node *node, const char *pcKey,
+size_t uLength) {
+    if(node->length != uLength) return 0;
+    if(oSymTable->ops.pfEquals != NULL) return oSymTable->ops.pfEquals(node->key, pcKey, uLength);
+    return memcmp(node->key, pcKey, uLength) == 0;
+}
+
+/* Release value, which oSymTable no longer binds, with the value-free function of
+oSymTable if it has one. */
+static void SymTable_release(SymTable_T oSymTable, void *value) {
+    if(oSymTable->ops.pfFreeValue != NULL) oSymTable->ops.pfFreeValue(value);
+}
+
+/* Free psNode and its key unless they lie in a block, which is freed as a whole. */
+static void SymTable_freeNode(struct Node *psNode) {
+    if(psNode->inBlock) return;
+    free(psNode->key);
+    free(psNode);
+}
+
+/* Return the number of BlockWords a node with a key of uLength characters takes in a
+block. */
+static size_t SymTable_nodeWords(size_t uLength) {
+    return (sizeof(struct Node) + uLength + 1 + sizeof(union BlockWord) - 1)
+        / sizeof(union BlockWord);
+}
+
+/* Remove from oSymTable each binding whose key oOther binds if iFound is 1, or does not bind
+if iFound is 0, calling pfRemoved with it unless pfRemoved is NULL. Return the number of
+bindings removed. */
+static size_t SymTable_filter(SymTable_T oSymTable, SymTable_T oOther, int iFound,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    struct Node **ppsLink = &oSymTable->first;
+    struct Node *psNode;
+    size_t uRemoved = 0;
+    while(*ppsLink != NULL) {
+        psNode = *ppsLink;
+        if(SymTable_containsN(oOther, psNode->key, psNode->length) != iFound) {
+            ppsLink = &psNode->next;
+            continue;
+        }
+        *ppsLink = psNode->next;
+        if(pfRemoved != NULL) pfRemoved(psNode->key, psNode->value, (void*)pvExtra);
+        SymTable_release(oSymTable, psNode->value);
+        SymTable_freeNode(psNode);
+        oSymTable->length--;
+        uRemoved++;
+    }
+    return uRemoved;
+}
+
 SymTable_T SymTable_new(void) {
     SymTable_T out = (SymTable_T)malloc(sizeof(struct SymTable));
     if(out == NULL) return NULL;
     out->length = 0;
     out->first = NULL;
+    out->ops.pfFreeValue = NULL;
+    out->ops.pfHash = NULL;
+    out->ops.pfEquals = NULL;
+    out->block = NULL;
+    out->blockBytes = 0;
+    return out;
+}
+
+SymTable_T SymTable_newWithOps(const struct SymTableOps *psOps) {
+    SymTable_T out;
+    assert(psOps != NULL);
+    out = SymTable_new();
+    if(out == NULL) return NULL;
+    out->ops = *psOps;
     return out;
 }
 
 void SymTable_free(SymTable_T oSymTable) {
+    assert(oSymTable != NULL);
+    SymTable_clear(oSymTable);
+    free(oSymTable);
+}
+
+void SymTable_clear(SymTable_T oSymTable) {
     struct Node* tracer;
     struct Node* temp;
     assert(oSymTable != NULL);
     for(tracer = oSymTable->first; tracer != NULL; tracer = temp) {
         temp = tracer->next;
-        free(tracer->key);
-        free(tracer);
+        SymTable_release(oSymTable, tracer->value);
+        SymTable_freeNode(tracer);
     }
-    free(oSymTable);
+    free(oSymTable->block);
+    oSymTable->block = NULL;
+    oSymTable->blockBytes = 0;
+    oSymTable->first = NULL;
+    oSymTable->length = 0;
 }
 
 size_t SymTable_getLength(SymTable_T oSymTable) {
@@ -56,22 +156,30 @@ size_t SymTable_getLength(SymTable_T oSymTable) {
 }
 
 int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void *pvValue) {
+    assert(pcKey != NULL);
+    return SymTable_putN(oSymTable, pcKey, strlen(pcKey), pvValue);
+}
+
+int SymTable_putN(SymTable_T oSymTable, const char *pcKey, size_t uLen, const void *pvValue) {
     struct Node *psNewNode;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    if(SymTable_contains(oSymTable, pcKey)) return 0;
+    if(SymTable_containsN(oSymTable, pcKey, uLen)) return 0;
 
     psNewNode = (struct Node*)malloc(sizeof(struct Node));
     if (psNewNode == NULL) return 0;
     
-    psNewNode->key = (char*)malloc(strlen(pcKey)+ 1);
+    psNewNode->key = (char*)malloc(uLen + 1);
     if (psNewNode->key == NULL) {
         free(psNewNode);
         return 0;
     }
 
-    strcpy((char*)psNewNode->key, pcKey);
+    memcpy(psNewNode->key, pcKey, uLen);
+    psNewNode->key[uLen] = '\0';
     psNewNode->value = (void*)pvValue;    
+    psNewNode->length = uLen;
+    psNewNode->inBlock = 0;
 
     psNewNode->next = oSymTable->first;
     oSymTable->first = psNewNode;
@@ -83,14 +191,17 @@ void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvVa
     void *oldValue;
     struct Node* tracer;
     struct Node* temp;
+    size_t uLength;
     assert(oSymTable != NULL); 
     assert(pcKey != NULL);
 
+    uLength = strlen(pcKey);
     for(tracer = oSymTable->first; tracer != NULL; tracer = temp) {
         temp = tracer->next;
-        if(!strcmp(tracer->key,pcKey)) {
+        if(SymTable_matches(oSymTable, tracer, pcKey, uLength)) {
             oldValue = tracer->value;
             tracer->value = (void*)pvValue;
+            SymTable_release(oSymTable, oldValue);
             return oldValue;
         }
     }
@@ -98,64 +209,65 @@ void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const void *pvVa
 }
 
 int SymTable_contains(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_containsN(oSymTable, pcKey, strlen(pcKey));
+}
+
+int SymTable_containsN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
     struct Node* tracer; 
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
     tracer = oSymTable->first; 
     while(tracer != NULL) {
-        if(!strcmp(tracer->key,pcKey)) return 1;
+        if(SymTable_matches(oSymTable, tracer, pcKey, uLen)) return 1;
         tracer = tracer->next;
     }
     return 0;
 }
 
 void *SymTable_get(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_getN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_getN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
     struct Node* tracer; 
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
     tracer = oSymTable->first; 
 
     while(tracer != NULL) {
-        if(!strcmp(tracer->key,pcKey)) return tracer->value;
+        if(SymTable_matches(oSymTable, tracer, pcKey, uLen)) return tracer->value;
         tracer = tracer->next;
     }
     return NULL;
 }
 
 void *SymTable_remove(SymTable_T oSymTable, const char *pcKey) {
+    assert(pcKey != NULL);
+    return SymTable_removeN(oSymTable, pcKey, strlen(pcKey));
+}
+
+void *SymTable_removeN(SymTable_T oSymTable, const char *pcKey, size_t uLen) {
     void *output;
-    struct Node* tracer1; 
-    struct Node* tracer2;
+    struct Node **ppsLink;
+    struct Node *psNode;
     assert(oSymTable != NULL);
     assert(pcKey != NULL);
-    tracer1 = oSymTable->first;
-    if(tracer1 == NULL) return NULL; 
-    tracer2 = tracer1->next;
 
-    if(!SymTable_contains(oSymTable, pcKey)) return NULL;
-
-    if(!strcmp(tracer1->key,pcKey)) {
-        output = tracer1->value;
-        oSymTable->first = tracer1->next;
-        free(tracer1->key);
-        free(tracer1);
-        oSymTable->length--;
-        return output;
-    }
-
-    while(tracer2 != NULL) {
-        if(!strcmp(tracer2->key,pcKey)) {
-            output = tracer2->value;
-            tracer1->next = tracer2->next;
-            free(tracer2->key);
-            free(tracer2);
+    /* the link that points at a node is kept, so the node is unlinked in the same pass that
+       finds it */
+    for(ppsLink = &oSymTable->first; *ppsLink != NULL; ppsLink = &psNode->next) {
+        psNode = *ppsLink;
+        if(SymTable_matches(oSymTable, psNode, pcKey, uLen)) {
+            output = psNode->value;
+            *ppsLink = psNode->next;
+            SymTable_freeNode(psNode);
             oSymTable->length--;
+            SymTable_release(oSymTable, output);
             return output;
         }
-        tracer1 = tracer2;
-        tracer2 = tracer2->next;
     }
-
     return NULL;
 }
 
@@ -169,4 +281,145 @@ const void *pvExtra) {
         pfApply(tracer->key, (void*)tracer->value, (void*)pvExtra);
         tracer = tracer->next;
     }
-}
\ No newline at end of file
+}
+
+size_t SymTable_memoryUsage(SymTable_T oSymTable, struct SymTableMemory *psUsage) {
+    struct SymTableMemory sUsage;
+    struct Node *psCurrentNode;
+    size_t uBlockUsed = 0;
+    assert(oSymTable != NULL);
+
+    sUsage.buckets = 0;
+    sUsage.nodes = oSymTable->length * sizeof(struct Node);
+    sUsage.keys = 0;
+    for(psCurrentNode = oSymTable->first; psCurrentNode != NULL;
+        psCurrentNode = psCurrentNode->next) {
+        sUsage.keys += psCurrentNode->length + 1;
+        if(psCurrentNode->inBlock)
+            uBlockUsed += sizeof(struct Node) + psCurrentNode->length + 1;
+    }
+    /* the padding of the block and the room of the nodes removed from it */
+    sUsage.overhead = sizeof(struct SymTable) + oSymTable->blockBytes - uBlockUsed;
+    if(psUsage != NULL) *psUsage = sUsage;
+    return sUsage.buckets + sUsage.nodes + sUsage.keys + sUsage.overhead;
+}
+
+int SymTable_merge(SymTable_T oSymTable, SymTable_T oSource) {
+    struct Node **ppsLink;
+    struct Node *psNode;
+    struct Node *psCopy;
+    assert(oSymTable != NULL);
+    assert(oSource != NULL);
+    assert(oSymTable != oSource);
+
+    /* The nodes moved go to the front of oSymTable, as new bindings do. A node in the block
+       of oSource moves as a copy, since the block stays with oSource. */
+    ppsLink = &oSource->first;
+    while(*ppsLink != NULL) {
+        psNode = *ppsLink;
+        if(SymTable_containsN(oSymTable, psNode->key, psNode->length)) {
+            ppsLink = &psNode->next;
+            continue;
+        }
+        if(psNode->inBlock) {
+            psCopy = (struct Node*)malloc(sizeof(struct Node));
+            if(psCopy == NULL) return 0;
+            *psCopy = *psNode;
+            psCopy->key = (char*)malloc(psNode->length + 1);
+            if(psCopy->key == NULL) {
+                free(psCopy);
+                return 0;
+            }
+            memcpy(psCopy->key, psNode->key, psNode->length + 1);
+            psCopy->inBlock = 0;
+            psNode = psCopy;
+        }
+        *ppsLink = psNode->next;
+        oSource->length--;
+        psNode->next = oSymTable->first;
+        oSymTable->first = psNode;
+        oSymTable->length++;
+    }
+    return 1;
+}
+
+size_t SymTable_intersect(SymTable_T oSymTable, SymTable_T oOther,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    assert(oSymTable != NULL);
+    assert(oOther != NULL);
+    assert(oSymTable != oOther);
+    return SymTable_filter(oSymTable, oOther, 0, pfRemoved, pvExtra);
+}
+
+size_t SymTable_diff(SymTable_T oSymTable, SymTable_T oOther,
+void (*pfRemoved)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    assert(oSymTable != NULL);
+    assert(oOther != NULL);
+    assert(oSymTable != oOther);
+    return SymTable_filter(oSymTable, oOther, 1, pfRemoved, pvExtra);
+}
+
+size_t SymTable_removeIf(SymTable_T oSymTable,
+int (*pfPredicate)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    struct Node **ppsLink;
+    struct Node *psNode;
+    size_t uRemoved = 0;
+    assert(oSymTable != NULL);
+    assert(pfPredicate != NULL);
+
+    ppsLink = &oSymTable->first;
+    while(*ppsLink != NULL) {
+        psNode = *ppsLink;
+        if(!pfPredicate(psNode->key, psNode->value, (void*)pvExtra)) {
+            ppsLink = &psNode->next;
+            continue;
+        }
+        *ppsLink = psNode->next;
+        SymTable_release(oSymTable, psNode->value);
+        SymTable_freeNode(psNode);
+        oSymTable->length--;
+        uRemoved++;
+    }
+    return uRemoved;
+}
+
+int SymTable_compact(SymTable_T oSymTable) {
+    union BlockWord *block = NULL;
+    struct Node **ppsLink;
+    struct Node *psNode;
+    struct Node *psNext;
+    struct Node *psMoved;
+    size_t uWords = 0;
+    size_t uUsed = 0;
+    assert(oSymTable != NULL);
+
+    for(psNode = oSymTable->first; psNode != NULL; psNode = psNode->next)
+        uWords += SymTable_nodeWords(psNode->length);
+    if(uWords > 0) {
+        block = (union BlockWord*)malloc(uWords * sizeof(union BlockWord));
+        if(block == NULL) return 0;
+    }
+
+    /* Each node is followed by its key, in the order of the list. */
+    ppsLink = &oSymTable->first;
+    for(psNode = oSymTable->first; psNode != NULL; psNode = psNext) {
+        psNext = psNode->next;
+        psMoved = (struct Node*)(void*)(block + uUsed);
+        uUsed += SymTable_nodeWords(psNode->length);
+        *psMoved = *psNode;
+        psMoved->key = (char*)(psMoved + 1);
+        memcpy(psMoved->key, psNode->key, psNode->length + 1);
+        psMoved->inBlock = 1;
+        *ppsLink = psMoved;
+        ppsLink = &psMoved->next;
+        SymTable_freeNode(psNode);
+    }
+    free(oSymTable->block);
+    oSymTable->block = block;
+    oSymTable->blockBytes = uWords * sizeof(union BlockWord);
+#ifdef __GLIBC__
+    /* hand the pages freed by the moves back to the system */
+    (void)malloc_trim(0);
+#endif
+    return 1;
+}
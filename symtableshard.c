@@ -0,0 +1,196 @@
+/******************************************************************/
+/* symtableshard.c                                                */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <pthread.h>
+#include "symtable.h"
+#include "symtableshard.h"
+
+/* size of a cache line in bytes */
+enum {CACHE_LINE_SIZE = 64};
+
+/* Return a 64 bit hash code for pcKey whose high bits are well mixed. The shard index is
+taken from the high bits so that it does not follow the bucket index the shard's own
+SymTable derives from the low bits. */
+static uint64_t ShardedSymTable_hash(const char *pcKey) {
+    const uint64_t HASH_MULTIPLIER = 65599;
+    const uint64_t GOLDEN_RATIO = 0x9E3779B97F4A7C15u;
+    size_t u;
+    uint64_t uHash = 0;
+    assert(pcKey != NULL);
+    for (u = 0; pcKey[u] != '\0'; u++)
+        uHash = uHash * HASH_MULTIPLIER + (uint64_t)pcKey[u];
+    return uHash * GOLDEN_RATIO;
+}
+
+/* struct Shard pairs one SymTable with the lock that guards it. Each Shard is padded to a
+whole number of cache lines, and the array of Shards starts on one, so that threads using
+neighbouring Shards do not keep taking the same line away from each other. */
+struct Shard {
+    /* guards every access to table */
+    pthread_mutex_t lock;
+    /* the bindings whose keys route to the Shard */
+    SymTable_T table;
+    /* pads the Shard to a multiple of CACHE_LINE_SIZE */
+    char padding[CACHE_LINE_SIZE -
+        (sizeof(pthread_mutex_t) + sizeof(SymTable_T)) % CACHE_LINE_SIZE];
+};
+
+/* struct ShardedSymTable points at an array of Shards. Since every Shard counts and expands
+its own bindings, writers on different Shards share no counter and no resize. */
+struct ShardedSymTable {
+    /* the Shards of the ShardedSymTable */
+    struct Shard *shards;
+    /* number of Shards, a power of 2 */
+    size_t count;
+    /* number of hash bits that select a Shard */
+    unsigned int bits;
+};
+
+/* Return the Shard of oShardedSymTable that holds pcKey. */
+static struct Shard *ShardedSymTable_route(ShardedSymTable_T oShardedSymTable, const char *pcKey) {
+    uint64_t uHash;
+    if(oShardedSymTable->bits == 0) return oShardedSymTable->shards;
+    uHash = ShardedSymTable_hash(pcKey);
+    return &oShardedSymTable->shards[uHash >> (64 - oShardedSymTable->bits)];
+}
+
+ShardedSymTable_T ShardedSymTable_new(size_t uShardCount) {
+    ShardedSymTable_T out;
+    void *pvShards;
+    size_t i;
+
+    out = (ShardedSymTable_T)calloc(1, sizeof(struct ShardedSymTable));
+    if(out == NULL) return NULL;
+    out->count = 1;
+    while(out->count < uShardCount && out->bits < 16) {
+        out->count <<= 1;
+        out->bits++;
+    }
+
+    /* calloc only aligns to 16 bytes, which would let a Shard straddle two cache lines. */
+    if(posix_memalign(&pvShards, CACHE_LINE_SIZE, out->count * sizeof(struct Shard)) != 0) {
+        free(out);
+        return NULL;
+    }
+    out->shards = (struct Shard*)pvShards;
+    memset(out->shards, 0, out->count * sizeof(struct Shard));
+    for(i = 0; i < out->count; i++) {
+        out->shards[i].table = SymTable_new();
+        if(out->shards[i].table == NULL ||
+            pthread_mutex_init(&out->shards[i].lock, NULL) != 0) {
+            if(out->shards[i].table != NULL) SymTable_free(out->shards[i].table);
+            out->count = i;
+            ShardedSymTable_free(out);
+            return NULL;
+        }
+    }
+    return out;
+}
+
+void ShardedSymTable_free(ShardedSymTable_T oShardedSymTable) {
+    size_t i;
+    assert(oShardedSymTable != NULL);
+    for(i = 0; i < oShardedSymTable->count; i++) {
+        SymTable_free(oShardedSymTable->shards[i].table);
+        pthread_mutex_destroy(&oShardedSymTable->shards[i].lock);
+    }
+    free(oShardedSymTable->shards);
+    free(oShardedSymTable);
+}
+
+size_t ShardedSymTable_getLength(ShardedSymTable_T oShardedSymTable) {
+    size_t i;
+    size_t uLength = 0;
+    struct Shard *shard;
+    assert(oShardedSymTable != NULL);
+    for(i = 0; i < oShardedSymTable->count; i++) {
+        shard = &oShardedSymTable->shards[i];
+        pthread_mutex_lock(&shard->lock);
+        uLength += SymTable_getLength(shard->table);
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return uLength;
+}
+
+int ShardedSymTable_put(ShardedSymTable_T oShardedSymTable, const char *pcKey, const void *pvValue) {
+    struct Shard *shard;
+    int output;
+    assert(oShardedSymTable != NULL);
+    assert(pcKey != NULL);
+    shard = ShardedSymTable_route(oShardedSymTable, pcKey);
+    pthread_mutex_lock(&shard->lock);
+    output = SymTable_put(shard->table, pcKey, pvValue);
+    pthread_mutex_unlock(&shard->lock);
+    return output;
+}
+
+void *ShardedSymTable_replace(ShardedSymTable_T oShardedSymTable, const char *pcKey,
+const void *pvValue) {
+    struct Shard *shard;
+    void *output;
+    assert(oShardedSymTable != NULL);
+    assert(pcKey != NULL);
+    shard = ShardedSymTable_route(oShardedSymTable, pcKey);
+    pthread_mutex_lock(&shard->lock);
+    output = SymTable_replace(shard->table, pcKey, pvValue);
+    pthread_mutex_unlock(&shard->lock);
+    return output;
+}
+
+int ShardedSymTable_contains(ShardedSymTable_T oShardedSymTable, const char *pcKey) {
+    struct Shard *shard;
+    int output;
+    assert(oShardedSymTable != NULL);
+    assert(pcKey != NULL);
+    shard = ShardedSymTable_route(oShardedSymTable, pcKey);
+    pthread_mutex_lock(&shard->lock);
+    output = SymTable_contains(shard->table, pcKey);
+    pthread_mutex_unlock(&shard->lock);
+    return output;
+}
+
+void *ShardedSymTable_get(ShardedSymTable_T oShardedSymTable, const char *pcKey) {
+    struct Shard *shard;
+    void *output;
+    assert(oShardedSymTable != NULL);
+    assert(pcKey != NULL);
+    shard = ShardedSymTable_route(oShardedSymTable, pcKey);
+    pthread_mutex_lock(&shard->lock);
+    output = SymTable_get(shard->table, pcKey);
+    pthread_mutex_unlock(&shard->lock);
+    return output;
+}
+
+void *ShardedSymTable_remove(ShardedSymTable_T oShardedSymTable, const char *pcKey) {
+    struct Shard *shard;
+    void *output;
+    assert(oShardedSymTable != NULL);
+    assert(pcKey != NULL);
+    shard = ShardedSymTable_route(oShardedSymTable, pcKey);
+    pthread_mutex_lock(&shard->lock);
+    output = SymTable_remove(shard->table, pcKey);
+    pthread_mutex_unlock(&shard->lock);
+    return output;
+}
+
+void ShardedSymTable_map(ShardedSymTable_T oShardedSymTable,
+void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    size_t i;
+    struct Shard *shard;
+    assert(oShardedSymTable != NULL);
+    assert(pfApply != NULL);
+    for(i = 0; i < oShardedSymTable->count; i++) {
+        shard = &oShardedSymTable->shards[i];
+        pthread_mutex_lock(&shard->lock);
+        SymTable_map(shard->table, pfApply, pvExtra);
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
@@ -0,0 +1,54 @@
+/******************************************************************/
+/* symtableshard.h                                                */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#ifndef SYMTABLESHARD_INCLUDED
+#define SYMTABLESHARD_INCLUDED
+#include <stddef.h>
+/* struct ShardedSymTable spreads pairings of strings and values over several independent
+SymTables so that threads inserting different keys rarely wait for one another. Every
+function may be called from several threads at once. */
+struct ShardedSymTable;
+/* ShardedSymTable_T is an alias for ShardedSymTable */
+typedef struct ShardedSymTable *ShardedSymTable_T;
+
+/* Returns a new ShardedSymTable with no bindings that spreads its bindings over at least
+uShardCount shards, or NULL if insufficient memory is available. The shard count is rounded
+up to a power of 2. */
+ShardedSymTable_T ShardedSymTable_new(size_t uShardCount);
+
+/* Frees all memory occupied by oShardedSymTable. No other thread may be using it. */
+void ShardedSymTable_free(ShardedSymTable_T oShardedSymTable);
+
+/* Returns the number of bindings in oShardedSymTable, summed over all of its shards */
+size_t ShardedSymTable_getLength(ShardedSymTable_T oShardedSymTable);
+
+/* Adds pcKey into oShardedSymTable and assigns pcKey the value pvValue. Returns int 1
+if the addition was successful and int 0 if pcKey is already in oShardedSymTable or if
+insufficient memory is available. */
+int ShardedSymTable_put(ShardedSymTable_T oShardedSymTable, const char *pcKey, const void *pvValue);
+
+/* Changes the value assigned to pcKey inside oShardedSymTable to pvValue. Returns the
+previous value of pcKey or NULL if pcKey isn't in oShardedSymTable */
+void *ShardedSymTable_replace(ShardedSymTable_T oShardedSymTable, const char *pcKey,
+const void *pvValue);
+
+/* Returns 1 if oShardedSymTable has an entry with pcKey as its key. Returns 0 if not. */
+int ShardedSymTable_contains(ShardedSymTable_T oShardedSymTable, const char *pcKey);
+
+/* Returns the value assigned to pcKey inside oShardedSymTable or NULL if pcKey isn't in
+oShardedSymTable */
+void *ShardedSymTable_get(ShardedSymTable_T oShardedSymTable, const char *pcKey);
+
+/* If oShardedSymTable contains an entry with key pcKey, then removes that entry and returns
+its value. Otherwise returns NULL. */
+void *ShardedSymTable_remove(ShardedSymTable_T oShardedSymTable, const char *pcKey);
+
+/* Applies the function (*pfApply)(pcKey, pvValue, pvExtra) for each binding in
+oShardedSymTable, one shard at a time, passing pvExtra as an extra parameter. Each shard is
+locked while it is visited, so pfApply must not call back into oShardedSymTable. */
+void ShardedSymTable_map(ShardedSymTable_T oShardedSymTable,
+void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra), const void *pvExtra);
+
+#endif
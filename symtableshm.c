@@ -0,0 +1,664 @@
+/******************************************************************/
+/* symtableshm.c                                                  */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "symtableshm.h"
+
+/* the number of bytes allocations in the segment are rounded up to, and aligned on */
+enum {GRANULE = 16};
+/* the number of size classes of blocks of one to SMALL_CLASSES granules; the classes above
+them hold blocks of a power of 2 granules */
+enum {SMALL_CLASSES = 64};
+/* the number of size classes, enough for blocks of any size a segment can have */
+enum {CLASS_COUNT = SMALL_CLASSES + 58};
+/* number of buckets of a new SharedSymTable, a power of 2 */
+enum {INITIAL_BUCKETS = 64};
+
+/* the first word of a segment once SharedSymTable_create has finished making it */
+#define SEGMENT_MAGIC ((uint64_t)0x53594d5348415245u)
+
+/* struct Segment is the header at offset 0 of a shared memory segment. The rest of the
+segment is a heap of blocks, handed out from top upwards and, once freed, kept on a list
+per size class for reuse. Every link in the segment is an offset from its start, 0 meaning
+none, since each process maps the segment at its own address. */
+struct Segment {
+    /* SEGMENT_MAGIC once the segment is ready, 0 until then */
+    uint64_t magic;
+    /* number of bytes of the segment */
+    uint64_t size;
+    /* held by each change and map, in every process; robust, so that the next process to
+       take it after its holder died is told so rather than waiting forever */
+    pthread_mutex_t lock;
+    /* odd while a change is under way and raised by each change, so that a lookup, which
+       takes no lock, can tell that it read the bindings while they changed */
+    uint64_t sequence;
+    /* 1 once a process has died while changing the bindings, which are no longer used */
+    uint64_t damaged;
+    /* number of bindings in the SharedSymTable */
+    uint64_t length;
+    /* the offset of the array of the offsets of the first Node of each bucket */
+    uint64_t buckets;
+    /* number of buckets, a power of 2 */
+    uint64_t bucketCount;
+    /* the offset of the first byte that has never been handed out */
+    uint64_t top;
+    /* for each size class, the offset of the first free block, each free block starting
+       with the offset of the next */
+    uint64_t freeLists[CLASS_COUNT];
+};
+
+/* struct Node is one binding, in a block of the segment. The '\0' terminated characters of
+its key follow it, and then the bytes of its value. */
+struct Node {
+    /* the offset of the next Node of the bucket, or 0 */
+    uint64_t next;
+    /* the hash code of the key */
+    uint64_t hash;
+    /* number of characters of the key, not counting '\0' */
+    uint32_t keyLength;
+    /* number of bytes of the value */
+    uint32_t valueLength;
+    /* the size class of the block that holds the Node */
+    uint32_t sizeClass;
+};
+
+/* struct SharedSymTable is the view of one process of a segment. */
+struct SharedSymTable {
+    /* the address at which the segment is mapped in this process */
+    char *base;
+    /* number of bytes mapped */
+    size_t size;
+};
+
+/* Return the header of the segment of oSharedSymTable. */
+static struct Segment *SharedSymTable_segment(SharedSymTable_T oSharedSymTable) {
+    return (struct Segment*)oSharedSymTable->base;
+}
+
+/* Return the address in this process of the byte at uOffset in the segment of
+oSharedSymTable. */
+static void *SharedSymTable_at(SharedSymTable_T oSharedSymTable, uint64_t uOffset) {
+    assert(uOffset != 0 && uOffset < oSharedSymTable->size);
+    return oSharedSymTable->base + uOffset;
+}
+
+/* Take the lock of the segment of oSharedSymTable. If the process that held the lock died,
+make the lock usable again, and mark the segment damaged if that process was changing the
+bindings. Return 1 if the segment can be used, or release the lock and return 0 if it is
+damaged. */
+static int SharedSymTable_lock(SharedSymTable_T oSharedSymTable) {
+    struct Segment *psSegment = SharedSymTable_segment(oSharedSymTable);
+    if(pthread_mutex_lock(&psSegment->lock) == EOWNERDEAD) {
+        if(psSegment->sequence % 2 != 0)
+            __atomic_store_n(&psSegment->damaged, 1, __ATOMIC_RELEASE);
+        pthread_mutex_consistent(&psSegment->lock);
+    }
+    if(psSegment->damaged) {
+        pthread_mutex_unlock(&psSegment->lock);
+        return 0;
+    }
+    return 1;
+}
+
+/* Start a change of oSharedSymTable, whose lock the caller holds, making the sequence of its
+segment odd. */
+static void SharedSymTable_beginChange(SharedSymTable_T oSharedSymTable) {
+    struct Segment *psSegment = SharedSymTable_segment(oSharedSymTable);
+    __atomic_store_n(&psSegment->sequence, psSegment->sequence + 1, __ATOMIC_RELAXED);
+    /* Every store of the change must follow this one, so that a lookup that sees any of
+       them sees the sequence change too. */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/* End the change of oSharedSymTable under way, if any, and release its lock. */
+static void SharedSymTable_unlock(SharedSymTable_T oSharedSymTable) {
+    struct Segment *psSegment = SharedSymTable_segment(oSharedSymTable);
+    if(psSegment->sequence % 2 != 0)
+        __atomic_store_n(&psSegment->sequence, psSegment->sequence + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&psSegment->lock);
+}
+
+/* Start a lookup in oSharedSymTable and store the sequence of its segment in *puSequence.
+A lookup that finds a change under way waits for it on the lock, which is also how it
+finds a writer that died. Return 1 if successful or 0 if the segment is damaged. */
+static int SharedSymTable_beginRead(SharedSymTable_T oSharedSymTable, uint64_t *puSequence) {
+    struct Segment *psSegment = SharedSymTable_segment(oSharedSymTable);
+    for(;;) {
+        *puSequence = __atomic_load_n(&psSegment->sequence, __ATOMIC_ACQUIRE);
+        if(__atomic_load_n(&psSegment->damaged, __ATOMIC_ACQUIRE)) return 0;
+        if(*puSequence % 2 == 0) return 1;
+        if(!SharedSymTable_lock(oSharedSymTable)) return 0;
+        pthread_mutex_unlock(&psSegment->lock);
+    }
+}
+
+/* Return 1 if no change of oSharedSymTable has begun since the lookup that found the
+sequence uSequence started, so that what it read is consistent, or 0 if it must try again. */
+static int SharedSymTable_endRead(SharedSymTable_T oSharedSymTable, uint64_t uSequence) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&SharedSymTable_segment(oSharedSymTable)->sequence,
+        __ATOMIC_RELAXED) == uSequence;
+}
+
+/* Return 1 if uBytes bytes at uOffset lie in the heap of the segment of oSharedSymTable and
+uOffset starts a block, or 0 otherwise, which a lookup that raced a change may find. */
+static int SharedSymTable_holds(SharedSymTable_T oSharedSymTable, uint64_t uOffset,
+uint64_t uBytes) {
+    return uOffset >= sizeof(struct Segment) && uOffset % GRANULE == 0 &&
+        uOffset <= oSharedSymTable->size && uBytes <= oSharedSymTable->size - uOffset;
+}
+
+/* Return a hash code of the uLength characters at pcKey, which are read eight at a time and
+each word mixed in with a multiply, then spread by the finalizer of MurmurHash3 so that its
+low bits, which pick the bucket, depend on every character. The hash code depends only on
+the key, so every process finds a key where any other put it. */
+static uint64_t SharedSymTable_hash(const char *pcKey, size_t uLength) {
+    const uint64_t GOLDEN_RATIO = 0x9E3779B97F4A7C15u;
+    uint64_t x = 0xcbf29ce484222325u ^ uLength;
+    uint64_t m;
+    size_t u;
+    size_t i;
+    for(u = 0; u + 8 <= uLength; u += 8) {
+        memcpy(&m, pcKey + u, 8);
+        x = (x ^ m) * GOLDEN_RATIO;
+        x ^= x >> 29;
+    }
+    m = 0;
+    for(i = 0; u + i < uLength; i++) m |= (uint64_t)(unsigned char)pcKey[u + i] << (8 * i);
+    x = (x ^ m) * GOLDEN_RATIO;
+    x = (x ^ (x >> 33)) * 0xff51afd7ed558ccdu;
+    x = (x ^ (x >> 33)) * 0xc4ceb9fe1a85ec53u;
+    return x ^ (x >> 33);
+}
+
+/* Return the size class of the smallest block that holds uBytes bytes: one class for each
+number of granules up to SMALL_CLASSES, which covers most bindings with little waste, then
+one for each power of 2 of granules. */
+static int SharedSymTable_classOf(uint64_t uBytes) {
+    uint64_t uGranules = (uBytes + GRANULE - 1) / GRANULE;
+    int iClass = SMALL_CLASSES;
+    uint64_t uBlock = 2 * SMALL_CLASSES;
+    if(uGranules == 0) uGranules = 1;
+    if(uGranules <= SMALL_CLASSES) return (int)uGranules - 1;
+    while(uBlock < uGranules) {
+        uBlock *= 2;
+        iClass++;
+    }
+    return iClass;
+}
+
+/* Return the number of bytes of a block of size class iClass. */
+static uint64_t SharedSymTable_blockSize(int iClass) {
+    if(iClass < SMALL_CLASSES) return (uint64_t)(iClass + 1) * GRANULE;
+    return (uint64_t)2 * SMALL_CLASSES * GRANULE << (iClass - SMALL_CLASSES);
+}
+
+/* Return the offset of a block of the segment of oSharedSymTable with room for uBytes
+bytes, storing its size class in *piClass, or 0 if the segment has no room left. A freed
+block of the class is reused before the top of the heap is raised. */
+static uint64_t SharedSymTable_alloc(SharedSymTable_T oSharedSymTable, uint64_t uBytes,
+int *piClass) {
+    struct Segment *psSegment = SharedSymTable_segment(oSharedSymTable);
+    int iClass = SharedSymTable_classOf(uBytes);
+    uint64_t uBlock = SharedSymTable_blockSize(iClass);
+    uint64_t uOffset = psSegment->freeLists[iClass];
+
+    *piClass = iClass;
+    if(uOffset != 0) {
+        memcpy(&psSegment->freeLists[iClass], SharedSymTable_at(oSharedSymTable, uOffset),
+            sizeof(uint64_t));
+        return uOffset;
+    }
+    if(uBlock > psSegment->size - psSegment->top) return 0;
+    uOffset = psSegment->top;
+    psSegment->top += uBlock;
+    return uOffset;
+}
+
+/* Put the block at uOffset, of size class iClass, on the free list of its class in the
+segment of oSharedSymTable. */
+static void SharedSymTable_release(SharedSymTable_T oSharedSymTable, uint64_t uOffset,
+int iClass) {
+    struct Segment *psSegment = SharedSymTable_segment(oSharedSymTable);
+    memcpy(SharedSymTable_at(oSharedSymTable, uOffset), &psSegment->freeLists[iClass],
+        sizeof(uint64_t));
+    psSegment->freeLists[iClass] = uOffset;
+}
+
+/* Return the array of the offsets of the first Nodes of the buckets of oSharedSymTable. */
+static uint64_t *SharedSymTable_buckets(SharedSymTable_T oSharedSymTable) {
+    return (uint64_t*)SharedSymTable_at(oSharedSymTable,
+        SharedSymTable_segment(oSharedSymTable)->buckets);
+}
+
+/* Return the characters of the key of psNode. */
+static char *SharedSymTable_keyOf(struct Node *psNode) {
+    return (char*)(psNode + 1);
+}
+
+/* Return the bytes of the value of psNode. */
+static char *SharedSymTable_valueOf(struct Node *psNode) {
+    return SharedSymTable_keyOf(psNode) + psNode->keyLength + 1;
+}
+
+/* Return the link of oSharedSymTable, the entry of a bucket or the next field of a Node,
+that holds the offset of the Node of the uLength characters at pcKey, whose hash code is
+hash, or the 0 that ends the chain of its bucket if pcKey isn't in oSharedSymTable. */
+static uint64_t *SharedSymTable_locate(SharedSymTable_T oSharedSymTable, const char *pcKey,
+size_t uLength, uint64_t hash) {
+    struct Segment *psSegment = SharedSymTable_segment(oSharedSymTable);
+    uint64_t *puLink = &SharedSymTable_buckets(oSharedSymTable)[hash &
+        (psSegment->bucketCount - 1)];
+    struct Node *psNode;
+
+    while(*puLink != 0) {
+        psNode = (struct Node*)SharedSymTable_at(oSharedSymTable, *puLink);
+        if(psNode->hash == hash && psNode->keyLength == uLength &&
+            memcmp(SharedSymTable_keyOf(psNode), pcKey, uLength) == 0) break;
+        puLink = &psNode->next;
+    }
+    return puLink;
+}
+
+/* Return the offset of the Node of the uLength characters at pcKey, whose hash code is hash,
+in oSharedSymTable, or 0 if pcKey isn't in it or a change has begun since the lookup that
+found the sequence uSequence started. Every offset is checked before it is followed, since
+the lookup holds no lock. */
+static uint64_t SharedSymTable_seek(SharedSymTable_T oSharedSymTable, const char *pcKey,
+size_t uLength, uint64_t hash, uint64_t uSequence) {
+    struct Segment *psSegment = SharedSymTable_segment(oSharedSymTable);
+    uint64_t uCount = psSegment->bucketCount;
+    uint64_t uBuckets = psSegment->buckets;
+    uint64_t uOffset;
+    struct Node *psNode;
+
+    if(uCount == 0 || (uCount & (uCount - 1)) != 0 || uCount > oSharedSymTable->size ||
+        !SharedSymTable_holds(oSharedSymTable, uBuckets, uCount * sizeof(uint64_t)))
+        return 0;
+    uOffset = ((uint64_t*)SharedSymTable_at(oSharedSymTable, uBuckets))[hash & (uCount - 1)];
+    while(uOffset != 0) {
+        if(!SharedSymTable_holds(oSharedSymTable, uOffset, sizeof(struct Node) + uLength + 1) ||
+            !SharedSymTable_endRead(oSharedSymTable, uSequence)) return 0;
+        psNode = (struct Node*)SharedSymTable_at(oSharedSymTable, uOffset);
+        if(psNode->hash == hash && psNode->keyLength == uLength &&
+            memcmp(SharedSymTable_keyOf(psNode), pcKey, uLength) == 0) return uOffset;
+        uOffset = psNode->next;
+    }
+    return 0;
+}
+
+/* Return the offset of a new Node of the segment of oSharedSymTable binding the uLength
+characters at pcKey, whose hash code is hash, to a copy of the uValueLength bytes at
+pvValue, or 0 if the segment has no room left. */
+static uint64_t SharedSymTable_newNode(SharedSymTable_T oSharedSymTable, const char *pcKey,
+size_t uLength, uint64_t hash, const void *pvValue, size_t uValueLength) {
+    struct Node *psNode;
+    uint64_t uOffset;
+    int iClass;
+
+    uOffset = SharedSymTable_alloc(oSharedSymTable,
+        sizeof(struct Node) + uLength + 1 + uValueLength, &iClass);
+    if(uOffset == 0) return 0;
+    psNode = (struct Node*)SharedSymTable_at(oSharedSymTable, uOffset);
+    psNode->next = 0;
+    psNode->hash = hash;
+    psNode->keyLength = (uint32_t)uLength;
+    psNode->valueLength = (uint32_t)uValueLength;
+    psNode->sizeClass = (uint32_t)iClass;
+    memcpy(SharedSymTable_keyOf(psNode), pcKey, uLength + 1);
+    if(uValueLength > 0) memcpy(SharedSymTable_valueOf(psNode), pvValue, uValueLength);
+    return uOffset;
+}
+
+/* Doubles the number of buckets of oSharedSymTable, moving each Node to the bucket its
+stored hash code selects, and returns the old bucket array to the heap. Leaves
+oSharedSymTable unchanged if the segment has no room for the new array. */
+static void SharedSymTable_expand(SharedSymTable_T oSharedSymTable) {
+    struct Segment *psSegment = SharedSymTable_segment(oSharedSymTable);
+    uint64_t uOldCount = psSegment->bucketCount;
+    uint64_t uOldOffset = psSegment->buckets;
+    uint64_t *puOld = SharedSymTable_buckets(oSharedSymTable);
+    uint64_t *puNew;
+    uint64_t uNewOffset;
+    uint64_t uOffset;
+    uint64_t uNext;
+    struct Node *psNode;
+    uint64_t u;
+    int iClass;
+
+    uNewOffset = SharedSymTable_alloc(oSharedSymTable, uOldCount * 2 * sizeof(uint64_t),
+        &iClass);
+    if(uNewOffset == 0) return;
+    puNew = (uint64_t*)SharedSymTable_at(oSharedSymTable, uNewOffset);
+    memset(puNew, 0, uOldCount * 2 * sizeof(uint64_t));
+    for(u = 0; u < uOldCount; u++) {
+        for(uOffset = puOld[u]; uOffset != 0; uOffset = uNext) {
+            psNode = (struct Node*)SharedSymTable_at(oSharedSymTable, uOffset);
+            uNext = psNode->next;
+            psNode->next = puNew[psNode->hash & (uOldCount * 2 - 1)];
+            puNew[psNode->hash & (uOldCount * 2 - 1)] = uOffset;
+        }
+    }
+    psSegment->buckets = uNewOffset;
+    psSegment->bucketCount = uOldCount * 2;
+    SharedSymTable_release(oSharedSymTable, uOldOffset,
+        SharedSymTable_classOf(uOldCount * sizeof(uint64_t)));
+}
+
+SharedSymTable_T SharedSymTable_create(const char *pcName, size_t uSize) {
+    SharedSymTable_T out;
+    struct Segment *psSegment;
+    pthread_mutexattr_t sAttr;
+    void *pvBase;
+    int iClass;
+    int fd;
+    assert(pcName != NULL);
+
+    if(uSize < sizeof(struct Segment) + GRANULE + INITIAL_BUCKETS * sizeof(uint64_t))
+        return NULL;
+    out = (SharedSymTable_T)malloc(sizeof(struct SharedSymTable));
+    if(out == NULL) return NULL;
+    fd = shm_open(pcName, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd < 0) {
+        free(out);
+        return NULL;
+    }
+    pvBase = MAP_FAILED;
+    if(ftruncate(fd, (off_t)uSize) == 0)
+        pvBase = mmap(NULL, uSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(pvBase == MAP_FAILED) {
+        shm_unlink(pcName);
+        free(out);
+        return NULL;
+    }
+    out->base = (char*)pvBase;
+    out->size = uSize;
+
+    /* ftruncate zeroed the segment, so only the fields that are not 0 need setting. */
+    psSegment = SharedSymTable_segment(out);
+    psSegment->size = uSize;
+    psSegment->top = (sizeof(struct Segment) + GRANULE - 1) / GRANULE * GRANULE;
+    psSegment->bucketCount = INITIAL_BUCKETS;
+    psSegment->buckets = SharedSymTable_alloc(out, INITIAL_BUCKETS * sizeof(uint64_t),
+        &iClass);
+    if(pthread_mutexattr_init(&sAttr) != 0) {
+        SharedSymTable_detach(out);
+        shm_unlink(pcName);
+        return NULL;
+    }
+    if(pthread_mutexattr_setpshared(&sAttr, PTHREAD_PROCESS_SHARED) != 0 ||
+        pthread_mutexattr_setrobust(&sAttr, PTHREAD_MUTEX_ROBUST) != 0 ||
+        pthread_mutex_init(&psSegment->lock, &sAttr) != 0) {
+        pthread_mutexattr_destroy(&sAttr);
+        SharedSymTable_detach(out);
+        shm_unlink(pcName);
+        return NULL;
+    }
+    pthread_mutexattr_destroy(&sAttr);
+    /* The magic is stored last, after every other write, so that a process that sees it
+       sees a finished segment. */
+    __atomic_store_n(&psSegment->magic, SEGMENT_MAGIC, __ATOMIC_RELEASE);
+    return out;
+}
+
+SharedSymTable_T SharedSymTable_attach(const char *pcName) {
+    SharedSymTable_T out;
+    struct stat sStat;
+    void *pvBase;
+    int fd;
+    assert(pcName != NULL);
+
+    out = (SharedSymTable_T)malloc(sizeof(struct SharedSymTable));
+    if(out == NULL) return NULL;
+    fd = shm_open(pcName, O_RDWR, 0);
+    if(fd < 0) {
+        free(out);
+        return NULL;
+    }
+    pvBase = MAP_FAILED;
+    if(fstat(fd, &sStat) == 0 && (size_t)sStat.st_size >= sizeof(struct Segment))
+        pvBase = mmap(NULL, (size_t)sStat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(pvBase == MAP_FAILED) {
+        free(out);
+        return NULL;
+    }
+    out->base = (char*)pvBase;
+    out->size = (size_t)sStat.st_size;
+    if(__atomic_load_n(&SharedSymTable_segment(out)->magic, __ATOMIC_ACQUIRE) !=
+        SEGMENT_MAGIC) {
+        SharedSymTable_detach(out);
+        return NULL;
+    }
+    return out;
+}
+
+void SharedSymTable_detach(SharedSymTable_T oSharedSymTable) {
+    assert(oSharedSymTable != NULL);
+    munmap(oSharedSymTable->base, oSharedSymTable->size);
+    free(oSharedSymTable);
+}
+
+int SharedSymTable_unlink(const char *pcName) {
+    assert(pcName != NULL);
+    return shm_unlink(pcName) == 0;
+}
+
+size_t SharedSymTable_getLength(SharedSymTable_T oSharedSymTable) {
+    struct Segment *psSegment;
+    size_t uLength;
+    uint64_t uSequence;
+    assert(oSharedSymTable != NULL);
+    psSegment = SharedSymTable_segment(oSharedSymTable);
+    do {
+        if(!SharedSymTable_beginRead(oSharedSymTable, &uSequence)) return 0;
+        uLength = (size_t)psSegment->length;
+    } while(!SharedSymTable_endRead(oSharedSymTable, uSequence));
+    return uLength;
+}
+
+void SharedSymTable_getUsage(SharedSymTable_T oSharedSymTable, size_t *puUsed,
+size_t *puSize) {
+    struct Segment *psSegment;
+    assert(oSharedSymTable != NULL);
+    psSegment = SharedSymTable_segment(oSharedSymTable);
+    /* The top of the heap only grows and is one word, so it is read without a lookup; that
+       also measures a damaged segment, as it stood when it was damaged. */
+    if(puUsed != NULL) *puUsed = (size_t)__atomic_load_n(&psSegment->top, __ATOMIC_RELAXED);
+    if(puSize != NULL) *puSize = (size_t)psSegment->size;
+}
+
+int SharedSymTable_isDamaged(SharedSymTable_T oSharedSymTable) {
+    uint64_t uSequence;
+    assert(oSharedSymTable != NULL);
+    return !SharedSymTable_beginRead(oSharedSymTable, &uSequence);
+}
+
+int SharedSymTable_put(SharedSymTable_T oSharedSymTable, const char *pcKey,
+const void *pvValue, size_t uLength) {
+    struct Segment *psSegment;
+    size_t uKeyLength;
+    uint64_t *puLink;
+    uint64_t hash;
+    assert(oSharedSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(pvValue != NULL || uLength == 0);
+
+    uKeyLength = strlen(pcKey);
+    if(uKeyLength >= UINT32_MAX || uLength > UINT32_MAX) return 0;
+    hash = SharedSymTable_hash(pcKey, uKeyLength);
+    psSegment = SharedSymTable_segment(oSharedSymTable);
+    if(!SharedSymTable_lock(oSharedSymTable)) return 0;
+    puLink = SharedSymTable_locate(oSharedSymTable, pcKey, uKeyLength, hash);
+    if(*puLink != 0) {
+        SharedSymTable_unlock(oSharedSymTable);
+        return 0;
+    }
+    SharedSymTable_beginChange(oSharedSymTable);
+    /* Allocating never moves the segment, so puLink stays valid. */
+    *puLink = SharedSymTable_newNode(oSharedSymTable, pcKey, uKeyLength, hash, pvValue,
+        uLength);
+    if(*puLink == 0) {
+        SharedSymTable_unlock(oSharedSymTable);
+        return 0;
+    }
+    psSegment->length++;
+    if(psSegment->length > psSegment->bucketCount) SharedSymTable_expand(oSharedSymTable);
+    SharedSymTable_unlock(oSharedSymTable);
+    return 1;
+}
+
+int SharedSymTable_replace(SharedSymTable_T oSharedSymTable, const char *pcKey,
+const void *pvValue, size_t uLength) {
+    struct Node *psNode;
+    size_t uKeyLength;
+    uint64_t *puLink;
+    uint64_t uOffset;
+    uint64_t hash;
+    assert(oSharedSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(pvValue != NULL || uLength == 0);
+
+    uKeyLength = strlen(pcKey);
+    if(uKeyLength >= UINT32_MAX || uLength > UINT32_MAX) return 0;
+    hash = SharedSymTable_hash(pcKey, uKeyLength);
+    if(!SharedSymTable_lock(oSharedSymTable)) return 0;
+    puLink = SharedSymTable_locate(oSharedSymTable, pcKey, uKeyLength, hash);
+    if(*puLink == 0) {
+        SharedSymTable_unlock(oSharedSymTable);
+        return 0;
+    }
+    SharedSymTable_beginChange(oSharedSymTable);
+    psNode = (struct Node*)SharedSymTable_at(oSharedSymTable, *puLink);
+    /* A value that fits in the block of the Node is copied over the old one. */
+    if(sizeof(struct Node) + uKeyLength + 1 + uLength <=
+        SharedSymTable_blockSize((int)psNode->sizeClass)) {
+        psNode->valueLength = (uint32_t)uLength;
+        if(uLength > 0) memcpy(SharedSymTable_valueOf(psNode), pvValue, uLength);
+        SharedSymTable_unlock(oSharedSymTable);
+        return 1;
+    }
+    uOffset = SharedSymTable_newNode(oSharedSymTable, pcKey, uKeyLength, hash, pvValue,
+        uLength);
+    if(uOffset == 0) {
+        SharedSymTable_unlock(oSharedSymTable);
+        return 0;
+    }
+    ((struct Node*)SharedSymTable_at(oSharedSymTable, uOffset))->next = psNode->next;
+    SharedSymTable_release(oSharedSymTable, *puLink, (int)psNode->sizeClass);
+    *puLink = uOffset;
+    SharedSymTable_unlock(oSharedSymTable);
+    return 1;
+}
+
+int SharedSymTable_contains(SharedSymTable_T oSharedSymTable, const char *pcKey) {
+    size_t uLength = 0;
+    return SharedSymTable_get(oSharedSymTable, pcKey, NULL, &uLength);
+}
+
+int SharedSymTable_get(SharedSymTable_T oSharedSymTable, const char *pcKey, void *pvValue,
+size_t *puLength) {
+    struct Node *psNode;
+    size_t uKeyLength;
+    size_t uRoom;
+    size_t uValueLength;
+    uint64_t uSequence;
+    uint64_t uOffset;
+    uint64_t hash;
+    assert(oSharedSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(puLength != NULL);
+    assert(pvValue != NULL || *puLength == 0);
+
+    uKeyLength = strlen(pcKey);
+    hash = SharedSymTable_hash(pcKey, uKeyLength);
+    uRoom = *puLength;
+    /* The value is copied out as the lookup finds it, and copied again if a change began
+       meanwhile. */
+    do {
+        if(!SharedSymTable_beginRead(oSharedSymTable, &uSequence)) return 0;
+        uOffset = SharedSymTable_seek(oSharedSymTable, pcKey, uKeyLength, hash, uSequence);
+        if(uOffset == 0) continue;
+        psNode = (struct Node*)SharedSymTable_at(oSharedSymTable, uOffset);
+        uValueLength = psNode->valueLength;
+        if(!SharedSymTable_holds(oSharedSymTable, uOffset,
+            sizeof(struct Node) + uKeyLength + 1 + uValueLength)) {
+            uOffset = 0;
+            continue;
+        }
+        if(uRoom > 0)
+            memcpy(pvValue, SharedSymTable_valueOf(psNode),
+                uRoom < uValueLength ? uRoom : uValueLength);
+    } while(!SharedSymTable_endRead(oSharedSymTable, uSequence));
+    if(uOffset == 0) return 0;
+    *puLength = uValueLength;
+    return 1;
+}
+
+int SharedSymTable_remove(SharedSymTable_T oSharedSymTable, const char *pcKey) {
+    struct Segment *psSegment;
+    struct Node *psNode;
+    size_t uKeyLength;
+    uint64_t *puLink;
+    uint64_t uOffset;
+    uint64_t hash;
+    assert(oSharedSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uKeyLength = strlen(pcKey);
+    hash = SharedSymTable_hash(pcKey, uKeyLength);
+    psSegment = SharedSymTable_segment(oSharedSymTable);
+    if(!SharedSymTable_lock(oSharedSymTable)) return 0;
+    puLink = SharedSymTable_locate(oSharedSymTable, pcKey, uKeyLength, hash);
+    if(*puLink == 0) {
+        SharedSymTable_unlock(oSharedSymTable);
+        return 0;
+    }
+    SharedSymTable_beginChange(oSharedSymTable);
+    uOffset = *puLink;
+    psNode = (struct Node*)SharedSymTable_at(oSharedSymTable, uOffset);
+    *puLink = psNode->next;
+    SharedSymTable_release(oSharedSymTable, uOffset, (int)psNode->sizeClass);
+    psSegment->length--;
+    SharedSymTable_unlock(oSharedSymTable);
+    return 1;
+}
+
+void SharedSymTable_map(SharedSymTable_T oSharedSymTable,
+void (*pfApply)(const char *pcKey, const void *pvValue, size_t uLength, void *pvExtra),
+const void *pvExtra) {
+    struct Segment *psSegment;
+    struct Node *psNode;
+    uint64_t *puBuckets;
+    uint64_t uOffset;
+    uint64_t u;
+    assert(oSharedSymTable != NULL);
+    assert(pfApply != NULL);
+
+    psSegment = SharedSymTable_segment(oSharedSymTable);
+    /* Holding the lock keeps changes out without stopping lookups, which take no lock. */
+    if(!SharedSymTable_lock(oSharedSymTable)) return;
+    puBuckets = SharedSymTable_buckets(oSharedSymTable);
+    for(u = 0; u < psSegment->bucketCount; u++) {
+        for(uOffset = puBuckets[u]; uOffset != 0; uOffset = psNode->next) {
+            psNode = (struct Node*)SharedSymTable_at(oSharedSymTable, uOffset);
+            pfApply(SharedSymTable_keyOf(psNode), SharedSymTable_valueOf(psNode),
+                psNode->valueLength, (void*)pvExtra);
+        }
+    }
+    SharedSymTable_unlock(oSharedSymTable);
+}
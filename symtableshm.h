@@ -0,0 +1,86 @@
+/******************************************************************/
+/* symtableshm.h                                                  */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#ifndef SYMTABLESHM_INCLUDED
+#define SYMTABLESHM_INCLUDED
+#include <stddef.h>
+/* struct SharedSymTable stores pairings of strings and values in a POSIX shared memory
+segment, so that one process can build a table that others attach to instead of building
+their own. Everything in the segment, its links and its allocator, is addressed by offsets
+from its start, so each process may map it at a different address. Values are copied into
+the segment as bytes, since a pointer means nothing in another process. A robust mutex in
+the segment is held by each change and map, in any process or thread, so that a process
+that dies holding it does not leave the others waiting forever. Lookups take no lock: they
+run alongside each other and a change, and look again if a change began meanwhile. If a
+process died during a change, the bindings may be half changed, so the segment is marked
+damaged: from then on it is treated as empty, cannot be changed, and must be made again. */
+struct SharedSymTable;
+/* SharedSymTable_T is an alias for SharedSymTable */
+typedef struct SharedSymTable *SharedSymTable_T;
+
+/* Returns a new SharedSymTable with no bindings in a new shared memory segment of uSize
+bytes named pcName, which must start with '/', or NULL if the segment already exists or
+cannot be made. The segment keeps its size: a put fails once its bytes are used up. */
+SharedSymTable_T SharedSymTable_create(const char *pcName, size_t uSize);
+
+/* Returns the SharedSymTable in the shared memory segment named pcName, or NULL if there is
+no such segment, if SharedSymTable_create has not finished making it, or if insufficient
+memory is available. */
+SharedSymTable_T SharedSymTable_attach(const char *pcName);
+
+/* Unmaps the segment of oSharedSymTable from the calling process and frees the memory
+oSharedSymTable occupies in it. The bindings stay in the segment. */
+void SharedSymTable_detach(SharedSymTable_T oSharedSymTable);
+
+/* Removes the name pcName of a shared memory segment, which is freed once every process
+has detached from it. Returns 1 if successful and 0 if there is no such segment. */
+int SharedSymTable_unlink(const char *pcName);
+
+/* Returns the number of bindings in oSharedSymTable */
+size_t SharedSymTable_getLength(SharedSymTable_T oSharedSymTable);
+
+/* Stores, unless the pointer is NULL, the number of bytes of the segment of oSharedSymTable
+in use, free blocks left for reuse included, in *puUsed, and its size in *puSize. */
+void SharedSymTable_getUsage(SharedSymTable_T oSharedSymTable, size_t *puUsed,
+size_t *puSize);
+
+/* Returns 1 if a process died while changing oSharedSymTable, after which it has no
+bindings for any process and every change fails, or 0 otherwise. */
+int SharedSymTable_isDamaged(SharedSymTable_T oSharedSymTable);
+
+/* Adds pcKey into oSharedSymTable and assigns pcKey a copy of the uLength bytes at
+pvValue. Returns 1 if the addition was successful and 0 if pcKey is already in
+oSharedSymTable or if the segment has no room left. */
+int SharedSymTable_put(SharedSymTable_T oSharedSymTable, const char *pcKey,
+const void *pvValue, size_t uLength);
+
+/* Changes the value assigned to pcKey inside oSharedSymTable to a copy of the uLength bytes
+at pvValue. Returns 1 if successful and 0 if pcKey isn't in oSharedSymTable or if the
+segment has no room left for a longer value. */
+int SharedSymTable_replace(SharedSymTable_T oSharedSymTable, const char *pcKey,
+const void *pvValue, size_t uLength);
+
+/* Returns 1 if oSharedSymTable has a binding with pcKey as its key. Returns 0 if not. */
+int SharedSymTable_contains(SharedSymTable_T oSharedSymTable, const char *pcKey);
+
+/* If oSharedSymTable binds pcKey, copies as much of its value as fits in the *puLength
+bytes at pvValue, stores the length of the whole value in *puLength and returns 1.
+Otherwise returns 0. pvValue may be NULL if *puLength is 0. */
+int SharedSymTable_get(SharedSymTable_T oSharedSymTable, const char *pcKey, void *pvValue,
+size_t *puLength);
+
+/* If oSharedSymTable contains a binding with key pcKey, then removes that binding, returns
+its bytes to the segment and returns 1. Otherwise returns 0. */
+int SharedSymTable_remove(SharedSymTable_T oSharedSymTable, const char *pcKey);
+
+/* Applies the function (*pfApply)(pcKey, pvValue, uLength, pvExtra) for each binding in
+oSharedSymTable, passing its key, its value of uLength bytes in the segment and pvExtra.
+Changes wait until the map ends, so pfApply may look keys up in oSharedSymTable but must
+not call any other SharedSymTable function with it. */
+void SharedSymTable_map(SharedSymTable_T oSharedSymTable,
+void (*pfApply)(const char *pcKey, const void *pvValue, size_t uLength, void *pvExtra),
+const void *pvExtra);
+
+#endif
@@ -0,0 +1,202 @@
+/******************************************************************/
+/* symtableu64.c                                                  */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#include <stdlib.h>
+#include <assert.h>
+#include "symtableu64.h"
+
+/* number of slots a new SymTableU64 has, a power of 2 */
+enum {INITIAL_SLOTS = 64};
+
+/* struct Slot holds one binding of the open addressed array. A Slot whose key is 0 is
+empty; the binding of the key 0 itself is kept in struct SymTableU64 instead. */
+struct Slot {
+    /* the key of the binding, or 0 if the Slot is empty */
+    uint64_t key;
+    /* the value of the binding */
+    void *value;
+};
+
+/* struct SymTableU64 points at an array of Slots with struct Slot *slots, whose size is a
+power of 2. A key is placed at the slot its hash code selects or, if that is taken, at the
+next free slot after it, wrapping around. */
+struct SymTableU64 {
+    /* an array of the Slots in SymTableU64 */
+    struct Slot *slots;
+    /* number of Slots in slots, minus 1, which masks a slot index */
+    size_t mask;
+    /* number of bits of the hash code that select a slot */
+    int bits;
+    /* number of bindings in SymTableU64, counting the binding of 0 */
+    size_t length;
+    /* 1 if the key 0 is bound, 0 otherwise */
+    int zeroBound;
+    /* the value of the key 0 */
+    void *zeroValue;
+};
+
+/* Return the index of the slot where the search for uKey starts in a table whose hash codes
+have bits bits. Fibonacci hashing multiplies by 2^64 divided by the golden ratio and keeps
+the top bits, which depend on every bit of the key, so that consecutive identifiers spread
+over the whole array. */
+static size_t SymTable_homeU64(uint64_t uKey, int bits) {
+    const uint64_t GOLDEN_RATIO = 0x9E3779B97F4A7C15u;
+    return (size_t)((uKey * GOLDEN_RATIO) >> (64 - bits));
+}
+
+/* Return the index of the slot of oSymTable that holds uKey, which is not 0, or of the
+empty slot that ends its search if uKey isn't in oSymTable. */
+static size_t SymTable_probeU64(SymTableU64_T oSymTable, uint64_t uKey) {
+    size_t i = SymTable_homeU64(uKey, oSymTable->bits);
+    while(oSymTable->slots[i].key != uKey && oSymTable->slots[i].key != 0)
+        i = (i + 1) & oSymTable->mask;
+    return i;
+}
+
+/* doubles the number of Slots oSymTable has, placing every binding again. Returns 1 if
+successful or 0, leaving oSymTable unchanged, if insufficient memory is available. */
+static int SymTable_expandU64(SymTableU64_T oSymTable) {
+    struct Slot *oldSlots = oSymTable->slots;
+    size_t oldCount = oSymTable->mask + 1;
+    struct Slot *newSlots;
+    size_t i;
+
+    newSlots = (struct Slot*)calloc(2 * oldCount, sizeof(struct Slot));
+    if(newSlots == NULL) return 0;
+    oSymTable->slots = newSlots;
+    oSymTable->mask = 2 * oldCount - 1;
+    oSymTable->bits++;
+    for(i = 0; i < oldCount; i++)
+        if(oldSlots[i].key != 0)
+            newSlots[SymTable_probeU64(oSymTable, oldSlots[i].key)] = oldSlots[i];
+    free(oldSlots);
+    return 1;
+}
+
+SymTableU64_T SymTable_newU64(void) {
+    SymTableU64_T newTable = (SymTableU64_T)calloc(1, sizeof(struct SymTableU64));
+    if(newTable == NULL) return NULL;
+    newTable->slots = (struct Slot*)calloc(INITIAL_SLOTS, sizeof(struct Slot));
+    if(newTable->slots == NULL) {
+        free(newTable);
+        return NULL;
+    }
+    newTable->mask = INITIAL_SLOTS - 1;
+    for(newTable->bits = 0; ((size_t)1 << newTable->bits) < INITIAL_SLOTS; newTable->bits++);
+    return newTable;
+}
+
+void SymTable_freeU64(SymTableU64_T oSymTable) {
+    assert(oSymTable != NULL);
+    free(oSymTable->slots);
+    free(oSymTable);
+}
+
+size_t SymTable_getLengthU64(SymTableU64_T oSymTable) {
+    assert(oSymTable != NULL);
+    return oSymTable->length;
+}
+
+int SymTable_putU64(SymTableU64_T oSymTable, uint64_t uKey, const void *pvValue) {
+    size_t i;
+    assert(oSymTable != NULL);
+
+    if(uKey == 0) {
+        if(oSymTable->zeroBound) return 0;
+        oSymTable->zeroBound = 1;
+        oSymTable->zeroValue = (void*)pvValue;
+        oSymTable->length++;
+        return 1;
+    }
+
+    i = SymTable_probeU64(oSymTable, uKey);
+    if(oSymTable->slots[i].key == uKey) return 0;
+    /* keeps at least a quarter of the slots empty so that searches stay short */
+    if(4 * (oSymTable->length + 1) > 3 * (oSymTable->mask + 1)) {
+        if(!SymTable_expandU64(oSymTable)) return 0;
+        i = SymTable_probeU64(oSymTable, uKey);
+    }
+    oSymTable->slots[i].key = uKey;
+    oSymTable->slots[i].value = (void*)pvValue;
+    oSymTable->length++;
+    return 1;
+}
+
+void *SymTable_replaceU64(SymTableU64_T oSymTable, uint64_t uKey, const void *pvValue) {
+    void *output;
+    size_t i;
+    assert(oSymTable != NULL);
+
+    if(uKey == 0) {
+        if(!oSymTable->zeroBound) return NULL;
+        output = oSymTable->zeroValue;
+        oSymTable->zeroValue = (void*)pvValue;
+        return output;
+    }
+    i = SymTable_probeU64(oSymTable, uKey);
+    if(oSymTable->slots[i].key != uKey) return NULL;
+    output = oSymTable->slots[i].value;
+    oSymTable->slots[i].value = (void*)pvValue;
+    return output;
+}
+
+int SymTable_containsU64(SymTableU64_T oSymTable, uint64_t uKey) {
+    assert(oSymTable != NULL);
+    if(uKey == 0) return oSymTable->zeroBound;
+    return oSymTable->slots[SymTable_probeU64(oSymTable, uKey)].key == uKey;
+}
+
+void *SymTable_getU64(SymTableU64_T oSymTable, uint64_t uKey) {
+    size_t i;
+    assert(oSymTable != NULL);
+    if(uKey == 0) return oSymTable->zeroBound ? oSymTable->zeroValue : NULL;
+    i = SymTable_probeU64(oSymTable, uKey);
+    if(oSymTable->slots[i].key != uKey) return NULL;
+    return oSymTable->slots[i].value;
+}
+
+void *SymTable_removeU64(SymTableU64_T oSymTable, uint64_t uKey) {
+    void *output;
+    size_t i;
+    size_t j;
+    size_t home;
+    assert(oSymTable != NULL);
+
+    if(uKey == 0) {
+        if(!oSymTable->zeroBound) return NULL;
+        oSymTable->zeroBound = 0;
+        oSymTable->length--;
+        return oSymTable->zeroValue;
+    }
+
+    i = SymTable_probeU64(oSymTable, uKey);
+    if(oSymTable->slots[i].key != uKey) return NULL;
+    output = oSymTable->slots[i].value;
+
+    /* shifts back the bindings after the hole whose search would otherwise stop at it, so
+       that no tombstones are needed */
+    for(j = (i + 1) & oSymTable->mask; oSymTable->slots[j].key != 0;
+        j = (j + 1) & oSymTable->mask) {
+        home = SymTable_homeU64(oSymTable->slots[j].key, oSymTable->bits);
+        if(((j - home) & oSymTable->mask) >= ((j - i) & oSymTable->mask)) {
+            oSymTable->slots[i] = oSymTable->slots[j];
+            i = j;
+        }
+    }
+    oSymTable->slots[i].key = 0;
+    oSymTable->length--;
+    return output;
+}
+
+void SymTable_mapU64(SymTableU64_T oSymTable,
+void (*pfApply)(uint64_t uKey, void *pvValue, void *pvExtra), const void *pvExtra) {
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    if(oSymTable->zeroBound) pfApply(0, oSymTable->zeroValue, (void*)pvExtra);
+    for(i = 0; i <= oSymTable->mask; i++)
+        if(oSymTable->slots[i].key != 0)
+            pfApply(oSymTable->slots[i].key, oSymTable->slots[i].value, (void*)pvExtra);
+}
@@ -0,0 +1,50 @@
+/******************************************************************/
+/* symtableu64.h                                                  */
+/* Author: Yavuz Gonen                                            */
+/******************************************************************/
+
+#ifndef SYMTABLEU64_INCLUDED
+#define SYMTABLEU64_INCLUDED
+#include <stddef.h>
+#include <stdint.h>
+/* struct SymTableU64 stores pairings of 64 bit integers and values attached to those
+integers. It serves integer identifiers without rendering them as strings: keys are stored
+inline in one open addressed array, so a binding costs no allocation of its own. */
+struct SymTableU64;
+/* SymTableU64_T is an alias for SymTableU64 */
+typedef struct SymTableU64 *SymTableU64_T;
+
+/* Returns a new SymTableU64 object with no bindings, or NULL if insufficient memory is
+available */
+SymTableU64_T SymTable_newU64(void);
+
+/* Frees all memory occupied by oSymTable. */
+void SymTable_freeU64(SymTableU64_T oSymTable);
+
+/* Returns the number of bindings oSymTable has */
+size_t SymTable_getLengthU64(SymTableU64_T oSymTable);
+
+/* Adds uKey into oSymTable and assigns uKey the value pvValue. Returns 1 if the addition was
+successful and 0 if uKey is already in oSymTable or if insufficient memory is available. */
+int SymTable_putU64(SymTableU64_T oSymTable, uint64_t uKey, const void *pvValue);
+
+/* Changes the value assigned to uKey inside oSymTable to pvValue. Returns the previous value
+of uKey or NULL if uKey isn't in oSymTable */
+void *SymTable_replaceU64(SymTableU64_T oSymTable, uint64_t uKey, const void *pvValue);
+
+/* Returns 1 if oSymTable has a binding with uKey as its key. Returns 0 if not. */
+int SymTable_containsU64(SymTableU64_T oSymTable, uint64_t uKey);
+
+/* Returns the value assigned to uKey inside oSymTable or NULL if uKey isn't in oSymTable */
+void *SymTable_getU64(SymTableU64_T oSymTable, uint64_t uKey);
+
+/* If oSymTable contains a binding with key uKey, then removes that binding from oSymTable
+and returns its value. Otherwise leaves oSymTable unchanged and returns NULL. */
+void *SymTable_removeU64(SymTableU64_T oSymTable, uint64_t uKey);
+
+/* Applies the function (*pfApply)(uKey, pvValue, pvExtra) for each uKey and pvValue binding
+in oSymTable, passing pvExtra as an extra parameter. */
+void SymTable_mapU64(SymTableU64_T oSymTable,
+void (*pfApply)(uint64_t uKey, void *pvValue, void *pvExtra), const void *pvExtra);
+
+#endif
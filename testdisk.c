@@ -0,0 +1,319 @@
+/*--------------------------------------------------------------------*/
+/* testdisk.c                                                         */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#include "symtabledisk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* The size of the buffer of a key, long enough that a few hundred
+   keys fill many pages */
+
+enum {MAX_KEY_LENGTH = 320};
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write into pcKey the key of index i: its number padded with
+   dots, to a length that varies with i. */
+
+static void makeKey(char *pcKey, int i)
+{
+   size_t uLength;
+   sprintf(pcKey, "%d", i);
+   uLength = strlen(pcKey);
+   memset(pcKey + uLength, '.', (size_t)(i % 300));
+   pcKey[uLength + (size_t)(i % 300)] = '\0';
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the count that pvExtra points to and check that pvValue
+   is the index of the key pcKey. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   ASSURE(atoi(pcKey) == *(int*)pvValue);
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The number of values freeValue has been called with */
+
+static size_t uFreedValues;
+
+/*--------------------------------------------------------------------*/
+
+/* Count pvValue as freed. */
+
+static void freeValue(void *pvValue)
+{
+   assert(pvValue != NULL);
+   uFreedValues++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable with iBindingCount long keys and a cache of only
+   four pages, so that most pages are in the file. */
+
+static void testEviction(int iBindingCount)
+{
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int *piIndices;
+   size_t uReads;
+   size_t uWrites;
+   size_t uPages;
+   size_t uCompacted;
+   size_t uCount;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable whose pages do not fit in its cache.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   piIndices = (int*)malloc((size_t)(iBindingCount + 1) * sizeof(int));
+   ASSURE(piIndices != NULL);
+   for (i = 0; i < iBindingCount; i++)
+      piIndices[i] = i;
+
+   oSymTable = SymTable_newDisk(".", 4, NULL);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      makeKey(acKey, i);
+      ASSURE(SymTable_put(oSymTable, acKey, &piIndices[i]));
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+   SymTable_getPageStats(oSymTable, &uReads, &uWrites, &uPages);
+   if (iBindingCount >= 200)
+      ASSURE(uWrites > 0 && uPages > 4);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      makeKey(acKey, i);
+      ASSURE(! SymTable_put(oSymTable, acKey, &piIndices[0]));
+      ASSURE(SymTable_get(oSymTable, acKey) == &piIndices[i]);
+      acKey[strlen(acKey) / 2] = '#';
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iBindingCount);
+   SymTable_getPageStats(oSymTable, &uReads, NULL, NULL);
+   if (iBindingCount >= 200)
+      ASSURE(uReads > 0);
+
+   /* Removing bindings empties overflow pages, which are reused. */
+   for (i = 0; i < iBindingCount; i += 2)
+   {
+      makeKey(acKey, i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &piIndices[i]);
+      ASSURE(SymTable_remove(oSymTable, acKey) == NULL);
+   }
+   for (i = 1; i < iBindingCount; i += 2)
+   {
+      makeKey(acKey, i);
+      ASSURE(SymTable_replace(oSymTable, acKey, &piIndices[i - 1]) ==
+         &piIndices[i]);
+      ASSURE(SymTable_replace(oSymTable, acKey, &piIndices[i]) ==
+         &piIndices[i - 1]);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)(iBindingCount / 2));
+   SymTable_getPageStats(oSymTable, NULL, NULL, &uPages);
+
+   /* Compacting packs each chain onto consecutive pages of a new file
+      and leaves out the free pages. */
+   ASSURE(SymTable_compact(oSymTable));
+   SymTable_getPageStats(oSymTable, NULL, NULL, &uCompacted);
+   ASSURE(uCompacted <= uPages);
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)(iBindingCount / 2));
+   for (i = 0; i < iBindingCount; i++)
+   {
+      makeKey(acKey, i);
+      ASSURE(SymTable_get(oSymTable, acKey) ==
+         (i % 2 == 1 ? &piIndices[i] : NULL));
+   }
+   for (i = 0; i < iBindingCount; i += 2)
+   {
+      makeKey(acKey, i);
+      ASSURE(SymTable_put(oSymTable, acKey, &piIndices[i]));
+   }
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iBindingCount);
+   SymTable_free(oSymTable);
+   free(piIndices);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test keys of the longest length a page holds, and one longer. */
+
+static void testLongKeys(void)
+{
+   SymTable_T oSymTable;
+   char *pcKey;
+   size_t uMax = SymTable_getMaxKeyLength();
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing keys as long as a page.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   ASSURE(uMax >= 1000);
+   pcKey = (char*)malloc(uMax + 2);
+   ASSURE(pcKey != NULL);
+   memset(pcKey, 'k', uMax + 1);
+   pcKey[uMax + 1] = '\0';
+
+   oSymTable = SymTable_newDisk(NULL, 2, NULL);
+   ASSURE(oSymTable != NULL);
+   ASSURE(! SymTable_put(oSymTable, pcKey, pcKey));
+   for (i = 0; i < 8; i++)
+   {
+      pcKey[i] = 'a';
+      ASSURE(SymTable_putN(oSymTable, pcKey, uMax, pcKey + i));
+   }
+   for (i = 0; i < 8; i++)
+   {
+      ASSURE(SymTable_getN(oSymTable, pcKey, uMax) == pcKey + 7 - i);
+      ASSURE(SymTable_removeN(oSymTable, pcKey, uMax) == pcKey + 7 - i);
+      pcKey[7 - i] = 'k';
+   }
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   SymTable_free(oSymTable);
+   free(pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_clear() and the set operations on SymTables with
+   iBindingCount bindings and small caches, whose values they own. */
+
+static void testClearAndSetOps(int iBindingCount)
+{
+   struct SymTableOps sOps = {freeValue, NULL, NULL};
+   SymTable_T oSymTable1;
+   SymTable_T oSymTable2;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   int iHalf = iBindingCount / 2;
+   size_t uPages;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_clear(), SymTable_merge(), "
+      "SymTable_intersect() and SymTable_diff() with small caches.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   uFreedValues = 0;
+   oSymTable1 = SymTable_newDisk(NULL, 3, &sOps);
+   oSymTable2 = SymTable_newDisk(NULL, 5, &sOps);
+   ASSURE(oSymTable1 != NULL && oSymTable2 != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      makeKey(acKey, i);
+      ASSURE(SymTable_put(oSymTable1, acKey, acValue));
+      makeKey(acKey, i + iHalf);
+      ASSURE(SymTable_put(oSymTable2, acKey, acValue));
+   }
+
+   ASSURE(SymTable_merge(oSymTable1, oSymTable2));
+   ASSURE(SymTable_getLength(oSymTable1) ==
+      (size_t)(iBindingCount + iHalf));
+   ASSURE(SymTable_getLength(oSymTable2) ==
+      (size_t)(iBindingCount - iHalf));
+   ASSURE(uFreedValues == 0);
+   ASSURE(SymTable_intersect(oSymTable1, oSymTable2, NULL, NULL) ==
+      (size_t)(2 * iHalf));
+   ASSURE(uFreedValues == (size_t)(2 * iHalf));
+   for (i = 0; i < iBindingCount + iHalf; i++)
+   {
+      makeKey(acKey, i);
+      ASSURE(SymTable_contains(oSymTable1, acKey) ==
+         (i >= iHalf && i < iBindingCount));
+   }
+   ASSURE(SymTable_diff(oSymTable2, oSymTable1, NULL, NULL) ==
+      (size_t)(iBindingCount - iHalf));
+   ASSURE(SymTable_getLength(oSymTable2) == 0);
+
+   /* A cleared table starts again from one page. */
+   uFreedValues = 0;
+   SymTable_clear(oSymTable1);
+   ASSURE(uFreedValues == (size_t)(iBindingCount - iHalf));
+   ASSURE(SymTable_getLength(oSymTable1) == 0);
+   SymTable_getPageStats(oSymTable1, NULL, NULL, &uPages);
+   ASSURE(uPages == 1);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      makeKey(acKey, i);
+      ASSURE(! SymTable_contains(oSymTable1, acKey));
+      ASSURE(SymTable_put(oSymTable1, acKey, acValue));
+   }
+   ASSURE(SymTable_getLength(oSymTable1) == (size_t)iBindingCount);
+
+   uFreedValues = 0;
+   SymTable_free(oSymTable1);
+   SymTable_free(oSymTable2);
+   ASSURE(uFreedValues == (size_t)iBindingCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the functions that only the disk-backed implementation of the
+   SymTable ADT provides. argv[1] is the number of bindings used by
+   the larger tests. Exit with EXIT_FAILURE if argv[1] is missing or
+   not numeric. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1 || iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount must be a nonnegative number\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testEviction(iBindingCount);
+   testLongKeys();
+   testClearAndSetOps(iBindingCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
@@ -0,0 +1,739 @@
+/*--------------------------------------------------------------------*/
+/* testext.c                                                          */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the functions that take the key as a length and a pointer
+   into a larger buffer. */
+
+static void testSlices(void)
+{
+   SymTable_T oSymTable;
+   const char acSource[] = "count = count + counter;";
+   char acInt[] = "int";
+   char acLong[] = "long";
+   char *pcValue;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the functions that take keys as slices.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* "count" at offset 0 */
+   iSuccessful = SymTable_putN(oSymTable, acSource, 5, acInt);
+   ASSURE(iSuccessful);
+
+   /* "count" again at offset 8 is the same key */
+   iSuccessful = SymTable_putN(oSymTable, acSource + 8, 5, acLong);
+   ASSURE(! iSuccessful);
+
+   /* "counter" at offset 16 shares the prefix but is another key */
+   iSuccessful = SymTable_putN(oSymTable, acSource + 16, 7, acLong);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+
+   pcValue = (char*)SymTable_getN(oSymTable, acSource + 8, 5);
+   ASSURE(pcValue == acInt);
+   pcValue = (char*)SymTable_getN(oSymTable, acSource + 16, 7);
+   ASSURE(pcValue == acLong);
+   pcValue = (char*)SymTable_getN(oSymTable, acSource + 16, 6);
+   ASSURE(pcValue == NULL);
+   ASSURE(SymTable_containsN(oSymTable, acSource, 5));
+   ASSURE(! SymTable_containsN(oSymTable, acSource, 4));
+
+   /* Slices and strings name the same keys. */
+   ASSURE(SymTable_get(oSymTable, "count") == acInt);
+   ASSURE(SymTable_get(oSymTable, "counter") == acLong);
+   ASSURE(SymTable_containsN(oSymTable, "counter", 7));
+
+   /* The empty slice is a valid key. */
+   iSuccessful = SymTable_putN(oSymTable, acSource, 0, acInt);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_contains(oSymTable, ""));
+
+   pcValue = (char*)SymTable_removeN(oSymTable, acSource + 16, 7);
+   ASSURE(pcValue == acLong);
+   pcValue = (char*)SymTable_removeN(oSymTable, acSource + 16, 7);
+   ASSURE(pcValue == NULL);
+   ASSURE(SymTable_contains(oSymTable, "count"));
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The number of values that freeValue has released */
+
+static size_t uFreedValues = 0;
+
+/*--------------------------------------------------------------------*/
+
+/* Free pvValue, a SymTable, and count it. */
+
+static void freeValue(void *pvValue)
+{
+   SymTable_free((SymTable_T)pvValue);
+   uFreedValues++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable that owns its values, which are SymTables. */
+
+static void testOwnedValues(void)
+{
+   struct SymTableOps sOps = {freeValue, NULL, NULL};
+   SymTable_T oSymTable;
+   SymTable_T oSymTable1;
+   SymTable_T oSymTable2;
+   SymTable_T oSymTable3;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newWithOps() with a value-free function.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   uFreedValues = 0;
+   oSymTable = SymTable_newWithOps(&sOps);
+   ASSURE(oSymTable != NULL);
+   oSymTable1 = SymTable_new();
+   oSymTable2 = SymTable_new();
+   oSymTable3 = SymTable_new();
+   ASSURE(oSymTable1 != NULL && oSymTable2 != NULL && oSymTable3 != NULL);
+   ASSURE(SymTable_put(oSymTable1, "Jeter", "Shortstop"));
+
+   ASSURE(SymTable_put(oSymTable, "first table", oSymTable1));
+   ASSURE(SymTable_put(oSymTable, "second table", oSymTable2));
+   ASSURE(SymTable_put(oSymTable, "third table", oSymTable3));
+   ASSURE(uFreedValues == 0);
+
+   /* remove and replace release the value they take out */
+   ASSURE(SymTable_remove(oSymTable, "second table") ==
+      (void*)oSymTable2);
+   ASSURE(uFreedValues == 1);
+   ASSURE(SymTable_remove(oSymTable, "second table") == NULL);
+   ASSURE(uFreedValues == 1);
+
+   oSymTable2 = SymTable_new();
+   ASSURE(oSymTable2 != NULL);
+   ASSURE(SymTable_replace(oSymTable, "third table", oSymTable2) ==
+      (void*)oSymTable3);
+   ASSURE(uFreedValues == 2);
+
+   /* free releases the rest without a separate map pass */
+   SymTable_free(oSymTable);
+   ASSURE(uFreedValues == 4);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_clear() on a table with iBindingCount bindings that
+   is then used again. */
+
+static void testClear(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   struct SymTableOps sOps = {freeValue, NULL, NULL};
+   SymTable_T oSymTable;
+   SymTable_T oValue;
+   char acKey[MAX_KEY_LENGTH];
+   int iRound;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_clear().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   uFreedValues = 0;
+   oSymTable = SymTable_newWithOps(&sOps);
+   ASSURE(oSymTable != NULL);
+
+   for (iRound = 0; iRound < 2; iRound++)
+   {
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "%d", i);
+         oValue = SymTable_new();
+         ASSURE(oValue != NULL);
+         ASSURE(SymTable_put(oSymTable, acKey, oValue));
+      }
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+
+      SymTable_clear(oSymTable);
+      ASSURE(SymTable_getLength(oSymTable) == 0);
+      ASSURE(uFreedValues == (size_t)iBindingCount * (iRound + 1));
+      ASSURE(! SymTable_contains(oSymTable, "0"));
+   }
+
+   SymTable_free(oSymTable);
+   ASSURE(uFreedValues == (size_t)iBindingCount * 2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash code of the uLen characters at pcKey, ignoring
+   case. */
+
+static size_t hashNoCase(const char *pcKey, size_t uLen)
+{
+   size_t uHash = 0;
+   size_t u;
+   for (u = 0; u < uLen; u++)
+      uHash = uHash * 31 + (size_t)tolower((unsigned char)pcKey[u]);
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if the uLen characters at pcKey1 and pcKey2 are the same
+   apart from case, and 0 otherwise. */
+
+static int equalsNoCase(const char *pcKey1, const char *pcKey2,
+   size_t uLen)
+{
+   size_t u;
+   for (u = 0; u < uLen; u++)
+      if (tolower((unsigned char)pcKey1[u]) !=
+         tolower((unsigned char)pcKey2[u]))
+         return 0;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable whose keys are compared without regard to case. */
+
+static void testCustomKeys(void)
+{
+   struct SymTableOps sOps = {NULL, hashNoCase, equalsNoCase};
+   SymTable_T oSymTable;
+   char acInt[] = "int";
+   char acLong[] = "long";
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newWithOps() with key functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newWithOps(&sOps);
+   ASSURE(oSymTable != NULL);
+
+   ASSURE(SymTable_put(oSymTable, "Count", acInt));
+   ASSURE(! SymTable_put(oSymTable, "COUNT", acLong));
+   ASSURE(SymTable_put(oSymTable, "Counter", acLong));
+   ASSURE(SymTable_get(oSymTable, "count") == acInt);
+   ASSURE(SymTable_getN(oSymTable, "COUNTERS", 7) == acLong);
+   ASSURE(SymTable_replace(oSymTable, "cOuNt", acLong) == acInt);
+   ASSURE(SymTable_remove(oSymTable, "counter") == acLong);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_memoryUsage() as iBindingCount bindings are added and
+   removed. */
+
+static void testMemoryUsage(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   struct SymTableMemory sUsage;
+   struct SymTableMemory sEmpty;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   size_t uTotal;
+   size_t uKeyLengths = 0;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_memoryUsage().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   uTotal = SymTable_memoryUsage(oSymTable, &sEmpty);
+   ASSURE(uTotal == sEmpty.buckets + sEmpty.nodes + sEmpty.keys +
+      sEmpty.overhead);
+   ASSURE(sEmpty.nodes == 0 && sEmpty.keys == 0);
+   ASSURE(sEmpty.overhead > 0);
+   ASSURE(SymTable_memoryUsage(oSymTable, NULL) == uTotal);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      uKeyLengths += strlen(acKey) + 1;
+      ASSURE(SymTable_put(oSymTable, acKey, NULL));
+   }
+   uTotal = SymTable_memoryUsage(oSymTable, &sUsage);
+   ASSURE(uTotal == sUsage.buckets + sUsage.nodes + sUsage.keys +
+      sUsage.overhead);
+   ASSURE(sUsage.keys >= uKeyLengths);
+   ASSURE(sUsage.buckets >= sEmpty.buckets);
+
+   /* Removing every binding gives back the memory of the keys. */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == NULL);
+   }
+   (void)SymTable_memoryUsage(oSymTable, &sUsage);
+   ASSURE(sUsage.keys == 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the count that pvExtra points to. pcKey and pvValue are
+   unused. */
+
+static void countRemoved(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvValue;
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable that uses the functions of *psOps, or of
+   SymTable_new if psOps is NULL, and binds the iCount keys from
+   iFirst on to pvValue. */
+
+static SymTable_T makeRange(const struct SymTableOps *psOps, int iFirst,
+   int iCount, void *pvValue)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   oSymTable = psOps == NULL ? SymTable_new() :
+      SymTable_newWithOps(psOps);
+   ASSURE(oSymTable != NULL);
+   for (i = iFirst; i < iFirst + iCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, pvValue));
+   }
+   return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_merge(), SymTable_intersect() and SymTable_diff() on
+   a table of the iBindingCount keys from 0 on and one of as many keys
+   from iBindingCount / 2 on. Tables that hash keys differently and
+   alike are both combined. */
+
+static void testSetOps(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   struct SymTableOps sOps = {NULL, hashNoCase, NULL};
+   const struct SymTableOps *psOps;
+   SymTable_T oSymTable1;
+   SymTable_T oSymTable2;
+   char acKey[MAX_KEY_LENGTH];
+   char acFirst[] = "first";
+   char acSecond[] = "second";
+   int iHalf = iBindingCount / 2;
+   size_t uRemoved;
+   int iAlike;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_merge(), SymTable_intersect() and "
+      "SymTable_diff().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (iAlike = 0; iAlike <= 1; iAlike++)
+   {
+      psOps = iAlike ? &sOps : NULL;
+
+      /* A merge moves the keys only the second table binds and leaves
+         it the keys both bind. */
+      oSymTable1 = makeRange(psOps, 0, iBindingCount, acFirst);
+      oSymTable2 = makeRange(psOps, iHalf, iBindingCount, acSecond);
+      ASSURE(SymTable_merge(oSymTable1, oSymTable2));
+      ASSURE(SymTable_getLength(oSymTable1) ==
+         (size_t)(iHalf + iBindingCount));
+      ASSURE(SymTable_getLength(oSymTable2) ==
+         (size_t)(iBindingCount - iHalf));
+      for (i = 0; i < iHalf + iBindingCount; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_get(oSymTable1, acKey) ==
+            (i < iBindingCount ? acFirst : acSecond));
+         ASSURE(SymTable_contains(oSymTable2, acKey) ==
+            (i >= iHalf && i < iBindingCount));
+      }
+      /* Merged bindings are removed and put like any others. */
+      ASSURE(SymTable_remove(oSymTable1, "-1") == NULL);
+      if (iBindingCount > 0)
+      {
+         sprintf(acKey, "%d", iHalf + iBindingCount - 1);
+         ASSURE(SymTable_remove(oSymTable1, acKey) != NULL);
+         ASSURE(SymTable_put(oSymTable1, acKey, acFirst));
+      }
+      SymTable_free(oSymTable1);
+      SymTable_free(oSymTable2);
+
+      /* An intersection removes the keys the second table lacks. */
+      oSymTable1 = makeRange(psOps, 0, iBindingCount, acFirst);
+      oSymTable2 = makeRange(psOps, iHalf, iBindingCount, acSecond);
+      uRemoved = 0;
+      ASSURE(SymTable_intersect(oSymTable1, oSymTable2, countRemoved,
+         &uRemoved) == (size_t)iHalf);
+      ASSURE(uRemoved == (size_t)iHalf);
+      ASSURE(SymTable_getLength(oSymTable1) ==
+         (size_t)(iBindingCount - iHalf));
+      ASSURE(SymTable_getLength(oSymTable2) == (size_t)iBindingCount);
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_contains(oSymTable1, acKey) == (i >= iHalf));
+      }
+
+      /* A difference then removes the keys the second table binds. */
+      ASSURE(SymTable_diff(oSymTable1, oSymTable2, NULL, NULL) ==
+         (size_t)(iBindingCount - iHalf));
+      ASSURE(SymTable_getLength(oSymTable1) == 0);
+      ASSURE(SymTable_put(oSymTable1, "0", acFirst));
+      SymTable_free(oSymTable1);
+
+      oSymTable1 = makeRange(psOps, 0, iBindingCount, acFirst);
+      ASSURE(SymTable_diff(oSymTable1, oSymTable2, NULL, NULL) ==
+         (size_t)(iBindingCount - iHalf));
+      ASSURE(SymTable_getLength(oSymTable1) == (size_t)iHalf);
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_contains(oSymTable1, acKey) == (i < iHalf));
+      }
+      SymTable_free(oSymTable1);
+      SymTable_free(oSymTable2);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the count that pvExtra points to and check that pvValue is
+   the index of the key pcKey. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   ASSURE(atoi(pcKey) == *(int*)pvValue);
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_compact() on a table of iBindingCount bindings that
+   have been removed and put again, on a table that owns its values
+   and on a compacted table that bindings are merged from. */
+
+static void testCompact(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   struct SymTableOps sOps = {freeValue, NULL, NULL};
+   SymTable_T oSymTable;
+   SymTable_T oSource;
+   char acKey[MAX_KEY_LENGTH];
+   char acFirst[] = "first";
+   int *piIndices;
+   size_t uCount;
+   int iRound;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_compact().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   piIndices = (int*)malloc((size_t)(iBindingCount + 1) * sizeof(int));
+   ASSURE(piIndices != NULL);
+   for (i = 0; i < iBindingCount; i++)
+      piIndices[i] = i;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_compact(oSymTable));
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, &piIndices[i]));
+   }
+
+   /* Each round removes a third of the bindings and puts them again,
+      so that their nodes are scattered, before compacting. */
+   for (iRound = 0; iRound < 3; iRound++)
+   {
+      for (i = iRound; i < iBindingCount; i += 3)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_remove(oSymTable, acKey) == &piIndices[i]);
+      }
+      for (i = iRound; i < iBindingCount; i += 3)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_put(oSymTable, acKey, &piIndices[i]));
+      }
+      ASSURE(SymTable_compact(oSymTable));
+      ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_get(oSymTable, acKey) == &piIndices[i]);
+      }
+      ASSURE(! SymTable_contains(oSymTable, "-1"));
+      uCount = 0;
+      SymTable_map(oSymTable, countBinding, &uCount);
+      ASSURE(uCount == (size_t)iBindingCount);
+   }
+
+   /* Compacted bindings are removed and put like any others. */
+   for (i = 0; i < iBindingCount; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &piIndices[i]);
+   }
+   ASSURE(SymTable_put(oSymTable, "-1", &piIndices[0]));
+   ASSURE(SymTable_compact(oSymTable));
+   ASSURE(SymTable_get(oSymTable, "-1") == &piIndices[0]);
+   ASSURE(SymTable_getLength(oSymTable) ==
+      (size_t)(iBindingCount / 2 + 1));
+   SymTable_free(oSymTable);
+
+   /* Compacting does not release the values a table owns. */
+   uFreedValues = 0;
+   oSymTable = SymTable_newWithOps(&sOps);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_put(oSymTable, "first table", SymTable_new()));
+   ASSURE(SymTable_put(oSymTable, "second table", SymTable_new()));
+   ASSURE(SymTable_compact(oSymTable));
+   ASSURE(uFreedValues == 0);
+   ASSURE(SymTable_remove(oSymTable, "first table") != NULL);
+   ASSURE(uFreedValues == 1);
+   SymTable_free(oSymTable);
+   ASSURE(uFreedValues == 2);
+
+   /* Bindings merged out of a compacted table outlive it. */
+   oSymTable = makeRange(NULL, 0, iBindingCount, acFirst);
+   oSource = makeRange(NULL, iBindingCount / 2, iBindingCount, acFirst);
+   ASSURE(SymTable_compact(oSource));
+   ASSURE(SymTable_merge(oSymTable, oSource));
+   SymTable_free(oSource);
+   ASSURE(SymTable_getLength(oSymTable) ==
+      (size_t)(iBindingCount / 2 + iBindingCount));
+   for (i = 0; i < iBindingCount / 2 + iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == acFirst);
+   }
+   SymTable_free(oSymTable);
+   free(piIndices);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if the number pcKey is below the limit that pvExtra points
+   to, and 0 otherwise. pvValue is unused. */
+
+static int isBelow(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   (void)pvValue;
+   return atoi(pcKey) < *(int*)pvExtra;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if the number pcKey is odd, and 0 otherwise, and add 1 to
+   the count that pvExtra points to. pvValue is unused. */
+
+static int isOdd(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   (void)pvValue;
+   (*(size_t*)pvExtra)++;
+   return atoi(pcKey) % 2 == 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1, selecting every binding. pcKey, pvValue and pvExtra are
+   unused. */
+
+static int isAny(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvValue;
+   (void)pvExtra;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_removeIf() on a table of iBindingCount bindings, on
+   one that hashes keys without regard to case and on one that owns
+   its values. */
+
+static void testRemoveIf(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   struct SymTableOps sOps = {NULL, hashNoCase, NULL};
+   struct SymTableOps sOwningOps = {freeValue, NULL, NULL};
+   SymTable_T oSymTable;
+   SymTable_T oValue;
+   char acKey[MAX_KEY_LENGTH];
+   char acFirst[] = "first";
+   size_t uCalls;
+   size_t uCount;
+   int iLimit;
+   int iAlike;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_removeIf().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (iAlike = 0; iAlike <= 1; iAlike++)
+   {
+      /* The predicate sees each binding once, and only the ones it
+         selects leave. */
+      oSymTable = makeRange(iAlike ? &sOps : NULL, 0, iBindingCount,
+         acFirst);
+      uCalls = 0;
+      ASSURE(SymTable_removeIf(oSymTable, isOdd, &uCalls) ==
+         (size_t)(iBindingCount / 2));
+      ASSURE(uCalls == (size_t)iBindingCount);
+      ASSURE(SymTable_getLength(oSymTable) ==
+         (size_t)(iBindingCount - iBindingCount / 2));
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_contains(oSymTable, acKey) == (i % 2 == 0));
+      }
+      uCount = 0;
+      SymTable_map(oSymTable, countRemoved, &uCount);
+      ASSURE(uCount == (size_t)(iBindingCount - iBindingCount / 2));
+
+      /* A removed key can be put again, and a later pass sees it. */
+      if (iBindingCount > 1)
+      {
+         ASSURE(SymTable_put(oSymTable, "1", acFirst));
+         ASSURE(SymTable_get(oSymTable, "1") == acFirst);
+      }
+      iLimit = iBindingCount / 4;
+      ASSURE(SymTable_removeIf(oSymTable, isBelow, &iLimit) ==
+         (size_t)((iLimit + 1) / 2 + (iLimit > 1)));
+      ASSURE(! SymTable_contains(oSymTable, "0") || iLimit == 0);
+      ASSURE(SymTable_removeIf(oSymTable, isBelow, &iLimit) == 0);
+
+      uCount = SymTable_getLength(oSymTable);
+      ASSURE(SymTable_removeIf(oSymTable, isAny, NULL) == uCount);
+      ASSURE(SymTable_getLength(oSymTable) == 0);
+      ASSURE(SymTable_removeIf(oSymTable, isAny, NULL) == 0);
+      ASSURE(SymTable_put(oSymTable, "0", acFirst));
+      ASSURE(SymTable_get(oSymTable, "0") == acFirst);
+      SymTable_free(oSymTable);
+   }
+
+   /* The values removed are released. */
+   uFreedValues = 0;
+   oSymTable = SymTable_newWithOps(&sOwningOps);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < 10; i++)
+   {
+      sprintf(acKey, "%d", i);
+      oValue = SymTable_new();
+      ASSURE(oValue != NULL);
+      ASSURE(SymTable_put(oSymTable, acKey, oValue));
+   }
+   uCalls = 0;
+   ASSURE(SymTable_removeIf(oSymTable, isOdd, &uCalls) == 5);
+   ASSURE(uFreedValues == 5);
+   SymTable_free(oSymTable);
+   ASSURE(uFreedValues == 10);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the extended functions of the SymTable ADT. argv[1] is the
+   number of bindings used by the larger tests. Exit with
+   EXIT_FAILURE if argv[1] is missing or not numeric. Otherwise
+   return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1 || iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount must be a nonnegative number\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testSlices();
+   testOwnedValues();
+   testClear(iBindingCount);
+   testCustomKeys();
+   testMemoryUsage(iBindingCount);
+   testSetOps(iBindingCount);
+   testCompact(iBindingCount);
+   testRemoveIf(iBindingCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
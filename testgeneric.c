@@ -0,0 +1,167 @@
+/*--------------------------------------------------------------------*/
+/* testgeneric.c                                                      */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#include "symtablegeneric.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A Point is the value type of the tables under test. */
+
+struct Point
+{
+   /* the horizontal coordinate */
+   int iX;
+   /* the vertical coordinate */
+   int iY;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash code of the identifier uId. */
+
+static size_t hashId(uint64_t uId)
+{
+   return (size_t)(uId * 0x9E3779B97F4A7C15u >> 17);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if the identifiers uId1 and uId2 are equal and 0
+   otherwise. */
+
+static int equalsId(uint64_t uId1, uint64_t uId2)
+{
+   return uId1 == uId2;
+}
+
+/*--------------------------------------------------------------------*/
+
+SYMTABLE_DEFINE_TABLE(PointTable, uint64_t, struct Point, hashId,
+   equalsId)
+
+/*--------------------------------------------------------------------*/
+
+/* Add the x coordinate of the point that pPoint points to and uId to
+   the sum that pvExtra points to. */
+
+static void sumPoint(uint64_t uId, struct Point *pPoint, void *pvExtra)
+{
+   *(uint64_t*)pvExtra += uId + (uint64_t)pPoint->iX;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a table of uint64_t keys and struct Point values with
+   iBindingCount bindings. */
+
+static void testPointTable(int iBindingCount)
+{
+   PointTable_T oTable;
+   struct Point sPoint;
+   struct Point *pPoint;
+   uint64_t uSum = 0;
+   uint64_t uExpected = 0;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a table generated by SYMTABLE_DEFINE_TABLE.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oTable = PointTable_new();
+   ASSURE(oTable != NULL);
+   ASSURE(PointTable_getLength(oTable) == 0);
+   ASSURE(PointTable_get(oTable, 7) == NULL);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sPoint.iX = i;
+      sPoint.iY = -i;
+      ASSURE(PointTable_put(oTable, (uint64_t)i * 1000003, sPoint));
+   }
+   ASSURE(! PointTable_put(oTable, 0, sPoint));
+   ASSURE(PointTable_getLength(oTable) == (size_t)iBindingCount);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      pPoint = PointTable_get(oTable, (uint64_t)i * 1000003);
+      ASSURE(pPoint != NULL && pPoint->iX == i && pPoint->iY == -i);
+      ASSURE(! PointTable_contains(oTable, (uint64_t)i * 1000003 + 1));
+      uExpected += (uint64_t)i * 1000003 + (uint64_t)i;
+   }
+
+   PointTable_map(oTable, sumPoint, &uSum);
+   ASSURE(uSum == uExpected);
+
+   /* Values are changed in place through the pointer from get. */
+   if (iBindingCount > 0)
+   {
+      PointTable_get(oTable, 0)->iY = 42;
+      ASSURE(PointTable_get(oTable, 0)->iY == 42);
+   }
+
+   for (i = 0; i < iBindingCount; i += 2)
+   {
+      ASSURE(PointTable_remove(oTable, (uint64_t)i * 1000003, &sPoint));
+      ASSURE(sPoint.iX == i);
+      ASSURE(! PointTable_remove(oTable, (uint64_t)i * 1000003, NULL));
+   }
+   ASSURE(PointTable_getLength(oTable) == (size_t)iBindingCount / 2);
+   for (i = 0; i < iBindingCount; i++)
+      ASSURE(PointTable_contains(oTable, (uint64_t)i * 1000003) ==
+         (i % 2 == 1));
+
+   PointTable_free(oTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the tables that symtablegeneric.h generates. argv[1] is the
+   number of bindings used by the larger tests. Exit with EXIT_FAILURE
+   if argv[1] is missing or not numeric. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1 || iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount must be a nonnegative number\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testPointTable(iBindingCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
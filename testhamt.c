@@ -0,0 +1,226 @@
+/*--------------------------------------------------------------------*/
+/* testhamt.c                                                         */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#include "symtablehamt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that a clone and its original can change independently. */
+
+static void testClone(void)
+{
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char acFirstBase[] = "First Base";
+   char *pcValue;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_clone().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "Jeter", acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "Mantle", acCenterField);
+   ASSURE(iSuccessful);
+
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   ASSURE(SymTable_getLength(oClone) == 2);
+
+   /* Changes to the clone must not show in the original. */
+   iSuccessful = SymTable_put(oClone, "Gehrig", acFirstBase);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oClone) == 3);
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+   ASSURE(! SymTable_contains(oSymTable, "Gehrig"));
+
+   pcValue = (char*)SymTable_replace(oClone, "Jeter", acFirstBase);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_get(oSymTable, "Jeter");
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_get(oClone, "Jeter");
+   ASSURE(pcValue == acFirstBase);
+
+   /* Changes to the original must not show in the clone. */
+   pcValue = (char*)SymTable_remove(oSymTable, "Mantle");
+   ASSURE(pcValue == acCenterField);
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   pcValue = (char*)SymTable_get(oClone, "Mantle");
+   ASSURE(pcValue == acCenterField);
+
+   /* Freeing the original must leave the clone intact. */
+   SymTable_free(oSymTable);
+   pcValue = (char*)SymTable_get(oClone, "Gehrig");
+   ASSURE(pcValue == acFirstBase);
+   ASSURE(SymTable_getLength(oClone) == 3);
+
+   SymTable_free(oClone);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a sequence of versions built with SymTable_putVersion() and
+   SymTable_removeVersion(), each of which must keep its own
+   bindings. */
+
+static void testVersions(void)
+{
+   enum {VERSION_COUNT = 200};
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T aoVersions[VERSION_COUNT + 1];
+   SymTable_T oRemoved;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+   int j;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_putVersion() and SymTable_removeVersion().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   aoVersions[0] = SymTable_new();
+   ASSURE(aoVersions[0] != NULL);
+   for (i = 0; i < VERSION_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      aoVersions[i + 1] = SymTable_putVersion(aoVersions[i], acKey, NULL);
+      ASSURE(aoVersions[i + 1] != NULL);
+   }
+
+   /* A duplicate key yields no new version. */
+   ASSURE(SymTable_putVersion(aoVersions[VERSION_COUNT], "0", NULL) == NULL);
+
+   /* Version i holds exactly the keys 0 through i-1. */
+   for (i = 0; i <= VERSION_COUNT; i += 50)
+   {
+      ASSURE(SymTable_getLength(aoVersions[i]) == (size_t)i);
+      for (j = 0; j < VERSION_COUNT; j++)
+      {
+         sprintf(acKey, "%d", j);
+         ASSURE(SymTable_contains(aoVersions[i], acKey) == (j < i));
+      }
+   }
+
+   oRemoved = SymTable_removeVersion(aoVersions[VERSION_COUNT], "7");
+   ASSURE(oRemoved != NULL);
+   ASSURE(SymTable_getLength(oRemoved) == VERSION_COUNT - 1);
+   ASSURE(! SymTable_contains(oRemoved, "7"));
+   ASSURE(SymTable_contains(aoVersions[VERSION_COUNT], "7"));
+   SymTable_free(oRemoved);
+
+   for (i = 0; i <= VERSION_COUNT; i++)
+      SymTable_free(aoVersions[i]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that emptying a clone of a table with iBindingCount bindings
+   leaves the original untouched. */
+
+static void testEmptyClone(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   SymTable_T oClone;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the removal of every binding from a clone.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, NULL);
+      ASSURE(iSuccessful);
+   }
+
+   oClone = SymTable_clone(oSymTable);
+   ASSURE(oClone != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oClone, acKey));
+      (void)SymTable_remove(oClone, acKey);
+      ASSURE(! SymTable_contains(oClone, acKey));
+   }
+   ASSURE(SymTable_getLength(oClone) == 0);
+
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey));
+   }
+
+   SymTable_free(oClone);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the persistent operations of the SymTable ADT. argv[1] is the
+   number of bindings to put into the cloned table. Exit with
+   EXIT_FAILURE if argv[1] is missing or not numeric. Otherwise
+   return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1 || iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount must be a nonnegative number\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testClone();
+   testVersions();
+   testEmptyClone(iBindingCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
@@ -0,0 +1,1733 @@
+/*--------------------------------------------------------------------*/
+/* testhashext.c                                                      */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#include "symtablehash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test nested scopes with shadowed bindings. */
+
+static void testScopes(void)
+{
+   SymTable_T oSymTable;
+   char acGlobal[] = "global";
+   char acOuter[] = "outer";
+   char acInner[] = "inner";
+   char *pcValue;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_enterScope() and SymTable_exitScope().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getScopeDepth(oSymTable) == 0);
+
+   ASSURE(SymTable_put(oSymTable, "x", acGlobal));
+   ASSURE(SymTable_put(oSymTable, "y", acGlobal));
+
+   ASSURE(SymTable_enterScope(oSymTable));
+   ASSURE(SymTable_getScopeDepth(oSymTable) == 1);
+   /* x is shadowed, z is new, and a second x in the scope fails */
+   ASSURE(SymTable_put(oSymTable, "x", acOuter));
+   ASSURE(! SymTable_put(oSymTable, "x", acInner));
+   ASSURE(SymTable_put(oSymTable, "z", acOuter));
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+
+   ASSURE(SymTable_enterScope(oSymTable));
+   ASSURE(SymTable_put(oSymTable, "x", acInner));
+   ASSURE(SymTable_put(oSymTable, "y", acInner));
+   ASSURE(SymTable_put(oSymTable, "w", acInner));
+   pcValue = (char*)SymTable_get(oSymTable, "x");
+   ASSURE(pcValue == acInner);
+   pcValue = (char*)SymTable_get(oSymTable, "z");
+   ASSURE(pcValue == acOuter);
+   ASSURE(SymTable_getLength(oSymTable) == 4);
+
+   /* Removing the innermost y uncovers the global one. */
+   pcValue = (char*)SymTable_remove(oSymTable, "y");
+   ASSURE(pcValue == acInner);
+   pcValue = (char*)SymTable_get(oSymTable, "y");
+   ASSURE(pcValue == acGlobal);
+
+   SymTable_exitScope(oSymTable);
+   pcValue = (char*)SymTable_get(oSymTable, "x");
+   ASSURE(pcValue == acOuter);
+   pcValue = (char*)SymTable_get(oSymTable, "y");
+   ASSURE(pcValue == acGlobal);
+   ASSURE(! SymTable_contains(oSymTable, "w"));
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+
+   /* Removing a new binding of a scope leaves nothing to undo. */
+   pcValue = (char*)SymTable_remove(oSymTable, "z");
+   ASSURE(pcValue == acOuter);
+
+   SymTable_exitScope(oSymTable);
+   ASSURE(SymTable_getScopeDepth(oSymTable) == 0);
+   pcValue = (char*)SymTable_get(oSymTable, "x");
+   ASSURE(pcValue == acGlobal);
+   ASSURE(! SymTable_contains(oSymTable, "z"));
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+
+   /* Outside every scope a duplicate put fails again. */
+   ASSURE(! SymTable_put(oSymTable, "x", acInner));
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a scope that holds iBindingCount bindings, enough to expand
+   the table while the scope is open. */
+
+static void testLargeScope(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acOuter[] = "outer";
+   char acInner[] = "inner";
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a scope that holds many bindings.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, acOuter));
+   }
+
+   ASSURE(SymTable_enterScope(oSymTable));
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, acInner));
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+   SymTable_exitScope(oSymTable);
+
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)(iBindingCount + 1) / 2);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) ==
+         (i % 2 == 0 ? acOuter : NULL));
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the count that pvExtra points to and check that pvValue is
+   the value the test bound to pcKey. */
+
+static void countEviction(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   ASSURE(strcmp(pcKey, (char*)pvValue) == 0);
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a bounded SymTable that evicts bindings. */
+
+static void testBounded(void)
+{
+   SymTable_T oSymTable;
+   char acA[] = "a";
+   char acB[] = "b";
+   char acC[] = "c";
+   char acD[] = "d";
+   size_t uEvictions = 0;
+   size_t uHits;
+   size_t uMisses;
+   size_t uEvicted;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newBounded().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newBounded(3, countEviction, &uEvictions);
+   ASSURE(oSymTable != NULL);
+
+   ASSURE(SymTable_put(oSymTable, "a", acA));
+   ASSURE(SymTable_put(oSymTable, "b", acB));
+   ASSURE(SymTable_put(oSymTable, "c", acC));
+   ASSURE(uEvictions == 0);
+
+   /* a is used, so b is the binding that has to go */
+   ASSURE(SymTable_get(oSymTable, "a") == acA);
+   ASSURE(SymTable_put(oSymTable, "d", acD));
+   ASSURE(uEvictions == 1);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+   ASSURE(SymTable_contains(oSymTable, "a"));
+   ASSURE(! SymTable_contains(oSymTable, "b"));
+   ASSURE(SymTable_contains(oSymTable, "c"));
+   ASSURE(SymTable_contains(oSymTable, "d"));
+
+   /* A removed binding frees its place without an eviction. */
+   ASSURE(SymTable_remove(oSymTable, "c") == acC);
+   ASSURE(SymTable_put(oSymTable, "b", acB));
+   ASSURE(uEvictions == 1);
+   ASSURE(SymTable_get(oSymTable, "c") == NULL);
+
+   SymTable_getCacheStats(oSymTable, &uHits, &uMisses, &uEvicted);
+   ASSURE(uHits == 1);
+   ASSURE(uMisses == 1);
+   ASSURE(uEvicted == 1);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a bounded SymTable that receives iBindingCount bindings, many
+   more than it can hold, while one binding is used all along. */
+
+static void testBoundedChurn(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {CAPACITY = 100};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acHot[] = "hot";
+   size_t uEvictions = 0;
+   size_t uEvicted;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a bounded SymTable with many bindings.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newBounded(CAPACITY, NULL, NULL);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_put(oSymTable, "hot", acHot));
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, NULL));
+      ASSURE(SymTable_getLength(oSymTable) <= CAPACITY);
+      ASSURE(SymTable_get(oSymTable, "hot") == acHot);
+      if (i % 7 == 0)
+         (void)SymTable_remove(oSymTable, acKey);
+      else
+         uEvictions++;
+   }
+
+   /* Every put past the capacity evicted exactly one binding. */
+   SymTable_getCacheStats(oSymTable, NULL, NULL, &uEvicted);
+   ASSURE(uEvicted + SymTable_getLength(oSymTable) ==
+      uEvictions + 1);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the time that pvExtra points to, so that the tests decide
+   what time it is. */
+
+static unsigned long readClock(void *pvExtra)
+{
+   return *(unsigned long*)pvExtra;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test bindings that expire, on a clock that the test sets. */
+
+static void testExpiry(void)
+{
+   SymTable_T oSymTable;
+   char acA[] = "a";
+   char acB[] = "b";
+   char acC[] = "c";
+   unsigned long ulNow = 1000;
+   size_t uExpired = 0;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_setExpiry() and SymTable_expire().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   SymTable_setClock(oSymTable, readClock, &ulNow);
+   SymTable_setExpireHandler(oSymTable, countEviction, &uExpired);
+
+   ASSURE(SymTable_put(oSymTable, "a", acA));
+   ASSURE(SymTable_put(oSymTable, "b", acB));
+   ASSURE(SymTable_put(oSymTable, "c", acC));
+   ASSURE(! SymTable_setExpiry(oSymTable, "d", 10));
+
+   /* a expires on the first level, b on the third, and c beyond the
+      last */
+   ASSURE(SymTable_setExpiry(oSymTable, "a", 10));
+   ASSURE(SymTable_setExpiry(oSymTable, "b", 100000));
+   ASSURE(SymTable_setExpiry(oSymTable, "c", 20000000));
+
+   ulNow = 1009;
+   ASSURE(SymTable_expire(oSymTable) == 0);
+   ASSURE(SymTable_get(oSymTable, "a") == acA);
+
+   /* A lookup removes an expired binding it finds. */
+   ulNow = 1010;
+   ASSURE(SymTable_get(oSymTable, "a") == NULL);
+   ASSURE(uExpired == 1);
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+
+   /* Expiry times can be postponed. */
+   ASSURE(SymTable_setExpiry(oSymTable, "b", 100000));
+   ulNow = 100999;
+   ASSURE(SymTable_expire(oSymTable) == 0);
+   ulNow = 101010;
+   ASSURE(SymTable_expire(oSymTable) == 1);
+   ASSURE(uExpired == 2);
+   ASSURE(! SymTable_contains(oSymTable, "b"));
+
+   ulNow = 20000999;
+   ASSURE(SymTable_expire(oSymTable) == 0);
+   ASSURE(SymTable_contains(oSymTable, "c"));
+   ulNow = 20001000;
+   ASSURE(SymTable_expire(oSymTable) == 1);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+
+   /* An expired key can be bound again, and then does not expire. */
+   ASSURE(SymTable_put(oSymTable, "a", acA));
+   ASSURE(SymTable_setExpiry(oSymTable, "a", 0));
+   ASSURE(SymTable_put(oSymTable, "a", acA));
+   ASSURE(uExpired == 4);
+   ulNow += 1000;
+   ASSURE(SymTable_expire(oSymTable) == 0);
+   ASSURE(SymTable_get(oSymTable, "a") == acA);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test iBindingCount bindings with many different lifetimes, swept
+   at regular times. */
+
+static void testExpirySweep(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {MAX_LIFETIME = 300000};
+   enum {STEP = 997};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   unsigned long ulNow = 0;
+   unsigned long ulLifetime;
+   size_t uDue;
+   size_t uExpired = 0;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_expire() with many bindings.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   SymTable_setClock(oSymTable, readClock, &ulNow);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, NULL));
+      ASSURE(SymTable_setExpiry(oSymTable, acKey,
+         ((unsigned long)i * 7919) % MAX_LIFETIME));
+   }
+
+   for (ulNow = 0; ulNow <= MAX_LIFETIME + STEP; ulNow += STEP)
+   {
+      uExpired += SymTable_expire(oSymTable);
+      uDue = 0;
+      for (i = 0; i < iBindingCount; i++)
+      {
+         ulLifetime = ((unsigned long)i * 7919) % MAX_LIFETIME;
+         if (ulLifetime <= ulNow)
+            uDue++;
+      }
+      ASSURE(uExpired == uDue);
+      ASSURE(SymTable_getLength(oSymTable) ==
+         (size_t)iBindingCount - uDue);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return one of 13 hash codes for the uLen characters at pcKey, so
+   that many keys collide. */
+
+static size_t hashFewCodes(const char *pcKey, size_t uLen)
+{
+   if (uLen == 0)
+      return 0;
+   return (size_t)((unsigned char)pcKey[uLen - 1] % 13) * 1000003;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the count that pvExtra points to and check that pvValue is
+   the index of the key pcKey. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   ASSURE(atoi(pcKey) == *(int*)pvValue);
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test iBindingCount bindings whose keys have only a few hash codes,
+   so that most of them are kept in long chains or beyond them. */
+
+static void testCollisions(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   struct SymTableOps sOps = {NULL, hashFewCodes, NULL};
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int *piValues;
+   int iOther = -1;
+   size_t uCount = 0;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing many keys with the same hash codes.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   piValues = (int*)malloc(((size_t)iBindingCount + 1) * sizeof(int));
+   ASSURE(piValues != NULL);
+   oSymTable = SymTable_newWithOps(&sOps);
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      piValues[i] = i;
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, &piValues[i]));
+      ASSURE(! SymTable_put(oSymTable, acKey, &iOther));
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &piValues[i]);
+   }
+   ASSURE(! SymTable_contains(oSymTable, "x"));
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iBindingCount);
+
+   /* Shadows of colliding keys are undone like any others. */
+   ASSURE(SymTable_enterScope(oSymTable));
+   for (i = 0; i < iBindingCount; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, &iOther));
+   }
+   if (iBindingCount > 0)
+      ASSURE(SymTable_get(oSymTable, "0") == &iOther);
+   SymTable_exitScope(oSymTable);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &piValues[i]);
+   }
+
+   for (i = 1; i < iBindingCount; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &piValues[i]);
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+   ASSURE(SymTable_getLength(oSymTable) ==
+      (size_t)(iBindingCount + 1) / 2);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey) == (i % 2 == 0));
+      if (i % 2 != 0)
+         ASSURE(SymTable_put(oSymTable, acKey, &piValues[i]));
+   }
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_replace(oSymTable, acKey, &piValues[i]) ==
+         &piValues[i]);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+
+   SymTable_clear(oSymTable);
+   ASSURE(! SymTable_contains(oSymTable, "0"));
+   ASSURE(SymTable_put(oSymTable, "0", &iOther));
+
+   SymTable_free(oSymTable);
+   free(piValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The keys in the order that recordKey saw them */
+
+static const char *apcOrder[2][64];
+
+/*--------------------------------------------------------------------*/
+
+/* Store pcKey in the row *pvExtra of apcOrder, after the keys stored
+   there before. */
+
+static void recordKey(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   static size_t auSeen[2];
+   int iRow = *(int*)pvExtra;
+   (void)pvValue;
+   if (auSeen[iRow] < 64)
+      apcOrder[iRow][auSeen[iRow]++] = pcKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that tables with the same seed lay out the same keys the
+   same way. */
+
+static void testSeed(void)
+{
+   enum {KEY_COUNT = 64};
+   enum {MAX_KEY_LENGTH = 24};
+
+   SymTable_T aoSymTables[2];
+   int aiRows[2] = {0, 1};
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newWithSeed().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (i = 0; i < 2; i++)
+   {
+      aoSymTables[i] = SymTable_newWithSeed(0x0123456789abcdefu, 42);
+      ASSURE(aoSymTables[i] != NULL);
+   }
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE(SymTable_put(aoSymTables[0], acKey, NULL));
+      ASSURE(SymTable_put(aoSymTables[1], acKey, NULL));
+   }
+   for (i = 0; i < 2; i++)
+      SymTable_map(aoSymTables[i], recordKey, &aiRows[i]);
+   for (i = 0; i < KEY_COUNT; i++)
+      ASSURE(strcmp(apcOrder[0][i], apcOrder[1][i]) == 0);
+
+   for (i = 0; i < 2; i++)
+      SymTable_free(aoSymTables[i]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_loadFile() on a file of iBindingCount lines and a
+   few unusual ones, parsed by 1 and by 3 threads. */
+
+static void testLoadFile(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   const char *pcPath = "testhashext.tmp";
+   SymTable_T oSymTable;
+   FILE *psFile;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[MAX_KEY_LENGTH];
+   char acFirst[] = "first";
+   size_t uLoaded;
+   int iThreadCount;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_loadFile().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   psFile = fopen(pcPath, "w");
+   ASSURE(psFile != NULL);
+   fprintf(psFile, "key0\tbound before the load\n\n");
+   for (i = 0; i < iBindingCount; i++)
+      fprintf(psFile, "key%d\tvalue%d\n", i, i);
+   fprintf(psFile, "key1\tduplicate\n");
+   fprintf(psFile, "crlf\tvalue\r\n");
+   fprintf(psFile, "no tab\n");
+   fprintf(psFile, "\tempty key\n");
+   fprintf(psFile, "two\ttabs\there");
+   fclose(psFile);
+
+   for (iThreadCount = 1; iThreadCount <= 3; iThreadCount += 2)
+   {
+      oSymTable = SymTable_new();
+      ASSURE(oSymTable != NULL);
+      ASSURE(SymTable_put(oSymTable, "key0", acFirst));
+
+      ASSURE(SymTable_loadFile(oSymTable, pcPath, iThreadCount,
+         &uLoaded));
+      /* key0 is bound before and key1 is bound even if the loop
+         does not bind it */
+      ASSURE(uLoaded == (iBindingCount > 1 ?
+         (size_t)iBindingCount - 1 : 1) + 4);
+      ASSURE(SymTable_getLength(oSymTable) == uLoaded + 1);
+
+      ASSURE(SymTable_get(oSymTable, "key0") == acFirst);
+      for (i = 1; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "key%d", i);
+         sprintf(acValue, "value%d", i);
+         ASSURE(strcmp((char*)SymTable_get(oSymTable, acKey),
+            acValue) == 0);
+      }
+      ASSURE(strcmp((char*)SymTable_get(oSymTable, "crlf"), "value")
+         == 0);
+      ASSURE(strcmp((char*)SymTable_get(oSymTable, "no tab"), "") == 0);
+      ASSURE(strcmp((char*)SymTable_get(oSymTable, ""), "empty key")
+         == 0);
+      ASSURE(strcmp((char*)SymTable_get(oSymTable, "two"), "tabs\there")
+         == 0);
+
+      /* Loaded bindings are removed and replaced like any others. */
+      if (iBindingCount > 1)
+      {
+         ASSURE(SymTable_remove(oSymTable, "key1") != NULL);
+         ASSURE(! SymTable_contains(oSymTable, "key1"));
+         ASSURE(SymTable_put(oSymTable, "key1", acFirst));
+      }
+      ASSURE(SymTable_replace(oSymTable, "crlf", acFirst) != NULL);
+      ASSURE(SymTable_get(oSymTable, "crlf") == acFirst);
+
+      SymTable_free(oSymTable);
+   }
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   remove(pcPath);
+   ASSURE(! SymTable_loadFile(oSymTable, pcPath, 1, &uLoaded));
+   ASSURE(uLoaded == 0);
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_setAllocPolicy() on a table large enough for its
+   bucket array to be mapped in huge pages. */
+
+static void testAllocPolicy(void)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {KEY_COUNT = 70000};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_setAllocPolicy().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_setAllocPolicy(oSymTable, SYMTABLE_ALLOC_HUGE_PAGES |
+      SYMTABLE_ALLOC_EXPLICIT_HUGE_PAGES | SYMTABLE_ALLOC_NUMA_NODE, 0));
+
+   /* The table expands into mapped arrays on the way. */
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, NULL));
+   }
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+
+   /* Changing the policy moves the bindings to a new array. */
+   ASSURE(SymTable_setAllocPolicy(oSymTable, 0, 0));
+   ASSURE(SymTable_getLength(oSymTable) == KEY_COUNT);
+   ASSURE(SymTable_setAllocPolicy(oSymTable, SYMTABLE_ALLOC_HUGE_PAGES,
+      0));
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey));
+   }
+   ASSURE(! SymTable_contains(oSymTable, "-1"));
+
+   SymTable_clear(oSymTable);
+   ASSURE(SymTable_put(oSymTable, "0", NULL));
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that the bucket array holds one Bucket of at most a cache line
+   per bucket, before and after the table expands. */
+
+static void testBucketSizing(void)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   /* the number of buckets of a new table and of a table that has
+      expanded once, and the largest size of a Bucket */
+   enum {FIRST_COUNT = 509, SECOND_COUNT = 1021, MAX_BUCKET_SIZE = 64};
+
+   struct SymTableMemory sUsage;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   size_t uBucketSize;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the size of the bucket array.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   (void)SymTable_memoryUsage(oSymTable, &sUsage);
+   ASSURE(sUsage.buckets % FIRST_COUNT == 0);
+   uBucketSize = sUsage.buckets / FIRST_COUNT;
+   ASSURE(uBucketSize > 0 && uBucketSize <= MAX_BUCKET_SIZE);
+
+   for (i = 0; i <= 2 * FIRST_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, NULL));
+   }
+   (void)SymTable_memoryUsage(oSymTable, &sUsage);
+   ASSURE(sUsage.buckets == SECOND_COUNT * uBucketSize);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_openLog(), SymTable_sync() and SymTable_getLogStats()
+   with iBindingCount bindings: recovery of puts, replaces, removes and
+   clears, a torn record at the end of the log, and compaction. */
+
+static void testLog(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 16};
+   enum {BIG_VALUE_LENGTH = 1000};
+   enum {MAX_REPLACES = 20000};
+
+   const char *pcPath = "testhashext.log";
+   SymTable_T oSymTable;
+   FILE *psFile;
+   char (*pacValues)[MAX_KEY_LENGTH];
+   char acKey[MAX_KEY_LENGTH];
+   char acBig[2][BIG_VALUE_LENGTH + 1];
+   char acReplaced[] = "replaced";
+   char acAfter[] = "after";
+   size_t uLogged;
+   size_t uWritten;
+   size_t uSyncs;
+   size_t uCompactions = 0;
+   long lSize;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_openLog().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   pacValues = (char(*)[MAX_KEY_LENGTH])malloc(((size_t)iBindingCount + 1)
+      * MAX_KEY_LENGTH);
+   ASSURE(pacValues != NULL);
+   remove(pcPath);
+
+   /* Puts, replaces and removes are replayed when the log is opened
+      again. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcPath, 16, 0));
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      sprintf(pacValues[i], "value%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, pacValues[i]));
+   }
+   if (iBindingCount > 1)
+   {
+      ASSURE(SymTable_replace(oSymTable, "key0", acReplaced) ==
+         pacValues[0]);
+      ASSURE(SymTable_remove(oSymTable, "key1") == pacValues[1]);
+   }
+   ASSURE(SymTable_sync(oSymTable));
+   SymTable_getLogStats(oSymTable, &uLogged, &uWritten, &uSyncs, NULL);
+   ASSURE(uWritten >= uLogged);
+   ASSURE(iBindingCount == 0 || uSyncs > 0);
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcPath, 16, 0));
+   ASSURE(SymTable_getLength(oSymTable) == (iBindingCount > 1 ?
+      (size_t)iBindingCount - 1 : (size_t)iBindingCount));
+   if (iBindingCount > 1)
+   {
+      ASSURE(strcmp((char*)SymTable_get(oSymTable, "key0"), "replaced")
+         == 0);
+      ASSURE(! SymTable_contains(oSymTable, "key1"));
+   }
+   for (i = 2; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE(strcmp((char*)SymTable_get(oSymTable, acKey), pacValues[i])
+         == 0);
+   }
+
+   /* A clear drops everything before it. */
+   SymTable_clear(oSymTable);
+   ASSURE(SymTable_put(oSymTable, "after", acAfter));
+   SymTable_free(oSymTable);
+
+   /* A torn record at the end is dropped, and later records follow the
+      last whole one. */
+   psFile = fopen(pcPath, "ab");
+   ASSURE(psFile != NULL);
+   fwrite("P\005\000\000", 1, 4, psFile);
+   fclose(psFile);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcPath, 1, 0));
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "after"), "after") == 0);
+   ASSURE(SymTable_put(oSymTable, "torn", acAfter));
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcPath, 1, 0));
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "torn"), "after") == 0);
+   SymTable_free(oSymTable);
+
+   /* Replacing a large value again and again grows the log until a
+      compaction shrinks it to the live bindings. */
+   remove(pcPath);
+   memset(acBig[0], 'a', BIG_VALUE_LENGTH);
+   memset(acBig[1], 'b', BIG_VALUE_LENGTH);
+   acBig[0][BIG_VALUE_LENGTH] = '\0';
+   acBig[1][BIG_VALUE_LENGTH] = '\0';
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcPath, 64, 2));
+   ASSURE(SymTable_put(oSymTable, "big", acBig[0]));
+   ASSURE(SymTable_put(oSymTable, "small", acAfter));
+   for (i = 1; i < MAX_REPLACES && uCompactions == 0; i++)
+   {
+      ASSURE(SymTable_replace(oSymTable, "big", acBig[i % 2]) != NULL);
+      if (i % 64 == 0)
+      {
+         ASSURE(SymTable_sync(oSymTable));
+         SymTable_getLogStats(oSymTable, NULL, NULL, NULL,
+            &uCompactions);
+      }
+   }
+   ASSURE(uCompactions > 0);
+   ASSURE(SymTable_remove(oSymTable, "small") == acAfter);
+   SymTable_free(oSymTable);
+   psFile = fopen("testhashext.log.compact", "rb");
+   ASSURE(psFile == NULL);
+   if (psFile != NULL)
+      fclose(psFile);
+
+   psFile = fopen(pcPath, "rb");
+   ASSURE(psFile != NULL);
+   fseek(psFile, 0, SEEK_END);
+   lSize = ftell(psFile);
+   fclose(psFile);
+   ASSURE(lSize < 1000000);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcPath, 64, 2));
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "big"),
+      acBig[(i - 1) % 2]) == 0);
+   SymTable_free(oSymTable);
+
+   remove(pcPath);
+   free(pacValues);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_merge(), SymTable_intersect() and SymTable_diff() on
+   tables of iBindingCount keys whose bindings lie in trees, on tables
+   with the same seed, and on a table with a log. */
+
+static void testSetOps(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   struct SymTableOps sOps = {NULL, hashFewCodes, NULL};
+   const char *pcPath = "testhashext.log";
+   SymTable_T oSymTable1;
+   SymTable_T oSymTable2;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   int iHalf = iBindingCount / 2;
+   int iSeeded;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_merge(), SymTable_intersect() and "
+      "SymTable_diff() on trees and logs.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (iSeeded = 0; iSeeded <= 1; iSeeded++)
+   {
+      oSymTable1 = iSeeded ? SymTable_newWithSeed(1, 2) :
+         SymTable_newWithOps(&sOps);
+      oSymTable2 = iSeeded ? SymTable_newWithSeed(1, 2) :
+         SymTable_newWithOps(&sOps);
+      ASSURE(oSymTable1 != NULL && oSymTable2 != NULL);
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_put(oSymTable1, acKey, acValue));
+         sprintf(acKey, "%d", i + iHalf);
+         ASSURE(SymTable_put(oSymTable2, acKey, acValue));
+      }
+
+      ASSURE(SymTable_merge(oSymTable1, oSymTable2));
+      ASSURE(SymTable_getLength(oSymTable1) ==
+         (size_t)(iBindingCount + iHalf));
+      ASSURE(SymTable_getLength(oSymTable2) ==
+         (size_t)(iBindingCount - iHalf));
+      ASSURE(SymTable_intersect(oSymTable1, oSymTable2, NULL, NULL) ==
+         (size_t)(2 * iHalf));
+      for (i = 0; i < iBindingCount + iHalf; i++)
+      {
+         sprintf(acKey, "%d", i);
+         ASSURE(SymTable_contains(oSymTable1, acKey) ==
+            (i >= iHalf && i < iBindingCount));
+         ASSURE(SymTable_contains(oSymTable2, acKey) ==
+            (i >= iHalf && i < iBindingCount));
+      }
+      ASSURE(SymTable_diff(oSymTable2, oSymTable1, NULL, NULL) ==
+         (size_t)(iBindingCount - iHalf));
+      ASSURE(SymTable_getLength(oSymTable2) == 0);
+      SymTable_free(oSymTable1);
+      SymTable_free(oSymTable2);
+   }
+
+   /* Bindings a logged table loses or gains stay lost or gained when
+      the log is opened again. */
+   remove(pcPath);
+   oSymTable1 = SymTable_new();
+   oSymTable2 = SymTable_new();
+   ASSURE(oSymTable1 != NULL && oSymTable2 != NULL);
+   ASSURE(SymTable_openLog(oSymTable1, pcPath, 16, 0));
+   ASSURE(SymTable_put(oSymTable1, "kept", acValue));
+   ASSURE(SymTable_put(oSymTable1, "dropped", acValue));
+   ASSURE(SymTable_put(oSymTable2, "dropped", acValue));
+   ASSURE(SymTable_diff(oSymTable1, oSymTable2, NULL, NULL) == 1);
+   ASSURE(SymTable_remove(oSymTable2, "dropped") == acValue);
+   ASSURE(SymTable_put(oSymTable2, "merged", acValue));
+   ASSURE(SymTable_merge(oSymTable1, oSymTable2));
+   SymTable_free(oSymTable1);
+   SymTable_free(oSymTable2);
+
+   oSymTable1 = SymTable_new();
+   ASSURE(oSymTable1 != NULL);
+   ASSURE(SymTable_openLog(oSymTable1, pcPath, 16, 0));
+   ASSURE(SymTable_getLength(oSymTable1) == 2);
+   ASSURE(SymTable_contains(oSymTable1, "kept"));
+   ASSURE(SymTable_contains(oSymTable1, "merged"));
+   SymTable_free(oSymTable1);
+   remove(pcPath);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the count that pvExtra points to. */
+
+static void countValue(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   assert(pcKey != NULL);
+   assert(pvValue != NULL);
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable in multimap mode with iBindingCount values spread
+   over a fifth as many keys, first with the built-in functions and
+   then with values that the SymTable frees and keys that collide. */
+
+static void testMulti(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   struct SymTableOps sOps = {free, hashFewCodes, NULL};
+   SymTable_T oSymTable;
+   SymTable_T oOther;
+   void *const *ppvValues;
+   int *piValue;
+   int *piFirst;
+   char acKey[MAX_KEY_LENGTH];
+   int aiValues[] = {1, 2, 3};
+   int iKeyCount = iBindingCount / 5 + 1;
+   size_t uSmall;
+   size_t uCount;
+   size_t u;
+   int iOwned;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_putMulti(), SymTable_getAll() and "
+      "SymTable_removeOne().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newMulti(NULL);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getAll(oSymTable, "a", &uCount) == NULL);
+   ASSURE(uCount == 0);
+   ASSURE(SymTable_put(oSymTable, "a", &aiValues[0]));
+   ASSURE(! SymTable_put(oSymTable, "a", &aiValues[1]));
+   ASSURE(SymTable_putMulti(oSymTable, "a", &aiValues[1]));
+   ASSURE(SymTable_putMulti(oSymTable, "a", &aiValues[0]));
+   ASSURE(SymTable_putMulti(oSymTable, "b", &aiValues[2]));
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+   ASSURE(SymTable_get(oSymTable, "a") == &aiValues[0]);
+   ppvValues = SymTable_getAll(oSymTable, "a", &uCount);
+   ASSURE(uCount == 3);
+   ASSURE(ppvValues[0] == &aiValues[0] && ppvValues[1] == &aiValues[1]
+      && ppvValues[2] == &aiValues[0]);
+
+   /* Only the first of equal values goes, and the rest keep their
+      order. */
+   ASSURE(! SymTable_removeOne(oSymTable, "a", &aiValues[2]));
+   ASSURE(! SymTable_removeOne(oSymTable, "c", &aiValues[0]));
+   ASSURE(SymTable_removeOne(oSymTable, "a", &aiValues[0]));
+   ppvValues = SymTable_getAll(oSymTable, "a", &uCount);
+   ASSURE(uCount == 2);
+   ASSURE(ppvValues[0] == &aiValues[1] && ppvValues[1] == &aiValues[0]);
+   ASSURE(SymTable_removeOne(oSymTable, "b", &aiValues[2]));
+   ASSURE(! SymTable_contains(oSymTable, "b"));
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   uCount = 0;
+   SymTable_map(oSymTable, countValue, &uCount);
+   ASSURE(uCount == 2);
+   ASSURE(SymTable_remove(oSymTable, "a") == &aiValues[1]);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+
+   /* Many values per key outgrow the room kept in the key. */
+   uSmall = 0;
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i % iKeyCount);
+      ASSURE(SymTable_putMulti(oSymTable, acKey, &aiValues[i % 3]));
+      if (i == iKeyCount - 1)
+         uSmall = SymTable_memoryUsage(oSymTable, NULL);
+   }
+   ASSURE(SymTable_getLength(oSymTable) ==
+      (size_t)(iBindingCount < iKeyCount ? iBindingCount : iKeyCount));
+   if (iBindingCount > 10 * iKeyCount / 2)
+      ASSURE(SymTable_memoryUsage(oSymTable, NULL) > uSmall);
+   for (i = 0; i < iKeyCount && i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ppvValues = SymTable_getAll(oSymTable, acKey, &uCount);
+      ASSURE(uCount == (size_t)((iBindingCount - i - 1) / iKeyCount + 1));
+      for (u = 0; u < uCount; u++)
+         ASSURE(ppvValues[u] ==
+            &aiValues[(i + (int)u * iKeyCount) % 3]);
+   }
+   uCount = 0;
+   SymTable_map(oSymTable, countValue, &uCount);
+   ASSURE(uCount == (size_t)iBindingCount);
+   SymTable_free(oSymTable);
+
+   /* A SymTable that frees its values frees each of them once, however
+      they leave it. */
+   for (iOwned = 0; iOwned <= 1; iOwned++)
+   {
+      oSymTable = SymTable_newMulti(&sOps);
+      oOther = SymTable_newMulti(NULL);
+      ASSURE(oSymTable != NULL && oOther != NULL);
+      for (i = 0; i < iBindingCount; i++)
+      {
+         piValue = (int*)malloc(sizeof(int));
+         ASSURE(piValue != NULL);
+         *piValue = i;
+         sprintf(acKey, "%d", i % iKeyCount);
+         ASSURE(SymTable_putMulti(oSymTable, acKey, piValue));
+         if (i < iKeyCount && i % 2 == 0)
+            ASSURE(SymTable_put(oOther, acKey, &aiValues[0]));
+      }
+      for (i = 0; i < iKeyCount && i < iBindingCount; i += 3)
+      {
+         sprintf(acKey, "%d", i);
+         piFirst = (int*)SymTable_get(oSymTable, acKey);
+         ASSURE(piFirst != NULL && *piFirst == i);
+         if (i % 2 == 0)
+            ASSURE(SymTable_removeOne(oSymTable, acKey, piFirst));
+         else
+            ASSURE(SymTable_remove(oSymTable, acKey) == piFirst);
+      }
+      uCount = 0;
+      if (iOwned)
+         ASSURE(SymTable_diff(oSymTable, oOther, countValue, &uCount)
+            <= (size_t)iKeyCount);
+      SymTable_clear(oSymTable);
+      ASSURE(SymTable_getLength(oSymTable) == 0);
+      ASSURE(SymTable_putMulti(oSymTable, "0", malloc(sizeof(int))));
+      SymTable_free(oSymTable);
+      SymTable_free(oOther);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_compactStep() on a table of iBindingCount bindings
+   with keys that collide, which is changed between the steps, and
+   SymTable_compact() on bounded, expiring, loaded, logged and
+   multimap tables, whose keys are pointed to from elsewhere. */
+
+static void testCompactStep(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   struct SymTableOps sOps = {NULL, hashFewCodes, NULL};
+   const char *pcPath = "testhashext.tmp";
+   const char *pcLog = "testhashext.log";
+   SymTable_T oSymTable;
+   SymTable_T oOther;
+   FILE *psFile;
+   void *const *ppvValues;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[MAX_KEY_LENGTH];
+   char acLogged[] = "logged";
+   int *piIndices;
+   unsigned long ulNow = 1000;
+   struct SymTableMemory sUsage;
+   size_t uCount;
+   size_t uUsage;
+   int iChanges = 0;
+   int iResult;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_compactStep() and SymTable_compact().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   piIndices = (int*)malloc((size_t)(2 * iBindingCount + 1) *
+      sizeof(int));
+   ASSURE(piIndices != NULL);
+   for (i = 0; i < 2 * iBindingCount + 1; i++)
+      piIndices[i] = i;
+
+   /* Between steps a key is put, growing the table, and another is
+      removed. */
+   oSymTable = SymTable_newWithOps(&sOps);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, &piIndices[i]));
+   }
+   while ((iResult = SymTable_compactStep(oSymTable, 64)) == 0)
+      if (iChanges + 1 < iBindingCount)
+      {
+         iChanges++;
+         sprintf(acKey, "%d", iBindingCount + iChanges);
+         ASSURE(SymTable_put(oSymTable, acKey,
+            &piIndices[iBindingCount + iChanges]));
+         sprintf(acKey, "%d", iChanges);
+         ASSURE(SymTable_remove(oSymTable, acKey) == &piIndices[iChanges]);
+      }
+   ASSURE(iResult == 1);
+   ASSURE(iBindingCount < 1000 || iChanges > 0);
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+   for (i = 0; i <= iBindingCount + iChanges; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) ==
+         ((i < iBindingCount ? i == 0 || i > iChanges :
+         i > iBindingCount) ? &piIndices[i] : NULL));
+   }
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iBindingCount);
+   ASSURE(SymTable_compactStep(oSymTable, 0) == 1);
+   ASSURE(SymTable_compact(oSymTable));
+   SymTable_free(oSymTable);
+
+   /* A bounded table goes on evicting from its ring. */
+   oSymTable = SymTable_newBounded((size_t)iBindingCount / 2 + 1, NULL,
+      NULL);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, &piIndices[i]));
+   }
+   ASSURE(SymTable_compact(oSymTable));
+   for (i = iBindingCount; i < 2 * iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, &piIndices[i]));
+   }
+   ASSURE(SymTable_getLength(oSymTable) ==
+      (iBindingCount == 0 ? 0 : (size_t)iBindingCount / 2 + 1));
+   uCount = 0;
+   SymTable_map(oSymTable, countBinding, &uCount);
+   ASSURE(uCount == SymTable_getLength(oSymTable));
+   SymTable_free(oSymTable);
+
+   /* Timers find the moved keys. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   SymTable_setClock(oSymTable, readClock, &ulNow);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, &piIndices[i]));
+      ASSURE(SymTable_setExpiry(oSymTable, acKey,
+         i % 2 == 0 ? 10 : 1000));
+   }
+   ASSURE(SymTable_compact(oSymTable));
+   ulNow += 10;
+   ASSURE(SymTable_expire(oSymTable) == (size_t)(iBindingCount + 1) / 2);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey) == (i % 2 == 1));
+   }
+   SymTable_free(oSymTable);
+
+   /* Loaded values move with their keys, and keys loaded during a
+      compaction are moved by it. */
+   psFile = fopen(pcPath, "w");
+   ASSURE(psFile != NULL);
+   for (i = 0; i < iBindingCount; i++)
+      fprintf(psFile, "key%d\tvalue%d\n", i, i);
+   fclose(psFile);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_loadFile(oSymTable, pcPath, 2, NULL));
+   (void)SymTable_compactStep(oSymTable, 1);
+   psFile = fopen(pcPath, "w");
+   ASSURE(psFile != NULL);
+   for (i = 0; i < iBindingCount; i++)
+      fprintf(psFile, "more%d\tvalue%d\n", i, i);
+   fclose(psFile);
+   ASSURE(SymTable_loadFile(oSymTable, pcPath, 2, NULL));
+   ASSURE(SymTable_compact(oSymTable));
+   ASSURE(SymTable_getLength(oSymTable) == 2 * (size_t)iBindingCount);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acValue, "value%d", i);
+      sprintf(acKey, "key%d", i);
+      ASSURE(strcmp((char*)SymTable_get(oSymTable, acKey), acValue) == 0);
+      sprintf(acKey, "more%d", i);
+      ASSURE(strcmp((char*)SymTable_get(oSymTable, acKey), acValue) == 0);
+   }
+   SymTable_free(oSymTable);
+   remove(pcPath);
+
+   /* Values replayed from a log stay where they are. */
+   remove(pcLog);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcLog, 16, 0));
+   for (i = 0; i < 10; i++)
+   {
+      sprintf(acKey, "log%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, acLogged));
+   }
+   SymTable_free(oSymTable);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcLog, 16, 0));
+   ASSURE(SymTable_compact(oSymTable));
+   uUsage = SymTable_memoryUsage(oSymTable, &sUsage);
+
+   /* The block the ten keys are moved into is sized for them. */
+   ASSURE(sUsage.keys < 4096);
+
+   /* The replayed values move with their keys, so compacting again
+      frees the old arena rather than keeping it. */
+   for (i = 0; i < 4; i++)
+      ASSURE(SymTable_compact(oSymTable));
+   ASSURE(SymTable_memoryUsage(oSymTable, NULL) <= uUsage);
+   for (i = 0; i < 10; i++)
+   {
+      sprintf(acKey, "log%d", i);
+      ASSURE(strcmp((char*)SymTable_get(oSymTable, acKey), acLogged)
+         == 0);
+   }
+   SymTable_free(oSymTable);
+   remove(pcLog);
+
+   /* The values inline in multimap keys move with them. */
+   oSymTable = SymTable_newMulti(NULL);
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i / 3);
+      ASSURE(SymTable_putMulti(oSymTable, acKey, &piIndices[i]));
+   }
+   ASSURE(SymTable_compact(oSymTable));
+   for (i = 0; i < iBindingCount; i += 3)
+   {
+      sprintf(acKey, "%d", i / 3);
+      ppvValues = SymTable_getAll(oSymTable, acKey, &uCount);
+      ASSURE(uCount == (size_t)(iBindingCount - i < 3 ?
+         iBindingCount - i : 3));
+      ASSURE(ppvValues != NULL && ppvValues[0] == &piIndices[i]);
+   }
+
+   /* A second compaction moves them again, from one arena to the
+      other, and a merge copies them out of the arena. */
+   ASSURE(SymTable_compact(oSymTable));
+   for (i = 0; i < iBindingCount; i += 3)
+   {
+      sprintf(acKey, "%d", i / 3);
+      ASSURE(SymTable_putMulti(oSymTable, acKey, &piIndices[i]));
+      ppvValues = SymTable_getAll(oSymTable, acKey, &uCount);
+      ASSURE(uCount == (size_t)(iBindingCount - i < 3 ?
+         iBindingCount - i : 3) + 1);
+      ASSURE(ppvValues != NULL && ppvValues[0] == &piIndices[i]);
+      ASSURE(ppvValues[uCount - 1] == &piIndices[i]);
+   }
+   ASSURE(SymTable_compact(oSymTable));
+   oOther = SymTable_newMulti(NULL);
+   ASSURE(oOther != NULL);
+   ASSURE(SymTable_merge(oOther, oSymTable));
+   SymTable_free(oSymTable);
+   for (i = 0; i < iBindingCount; i += 3)
+   {
+      sprintf(acKey, "%d", i / 3);
+      ppvValues = SymTable_getAll(oOther, acKey, &uCount);
+      ASSURE(uCount == (size_t)(iBindingCount - i < 3 ?
+         iBindingCount - i : 3) + 1);
+      ASSURE(ppvValues != NULL && ppvValues[0] == &piIndices[i]);
+      ASSURE(SymTable_putMulti(oOther, acKey, &piIndices[i]));
+   }
+   SymTable_free(oOther);
+   free(piIndices);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test handles to iBindingCount bindings whose keys have only a few
+   hash codes, while the table expands, and the ways they are
+   invalidated. */
+
+static void testHandles(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   struct SymTableOps sOps = {NULL, hashFewCodes, NULL};
+   const char *pcLog = "testhashext.log";
+   SymTable_T oSymTable;
+   struct SymTableHandle *psHandles;
+   struct SymTableHandle sHandle;
+   char acKey[MAX_KEY_LENGTH];
+   char acA[] = "a";
+   char acB[] = "b";
+   char acChanged[] = "changed";
+   int *piIndices;
+   unsigned long ulNow = 1000;
+   size_t uEvicted = 0;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_find() and the handle functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   piIndices = (int*)malloc((size_t)(4 * iBindingCount + 1) *
+      sizeof(int));
+   psHandles = (struct SymTableHandle*)malloc(
+      (size_t)(iBindingCount + 1) * sizeof(struct SymTableHandle));
+   ASSURE(piIndices != NULL && psHandles != NULL);
+   for (i = 0; i < 4 * iBindingCount + 1; i++)
+      piIndices[i] = i;
+
+   /* Handles stay valid while the table grows and its chains move
+      into the tree and back. */
+   oSymTable = SymTable_newWithOps(&sOps);
+   ASSURE(oSymTable != NULL);
+   ASSURE(! SymTable_find(oSymTable, "0", &sHandle));
+   ASSURE(! SymTable_handleIsValid(oSymTable, &sHandle));
+   ASSURE(SymTable_handleValue(oSymTable, &sHandle) == NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, &piIndices[i]));
+      ASSURE(SymTable_find(oSymTable, acKey, &psHandles[i]));
+   }
+   for (i = iBindingCount; i < 4 * iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, &piIndices[i]));
+   }
+   for (i = 0; i < iBindingCount; i++)
+   {
+      ASSURE(SymTable_handleIsValid(oSymTable, &psHandles[i]));
+      ASSURE(SymTable_handleValue(oSymTable, &psHandles[i]) ==
+         &piIndices[i]);
+      ASSURE(SymTable_handleSet(oSymTable, &psHandles[i],
+         &piIndices[i + 1]) == &piIndices[i]);
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &piIndices[i + 1]);
+   }
+
+   /* A removal invalidates every handle, and new ones are made. */
+   if (iBindingCount > 0)
+   {
+      sprintf(acKey, "%d", 4 * iBindingCount - 1);
+      ASSURE(SymTable_remove(oSymTable, acKey) != NULL);
+      ASSURE(! SymTable_handleIsValid(oSymTable, &psHandles[0]));
+      ASSURE(SymTable_handleValue(oSymTable, &psHandles[0]) == NULL);
+      ASSURE(SymTable_handleSet(oSymTable, &psHandles[0], acA) ==
+         NULL);
+      ASSURE(SymTable_handleRemove(oSymTable, &psHandles[0]) == NULL);
+   }
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_find(oSymTable, acKey, &sHandle));
+      ASSURE(SymTable_handleRemove(oSymTable, &sHandle) ==
+         &piIndices[i + 1]);
+      ASSURE(! SymTable_handleIsValid(oSymTable, &sHandle));
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)(iBindingCount > 0 ?
+      3 * iBindingCount - 1 : 0));
+   SymTable_free(oSymTable);
+
+   /* A handle sees the binding a scope uncovers, and not one that
+      expired or was evicted. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_put(oSymTable, "a", acA));
+   ASSURE(SymTable_enterScope(oSymTable));
+   ASSURE(SymTable_put(oSymTable, "a", acB));
+   ASSURE(SymTable_find(oSymTable, "a", &sHandle));
+   ASSURE(SymTable_handleValue(oSymTable, &sHandle) == acB);
+   SymTable_exitScope(oSymTable);
+   ASSURE(SymTable_handleValue(oSymTable, &sHandle) == acA);
+   ASSURE(SymTable_enterScope(oSymTable));
+   ASSURE(SymTable_put(oSymTable, "a", acB));
+   ASSURE(SymTable_handleRemove(oSymTable, &sHandle) == acB);
+   ASSURE(SymTable_get(oSymTable, "a") == acA);
+   SymTable_exitScope(oSymTable);
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   SymTable_setClock(oSymTable, readClock, &ulNow);
+   ASSURE(SymTable_put(oSymTable, "a", acA));
+   ASSURE(SymTable_setExpiry(oSymTable, "a", 10));
+   ASSURE(SymTable_find(oSymTable, "a", &sHandle));
+   ulNow = 1010;
+   ASSURE(SymTable_handleValue(oSymTable, &sHandle) == NULL);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTable_newBounded(1, countEviction, &uEvicted);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_put(oSymTable, "a", acA));
+   ASSURE(SymTable_find(oSymTable, "a", &sHandle));
+   ASSURE(SymTable_put(oSymTable, "b", acB));
+   ASSURE(uEvicted == 1);
+   ASSURE(! SymTable_handleIsValid(oSymTable, &sHandle));
+   SymTable_free(oSymTable);
+
+   /* A compaction moves the keys, which invalidates the handles. */
+   oSymTable = SymTable_newMulti(NULL);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_putMulti(oSymTable, "a", acA));
+   ASSURE(SymTable_putMulti(oSymTable, "a", acB));
+   ASSURE(SymTable_find(oSymTable, "a", &sHandle));
+   ASSURE(SymTable_handleValue(oSymTable, &sHandle) == acA);
+   ASSURE(SymTable_compact(oSymTable));
+   ASSURE(! SymTable_handleIsValid(oSymTable, &sHandle));
+   ASSURE(SymTable_find(oSymTable, "a", &sHandle));
+   ASSURE(SymTable_handleRemove(oSymTable, &sHandle) == acA);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   SymTable_free(oSymTable);
+
+   /* Changes made through handles are logged. */
+   remove(pcLog);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcLog, 16, 0));
+   ASSURE(SymTable_put(oSymTable, "a", acA));
+   ASSURE(SymTable_put(oSymTable, "b", acB));
+   ASSURE(SymTable_find(oSymTable, "a", &sHandle));
+   ASSURE(SymTable_handleSet(oSymTable, &sHandle, acChanged) == acA);
+   ASSURE(SymTable_find(oSymTable, "b", &sHandle));
+   ASSURE(SymTable_handleRemove(oSymTable, &sHandle) == acB);
+   SymTable_free(oSymTable);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcLog, 16, 0));
+   ASSURE(SymTable_getLength(oSymTable) == 1);
+   ASSURE(strcmp((char*)SymTable_get(oSymTable, "a"), acChanged) == 0);
+   SymTable_free(oSymTable);
+   remove(pcLog);
+
+   free(psHandles);
+   free(piIndices);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if the number pcKey is odd, and 0 otherwise. pvValue and
+   pvExtra are unused. */
+
+static int isOdd(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   (void)pvValue;
+   (void)pvExtra;
+   return atoi(pcKey) % 2 == 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_removeIf() and SymTable_removeIfParallel() on
+   iBindingCount bindings whose keys have only a few hash codes, so
+   that many are kept in the tree, and on bounded, expiring, durable
+   and multimap tables. */
+
+static void testRemoveIfParallel(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 24};
+
+   struct SymTableOps sOps = {NULL, hashFewCodes, NULL};
+   const char *pcLog = "testhashext.log";
+   SymTable_T oSymTable;
+   struct SymTableHandle sHandle;
+   char acKey[MAX_KEY_LENGTH];
+   char acValue[] = "value";
+   int *piIndices;
+   unsigned long ulNow = 1000;
+   size_t uEvicted = 0;
+   size_t uRemoved;
+   size_t uCount;
+   int iThreadCount;
+   int iMulti;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_removeIf() and "
+      "SymTable_removeIfParallel().\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   piIndices = (int*)malloc((size_t)(iBindingCount + 1) * sizeof(int));
+   ASSURE(piIndices != NULL);
+   for (i = 0; i < iBindingCount + 1; i++)
+      piIndices[i] = i;
+
+   /* Any number of threads removes the same bindings, in chains and
+      in the tree, of a table in either mode. */
+   for (iMulti = 0; iMulti <= 1; iMulti++)
+      for (iThreadCount = 0; iThreadCount <= 5; iThreadCount++)
+      {
+         oSymTable = iMulti ? SymTable_newMulti(&sOps) :
+            SymTable_newWithOps(&sOps);
+         ASSURE(oSymTable != NULL);
+         for (i = 0; i < iBindingCount; i++)
+         {
+            sprintf(acKey, "%d", i);
+            ASSURE(iMulti ?
+               SymTable_putMulti(oSymTable, acKey, &piIndices[i]) &&
+               SymTable_putMulti(oSymTable, acKey, &piIndices[i + 1]) :
+               SymTable_put(oSymTable, acKey, &piIndices[i]));
+         }
+         ASSURE(SymTable_find(oSymTable, "0", &sHandle) ==
+            (iBindingCount > 0));
+         if (iThreadCount == 0)
+            uRemoved = SymTable_removeIf(oSymTable, isOdd, NULL);
+         else
+            ASSURE(SymTable_removeIfParallel(oSymTable, isOdd, NULL,
+               iThreadCount, &uRemoved));
+         ASSURE(uRemoved == (size_t)(iBindingCount / 2));
+         ASSURE(SymTable_getLength(oSymTable) ==
+            (size_t)(iBindingCount - iBindingCount / 2));
+         ASSURE(! SymTable_handleIsValid(oSymTable, &sHandle) ||
+            iBindingCount < 2);
+         for (i = 0; i < iBindingCount; i++)
+         {
+            sprintf(acKey, "%d", i);
+            ASSURE(SymTable_get(oSymTable, acKey) ==
+               (i % 2 == 0 ? &piIndices[i] : NULL));
+         }
+         uCount = 0;
+         if (! iMulti)
+         {
+            SymTable_map(oSymTable, countBinding, &uCount);
+            ASSURE(uCount == (size_t)(iBindingCount - iBindingCount / 2));
+         }
+         for (i = 1; i < iBindingCount; i += 2)
+         {
+            sprintf(acKey, "%d", i);
+            ASSURE(SymTable_put(oSymTable, acKey, &piIndices[i]));
+         }
+         ASSURE(SymTable_getLength(oSymTable) == (size_t)iBindingCount);
+         SymTable_free(oSymTable);
+      }
+
+   /* The ring of a bounded table and the timers of expiring bindings
+      lose the bindings removed. */
+   oSymTable = SymTable_newBounded(4, countEviction, &uEvicted);
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_put(oSymTable, "0", "0"));
+   ASSURE(SymTable_put(oSymTable, "1", "1"));
+   ASSURE(SymTable_put(oSymTable, "2", "2"));
+   ASSURE(SymTable_put(oSymTable, "3", "3"));
+   ASSURE(SymTable_removeIfParallel(oSymTable, isOdd, NULL, 2, NULL));
+   ASSURE(SymTable_getLength(oSymTable) == 2);
+   ASSURE(SymTable_put(oSymTable, "5", "5"));
+   ASSURE(SymTable_put(oSymTable, "7", "7"));
+   ASSURE(uEvicted == 0);
+   ASSURE(SymTable_put(oSymTable, "9", "9"));
+   ASSURE(uEvicted == 1);
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   SymTable_setClock(oSymTable, readClock, &ulNow);
+   ASSURE(SymTable_put(oSymTable, "1", acValue));
+   ASSURE(SymTable_put(oSymTable, "2", acValue));
+   ASSURE(SymTable_setExpiry(oSymTable, "1", 10));
+   ASSURE(SymTable_setExpiry(oSymTable, "2", 10));
+   ASSURE(SymTable_removeIfParallel(oSymTable, isOdd, NULL, 3, &uRemoved));
+   ASSURE(uRemoved == 1);
+   ulNow = 1010;
+   ASSURE(SymTable_expire(oSymTable) == 1);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   SymTable_free(oSymTable);
+
+   /* The removals are logged. */
+   remove(pcLog);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcLog, 16, 0));
+   for (i = 0; i < 10; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_put(oSymTable, acKey, acValue));
+   }
+   ASSURE(SymTable_removeIfParallel(oSymTable, isOdd, NULL, 2, &uRemoved));
+   ASSURE(uRemoved == 5);
+   SymTable_free(oSymTable);
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_openLog(oSymTable, pcLog, 16, 0));
+   ASSURE(SymTable_getLength(oSymTable) == 5);
+   ASSURE(SymTable_contains(oSymTable, "0"));
+   ASSURE(! SymTable_contains(oSymTable, "1"));
+   SymTable_free(oSymTable);
+   remove(pcLog);
+
+   free(piIndices);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the functions that only the hash table implementation of the
+   SymTable ADT provides. argv[1] is the number of bindings used by
+   the larger tests. Exit with EXIT_FAILURE if argv[1] is missing or
+   not numeric. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1 || iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount must be a nonnegative number\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testScopes();
+   testLargeScope(iBindingCount);
+   testBounded();
+   testBoundedChurn(iBindingCount);
+   testExpiry();
+   testExpirySweep(iBindingCount);
+   testCollisions(iBindingCount);
+   testSeed();
+   testLoadFile(iBindingCount);
+   testAllocPolicy();
+   testBucketSizing();
+   testLog(iBindingCount);
+   testSetOps(iBindingCount);
+   testMulti(iBindingCount);
+   testCompactStep(iBindingCount);
+   testHandles(iBindingCount);
+   testRemoveIfParallel(iBindingCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
@@ -0,0 +1,117 @@
+/*--------------------------------------------------------------------*/
+/* testperfect.c                                                      */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#include "symtablehash.h"
+#include "testkeywords.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that the generated table binds pcKey to the string pvValue,
+   and that it binds no prefix of pcKey or extension of it that
+   SymTable pvExtra does not bind. */
+
+static void checkKey(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   enum {MAX_KEY_LENGTH = 64};
+
+   SymTable_T oSymTable = (SymTable_T)pvExtra;
+   char acKey[MAX_KEY_LENGTH];
+   size_t uLength = strlen(pcKey);
+   size_t u;
+
+   ASSURE(testkeywords_contains(pcKey));
+   ASSURE(strcmp(testkeywords_get(pcKey), (const char*)pvValue) == 0);
+   ASSURE(strcmp(testkeywords_getN(pcKey, uLength),
+      (const char*)pvValue) == 0);
+
+   for (u = 0; u < uLength; u++)
+      ASSURE((testkeywords_getN(pcKey, u) != NULL) ==
+         SymTable_containsN(oSymTable, pcKey, u));
+   ASSURE(uLength + 2 < MAX_KEY_LENGTH);
+   sprintf(acKey, "%s_", pcKey);
+   ASSURE(testkeywords_contains(acKey) ==
+      SymTable_contains(oSymTable, acKey));
+   acKey[0] ^= 0x20;
+   acKey[uLength] = '\0';
+   ASSURE(testkeywords_contains(acKey) ==
+      SymTable_contains(oSymTable, acKey));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the perfect hash table that symtablegen wrote from
+   testkeywords.txt against a SymTable loaded from the same list with
+   SymTable_loadFile, with the keys of the list and argv[1] keys that
+   are not in it. Exit with EXIT_FAILURE if argv[1] is missing or not
+   numeric. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   enum {MAX_KEY_LENGTH = 16};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int iBindingCount;
+   int i;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1 || iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount must be a nonnegative number\n");
+      exit(EXIT_FAILURE);
+   }
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the table generated by symtablegen.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_loadFile(oSymTable, "testkeywords.txt", 1, NULL));
+   ASSURE(testkeywords_getLength() == SymTable_getLength(oSymTable));
+
+   /* The first line of a key binds it, as with SymTable_loadFile. */
+   ASSURE(strcmp(testkeywords_get("int"), "type") == 0);
+   ASSURE(! testkeywords_contains(""));
+   SymTable_map(oSymTable, checkKey, oSymTable);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(! testkeywords_contains(acKey));
+      ASSURE(testkeywords_getN(acKey, strlen(acKey)) == NULL);
+   }
+
+   SymTable_free(oSymTable);
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
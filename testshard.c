@@ -0,0 +1,206 @@
+/*--------------------------------------------------------------------*/
+/* testshard.c                                                        */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtableshard.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the count that pvExtra points to. pcKey and pvValue are
+   unused. */
+
+static void countBinding(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   assert(pcKey != NULL);
+   (void)pvValue;
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ShardedSymTable functions from a single thread. */
+
+static void testBasics(void)
+{
+   enum {MAX_KEY_LENGTH = 12};
+   enum {KEY_COUNT = 1000};
+
+   ShardedSymTable_T oTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char *pcValue;
+   size_t uCount = 0;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the ShardedSymTable functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oTable = ShardedSymTable_new(6);
+   ASSURE(oTable != NULL);
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(ShardedSymTable_put(oTable, acKey, acShortstop));
+   }
+   ASSURE(! ShardedSymTable_put(oTable, "7", acCenterField));
+   ASSURE(ShardedSymTable_getLength(oTable) == KEY_COUNT);
+
+   ShardedSymTable_map(oTable, countBinding, &uCount);
+   ASSURE(uCount == KEY_COUNT);
+
+   ASSURE(ShardedSymTable_contains(oTable, "999"));
+   ASSURE(! ShardedSymTable_contains(oTable, "1000"));
+
+   pcValue = (char*)ShardedSymTable_replace(oTable, "42", acCenterField);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)ShardedSymTable_get(oTable, "42");
+   ASSURE(pcValue == acCenterField);
+
+   pcValue = (char*)ShardedSymTable_remove(oTable, "42");
+   ASSURE(pcValue == acCenterField);
+   pcValue = (char*)ShardedSymTable_remove(oTable, "42");
+   ASSURE(pcValue == NULL);
+   ASSURE(ShardedSymTable_getLength(oTable) == KEY_COUNT - 1);
+
+   ShardedSymTable_free(oTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* struct Worker describes the share of a concurrent test that one
+   thread performs. */
+
+struct Worker
+{
+   /* the table every thread uses */
+   ShardedSymTable_T oTable;
+   /* number of keys every thread tries to put */
+   int iKeyCount;
+   /* number of puts that succeeded in this thread */
+   int iSuccesses;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Put the keys 0 through iKeyCount-1 into the table described by
+   pvWorker, counting the puts that succeed. Return NULL. */
+
+static void *putKeys(void *pvWorker)
+{
+   enum {MAX_KEY_LENGTH = 12};
+
+   struct Worker *psWorker = (struct Worker*)pvWorker;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+
+   for (i = 0; i < psWorker->iKeyCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (ShardedSymTable_put(psWorker->oTable, acKey, NULL))
+         psWorker->iSuccesses++;
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that THREAD_COUNT threads that all put the same iKeyCount keys
+   at once succeed exactly once per key. */
+
+static void testConcurrentPuts(int iKeyCount)
+{
+   enum {THREAD_COUNT = 4};
+
+   ShardedSymTable_T oTable;
+   pthread_t aThreads[THREAD_COUNT];
+   struct Worker asWorkers[THREAD_COUNT];
+   int iSuccesses = 0;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing concurrent ShardedSymTable_put() calls.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oTable = ShardedSymTable_new(16);
+   ASSURE(oTable != NULL);
+
+   for (i = 0; i < THREAD_COUNT; i++)
+   {
+      asWorkers[i].oTable = oTable;
+      asWorkers[i].iKeyCount = iKeyCount;
+      asWorkers[i].iSuccesses = 0;
+      ASSURE(pthread_create(&aThreads[i], NULL, putKeys,
+         &asWorkers[i]) == 0);
+   }
+   for (i = 0; i < THREAD_COUNT; i++)
+   {
+      pthread_join(aThreads[i], NULL);
+      iSuccesses += asWorkers[i].iSuccesses;
+   }
+
+   ASSURE(iSuccesses == iKeyCount);
+   ASSURE(ShardedSymTable_getLength(oTable) == (size_t)iKeyCount);
+
+   ShardedSymTable_free(oTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ShardedSymTable ADT. argv[1] is the number of keys that
+   each thread of the concurrent test puts. Exit with EXIT_FAILURE if
+   argv[1] is missing or not numeric. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iKeyCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iKeyCount) != 1 || iKeyCount < 0)
+   {
+      fprintf(stderr, "bindingcount must be a nonnegative number\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testBasics();
+   testConcurrentPuts(iKeyCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
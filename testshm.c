@@ -0,0 +1,380 @@
+/*--------------------------------------------------------------------*/
+/* testshm.c                                                          */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "symtableshm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* The size of the buffer of a key or of the name of a segment */
+
+enum {MAX_KEY_LENGTH = 32};
+
+/* The number of processes that attach to the segment of
+   testProcesses() */
+
+enum {CHILD_COUNT = 3};
+
+/*--------------------------------------------------------------------*/
+
+/* The number of failed tests, which a child process exits with */
+
+static int iFailures;
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+      iFailures++;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add 1 to the count that pvExtra points to and check that the
+   value pvValue, of uLength bytes, is the index of the key pcKey. */
+
+static void countBinding(const char *pcKey, const void *pvValue,
+   size_t uLength, void *pvExtra)
+{
+   int iValue;
+
+   ASSURE(uLength == sizeof(int));
+   memcpy(&iValue, pvValue, sizeof(int));
+   ASSURE(atoi(pcKey + 3) == iValue);
+   (*(size_t*)pvExtra)++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Check that looking up the key pcKey in the SharedSymTable that
+   pvExtra is finds its value pvValue, of uLength bytes, while
+   SharedSymTable_map() holds the lock of the segment. */
+
+static void lookUpBinding(const char *pcKey, const void *pvValue,
+   size_t uLength, void *pvExtra)
+{
+   int iValue;
+   size_t uFound = sizeof(int);
+
+   ASSURE(SharedSymTable_get((SharedSymTable_T)pvExtra, pcKey,
+      &iValue, &uFound));
+   ASSURE(uFound == uLength && memcmp(&iValue, pvValue, uLength) == 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Exit from the process at once, while SharedSymTable_map() holds
+   the lock of the segment. pcKey, pvValue, uLength and pvExtra are
+   ignored. */
+
+static void exitHoldingLock(const char *pcKey, const void *pvValue,
+   size_t uLength, void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvValue;
+   (void)uLength;
+   (void)pvExtra;
+   _exit(0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SharedSymTable functions from a single process. */
+
+static void testBasics(void)
+{
+   SharedSymTable_T oTable;
+   SharedSymTable_T oOther;
+   char acName[MAX_KEY_LENGTH];
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char acValue[sizeof(acCenterField)];
+   size_t uLength;
+   size_t uUsed;
+   size_t uSize;
+   size_t uCount;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SharedSymTable functions in one process.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   sprintf(acName, "/testshm.%ld.a", (long)getpid());
+   ASSURE(SharedSymTable_attach(acName) == NULL);
+   oTable = SharedSymTable_create(acName, 1 << 16);
+   ASSURE(oTable != NULL);
+   ASSURE(SharedSymTable_create(acName, 1 << 16) == NULL);
+   ASSURE(SharedSymTable_getLength(oTable) == 0);
+
+   ASSURE(SharedSymTable_put(oTable, "Ruth", acShortstop,
+      sizeof(acShortstop)));
+   ASSURE(! SharedSymTable_put(oTable, "Ruth", acCenterField,
+      sizeof(acCenterField)));
+   ASSURE(SharedSymTable_put(oTable, "", NULL, 0));
+   ASSURE(SharedSymTable_contains(oTable, "Ruth"));
+   ASSURE(SharedSymTable_contains(oTable, ""));
+   ASSURE(! SharedSymTable_contains(oTable, "Gehrig"));
+   uLength = sizeof(acValue);
+   ASSURE(SharedSymTable_get(oTable, "Ruth", acValue, &uLength));
+   ASSURE(uLength == sizeof(acShortstop));
+   ASSURE(strcmp(acValue, acShortstop) == 0);
+   uLength = 0;
+   ASSURE(SharedSymTable_get(oTable, "", NULL, &uLength));
+   ASSURE(uLength == 0);
+
+   /* A value longer than the buffer is cut short. */
+   uLength = 4;
+   memset(acValue, 0, sizeof(acValue));
+   ASSURE(SharedSymTable_get(oTable, "Ruth", acValue, &uLength));
+   ASSURE(uLength == sizeof(acShortstop));
+   ASSURE(strcmp(acValue, "Shor") == 0);
+
+   /* A longer value moves the binding to a larger block. */
+   ASSURE(SharedSymTable_replace(oTable, "Ruth", acCenterField,
+      sizeof(acCenterField)));
+   ASSURE(SharedSymTable_replace(oTable, "Ruth", acShortstop,
+      sizeof(acShortstop)));
+   ASSURE(! SharedSymTable_replace(oTable, "Gehrig", acShortstop,
+      sizeof(acShortstop)));
+   uLength = sizeof(acValue);
+   ASSURE(SharedSymTable_get(oTable, "Ruth", acValue, &uLength));
+   ASSURE(strcmp(acValue, acShortstop) == 0);
+
+   /* A second view of the segment sees the same bindings. */
+   oOther = SharedSymTable_attach(acName);
+   ASSURE(oOther != NULL);
+   ASSURE(SharedSymTable_getLength(oOther) == 2);
+   ASSURE(SharedSymTable_remove(oOther, "Ruth"));
+   ASSURE(! SharedSymTable_remove(oOther, "Ruth"));
+   ASSURE(! SharedSymTable_contains(oTable, "Ruth"));
+   ASSURE(SharedSymTable_remove(oTable, ""));
+   ASSURE(SharedSymTable_getLength(oTable) == 0);
+   SharedSymTable_detach(oOther);
+
+   /* The segment fills up, and the blocks of removed bindings are
+      used again. */
+   for (i = 0; ; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      if (! SharedSymTable_put(oTable, acKey, &i, sizeof(int)))
+         break;
+   }
+   ASSURE(i > 100);
+   ASSURE(SharedSymTable_getLength(oTable) == (size_t)i);
+   SharedSymTable_getUsage(oTable, &uUsed, &uSize);
+   ASSURE(uSize == 1 << 16 && uUsed <= uSize);
+   ASSURE(! SharedSymTable_contains(oTable, acKey));
+   ASSURE(SharedSymTable_remove(oTable, "key7"));
+   ASSURE(SharedSymTable_put(oTable, "key7", &i, sizeof(int)));
+   ASSURE(SharedSymTable_replace(oTable, "key7", &i, sizeof(int)));
+   i = 7;
+   ASSURE(SharedSymTable_replace(oTable, "key7", &i, sizeof(int)));
+   uCount = 0;
+   SharedSymTable_map(oTable, countBinding, &uCount);
+   ASSURE(uCount == SharedSymTable_getLength(oTable));
+   SharedSymTable_map(oTable, lookUpBinding, oTable);
+
+   SharedSymTable_detach(oTable);
+   ASSURE(SharedSymTable_unlink(acName));
+   ASSURE(! SharedSymTable_unlink(acName));
+   ASSURE(SharedSymTable_attach(acName) == NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Attach to the segment named pcName and look up each of its
+   iBindingCount keys, some of them several times over, while the
+   parent process changes other keys. Exit with the number of failed
+   tests. */
+
+static void lookUpKeys(const char *pcName, int iBindingCount)
+{
+   SharedSymTable_T oTable;
+   char acKey[MAX_KEY_LENGTH];
+   size_t uLength;
+   int iValue;
+   int iRound;
+   int i;
+
+   iFailures = 0;
+   oTable = SharedSymTable_attach(pcName);
+   ASSURE(oTable != NULL);
+   if (oTable == NULL)
+      _exit(1);
+   for (iRound = 0; iRound < 4; iRound++)
+      for (i = 0; i < iBindingCount; i++)
+      {
+         sprintf(acKey, "key%d", i);
+         uLength = sizeof(int);
+         ASSURE(SharedSymTable_get(oTable, acKey, &iValue, &uLength));
+         ASSURE(uLength == sizeof(int) && iValue == i);
+      }
+   SharedSymTable_detach(oTable);
+   fflush(stdout);
+   _exit(iFailures > 255 ? 255 : iFailures);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test CHILD_COUNT processes that attach to a segment of
+   iBindingCount bindings and look them up while this process adds
+   and removes other bindings, growing the bucket array. */
+
+static void testProcesses(int iBindingCount)
+{
+   SharedSymTable_T oTable;
+   char acName[MAX_KEY_LENGTH];
+   char acKey[MAX_KEY_LENGTH];
+   pid_t aiChildren[CHILD_COUNT];
+   size_t uCount;
+   int iStatus;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing processes that look up keys while another "
+      "changes the SharedSymTable.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   sprintf(acName, "/testshm.%ld.b", (long)getpid());
+   oTable = SharedSymTable_create(acName,
+      (size_t)iBindingCount * 256 + (1 << 20));
+   ASSURE(oTable != NULL);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "key%d", i);
+      ASSURE(SharedSymTable_put(oTable, acKey, &i, sizeof(int)));
+   }
+
+   for (i = 0; i < CHILD_COUNT; i++)
+   {
+      aiChildren[i] = fork();
+      ASSURE(aiChildren[i] >= 0);
+      if (aiChildren[i] == 0)
+         lookUpKeys(acName, iBindingCount);
+   }
+
+   for (i = 0; i < 4 * iBindingCount; i++)
+   {
+      sprintf(acKey, "other%d", i);
+      ASSURE(SharedSymTable_put(oTable, acKey, &i, sizeof(int)));
+      if (i % 2 == 0)
+         ASSURE(SharedSymTable_remove(oTable, acKey));
+   }
+   for (i = 0; i < CHILD_COUNT; i++)
+   {
+      ASSURE(waitpid(aiChildren[i], &iStatus, 0) == aiChildren[i]);
+      ASSURE(WIFEXITED(iStatus) && WEXITSTATUS(iStatus) == 0);
+   }
+
+   ASSURE(SharedSymTable_getLength(oTable) ==
+      (size_t)(iBindingCount + 2 * iBindingCount));
+   for (i = 0; i < 4 * iBindingCount; i += 2)
+   {
+      sprintf(acKey, "other%d", i + 1);
+      ASSURE(SharedSymTable_remove(oTable, acKey));
+   }
+   uCount = 0;
+   SharedSymTable_map(oTable, countBinding, &uCount);
+   ASSURE(uCount == (size_t)iBindingCount);
+
+   SharedSymTable_detach(oTable);
+   ASSURE(SharedSymTable_unlink(acName));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that a process that dies while it holds the lock of a segment,
+   without changing it, leaves the segment usable by the others. */
+
+static void testDeadHolder(void)
+{
+   SharedSymTable_T oTable;
+   char acName[MAX_KEY_LENGTH];
+   pid_t iChild;
+   size_t uLength;
+   int iValue = 7;
+   int iStatus;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a process that dies holding the lock.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   sprintf(acName, "/testshm.%ld.c", (long)getpid());
+   oTable = SharedSymTable_create(acName, 1 << 16);
+   ASSURE(oTable != NULL);
+   ASSURE(SharedSymTable_put(oTable, "key7", &iValue, sizeof(int)));
+
+   iChild = fork();
+   ASSURE(iChild >= 0);
+   if (iChild == 0)
+      SharedSymTable_map(oTable, exitHoldingLock, NULL);
+   ASSURE(waitpid(iChild, &iStatus, 0) == iChild);
+   ASSURE(WIFEXITED(iStatus) && WEXITSTATUS(iStatus) == 0);
+
+   ASSURE(! SharedSymTable_isDamaged(oTable));
+   ASSURE(SharedSymTable_put(oTable, "key8", &iValue, sizeof(int)));
+   uLength = sizeof(int);
+   iValue = 0;
+   ASSURE(SharedSymTable_get(oTable, "key7", &iValue, &uLength));
+   ASSURE(uLength == sizeof(int) && iValue == 7);
+   ASSURE(SharedSymTable_getLength(oTable) == 2);
+
+   SharedSymTable_detach(oTable);
+   ASSURE(SharedSymTable_unlink(acName));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SharedSymTable ADT. argv[1] is the number of bindings
+   used by the larger tests. Exit with EXIT_FAILURE if argv[1] is
+   missing or not numeric. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1 || iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount must be a nonnegative number\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testBasics();
+   testProcesses(iBindingCount);
+   testDeadHolder();
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}
@@ -0,0 +1,156 @@
+/*--------------------------------------------------------------------*/
+/* testu64.c                                                          */
+/* Author: Yavuz Gonen                                                */
+/*--------------------------------------------------------------------*/
+
+#include "symtableu64.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add uKey to the sum that pvExtra points to. pvValue is unused. */
+
+static void sumKey(uint64_t uKey, void *pvValue, void *pvExtra)
+{
+   (void)pvValue;
+   *(uint64_t*)pvExtra += uKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTableU64 functions on a few keys, including 0. */
+
+static void testBasics(void)
+{
+   SymTableU64_T oSymTable;
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   uint64_t uSum = 0;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTableU64 functions.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newU64();
+   ASSURE(oSymTable != NULL);
+   ASSURE(SymTable_getLengthU64(oSymTable) == 0);
+
+   ASSURE(SymTable_putU64(oSymTable, 0, acShortstop));
+   ASSURE(! SymTable_putU64(oSymTable, 0, acCenterField));
+   ASSURE(SymTable_putU64(oSymTable, UINT64_MAX, acCenterField));
+   ASSURE(SymTable_putU64(oSymTable, 2, NULL));
+   ASSURE(SymTable_getLengthU64(oSymTable) == 3);
+
+   ASSURE(SymTable_getU64(oSymTable, 0) == acShortstop);
+   ASSURE(SymTable_getU64(oSymTable, UINT64_MAX) == acCenterField);
+   ASSURE(SymTable_getU64(oSymTable, 1) == NULL);
+   ASSURE(SymTable_containsU64(oSymTable, 2));
+   ASSURE(! SymTable_containsU64(oSymTable, 3));
+
+   ASSURE(SymTable_replaceU64(oSymTable, 0, acCenterField) ==
+      acShortstop);
+   ASSURE(SymTable_replaceU64(oSymTable, 3, acCenterField) == NULL);
+
+   SymTable_mapU64(oSymTable, sumKey, &uSum);
+   ASSURE(uSum == UINT64_MAX + 2);
+
+   ASSURE(SymTable_removeU64(oSymTable, 0) == acCenterField);
+   ASSURE(SymTable_removeU64(oSymTable, 0) == NULL);
+   ASSURE(! SymTable_containsU64(oSymTable, 0));
+   ASSURE(SymTable_getLengthU64(oSymTable) == 2);
+
+   SymTable_freeU64(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTableU64 with iBindingCount bindings, removing every
+   third one and checking that the rest can still be found. */
+
+static void testLargeTable(int iBindingCount)
+{
+   SymTableU64_T oSymTable;
+   uint64_t uKey;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTableU64 with many bindings.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_newU64();
+   ASSURE(oSymTable != NULL);
+
+   /* Keys that are multiples of a power of 2 share their low bits. */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      uKey = (uint64_t)i << 20;
+      ASSURE(SymTable_putU64(oSymTable, uKey, (void*)&oSymTable));
+   }
+   ASSURE(SymTable_getLengthU64(oSymTable) == (size_t)iBindingCount);
+
+   for (i = 0; i < iBindingCount; i += 3)
+      ASSURE(SymTable_removeU64(oSymTable, (uint64_t)i << 20) ==
+         (void*)&oSymTable);
+   for (i = 0; i < iBindingCount; i++)
+   {
+      uKey = (uint64_t)i << 20;
+      ASSURE(SymTable_containsU64(oSymTable, uKey) == (i % 3 != 0));
+      ASSURE(! SymTable_containsU64(oSymTable, uKey + 1));
+   }
+   ASSURE(SymTable_getLengthU64(oSymTable) ==
+      (size_t)iBindingCount - ((size_t)iBindingCount + 2) / 3);
+
+   SymTable_freeU64(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTableU64 ADT. argv[1] is the number of bindings used by
+   the larger tests. Exit with EXIT_FAILURE if argv[1] is missing or
+   not numeric. Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+
+   if (argc != 2)
+   {
+      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1 || iBindingCount < 0)
+   {
+      fprintf(stderr, "bindingcount must be a nonnegative number\n");
+      exit(EXIT_FAILURE);
+   }
+
+   testBasics();
+   testLargeTable(iBindingCount);
+
+   printf("------------------------------------------------------\n");
+   printf("End of %s.\n", argv[0]);
+   return 0;
+}